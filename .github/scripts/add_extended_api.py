@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+#
+# If not stated otherwise in this file or this component's LICENSE file the
+# following copyright and licenses apply:
+#
+# Copyright 2024 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# Declares the methods built with PLUGIN_<NAME>_EXTENDED_API in a checkout of
+# entservices-apis that does not declare them yet, so CI can build and test
+# them. Methods the interface already declares are left alone.
+#
+# usage: add_extended_api.py <entservices-apis/interfaces> <Plugin>...
+
+import os
+import re
+import sys
+
+METHODS = {
+    "TextToSpeech": ("ITextToSpeech", [
+        ("SpeakBatch",
+         "virtual Core::hresult SpeakBatch(const string callsign, RPC::IStringIterator* const texts, "
+         "uint32_t &firstspeechid /* @out */, TTSErrorDetail &status /* @out */) = 0;"),
+    ]),
+    "SystemAudioPlayer": ("ISystemAudioPlayer", [
+        ("PlayBufferRaw",
+         "virtual Core::hresult PlayBufferRaw(const int32_t id, const uint8_t data[] /* @length:length */, "
+         "const uint32_t length) = 0;"),
+        ("GetStatistics",
+         "virtual Core::hresult GetStatistics(const string &input, string &output /* @out */) = 0;"),
+        ("Enqueue",
+         "virtual Core::hresult Enqueue(const string &input, string &output /* @out */) = 0;"),
+        ("PrepareOnly",
+         "virtual Core::hresult PrepareOnly(const string &input, string &output /* @out */) = 0;"),
+        ("PlayAt",
+         "virtual Core::hresult PlayAt(const string &input, string &output /* @out */) = 0;"),
+    ]),
+}
+
+
+def find_closing_brace(text, pos):
+    depth = 1
+    while depth:
+        if text.startswith("//", pos):
+            pos = text.index("\n", pos)
+        elif text.startswith("/*", pos):
+            pos = text.index("*/", pos) + 1
+        elif text[pos] == "{":
+            depth += 1
+        elif text[pos] == "}":
+            depth -= 1
+        pos += 1
+    return pos - 1
+
+
+def add_methods(interfaces, plugin):
+    struct, methods = METHODS[plugin]
+    path = os.path.join(interfaces, struct + ".h")
+    with open(path) as f:
+        text = f.read()
+
+    # Appended at the end of the struct, where the types the methods use
+    # are already declared
+    opening = re.search(r"struct\s+EXTERNAL\s+" + struct + r"\b[^{;]*\{", text)
+    if not opening:
+        sys.exit("%s: cannot find the declaration of %s" % (path, struct))
+    closing = find_closing_brace(text, opening.end())
+    closing = text.rindex("\n", 0, closing) + 1
+
+    added = ""
+    for name, declaration in methods:
+        if re.search(r"\b" + name + r"\s*\(", text):
+            print("%s: %s already declared" % (path, name))
+            continue
+        added += "        " + declaration + "\n"
+        print("%s: declared %s" % (path, name))
+
+    text = text[:closing] + added + text[closing:]
+    with open(path, "w") as f:
+        f.write(text)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 3:
+        sys.exit("usage: %s <entservices-apis/interfaces> <Plugin>..." % sys.argv[0])
+    for plugin in sys.argv[2:]:
+        add_methods(sys.argv[1], plugin)
@@ -104,6 +104,11 @@ namespace Plugin {
 
         uint32_t Open(const JsonObject& parameters, JsonObject& response);
         uint32_t Play(const JsonObject& parameters, JsonObject& response);
+#ifdef SYSTEMAUDIOPLAYER_EXTENDED_API
+        uint32_t Enqueue(const JsonObject& parameters, JsonObject& response);
+        uint32_t PrepareOnly(const JsonObject& parameters, JsonObject& response);
+        uint32_t PlayAt(const JsonObject& parameters, JsonObject& response);
+#endif
         uint32_t PlayBuffer(const JsonObject& parameters, JsonObject& response);
         uint32_t Pause(const JsonObject& parameters, JsonObject& response);
         uint32_t Resume(const JsonObject& parameters, JsonObject& response);
@@ -114,6 +119,9 @@ namespace Plugin {
         uint32_t IsPlaying(const JsonObject& parameters, JsonObject& response);
 	uint32_t Config(const JsonObject& parameters, JsonObject& response);
         uint32_t GetPlayerSessionId(const JsonObject& parameters, JsonObject& response);
+#ifdef SYSTEMAUDIOPLAYER_EXTENDED_API
+        uint32_t GetStatistics(const JsonObject& parameters, JsonObject& response);
+#endif
 
         //version number API's
         uint32_t getapiversion(const JsonObject& parameters, JsonObject& response);
@@ -19,13 +19,31 @@
 
 #include "SystemAudioPlayerImplementation.h"
 #include <sys/prctl.h>
+#include <algorithm>
+#include <atomic>
+#include <sstream>
 #include "impl/Helper.h"
-#include "base64.h"
+#include "impl/Base64Decoder.h"
+#include "impl/FeederPool.h"
+#include "impl/PipelinePool.h"
+#include "impl/EarconCache.h"
+#include "impl/MixerOutput.h"
+#include "WebSockets/EventLoop.h"
+#include "WebSockets/Encryption/TlsSessionCache.h"
 #include "UtilsJsonRpc.h"
 
 #define SAP_MAJOR_VERSION 1
 #define SAP_MINOR_VERSION 0
 
+// "shm" players: 2s of 48kHz stereo S16LE, rounded to a power of two
+#define SHM_RING_DEFAULT_SIZE (512 * 1024)
+
+// Longest wait for closed players to be torn down on deinit
+#define SESSION_TEARDOWN_TIMEOUT_MS 3000
+
+// Sent once a closed player was torn down
+#define PLAYER_CLOSED "PLAYER_CLOSED"
+
 #define GET_STR(map, key, def) ((map.HasLabel(key) && !map[key].String().empty() && map[key].String() != "null") ? map[key].String() : def)
 #define CONVERT_PARAMETERS_TOJSON() JsonObject parameters, response; parameters.FromString(input);
 #define CONVERT_PARAMETERS_FROMJSON() response.ToString(output);
@@ -40,23 +58,161 @@
 namespace WPEFramework {
 namespace Plugin {
 
+#ifdef SYSTEMAUDIOPLAYER_EXTENDED_API
+    static JsonObject playbackStatsToJson(const PlaybackStats::Snapshot &stats)
+    {
+        JsonObject json;
+        json["bytesReceived"] = (uint64_t) stats.bytesReceived;
+        json["bytesPushed"] = (uint64_t) stats.bytesPushed;
+        json["buffersDropped"] = (uint64_t) stats.buffersDropped;
+        json["bytesDropped"] = (uint64_t) stats.bytesDropped;
+        json["queueHighWater"] = (uint64_t) stats.queueHighWater;
+        json["underruns"] = (uint64_t) stats.underruns;
+        json["feedPauses"] = (uint64_t) stats.feedPauses;
+        json["starts"] = (uint64_t) stats.starts;
+        // -1 until measured
+        json["startupUs"] = (int64_t) stats.startupUs;
+        json["maxStartupUs"] = (int64_t) stats.maxStartupUs;
+        json["pausedUs"] = (int64_t) stats.pausedUs;
+        json["playingUs"] = (int64_t) stats.playingUs;
+        json["maxPlayingUs"] = (int64_t) stats.maxPlayingUs;
+        json["feederCpuUs"] = (uint64_t) stats.feederCpuUs;
+        json["scheduledStarts"] = (uint64_t) stats.scheduledStarts;
+        json["startOffsetUs"] = (int64_t) stats.startOffsetUs;
+        json["maxStartOffsetUs"] = (int64_t) stats.maxStartOffsetUs;
+        return json;
+    }
+
+    static JsonObject reconnectStatsToJson(const ReconnectBackoff::Stats &stats)
+    {
+        JsonObject json;
+        json["outages"] = (uint64_t) stats.outages;
+        json["attempts"] = (uint64_t) stats.attempts;
+        json["reconnects"] = (uint64_t) stats.reconnects;
+        json["givenUp"] = (uint64_t) stats.givenUp;
+        json["outageMs"] = stats.outageMs;
+        json["maxOutageMs"] = stats.maxOutageMs;
+        return json;
+    }
+#endif
+
     SERVICE_REGISTRATION(SystemAudioPlayerImplementation, SAP_MAJOR_VERSION, SAP_MINOR_VERSION);
 
 
     SystemAudioPlayerImplementation::SystemAudioPlayerImplementation() : _adminLock()
     {
         AudioPlayer::Init(this);
+        _reaper.setDone([this](int id, double ms) {
+            SAPLOG_INFO("SAP: Player %d torn down in %.1f ms\n", id, ms);
+            onSAPEvent(id, PLAYER_CLOSED);
+        });
         SAPLOG_INFO("SAP: SystemAudioPlayerImplementation Constructor\n");
     }
 
     SystemAudioPlayerImplementation::~SystemAudioPlayerImplementation()
     {
-        AudioPlayer::DeInit();
+        // Players still open are torn down while the main loop runs, without
+        // events to a plugin going away
+        _reaper.setDone(SessionReaper::Done());
+        for(const Sessions::Handle &session : _sessions.clear())
+            closeSession(session);
+        bool reaped = _reaper.shutdown(SESSION_TEARDOWN_TIMEOUT_MS);
+        SessionReaper::Stats reaper = _reaper.stats();
+        SAPLOG_INFO("SAP: Reaper tore down %llu players, longest %.1f ms, %llu abandoned\n",
+                (unsigned long long)reaper.reaped, reaper.maxMs, (unsigned long long)reaper.abandoned);
+        // An abandoned teardown may still stop its pipeline on the main loop
+        // or post an event; DeInit would pull both from under it
+        if(reaped)
+            AudioPlayer::DeInit();
+        else
+            AudioPlayer::Abandon();
         SAPLOG_INFO("SAP: SystemAudioPlayerImplementation Destructor\n");
     }
 
     Core::hresult SystemAudioPlayerImplementation::Configure(PluginHost::IShell* service)
     {
+        JsonObject config;
+        if(service != nullptr)
+            config.FromString(service->ConfigLine());
+        // Threads feeding all PlayBuffer players, see FeederPool
+        if(config.HasLabel("feederthreads"))
+        {
+            int threads = atoi(config["feederthreads"].String().c_str());
+            if(threads > 0)
+                FeederPool::instance().setThreads((unsigned)threads);
+        }
+        // Threads serving all websocket connections, see WebSockets::EventLoop
+        if(config.HasLabel("websocketthreads"))
+        {
+            int threads = atoi(config["websocketthreads"].String().c_str());
+            if(threads > 0)
+                WebSockets::EventLoop::instance().setThreads((size_t)threads);
+        }
+        // TLS sessions secured websockets resume, see WebSockets::TlsSessionCache
+        if(config.HasLabel("tlssessioncache"))
+        {
+            int sessions = atoi(config["tlssessioncache"].String().c_str());
+            if(sessions >= 0)
+                WebSockets::TlsSessionCache::instance().setCapacity((size_t)sessions);
+        }
+        // Idle pipelines kept per kind of player, see PipelinePool
+        if(config.HasLabel("pipelinepool"))
+        {
+            int size = atoi(config["pipelinepool"].String().c_str());
+            if(size >= 0)
+                PipelinePool::instance().setSize((size_t)size);
+        }
+        int prewarm = 0;
+        if(config.HasLabel("prewarmpipelines"))
+            prewarm = std::min(atoi(config["prewarmpipelines"].String().c_str()), (int)PipelinePool::instance().size());
+        if(prewarm > 0)
+        {
+            // Every kind Open accepts, without smart volume which is only
+            // switched on later by SetSmartVolControl
+            for(const char *audioType : { "pcm", "mp3", "wav" })
+                for(const char *sourceType : { "data", "httpsrc", "filesrc", "websocket" })
+                    for(const char *playMode : { "system", "app" })
+                        AudioPlayer::Prewarm(audioTypeFromString(audioType), sourceTypeFromString(sourceType),
+                                playModeFromString(playMode), prewarm);
+            SAPLOG_INFO("SAP: Prewarmed %d pipelines of each kind\n", prewarm);
+        }
+        // Decoded UI sounds file players play from memory, see EarconCache
+        if(config.HasLabel("earconcache"))
+        {
+            int budget = atoi(config["earconcache"].String().c_str());
+            int maxClip = config.HasLabel("earconmaxclip") ? atoi(config["earconmaxclip"].String().c_str()) : 0;
+            if(budget > 0)
+                EarconCache::instance().configure((size_t)budget, maxClip > 0 ? (size_t)maxClip : 0);
+        }
+        if(config.HasLabel("earconpreload") && EarconCache::instance().enabled())
+        {
+            // Comma separated paths or file:// URLs
+            std::stringstream paths(config["earconpreload"].String());
+            string path;
+            while(std::getline(paths, path, ','))
+            {
+                extractFileProtocol(path);
+                if(!path.empty() && !EarconCache::instance().get(path))
+                    SAPLOG_WARNING("SAP: Cannot preload earcon %s\n", path.c_str());
+            }
+        }
+        // PCM PlayBuffer players of a play mode mixed into one sink, see MixerOutput
+        if(config.HasLabel("mixer"))
+        {
+            string format = config.HasLabel("mixerformat") ? config["mixerformat"].String() : string("S16LE");
+            int rate = config.HasLabel("mixerrate") ? atoi(config["mixerrate"].String().c_str()) : 0;
+            MixerOutput::configure(atoi(config["mixer"].String().c_str()) > 0, format, rate);
+        }
+        // Websocket PCM audio prebuffered against network jitter, see JitterBuffer
+        if(config.HasLabel("jitterbuffer"))
+        {
+            int target = atoi(config["jitterbuffer"].String().c_str());
+            int max = config.HasLabel("jitterbuffermax") ? atoi(config["jitterbuffermax"].String().c_str()) : 0;
+            AudioPlayer::configureJitterBuffer(target, max);
+        }
+        // Dropped websocket sessions reconnected with backoff, see ReconnectBackoff
+        if(config.HasLabel("websocketreconnect"))
+            AudioPlayer::configureReconnect(atoi(config["websocketreconnect"].String().c_str()));
         return Core::ERROR_NONE;
     }
 
@@ -110,7 +266,17 @@ namespace Plugin {
             returnResponse(false);
         }
 
-        auto sourceType = sourceTypeFromString(parameters["sourcetype"].String());
+        // A "shm" player is a data player fed through a shared memory ring
+        // written by the client process instead of PlayBuffer calls
+        size_t shmSize = 0;
+        bool shm = (parameters["sourcetype"].String() == "shm");
+        auto sourceType = shm ? SourceType::DATA : sourceTypeFromString(parameters["sourcetype"].String());
+        if(shm) {
+            int size = 0;
+            if(parameters.HasLabel("shmsize"))
+                getNumberParameter("shmsize", size);
+            shmSize = (size > 0) ? (size_t)size : SHM_RING_DEFAULT_SIZE;
+        }
         if(sourceType == SourceType::SourceType_None) {
             SAPLOG_INFO("SystemAudioPlayerImplementation Open SourceType :%s is not supported", parameters["sourcetype"].String().c_str());
             returnResponse(false);
@@ -123,9 +289,21 @@ namespace Plugin {
         }
 
         int id = -1;
-        _adminLock.Lock();      
-        OpenMapping(audioType,sourceType,playMode,id);        
-        _adminLock.Unlock();
+        Sessions::Handle session = OpenMapping(audioType,sourceType,playMode,id,shmSize);
+        if(shm)
+        {
+            AudioPlayer *player = session->player();
+            if(player->getShmPath().empty())
+            {
+                SAPLOG_ERROR("SystemAudioPlayerImplementation Open could not create shared memory ring\n");
+                CloseMapping(id);
+                returnResponse(false);
+            }
+            JsonObject shmInfo;
+            shmInfo["path"] = player->getShmPath();
+            shmInfo["size"] = (int) player->getShmSize();
+            response["shm"] = shmInfo;
+        }
         response["id"] = (int) id;
         returnResponse(true);
     }
@@ -138,12 +316,9 @@ namespace Plugin {
         int id = -1, rate = 0, channels = 0;
         bool ret = false;
         string format, layout;
-        AudioPlayer *player;
         getNumberParameter("id", id);
-        _adminLock.Lock();
-         player = getObjectFromMap(id);
-        _adminLock.Unlock();
-        if(player != NULL)
+        Sessions::Locked player(_sessions.find(id));
+        if(player)
         {
             //TODO parse pcmconfig and pass
             if( player->getAudioType() == AudioType::PCM)
@@ -182,7 +357,6 @@ namespace Plugin {
         url = parameters["url"].String();
         CHECK_SAP_PARAMETER_URL_VALID_RETURN_ON_FAIL(url.c_str());
         extractFileProtocol(url); //we do not store file:// for file playback
-        _adminLock.Lock();
         if(GetSessionFromUrl(url,playerid))
         {
             response["sessionId"] = (int) playerid;
@@ -191,10 +365,108 @@ namespace Plugin {
         {
             response["sessionId"] = (int) -1;
         }
-        _adminLock.Unlock();
         returnResponse(true);
     }
 
+#ifdef SYSTEMAUDIOPLAYER_EXTENDED_API
+    Core::hresult SystemAudioPlayerImplementation::GetStatistics(const string &input, string &output)
+    {
+        CONVERT_PARAMETERS_TOJSON();
+        // Counters are read without the session locks, a busy player is
+        // not held up by a stats poll
+        if(parameters.HasLabel("id"))
+        {
+            int id = -1;
+            getNumberParameter("id", id);
+            Sessions::Handle session = _sessions.find(id);
+            if(session == nullptr || session->closed())
+            {
+                SAPLOG_ERROR("SAP: GetStatistics for unknown player %d\n", id);
+                returnResponse(false);
+            }
+            AudioPlayer *player = session->player();
+            JsonObject stats = playbackStatsToJson(player->getPlaybackStats());
+            if(player->getSourceType() == SourceType::WEBSOCKET)
+                stats["websocket"] = reconnectStatsToJson(player->getReconnectStats());
+            response["id"] = (int) id;
+            response["statistics"] = stats;
+            returnResponse(true);
+        }
+
+        std::vector<Sessions::Handle> sessions = _sessions.all();
+        PlaybackStats::Snapshot totals = PlaybackStats().snapshot();
+        ReconnectBackoff::Stats reconnects = ReconnectBackoff::Stats();
+        for(const Sessions::Handle &session : sessions)
+        {
+            totals += session->player()->getPlaybackStats();
+            if(session->player()->getSourceType() != SourceType::WEBSOCKET)
+                continue;
+            ReconnectBackoff::Stats reconnect = session->player()->getReconnectStats();
+            reconnects.outages += reconnect.outages;
+            reconnects.attempts += reconnect.attempts;
+            reconnects.reconnects += reconnect.reconnects;
+            reconnects.givenUp += reconnect.givenUp;
+            reconnects.outageMs += reconnect.outageMs;
+            reconnects.maxOutageMs = std::max(reconnects.maxOutageMs, reconnect.maxOutageMs);
+        }
+        JsonObject stats = playbackStatsToJson(totals);
+        stats["websocket"] = reconnectStatsToJson(reconnects);
+        response["sessions"] = (int) sessions.size();
+        response["statistics"] = stats;
+
+        Sessions::Stats registry = _sessions.stats();
+        JsonObject lookups;
+        lookups["peakSessions"] = (uint64_t) registry.peakSessions;
+        lookups["lookups"] = (uint64_t) registry.lookups;
+        lookups["misses"] = (uint64_t) registry.misses;
+        response["registry"] = lookups;
+
+        FeederPool::Stats feeders = FeederPool::instance().stats();
+        JsonObject feederPool;
+        feederPool["threads"] = (uint32_t) feeders.threads;
+        feederPool["peakSessions"] = (uint32_t) feeders.peakSessions;
+        feederPool["wakeups"] = (uint64_t) feeders.wakeups;
+        feederPool["feeds"] = (uint64_t) feeders.feeds;
+        response["feederPool"] = feederPool;
+
+        PipelinePool::Stats pipelines = PipelinePool::instance().stats();
+        JsonObject pipelinePool;
+        pipelinePool["hits"] = (uint64_t) pipelines.hits;
+        pipelinePool["misses"] = (uint64_t) pipelines.misses;
+        pipelinePool["discarded"] = (uint64_t) pipelines.discarded;
+        pipelinePool["idle"] = (uint64_t) pipelines.idle;
+        response["pipelinePool"] = pipelinePool;
+
+        EarconCache::Stats earcons = EarconCache::instance().stats();
+        JsonObject earconCache;
+        earconCache["hits"] = (uint64_t) earcons.hits;
+        earconCache["misses"] = (uint64_t) earcons.misses;
+        earconCache["evictions"] = (uint64_t) earcons.evictions;
+        earconCache["clips"] = (uint64_t) earcons.clips;
+        earconCache["bytes"] = (uint64_t) earcons.bytes;
+        response["earconCache"] = earconCache;
+
+        WebSockets::EventLoop::Stats loop = WebSockets::EventLoop::instance().stats();
+        WebSockets::TlsSessionCache::Stats tls = WebSockets::TlsSessionCache::instance().stats();
+        JsonObject eventLoop;
+        eventLoop["threads"] = (uint64_t) loop.threads;
+        eventLoop["endpoints"] = (uint64_t) loop.endpoints;
+        eventLoop["peakEndpoints"] = (uint64_t) loop.peakEndpoints;
+        eventLoop["tlsHandshakes"] = (uint64_t) tls.handshakes;
+        eventLoop["tlsResumed"] = (uint64_t) tls.resumed;
+        response["websockets"] = eventLoop;
+
+        SessionReaper::Stats reaped = _reaper.stats();
+        JsonObject reaper;
+        reaper["reaped"] = (uint64_t) reaped.reaped;
+        reaper["pending"] = (uint64_t) reaped.pending;
+        reaper["peakPending"] = (uint64_t) reaped.peakPending;
+        reaper["maxMs"] = reaped.maxMs;
+        response["reaper"] = reaper;
+        returnResponse(true);
+    }
+#endif
+
     Core::hresult SystemAudioPlayerImplementation::Play(const string &input, string &output)
     {
         SAPLOG_INFO("SystemAudioPlayerImplementation Got Play request :%s\n",input.c_str());
@@ -204,14 +476,12 @@ namespace Plugin {
         SAPLOG_INFO("SAP: SystemAudioPlayerImplementation Play\n");
         int id = -1;
         string url;
-        AudioPlayer *player;
         url = parameters["url"].String(); 
         getNumberParameter("id", id);
-        _adminLock.Lock();
-         player = getObjectFromMap(id); 
-        _adminLock.Unlock();
+        Sessions::Handle session = _sessions.find(id);
 
-         if(player != NULL) {
+         if(session != nullptr) {
+            AudioPlayer *player = session->player();
             string sourceType = sourceTypeToString(player->getSourceType());
             if(!std::regex_match(url, patternMap.at(sourceType))) {
                 SAPLOG_ERROR("SAP: SystemAudioPlayerImplementation Source %s and Url %s is different",sourceType.c_str(),url.c_str());
@@ -224,61 +494,183 @@ namespace Plugin {
                 }
             }
 
-            _adminLock.Lock();
+            // Takes the locks of the other sessions of the play mode one at
+            // a time, so before this session's own
+            std::lock_guard<std::mutex> arbitration(playModeLock(player));
             if(SameModeNotPlaying(player,id)) {
-                _adminLock.Unlock();
+                Sessions::Locked locked(session);
+                if(!locked)
+                    returnResponse(false);
                 player->Play(url);
+                _sessions.setUrl(session, url);
                 returnResponse(true);
             }
-            _adminLock.Unlock();
             response["message"] = "Hardware resource already acquired by session with  id "+ std::to_string(id);
             returnResponse(false);
         }
         returnResponse(false);
     }
 
+#ifdef SYSTEMAUDIOPLAYER_EXTENDED_API
+    Core::hresult SystemAudioPlayerImplementation::Enqueue(const string &input, string &output)
+    {
+        SAPLOG_INFO("SystemAudioPlayerImplementation Got Enqueue request :%s\n",input.c_str());
+        CONVERT_PARAMETERS_TOJSON();
+        CHECK_SAP_PARAMETER_RETURN_ON_FAIL("id");
+        CHECK_SAP_PARAMETER_RETURN_ON_FAIL("url");
+        int id = -1;
+        string url;
+        url = parameters["url"].String();
+        getNumberParameter("id", id);
+        Sessions::Locked player(_sessions.find(id));
+        if(!player)
+            returnResponse(false);
+
+        string sourceType = sourceTypeToString(player->getSourceType());
+        // Gapless playback needs a source that can be prerolled
+        if(player->getSourceType() != SourceType::FILESRC && player->getSourceType() != SourceType::HTTPSRC) {
+            SAPLOG_ERROR("SAP: SystemAudioPlayerImplementation Enqueue is not supported by %s players",sourceType.c_str());
+            returnResponse(false);
+        }
+        if(!std::regex_match(url, patternMap.at(sourceType))) {
+            SAPLOG_ERROR("SAP: SystemAudioPlayerImplementation Source %s and Url %s is different",sourceType.c_str(),url.c_str());
+            returnResponse(false);
+        }
+        if(player->getSourceType() == SourceType::FILESRC) {
+            if(!extractFileProtocol(url)) {
+                returnResponse(false);
+            }
+        }
+        returnResponse(player->Enqueue(url));
+    }
+
+    Core::hresult SystemAudioPlayerImplementation::PrepareOnly(const string &input, string &output)
+    {
+        SAPLOG_INFO("SystemAudioPlayerImplementation Got PrepareOnly request :%s\n",input.c_str());
+        CONVERT_PARAMETERS_TOJSON();
+        CHECK_SAP_PARAMETER_RETURN_ON_FAIL("id");
+        CHECK_SAP_PARAMETER_RETURN_ON_FAIL("url");
+        int id = -1;
+        string url;
+        url = parameters["url"].String();
+        getNumberParameter("id", id);
+        Sessions::Handle session = _sessions.find(id);
+        if(session == nullptr || !checkPlayUrl(session->player(), url))
+            returnResponse(false);
+
+        // Prerolling takes the sink like Play does
+        std::lock_guard<std::mutex> arbitration(playModeLock(session->player()));
+        if(!SameModeNotPlaying(session->player(),id)) {
+            response["message"] = "Hardware resource already acquired by session with  id "+ std::to_string(id);
+            returnResponse(false);
+        }
+        Sessions::Locked player(session);
+        if(!player || !player->Prepare(url))
+            returnResponse(false);
+        _sessions.setUrl(session, url);
+        returnResponse(true);
+    }
+
+    Core::hresult SystemAudioPlayerImplementation::PlayAt(const string &input, string &output)
+    {
+        SAPLOG_INFO("SystemAudioPlayerImplementation Got PlayAt request :%s\n",input.c_str());
+        CONVERT_PARAMETERS_TOJSON();
+        CHECK_SAP_PARAMETER_RETURN_ON_FAIL("id");
+        CHECK_SAP_PARAMETER_RETURN_ON_FAIL("url");
+        CHECK_SAP_PARAMETER_RETURN_ON_FAIL("monotonicTimeNs");
+        int id = -1;
+        string url;
+        int64_t monotonicNs = 0;
+        url = parameters["url"].String();
+        getNumberParameter("id", id);
+        // Too large for getNumberParameter as a string
+        if(parameters["monotonicTimeNs"].Content() == Core::JSON::Variant::type::NUMBER)
+            monotonicNs = parameters["monotonicTimeNs"].Number();
+        else
+            try { monotonicNs = std::stoll(parameters["monotonicTimeNs"].String()); }
+            catch (...) { monotonicNs = 0; }
+        if(monotonicNs <= 0) {
+            SAPLOG_ERROR("SAP: SystemAudioPlayerImplementation PlayAt needs a CLOCK_MONOTONIC time in ns\n");
+            returnResponse(false);
+        }
+        Sessions::Handle session = _sessions.find(id);
+        if(session == nullptr || !checkPlayUrl(session->player(), url))
+            returnResponse(false);
+
+        std::lock_guard<std::mutex> arbitration(playModeLock(session->player()));
+        if(!SameModeNotPlaying(session->player(),id)) {
+            response["message"] = "Hardware resource already acquired by session with  id "+ std::to_string(id);
+            returnResponse(false);
+        }
+        // Held while the preroll is awaited; PlayBuffer does not take it
+        Sessions::Locked player(session);
+        int64_t lateUs = 0;
+        if(!player || !player->PlayAt(url, monotonicNs, lateUs))
+            returnResponse(false);
+        _sessions.setUrl(session, url);
+        response["lateUs"] = (int64_t) lateUs;
+        returnResponse(true);
+    }
+#endif
+
     Core::hresult SystemAudioPlayerImplementation::PlayBuffer(const string &input, string &output)
     {
-        SAPLOG_INFO("SystemAudioPlayerImplementation Got PlayBuffer request :%s\n",input.c_str());
+        SAPLOG_INFO("SystemAudioPlayerImplementation Got PlayBuffer request of %zu bytes\n",input.size());
         CONVERT_PARAMETERS_TOJSON();
-        AudioPlayer *player;
         int id = -1;
         std::string data;
         LOGINFO("PlayBuffer request\n");
         getNumberParameter("id", id);
         data = parameters["data"].String();
         LOGINFO("data size %d\n",data.size());
-        _adminLock.Lock();
-         player = getObjectFromMap(id);
-        _adminLock.Unlock();
-        if(player != NULL)
+        // Without the session lock: PlayBuffer may wait up to 500 ms for
+        // the feeder to make room in the queue, and a Stop or Close on
+        // another thread must not wait behind it. The player takes its
+        // own locks, and the queue clear in Stop ends the wait early.
+        Sessions::Handle session = _sessions.find(id);
+        if(session != nullptr && !session->closed())
         {           
-            std::vector<uint8_t> dectokenVec(data.begin(), data.end());
-            uint8_t *e = &dectokenVec[0];
-            size_t decworkspace_size = b64_get_decoded_buffer_size(dectokenVec.size());
-            uint8_t *decworkspace = new uint8_t[decworkspace_size];
-            size_t decnum_chars = b64_decode(e, dectokenVec.size(),decworkspace);
-            LOGINFO("decode size %d\n", decworkspace_size);
-            player->PlayBuffer((const char*)decworkspace,decnum_chars);
-            delete []decworkspace;
+            AudioPlayer *player = session->player();
+            // Decoded straight from the request into a reused buffer, the
+            // player copies it once more into its queue
+            size_t decnum_chars = 0;
+            const uint8_t *decoded = Base64Decoder::decodePooled(data.data(), data.size(), decnum_chars);
+            LOGINFO("decode size %zu\n", decnum_chars);
+            if(decnum_chars == 0)
+                SAPLOG_WARNING("SAP: PlayBuffer data is not valid base64\n");
+            else
+                player->PlayBuffer((const char*)decoded,decnum_chars);
             
             returnResponse(true);
         }
         returnResponse(false);
     }
 
+#ifdef SYSTEMAUDIOPLAYER_EXTENDED_API
+    Core::hresult SystemAudioPlayerImplementation::PlayBufferRaw(const int32_t id, const uint8_t data[], const uint32_t length)
+    {
+        // Binary PlayBuffer for COM-RPC clients: no JSON and no base64
+        if(data == nullptr || length == 0 || length > (uint32_t)INT32_MAX)
+            return Core::ERROR_BAD_REQUEST;
+
+        Sessions::Handle session = _sessions.find(id);
+        if(session == nullptr || session->closed())
+            return Core::ERROR_UNKNOWN_KEY;
+
+        session->player()->PlayBuffer((const char*)data,(int)length);
+        return Core::ERROR_NONE;
+    }
+#endif
+
     Core::hresult SystemAudioPlayerImplementation::Stop(const string &input, string &output)
     {
         SAPLOG_INFO("SystemAudioPlayerImplementation Got Stop request :%s\n",input.c_str());
         CONVERT_PARAMETERS_TOJSON();
-        AudioPlayer *player;
         int id = -1;
         getNumberParameter("id", id);
         SAPLOG_INFO("SAP: SystemAudioPlayerImplementation Stop\n");
-        _adminLock.Lock();
-         player = getObjectFromMap(id);
-        _adminLock.Unlock();
-         if(player != NULL)
+        Sessions::Locked player(_sessions.find(id));
+         if(player)
         {
             player->Stop();;
             returnResponse(true);
@@ -293,24 +685,21 @@ namespace Plugin {
         int id = -1;
         getNumberParameter("id", id);
         SAPLOG_INFO("SAP: SystemAudioPlayerImplementation Close\n");
-        _adminLock.Lock();
-        
           if(CloseMapping(id))
         {
-             _adminLock.Unlock();
             returnResponse(true);
         }
-        _adminLock.Unlock();
         returnResponse(false);
     }
 
     uint32_t nextId() {
-        static uint32_t counter = 0;
+        // Open is not serialized any more
+        static std::atomic<uint32_t> counter(0);
 
-        if(counter >= 0xFFFFFFFF)
-            counter = 0;
-
-        return ++counter;
+        uint32_t id = ++counter;
+        if(id == 0)
+            id = ++counter;
+        return id;
     }
 
     Core::hresult SystemAudioPlayerImplementation::SetMixerLevels(const string &input, string &output)
@@ -323,22 +712,19 @@ namespace Plugin {
         bool result = false;
         int primVol = -1;
         int thisVol = -1;
-        AudioPlayer *player;
         int playerId = -1;
         getNumberParameter("id", playerId);
         getNumberParameter("primaryVolume", primVol);
         getNumberParameter("playerVolume", thisVol);
-        _adminLock.Lock();
-        player = getObjectFromMap(playerId);
-        _adminLock.Unlock();
-        if (player != NULL &&  ( primVol >= 0 && primVol <= 100 && thisVol >= 0 && thisVol <=100) )
+        Sessions::Locked player(_sessions.find(playerId));
+        if (player &&  ( primVol >= 0 && primVol <= 100 && thisVol >= 0 && thisVol <=100) )
         {
             player->SetMixerLevels(primVol, thisVol);
             result = true;
         }
         else
         {
-            SAPLOG_ERROR("SAP: setMixerLevels failed Player Obj=%p primvol=%d thisVol=%d", player,primVol,thisVol);
+            SAPLOG_ERROR("SAP: setMixerLevels failed Player Obj=%p primvol=%d thisVol=%d", player ? player.get() : nullptr,primVol,thisVol);
             result = false;
         }
         returnResponse(result);
@@ -360,7 +746,6 @@ namespace Plugin {
         int holdTimeMs = -1;
         int duckPercent = -1;
         bool smartVolumeEnable = false;
-        AudioPlayer *player = nullptr;
         int playerId = -1;
         getNumberParameter("id", playerId);
         getBoolParameter("enable",smartVolumeEnable);
@@ -369,19 +754,17 @@ namespace Plugin {
         getNumberParameter("playerHoldTimeMs", holdTimeMs);
         getNumberParameter("primaryDuckingPercent", duckPercent);
 
-        SAPLOG_INFO("SAP: SetSmartVolControl Player Obj=%p isEnable=%d thresHold=%f detectTimeMs=%d holdTimeMs=%d duckPercent=%d", player,smartVolumeEnable,thresHold, detectTimeMs,holdTimeMs,duckPercent);
+        SAPLOG_INFO("SAP: SetSmartVolControl Player id=%d isEnable=%d thresHold=%f detectTimeMs=%d holdTimeMs=%d duckPercent=%d", playerId,smartVolumeEnable,thresHold, detectTimeMs,holdTimeMs,duckPercent);
 
-        _adminLock.Lock();
-        player = getObjectFromMap(playerId);
-        _adminLock.Unlock();
-        if (player != NULL &&  ( thresHold >= 0.0 && detectTimeMs >= 0 && holdTimeMs >= 0 && duckPercent >= 0 && duckPercent <=100) )
+        Sessions::Locked player(_sessions.find(playerId));
+        if (player &&  ( thresHold >= 0.0 && detectTimeMs >= 0 && holdTimeMs >= 0 && duckPercent >= 0 && duckPercent <=100) )
         {
             player->SetSmartVolControl( smartVolumeEnable, thresHold, detectTimeMs, holdTimeMs, duckPercent);
             result = true;
         }
         else
         {
-            SAPLOG_ERROR("SAP: SetSmartVolControl failed Player Obj=%p isActive=%d thresHold=%f detectTimeMs=%d holdTimeMs=%d duckPercent=%d", player,smartVolumeEnable, thresHold, detectTimeMs,holdTimeMs,duckPercent);
+            SAPLOG_ERROR("SAP: SetSmartVolControl failed Player Obj=%p isActive=%d thresHold=%f detectTimeMs=%d holdTimeMs=%d duckPercent=%d", player ? player.get() : nullptr,smartVolumeEnable, thresHold, detectTimeMs,holdTimeMs,duckPercent);
             result = false;
         }
         returnResponse(result);
@@ -392,14 +775,11 @@ namespace Plugin {
     {
         SAPLOG_INFO("SystemAudioPlayerImplementation Got Pause request :%s\n",input.c_str());
         CONVERT_PARAMETERS_TOJSON();
-        AudioPlayer *player;
         int id = -1;
         bool ret = false;
         getNumberParameter("id", id);
-        _adminLock.Lock();
-        player = getObjectFromMap(id);
-        _adminLock.Unlock();
-        if(player != NULL)
+        Sessions::Locked player(_sessions.find(id));
+        if(player)
         {
             ret = player->Pause();
         }
@@ -410,15 +790,12 @@ namespace Plugin {
     {
         SAPLOG_INFO("SystemAudioPlayerImplementation Got Resume request :%s\n",input.c_str());
         CONVERT_PARAMETERS_TOJSON();
-        AudioPlayer *player;
         int id = -1;
         bool ret = false;
         getNumberParameter("id", id);
         SAPLOG_INFO("SAP: SystemAudioPlayerImplementation Resume\n");
-        _adminLock.Lock();
-        player = getObjectFromMap(id);
-        _adminLock.Unlock();
-        if(player != NULL)
+        Sessions::Locked player(_sessions.find(id));
+        if(player)
         {
             ret = player->Resume();;
         }
@@ -429,16 +806,14 @@ namespace Plugin {
     {
         SAPLOG_INFO("SystemAudioPlayerImplementation Got IsPlayingrequest :%s\n",input.c_str());
         CONVERT_PARAMETERS_TOJSON();
-        AudioPlayer *player;
         int id = -1;
         bool ret = false;
         getNumberParameter("id", id);
         SAPLOG_INFO("SAP: SystemAudioPlayerImplementation IsPlaying\n");
-        _adminLock.Lock();
-        player = getObjectFromMap(id);
-        _adminLock.Unlock();
-        if(player != NULL) {
-            ret = player->isPlaying();;
+        // Not blocked by a slow call on the session
+        Sessions::Handle session = _sessions.find(id);
+        if(session != nullptr && !session->closed()) {
+            ret = session->player()->isPlaying();;
         }
         returnResponse(ret);
     }
@@ -500,68 +875,93 @@ namespace Plugin {
         params["event"] = message;
         dispatchEvent(ONSAPEVENT, params);
     }
+
+    void SystemAudioPlayerImplementation::onSAPUrlChanged(uint32_t id,const std::string &url)
+    {
+        // Keeps GetPlayerSessionId finding the player by what it plays
+        Sessions::Handle session = _sessions.find((int)id);
+        if(session != nullptr)
+            _sessions.setUrl(session, url);
+    }
     
-    void SystemAudioPlayerImplementation::OpenMapping(AudioType audioType,SourceType sourceType,PlayMode mode,int &playerid)
+    SystemAudioPlayerImplementation::Sessions::Handle SystemAudioPlayerImplementation::OpenMapping(AudioType audioType,SourceType sourceType,PlayMode mode,int &playerid,size_t shmSize)
     {
         playerid= nextId();
-        AudioPlayer *obj=new AudioPlayer(audioType,sourceType,mode,playerid);
-        objectMap[playerid] = obj;
+        AudioPlayer *obj=new AudioPlayer(audioType,sourceType,mode,playerid,shmSize);
         SAPLOG_INFO("SAP: SystemAudioPlayerImplementation New player created\n");
+        return _sessions.add(playerid, (int)mode, obj);
     }
    
     bool SystemAudioPlayerImplementation::GetSessionFromUrl(string url,int &playerid)
     {
-        std::map<int,AudioPlayer*>::iterator it = objectMap.begin();
-        while (it != objectMap.end())
+        Sessions::Handle session = _sessions.findByUrl(url);
+        if(session != nullptr)
         {
-            AudioPlayer *iplayer = it->second;
-            if((url.compare(iplayer->getUrl())) == 0)
-            {
-               playerid = iplayer->getObjectIdentifier();
-               SAPLOG_INFO("SAP: GetSessionFromUrl url %s found in list id: %d \n",url.c_str(),playerid);
-               return true;
-            }
-            it++;
+           playerid = session->id();
+           SAPLOG_INFO("SAP: GetSessionFromUrl url %s found in list id: %d \n",url.c_str(),playerid);
+           return true;
         }
         SAPLOG_INFO("SAP: GetSessionFromUrl url %s Not found in list \n",url.c_str());
         return false;
     }
 
+    std::mutex &SystemAudioPlayerImplementation::playModeLock(AudioPlayer *player)
+    {
+        return player->getPlayMode() == PlayMode::APP ? _appModeLock : _systemModeLock;
+    }
+
     /*
     If the same mode( app/system) player is playing already, do not allow play back for this player. Otherwise cleanup previous player's state and allow this player.
     */
     bool SystemAudioPlayerImplementation::SameModeNotPlaying(AudioPlayer *player,int &playerid)
     {
-        std::map<int,AudioPlayer*>::iterator it = objectMap.begin();
-        while (it != objectMap.end())
+        // A closed session holds the sink until the reaper has stopped it.
+        // Stopping it here waits for a teardown in progress, and one still
+        // queued finds its player stopped.
+        for(const Sessions::Handle &session : _sessions.closing((int)player->getPlayMode()))
         {
-            AudioPlayer *iplayer = it->second;
-            if((player->getObjectIdentifier() != iplayer->getObjectIdentifier()) &&
-               (player->getPlayMode() == iplayer->getPlayMode()))        
+            std::lock_guard<std::mutex> lock(session->mutex());
+            if(player->isMixed() && session->player()->isMixed())
+                continue;
+            session->player()->Stop();
+        }
+        for(const Sessions::Handle &session : _sessions.group((int)player->getPlayMode()))
+        {
+            if(session->id() == player->getObjectIdentifier())
+                continue;
+            Sessions::Locked iplayer(session);
+            if(!iplayer || (player->isMixed() && iplayer->isMixed()))
+                continue;
+            if(iplayer->isPlaying())
             {
-                if(iplayer->isPlaying())
-                {
-                    SAPLOG_INFO("SystemAudioPlayerImplementation play request rejected access for id %d",player->getObjectIdentifier());
-                    playerid = iplayer->getObjectIdentifier();
-                    return false;
-                }
-                iplayer->Stop();
+                SAPLOG_INFO("SystemAudioPlayerImplementation play request rejected access for id %d",player->getObjectIdentifier());
+                playerid = iplayer->getObjectIdentifier();
+                return false;
             }
-            it++;        
+            iplayer->Stop();
         }
         SAPLOG_INFO("SystemAudioPlayerImplementation play request granded access for id %d",player->getObjectIdentifier());
         return true;
     }
 
+    bool SystemAudioPlayerImplementation::checkPlayUrl(AudioPlayer *player, string &url)
+    {
+        string sourceType = sourceTypeToString(player->getSourceType());
+        if(!std::regex_match(url, patternMap.at(sourceType))) {
+            SAPLOG_ERROR("SAP: SystemAudioPlayerImplementation Source %s and Url %s is different",sourceType.c_str(),url.c_str());
+            return false;
+        }
+        if(player->getSourceType() == SourceType::FILESRC)
+            return extractFileProtocol(url);
+        return true;
+    }
+
     bool SystemAudioPlayerImplementation::CloseMapping(int key)
     {
-        AudioPlayer *player;
-        player = getObjectFromMap(key);
-        if(player != NULL)
+        Sessions::Handle session = _sessions.remove(key);
+        if(session != nullptr)
         {
-            objectMap.erase(key);
-            player->Stop();
-            delete player;
+            closeSession(session);
             SAPLOG_INFO("SystemAudioPlayerImplementation closemapping success for key %d\n",key);
             return true;
         }
@@ -569,18 +969,24 @@ namespace Plugin {
         return false;
     }
 
-    AudioPlayer* SystemAudioPlayerImplementation::getObjectFromMap(int key)
+    void SystemAudioPlayerImplementation::closeSession(const Sessions::Handle &session)
     {
-        std::map<int,AudioPlayer*>::iterator it;
-        it = objectMap.find(key);
-        if (it != objectMap.end())
         {
-            AudioPlayer *player = it->second;
-            SAPLOG_INFO("SystemAudioPlayerImplementation getObjectFromMap success for key %d\n",key);
-            return player;
+            Sessions::Locked player(session);
+            if(!player)
+                return;
+            session->close();
         }
-        SAPLOG_INFO("SystemAudioPlayerImplementation getObjectFromMap failed for key %d\n",key);
-        return NULL;
-    }     
+        Sessions::Handle closing = session;
+        _reaper.submit(session->id(), [closing]() mutable {
+            {
+                std::lock_guard<std::mutex> lock(closing->mutex());
+                closing->player()->Stop();
+            }
+            // The player is destroyed with the last handle, here unless a
+            // PlayBuffer or IsPlaying call on it is still returning
+            closing.reset();
+        });
+    }
 } // namespace Plugin
 } // namespace WPEFramework
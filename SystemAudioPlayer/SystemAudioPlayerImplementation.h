@@ -27,6 +27,9 @@
 #include "impl/AudioPlayer.h"
 #include "impl/logger.h"
 #include "impl/SecurityParameters.h"
+#include "impl/SessionRegistry.h"
+#include "impl/SessionReaper.h"
+#include <mutex>
 #include <vector>
 #include <regex>
 
@@ -128,7 +131,15 @@ namespace Plugin {
 
         virtual Core::hresult Open(const string &input, string &output /* @out */) override ;
         virtual Core::hresult Play(const string &input, string &output /* @out */) override ;
+#ifdef SYSTEMAUDIOPLAYER_EXTENDED_API
+        virtual Core::hresult Enqueue(const string &input, string &output /* @out */) override ;
+        virtual Core::hresult PrepareOnly(const string &input, string &output /* @out */) override ;
+        virtual Core::hresult PlayAt(const string &input, string &output /* @out */) override ;
+#endif
         virtual Core::hresult PlayBuffer(const string &input, string &output /* @out */) override ;
+#ifdef SYSTEMAUDIOPLAYER_EXTENDED_API
+        virtual Core::hresult PlayBufferRaw(const int32_t id, const uint8_t data[] /* @length:length */, const uint32_t length) override ;
+#endif
         virtual Core::hresult Pause(const string &input, string &output /* @out */) override ;
         virtual Core::hresult Resume(const string &input, string &output /* @out */) override ;
         virtual Core::hresult Stop(const string &input, string &output /* @out */) override ;
@@ -138,25 +149,44 @@ namespace Plugin {
         virtual Core::hresult IsPlaying(const string &input, string &output /* @out */) override ;
         virtual Core::hresult Config(const string &input, string &output /* @out */) override ;
         virtual Core::hresult GetPlayerSessionId(const string &input, string &output /* @out */) override ;
+#ifdef SYSTEMAUDIOPLAYER_EXTENDED_API
+        virtual Core::hresult GetStatistics(const string &input, string &output /* @out */) override ;
+#endif
 
-        virtual void onSAPEvent(uint32_t id,std::string message) override; 
+        virtual void onSAPEvent(uint32_t id,std::string message) override;
+        virtual void onSAPUrlChanged(uint32_t id,const std::string &url) override; 
       
         BEGIN_INTERFACE_MAP(SystemAudioPlayerImplementation)
         INTERFACE_ENTRY(Exchange::ISystemAudioPlayer)
         END_INTERFACE_MAP
 
     private:       
-        std::map<int, AudioPlayer*> objectMap;
-        AudioPlayer* getObjectFromMap(int key);
+        typedef SessionRegistry<AudioPlayer> Sessions;
+        // Players are looked up without _adminLock, see SessionRegistry
+        Sessions _sessions;
+        // Guards _notificationClients
         mutable Core::CriticalSection _adminLock;
         std::list<Exchange::ISystemAudioPlayer::INotification*> _notificationClients;
+        // Stops and destroys closed players off the API thread
+        SessionReaper _reaper;
+        // Held by Play, PrepareOnly and PlayAt from SameModeNotPlaying()
+        // until the player has taken the sink, so two sessions of a mode
+        // cannot both be granted it
+        std::mutex _systemModeLock;
+        std::mutex _appModeLock;
 
         void dispatchEvent(Event, JsonObject &params);
         void Dispatch(Event event, string data);
-        void OpenMapping(AudioType audioType,SourceType sourceType,PlayMode mode,int &playerid);
+        Sessions::Handle OpenMapping(AudioType audioType,SourceType sourceType,PlayMode mode,int &playerid,size_t shmSize = 0);
         bool GetSessionFromUrl(string url,int &playerid);
+        std::mutex &playModeLock(AudioPlayer *player);
         bool SameModeNotPlaying(AudioPlayer*,int &playerid);
+        // url is of the source of player, with the protocol stripped from a file url
+        bool checkPlayUrl(AudioPlayer *player, string &url);
         bool CloseMapping(int key);
+        // Detaches a session removed from _sessions and hands it to the
+        // reaper
+        void closeSession(const Sessions::Handle &session);
         impl::SecurityParameters extractSecurityParams(const JsonObject& params) const;
 
     public:
@@ -26,6 +26,11 @@ namespace Plugin {
     {
         Register("open", &SystemAudioPlayer::Open, this);        
         Register("play", &SystemAudioPlayer::Play, this);
+#ifdef SYSTEMAUDIOPLAYER_EXTENDED_API
+        Register("enqueue", &SystemAudioPlayer::Enqueue, this);
+        Register("prepareOnly", &SystemAudioPlayer::PrepareOnly, this);
+        Register("playAt", &SystemAudioPlayer::PlayAt, this);
+#endif
         Register("playbuffer", &SystemAudioPlayer::PlayBuffer, this);
         Register("pause", &SystemAudioPlayer::Pause, this);
         Register("resume", &SystemAudioPlayer::Resume, this);
@@ -36,6 +41,9 @@ namespace Plugin {
         Register("isspeaking", &SystemAudioPlayer::IsPlaying, this);
 	Register("config", &SystemAudioPlayer::Config, this);
         Register("getPlayerSessionId", &SystemAudioPlayer::GetPlayerSessionId, this);
+#ifdef SYSTEMAUDIOPLAYER_EXTENDED_API
+        Register("getStatistics", &SystemAudioPlayer::GetStatistics, this);
+#endif
     }
     
    
@@ -75,6 +83,20 @@ namespace Plugin {
         return Core::ERROR_NONE;
     }
 
+#ifdef SYSTEMAUDIOPLAYER_EXTENDED_API
+    uint32_t SystemAudioPlayer::GetStatistics(const JsonObject& parameters, JsonObject& response)
+    {
+        if(_sap) {
+            string params, result;
+            parameters.ToString(params);
+            uint32_t ret= _sap->GetStatistics(params, result);
+            response.FromString(result);
+            return ret;
+        }
+        return Core::ERROR_NONE;
+    }
+#endif
+
     uint32_t SystemAudioPlayer::Play(const JsonObject& parameters, JsonObject& response)
     {
         if(_sap) {
@@ -87,6 +109,44 @@ namespace Plugin {
         return Core::ERROR_NONE;
     }
 
+#ifdef SYSTEMAUDIOPLAYER_EXTENDED_API
+    uint32_t SystemAudioPlayer::Enqueue(const JsonObject& parameters, JsonObject& response)
+    {
+        if(_sap) {
+            string params, result;
+            parameters.ToString(params);
+            uint32_t ret = _sap->Enqueue(params, result);
+            response.FromString(result);
+            return ret;
+        }
+        return Core::ERROR_NONE;
+    }
+
+    uint32_t SystemAudioPlayer::PrepareOnly(const JsonObject& parameters, JsonObject& response)
+    {
+        if(_sap) {
+            string params, result;
+            parameters.ToString(params);
+            uint32_t ret = _sap->PrepareOnly(params, result);
+            response.FromString(result);
+            return ret;
+        }
+        return Core::ERROR_NONE;
+    }
+
+    uint32_t SystemAudioPlayer::PlayAt(const JsonObject& parameters, JsonObject& response)
+    {
+        if(_sap) {
+            string params, result;
+            parameters.ToString(params);
+            uint32_t ret = _sap->PlayAt(params, result);
+            response.FromString(result);
+            return ret;
+        }
+        return Core::ERROR_NONE;
+    }
+#endif
+
     uint32_t SystemAudioPlayer::PlayBuffer(const JsonObject& parameters, JsonObject& response)
     {
         if(_sap) {
@@ -20,11 +20,44 @@
 #include "AudioPlayer.h"
 #include "logger.h"
 #include <gst/app/gstappsrc.h>
+#include <gst/app/gstappsink.h>
 #include "SecuredWebSocketClient.h"
 #include "UnsecuredWebSocketClient.h"
+#include "WebSockets/EventLoop.h"
+#include "WebSockets/Encryption/TlsSessionCache.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
 #define AUDIO_GST_FRAGMENT_MAX_SIZE     (128 * 1024)
+#define PIPELINE_POOL_READY_TIMEOUT     (500 * GST_MSECOND)
+#define EARCON_DECODE_TIMEOUT           (2 * GST_SECOND)
+// BufferQueue holds this much PCM audio at the configured caps
+#define BUFFER_QUEUE_SECONDS            2
+// and this many bytes of compressed or unknown format audio
+#define BUFFER_QUEUE_DEFAULT_SIZE       (512 * 1024)
+// How long a producer may wait for room before bytes are dropped
+#define BUFFER_QUEUE_ADD_TIMEOUT_MS     500
+// How long the shm feeder sleeps on an empty ring before checking for shutdown
+#define SHM_RING_WAIT_MS                100
+// appsrc asks for data again once it is drained below this share of max-bytes
+#define APPSRC_MAX_BYTES                512000
+#define APPSRC_LOW_WATERMARK_PERCENT    25
+// PlayBuffer clients are asked to pause above and resume below these BufferQueue fill levels
+#define FEED_HIGH_WATERMARK_PERCENT     75
+#define FEED_LOW_WATERMARK_PERCENT      25
+// Websocket PCM audio prebuffered before it is played, none unless configured
+#define JITTER_BUFFER_DEFAULT_TARGET_MS 0
+#define JITTER_BUFFER_DEFAULT_MAX_MS    500
+// Delays between reconnects of a dropped websocket session, and how long it is tried
+#define RECONNECT_INITIAL_DELAY_MS      100
+#define RECONNECT_MAX_DELAY_MS          2000
+#define RECONNECT_DEFAULT_GIVE_UP_MS    10000
+// Playlist items queued after the current one, the prerolled one included
+#define PLAYLIST_MAX_ITEMS              16
+// How long PlayAt waits for the preroll, and when after the start it measures it
+#define PLAY_AT_PREROLL_TIMEOUT_MS      2000
+#define PLAY_AT_CHECK_DELAY_MS          200
 #define PLAYBACK_STARTED "PLAYBACK_STARTED"
 #define PLAYBACK_FINISHED "PLAYBACK_FINISHED"
 #define PLAYBACK_PAUSED "PLAYBACK_PAUSED"
@@ -32,29 +65,66 @@
 #define NETWORK_ERROR "NETWORK_ERROR"
 #define PLAYBACK_ERROR "PLAYBACK_ERROR"
 #define NEED_DATA "NEED_DATA"
+#define PAUSE_FEEDING "PAUSE_FEEDING"
+#define RESUME_FEEDING "RESUME_FEEDING"
 #define PLAYBACK_INPROGRESS "PLAYBACK_INPROGRESS"
+#define PLAYLIST_ITEM_FINISHED "PLAYLIST_ITEM_FINISHED"
 
 GMainLoop* AudioPlayer::m_main_loop=NULL;
+GMainContext* AudioPlayer::m_main_context=NULL;
 GThread* AudioPlayer::m_main_loop_thread=NULL;
+Utils::GstBusLatencyHistogram AudioPlayer::m_busLatency;
 std::mutex AudioPlayer::m_eventMutex;
 std::condition_variable AudioPlayer::m_eventCondition;
 bool AudioPlayer::m_isLoopStarted = false;
 SAPEventCallback* AudioPlayer::m_callback=NULL;
+int AudioPlayer::m_jitterTargetMs = JITTER_BUFFER_DEFAULT_TARGET_MS;
+int AudioPlayer::m_jitterMaxMs = JITTER_BUFFER_DEFAULT_MAX_MS;
+int AudioPlayer::m_reconnectGiveUpMs = RECONNECT_DEFAULT_GIVE_UP_MS;
 
 //TODO Dock primary volume , if both APP & SYSTEM mode are playing
 //static bool app_playing =false;
 //static bool sys_playing =false;
 
-AudioPlayer::AudioPlayer(AudioType audioType,SourceType sourceType,PlayMode playMode,int objectIdentifier)
+AudioPlayer::AudioPlayer(AudioType audioType,SourceType sourceType,PlayMode playMode,int objectIdentifier,size_t shmSize)
     : m_pipeline(nullptr)        // Fix: Prevents NULL dereference if createPipeline fails
     , m_audioSink(nullptr)        // Fix: Prevents crash when dereferenced if pipeline creation fails
     , m_audioVolume(nullptr)      // Fix: Prevents crash in setVolume if creation fails
     , m_capsfilter(nullptr)       // Fix: Prevents NULL dereference in configPCMCaps for non-PCM types
-    , m_busWatch(0)               // Fix: Initialize to 0 to prevent invalid value in gst_bus_remove_watch
+    , m_busWatch(nullptr)         // Fix: Initialize to prevent invalid value in removeWatch
     , m_duration(0)               // Fix: Initialize to prevent garbage value in GST_TIME_ARGS logging
     , m_thread(nullptr)           // Fix: Prevents dangling pointer for non-DATA/WEBSOCKET sources
     , bufferQueue(nullptr)        // Fix: Prevents delete of uninitialized pointer in destructor
     , m_source(nullptr)           // Fix: Prevents NULL dereference in Play/Stop/PlayBuffer operations
+    , m_appsrcFull(false)
+    , m_drained(false)
+    , m_feedPaused(false)
+    , m_jitterTimer([this] { releaseJitterFrames(); })
+    , m_backoff(RECONNECT_INITIAL_DELAY_MS, RECONNECT_MAX_DELAY_MS, m_reconnectGiveUpMs)
+    , m_reconnectTimer([this] { reconnectTimeout(); })
+    , m_wsReconnect(false)
+    , m_smartVolume(false)
+    , m_pooledPipeline(false)
+    , m_capsChanged(false)
+    , m_pipelineSetupUs(0)
+    , m_firstSampleLogged(false)
+    , m_openTime(std::chrono::steady_clock::now())
+    , m_earconPipeline(nullptr)
+    , m_earconSource(nullptr)
+    , m_earconSink(nullptr)
+    , m_earconVolume(nullptr)
+    , m_earconBusWatch(nullptr)
+    , m_earconActive(false)
+    , m_mixer(nullptr)
+    , m_mixerStream(-1)
+    , m_loudnessPad(nullptr)
+    , m_loudnessProbe(0)
+    , m_prepared(false)
+    , m_holdStart(false)
+    , m_dataPushed(false)
+    , m_scheduledClock(false)
+    , m_startPlan()
+    , m_startCheck([this] { startCheckTimeout(); })
 {
     this->audioType = audioType;
     this->sourceType = sourceType;
@@ -63,16 +133,10 @@ AudioPlayer::AudioPlayer(AudioType audioType,SourceType sourceType,PlayMode play
     m_audioCutter = false;
     m_thresHold_dB=  -40.0000;
     m_isPaused = false;
+    m_generation = Utils::Gst::newPipelineGeneration();
     state = READY;
+    m_next = PooledPipeline();
     SAPLOG_INFO("SAP: AudioPlayer Constructor\n");    
-    if(sourceType == DATA || sourceType == WEBSOCKET)
-    {
-        m_running = true;
-        appsrc_firstpacket = true;
-        bufferQueue = new BufferQueue(1000);
-        m_thread= new std::thread(&AudioPlayer::PushDataAppSrc, this);
-    }
-    
     if(this->audioType == PCM)
     {
         m_PCMFormat = "S16LE";
@@ -90,8 +154,46 @@ AudioPlayer::AudioPlayer(AudioType audioType,SourceType sourceType,PlayMode play
         }
 
     }
-    
-    createPipeline(false);
+
+    if(sourceType == DATA || sourceType == WEBSOCKET)
+    {
+        appsrc_firstpacket = true;
+    }
+    if(sourceType == WEBSOCKET && audioType == PCM && m_jitterTargetMs > 0)
+    {
+        m_jitter.reset(new JitterBuffer(m_jitterTargetMs, m_jitterMaxMs));
+        m_jitter->setRate(getBytesPerSecond());
+    }
+
+    // Websocket frames are pushed to appsrc from the websocket thread
+    if(sourceType == DATA && shmSize > 0)
+    {
+        // Fed by a client process through shared memory instead of PlayBuffer
+        m_shmRing = ShmRing::create(shmSize);
+        if(m_shmRing)
+        {
+            m_running = true;
+            m_thread= new std::thread(&AudioPlayer::PushShmAppSrc, this);
+        }
+    }
+    else if(sourceType == DATA)
+    {
+        // PlayBuffer players share the FeederPool threads
+        bufferQueue = new BufferQueue(getBufferQueueSize());
+        FeederPool::instance().add(this);
+    }
+
+    // PCM PlayBuffer players share the sink of their play mode when mixing is on
+    if(audioType == PCM && bufferQueue)
+    {
+        m_mixer = MixerOutput::get(playMode);
+        if(m_mixer)
+            m_mixerStream = m_mixer->addSession(this, m_PCMFormat, m_Rate, m_Channels);
+        if(m_mixerStream < 0)
+            m_mixer = nullptr;
+    }
+    if(m_mixer == nullptr)
+        createPipeline(false);
     SAPLOG_INFO("AudioPlayer AudioType:%d,SourceType:%d,playMode:%d,object id:%d\n",getAudioType(),getSourceType(),getPlayMode(),getObjectIdentifier());
     //Set mixter levels, this can be reflected when playing
     m_primVolume = DEFAULT_PRIM_VOL_LEVEL;
@@ -102,18 +204,38 @@ AudioPlayer::AudioPlayer(AudioType audioType,SourceType sourceType,PlayMode play
 AudioPlayer::~AudioPlayer()
 {
     SAPLOG_INFO("SAP: AudioPlayer Destructor\n");
-    if(sourceType == DATA || sourceType == WEBSOCKET)
-    {   
-        m_running = false;       
+    m_startCheck.stop();
+    // No more frames may reach appsrc once the pipeline is gone
+    cancelReconnect();
+    if(m_jitter)
+        clearJitterBuffer();
+    if(m_mixer)
+        m_mixer->removeSession(m_mixerStream);
+    if(bufferQueue)
+    {
+        // Waits for a feed() in progress on a pool thread
+        FeederPool::instance().remove(this);
         bufferQueue->preDelete();
+        delete bufferQueue;
+        bufferQueue = nullptr;
+    }
+    if(m_thread)
+    {   
+        {
+            std::lock_guard<std::mutex> lock(m_feedMutex);
+            m_running = false;
+        }
+        if(m_shmRing)
+            m_shmRing->close();
+        m_feedCondition.notify_all();
 	SAPLOG_INFO("SAP: AudioPlayer Destructor before Pushapp src thread join player id %d\n",getObjectIdentifier());
 	m_thread->join();
 	SAPLOG_INFO("SAP: AudioPlayer Destructor after Pushapp src thread join player id %d\n",getObjectIdentifier());
-        delete bufferQueue;
         delete m_thread;
     }  
-    gst_element_set_state (m_pipeline, GST_STATE_NULL);
-    gst_object_unref (m_pipeline);  
+    destroyEarconPipeline();
+    releaseNext();
+    releasePipeline();
 }
 
 void AudioPlayer::Init(SAPEventCallback *callback)
@@ -122,8 +244,13 @@ void AudioPlayer::Init(SAPEventCallback *callback)
     if(!gst_is_initialized())
         gst_init(NULL,NULL);
 
+    // Bus watches of all players are dispatched from a context owned by SAP
+    // rather than the global default context shared with other plugins
+    m_main_context = g_main_context_new();
+    m_main_loop = g_main_loop_new(m_main_context, false);
     m_main_loop_thread = g_thread_new("BusWatch", (void* (*)(void*)) event_loop, NULL);
     waitForMainLoop();
+    EarconCache::instance().setDecoder(&AudioPlayer::decodeEarcon);
     
     std::unique_lock<std::mutex> lock(m_eventMutex);
     if (m_isLoopStarted) {
@@ -142,33 +269,72 @@ void AudioPlayer::waitForMainLoop()
 
 void AudioPlayer::event_loop()
 {
-    m_main_loop = g_main_loop_new(NULL, false);
+    g_main_context_push_thread_default(m_main_context);
 
-    g_timeout_add(0, [] (gpointer data) -> gboolean {
+    GSource *started = g_timeout_source_new(0);
+    g_source_set_callback(started, [] (gpointer data) -> gboolean {
         std::unique_lock<std::mutex> lock(AudioPlayer::m_eventMutex);
         AudioPlayer::m_isLoopStarted = true;
         AudioPlayer::m_eventCondition.notify_one();
         return G_SOURCE_REMOVE;
-    }, nullptr);
+    }, nullptr, nullptr);
+    g_source_attach(started, m_main_context);
+    g_source_unref(started);
 
     g_main_loop_run(m_main_loop);
+    g_main_context_pop_thread_default(m_main_context);
+}
+
+void AudioPlayer::Abandon()
+{
+    static SAPEventCallback noEvents;
+    SAPLOG_ERROR("SAP: AudioPlayer left running for abandoned players\n");
+    std::lock_guard<std::mutex> lock(m_eventMutex);
+    m_callback = &noEvents;
 }
 
 void AudioPlayer::DeInit()
 {
     SAPLOG_INFO("SAP: AudioPlayer DeInit\n");
     waitForMainLoop();
+    MixerOutput::shutdown();
 
-    if(m_main_loop && g_main_loop_is_running(m_main_loop)) {
-        g_main_loop_quit(m_main_loop);
-        g_main_loop_unref(m_main_loop);
+    WebSockets::EventLoop::Stats wsStats = WebSockets::EventLoop::instance().stats();
+    SAPLOG_INFO("SAP: Websocket event loop: %zu threads served up to %zu endpoints\n", wsStats.threads, wsStats.peakEndpoints);
+    WebSockets::EventLoop::instance().stop();
+
+    WebSockets::TlsSessionCache::Stats tlsStats = WebSockets::TlsSessionCache::instance().stats();
+    if(tlsStats.handshakes > 0)
+    {
+        uint64_t full = tlsStats.handshakes - tlsStats.resumed;
+        SAPLOG_INFO("SAP: TLS: %llu of %llu handshakes resumed, %.1f ms resumed vs %.1f ms full\n",
+                (unsigned long long)tlsStats.resumed, (unsigned long long)tlsStats.handshakes,
+                tlsStats.resumed ? tlsStats.resumedMs / tlsStats.resumed : 0.0, full ? tlsStats.fullMs / full : 0.0);
+    }
+
+    // Idle pipelines still hold their sinks
+    for(PooledPipeline &pooled : PipelinePool::instance().drain())
+    {
+        gst_element_set_state(pooled.pipeline, GST_STATE_NULL);
+        gst_object_unref(pooled.pipeline);
     }
-    m_main_loop = nullptr;
+
+    if(m_main_loop)
+        g_main_loop_quit(m_main_loop);
 
     if(m_main_loop_thread)
         g_thread_join(m_main_loop_thread);
     m_main_loop_thread = nullptr;
 
+    if(m_main_loop)
+        g_main_loop_unref(m_main_loop);
+    m_main_loop = nullptr;
+    if(m_main_context)
+        g_main_context_unref(m_main_context);
+    m_main_context = nullptr;
+
+    SAPLOG_INFO("SAP: Bus message handling latency: %s\n", m_busLatency.summary().c_str());
+
     std::unique_lock<std::mutex> lock(m_eventMutex);
     systemAudioDeinitialize();
     m_isLoopStarted = false;
@@ -196,7 +362,20 @@ bool AudioPlayer::configPCMCaps(const std::string format, int rate, int channels
             return false;
         }
 
-        if(sourceType == DATA || sourceType == WEBSOCKET)
+        if(m_mixer)
+        {
+            // Converted to the output format by the mixer
+            gst_caps_unref(audiocaps);
+            Mixer::SampleFormat mixFormat;
+            if(layout != "interleaved" || channels > 2 || !Mixer::parseFormat(format, mixFormat)
+                    || !m_mixer->mixer().setInput(m_mixerStream, mixFormat, rate, channels))
+            {
+                SAPLOG_ERROR("SAP: Mixed Player id %d cannot take format=%s rate=%d channels=%d layout=%s\n",
+                        getObjectIdentifier(), format.c_str(), rate, channels, layout.c_str());
+                return false;
+            }
+        }
+        else if(sourceType == DATA || sourceType == WEBSOCKET)
         {
             gst_app_src_set_caps(GST_APP_SRC(m_source), audiocaps);
             gst_caps_unref(audiocaps);
@@ -220,6 +399,15 @@ bool AudioPlayer::configPCMCaps(const std::string format, int rate, int channels
     m_Layout = layout;
     m_Rate = rate;
     m_Channels = channels;
+    m_capsChanged = true;
+    if(m_jitter)
+        m_jitter->setRate(getBytesPerSecond());
+    {
+        // No producer may run during the resize
+        std::lock_guard<std::mutex> pushLock(m_pushMutex);
+        if(bufferQueue && !bufferQueue->resize(getBufferQueueSize()))
+            SAPLOG_WARNING("SAP: BufferQueue busy, keeping %zu bytes\n", bufferQueue->capacity());
+    }
     SAPLOG_INFO("SAP: PCM config is applied successfully format=%s layout=%s rate=%d channels=%d\n",m_PCMFormat.c_str() , m_Layout.c_str() , m_Rate , m_Channels);
     return true;
     }
@@ -248,7 +436,9 @@ bool AudioPlayer::isPlaying()
 {
     //TODO Handle error as not Playing
     bool playing = false;
-    if( m_pipeline)
+    if(m_mixer)
+        playing = (state == PLAYING && !appsrc_firstpacket);
+    else if( m_pipeline)
     {
         if((sourceType == HTTPSRC || sourceType == FILESRC ) && (state == PLAYING )) playing = true;
         else if(( sourceType ==  WEBSOCKET || sourceType == DATA ) && (state == PLAYING  && !appsrc_firstpacket )) playing = true;
@@ -257,7 +447,60 @@ bool AudioPlayer::isPlaying()
 }
 
 
+PipelinePool::Key AudioPlayer::getPipelineKey()
+{
+    PipelinePool::Key key;
+    key.audioType = audioType;
+    key.sourceType = sourceType;
+    key.playMode = playMode;
+    key.smartVolume = m_smartVolume;
+    return key;
+}
+
 void AudioPlayer::createPipeline(bool smartVolumeEnable)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    m_smartVolume = smartVolumeEnable;
+
+    PooledPipeline pooled;
+    m_pooledPipeline = PipelinePool::instance().take(getPipelineKey(), pooled);
+    if(m_pooledPipeline)
+    {
+        // Built for an earlier player with the same key and left in READY
+        m_pipeline = pooled.pipeline;
+        m_source = pooled.source;
+        m_capsfilter = pooled.capsfilter;
+        m_audioSink = pooled.audioSink;
+        m_audioVolume = pooled.audioVolume;
+    }
+    else if(!buildPipeline(smartVolumeEnable))
+    {
+        return;
+    }
+    // The volume element starts over, whoever had the pipeline before
+    m_prevThisVolume = -1;
+    attachPipeline();
+    m_pipelineSetupUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    SAPLOG_INFO("SAP: End of create pipeline Player id: %d, %s pipeline in %lld us\n",getObjectIdentifier(),
+            m_pooledPipeline ? "pooled" : "new", (long long)m_pipelineSetupUs);
+}
+
+void AudioPlayer::attachPipeline()
+{
+    if(sourceType == DATA || sourceType == WEBSOCKET)
+    {
+       g_signal_connect (m_source, "need-data", G_CALLBACK (AudioPlayer::appsrcNeedData), this);
+       g_signal_connect (m_source, "enough-data", G_CALLBACK (AudioPlayer::appsrcEnoughData), this);
+    }
+
+    addLoudnessProbe();
+
+    GstBus *bus = gst_element_get_bus(m_pipeline);
+    m_busWatch = Utils::Gst::addWatch(bus, m_main_context, (GstBusFunc) GstBusCallback, (gpointer)(this), &m_busLatency);
+    gst_object_unref(bus);
+}
+
+bool AudioPlayer::buildPipeline(bool smartVolumeEnable)
 {
     GstCaps *audiocaps = NULL;
     SAPLOG_INFO("SAP: Creating Pipeline...\n");
@@ -265,7 +508,7 @@ void AudioPlayer::createPipeline(bool smartVolumeEnable)
     if (!m_pipeline) {
 
         SAPLOG_ERROR("SAP: Failed to create gstreamer pipeline player id:%d\n",getObjectIdentifier());
-        return;
+        return false;
     }
      // create generic elements
     if(sourceType == HTTPSRC)
@@ -280,7 +523,8 @@ void AudioPlayer::createPipeline(bool smartVolumeEnable)
     {
        //appsrc
        m_source = gst_element_factory_make ("appsrc", NULL);
-       gst_app_src_set_max_bytes((GstAppSrc *)m_source,512000);
+       gst_app_src_set_max_bytes((GstAppSrc *)m_source,APPSRC_MAX_BYTES);
+       g_object_set(m_source, "min-percent", APPSRC_LOW_WATERMARK_PERCENT, NULL);
     }
 
     bool result = TRUE; 
@@ -290,15 +534,13 @@ void AudioPlayer::createPipeline(bool smartVolumeEnable)
         if(audiocaps == NULL)
         {
             SAPLOG_INFO("Unable to add audio caps for PCM audio.\n");
-            return;
+            return false;
         }
  
 	if(sourceType == DATA || sourceType == WEBSOCKET)
         {
             gst_app_src_set_caps(GST_APP_SRC(m_source), audiocaps);
 	    gst_caps_unref(audiocaps);
-	    //g_signal_connect (m_source, "need-data", G_CALLBACK (start_feed), this);
-            //g_signal_connect (m_source, "enough-data", G_CALLBACK (stop_feed), this);
 	    g_object_set(m_source, "format", GST_FORMAT_TIME, NULL);
 	    if(smartVolumeEnable)
             {
@@ -329,7 +571,7 @@ void AudioPlayer::createPipeline(bool smartVolumeEnable)
             else
             {
                 SAPLOG_ERROR( "SAP: Unable to create capsfilter for PCM audio Player id:%d\n",getObjectIdentifier());
-                return;
+                return false;
             }
             if(smartVolumeEnable)
             {
@@ -398,13 +640,9 @@ void AudioPlayer::createPipeline(bool smartVolumeEnable)
         SAPLOG_ERROR("SAP: Failed to link element Player id %d\n",getObjectIdentifier());
         gst_object_unref(m_pipeline);
         m_pipeline = NULL;
-        return;
+        return false;
     }
-
-    GstBus *bus = gst_element_get_bus(m_pipeline);
-    m_busWatch = gst_bus_add_watch(bus, GstBusCallback, (gpointer)(this));
-    gst_object_unref(bus);
-    SAPLOG_INFO("SAP: End of create pipeline Player id: %d\n",getObjectIdentifier());
+    return true;
 }   
 
 int AudioPlayer::GstBusCallback(GstBus *, GstMessage *message, gpointer data) 
@@ -413,200 +651,640 @@ int AudioPlayer::GstBusCallback(GstBus *, GstMessage *message, gpointer data)
     return player->handleMessage(message);
 }
 
-gboolean AudioPlayer::PushDataAppSrc()
+size_t AudioPlayer::getBufferQueueSize()
+{
+    if(audioType != PCM)
+        return BUFFER_QUEUE_DEFAULT_SIZE;
+    return std::max(getBytesPerSecond() * BUFFER_QUEUE_SECONDS, (size_t)AUDIO_GST_FRAGMENT_MAX_SIZE);
+}
+
+size_t AudioPlayer::getBytesPerSecond()
+{
+    // Sample width is the number in the format name, e.g. S16LE, F32LE, U8
+    size_t pos = m_PCMFormat.find_first_of("0123456789");
+    int bits = (pos != std::string::npos) ? atoi(m_PCMFormat.c_str() + pos) : 16;
+    if(bits <= 0)
+        bits = 16;
+    return (size_t)m_Rate * m_Channels * ((bits + 7) / 8);
+}
+
+bool AudioPlayer::isMixed()
+{
+    return m_mixer != nullptr;
+}
+
+bool AudioPlayer::feed()
+{
+    PlaybackStats::CpuTimer cpu(m_stats);
+    if(m_mixer)
+        return feedMixer();
+
+    // Leave the data in BufferQueue while appsrc has enough, so the
+    // backpressure reaches the PlayBuffer client. need-data reschedules us.
+    if(m_appsrcFull)
+        return false;
+
+    //package should be played as soon as it arrived
+    const char *ptr = NULL;
+    size_t lenToSend = bufferQueue->peek(ptr, AUDIO_GST_FRAGMENT_MAX_SIZE, false);
+    if(lenToSend == 0)
+    {
+        //event -->Underflow, once until PlayBuffer brings more data
+        if(!appsrc_firstpacket && !m_drained.exchange(true))
+            m_callback->onSAPEvent(getObjectIdentifier(),NEED_DATA);
+        return false;
+    }
+    m_drained = false;
+
+    GstBuffer *gbuffer = gst_buffer_new_and_alloc((guint)lenToSend);
+    GstMapInfo map;
+    gst_buffer_map(gbuffer, &map, GST_MAP_WRITE);
+    memcpy(map.data,ptr,lenToSend);
+    gst_buffer_unmap(gbuffer, &map);
+    bufferQueue->remove(lenToSend);
+    if(bufferQueue->count() * 100 <= bufferQueue->capacity() * FEED_LOW_WATERMARK_PERCENT)
+        setFeedPaused(false);
+    pushToAppSrc(gbuffer);
+    return true;
+}
+
+bool AudioPlayer::feedMixer()
+{
+    const char *ptr = NULL;
+    size_t lenToSend = bufferQueue->peek(ptr, AUDIO_GST_FRAGMENT_MAX_SIZE, false);
+    if(lenToSend == 0)
+    {
+        if(!appsrc_firstpacket && !m_drained.exchange(true))
+            m_callback->onSAPEvent(getObjectIdentifier(),NEED_DATA);
+        return false;
+    }
+    m_drained = false;
+
+    // The mixer takes whole frames while it has room, and wakes us up
+    // again once it mixed some
+    size_t taken = m_mixer->write(m_mixerStream, ptr, lenToSend);
+    if(taken == 0)
+    {
+        size_t frameSize = m_Channels * (m_PCMFormat == "S16LE" ? sizeof(int16_t) : sizeof(float));
+        if(lenToSend >= frameSize || bufferQueue->count() < frameSize)
+            return false;
+        // A frame split where the queue wraps, after a client sent a
+        // partial frame; dropped to get back in step
+        bufferQueue->remove(lenToSend);
+        m_stats.dropped(lenToSend);
+        return true;
+    }
+    bufferQueue->remove(taken);
+    m_stats.pushed(taken);
+    if(bufferQueue->count() * 100 <= bufferQueue->capacity() * FEED_LOW_WATERMARK_PERCENT)
+        setFeedPaused(false);
+    if(appsrc_firstpacket.exchange(false))
+    {
+        logFirstSample();
+        m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_STARTED);
+        setPrimaryVolume(m_primVolume);
+        setVolume(m_thisVolume);
+    }
+    return true;
+}
+
+gboolean AudioPlayer::PushShmAppSrc()
 {
+    bool drained = false;
     while(m_running)
-    {	    
-        Buffer *buffer =NULL;
-        if(bufferQueue->isEmpty())
+    {
         {
-             if(!appsrc_firstpacket)
-             {
-	         //event -->Underflow
-                 if(sourceType == DATA)
-                 { 
-                     m_callback->onSAPEvent(getObjectIdentifier(),NEED_DATA);
-                 }
-             }
+            std::unique_lock<std::mutex> lock(m_feedMutex);
+            m_feedCondition.wait(lock, [this] { return !m_appsrcFull || !m_running; });
+            // Nothing more will arrive once the client closed the ring
+            m_feedCondition.wait(lock, [this] { return !m_shmRing->isClosed() || !m_running; });
         }
-        size_t maxBytes = AUDIO_GST_FRAGMENT_MAX_SIZE;
-        //package should be played as soon as it arrived
-        //GstClockTime pts = 0;
-        //GstClockTime dts = 0;
-        buffer = bufferQueue->remove();  //blocking call
-	if(buffer == NULL)
-	{
-            continue;		
-	}
-        int length = buffer->getLength();
-        char *ptr = buffer->getBuffer();
-
-        while(length != 0)
-        {               
-            unsigned int lenToSend = length;
-        
-            if(lenToSend > maxBytes)
-            {
-                lenToSend = maxBytes;
-            }
-     
-            GstBuffer *gbuffer = gst_buffer_new_and_alloc((guint)lenToSend);
-            GstMapInfo map;
-            gst_buffer_map(gbuffer, &map, GST_MAP_WRITE);
-            memcpy(map.data,ptr,lenToSend);
-            gst_buffer_unmap(gbuffer, &map);
-            //GST_BUFFER_PTS(gbuffer) = pts;
-            //GST_BUFFER_DTS(gbuffer) = dts;
-            //GstFlowReturn ret = gst_app_src_push_buffer(GST_APP_SRC(player->m_source), gbuffer);
-            GstFlowReturn ret;
-            g_signal_emit_by_name (m_source, "push-buffer", gbuffer, &ret);
-
-            gst_buffer_unref (gbuffer);
-
-            if (ret != GST_FLOW_OK)
-            {
-	        SAPLOG_WARNING("SAP: appsrc not accepting buffer\n");
-            }
-            if(appsrc_firstpacket)
+
+        const char *ptr = NULL;
+        size_t lenToSend = m_shmRing->peek(ptr, AUDIO_GST_FRAGMENT_MAX_SIZE, SHM_RING_WAIT_MS);
+        if(lenToSend == 0)
+        {
+            if(!appsrc_firstpacket && !drained)
             {
-                appsrc_firstpacket = false;
-                m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_STARTED);
-                setPrimaryVolume(m_primVolume);
-                setVolume(m_thisVolume);
+                drained = true;
+                m_callback->onSAPEvent(getObjectIdentifier(),NEED_DATA);
             }
-            ptr = lenToSend + (char *)ptr;
-            length -= lenToSend;
+            continue;
         }
-        buffer->deleteBuffer();
-	delete buffer;        
+        drained = false;
+        m_stats.received(lenToSend);
+        PlaybackStats::CpuTimer cpu(m_stats);
+
+        GstBuffer *gbuffer = gst_buffer_new_and_alloc((guint)lenToSend);
+        GstMapInfo map;
+        gst_buffer_map(gbuffer, &map, GST_MAP_WRITE);
+        memcpy(map.data,ptr,lenToSend);
+        gst_buffer_unmap(gbuffer, &map);
+        m_shmRing->remove(lenToSend);
+        pushToAppSrc(gbuffer);
     }
     return TRUE;
 }
 
-void AudioPlayer::wsConnectionStatus(WSStatus status)
+void AudioPlayer::appsrcNeedData(GstElement *appsrc, guint, gpointer data)
 {
-    switch (status)
+    AudioPlayer *player = static_cast<AudioPlayer*>(data);
+    if(!player->appsrc_firstpacket && gst_app_src_get_current_level_bytes(GST_APP_SRC(appsrc)) == 0
+            && (player->bufferQueue == nullptr || player->bufferQueue->isEmpty())
+            && (player->m_shmRing == nullptr || player->m_shmRing->isEmpty()))
     {
-        case CONNECTED:     break;
-        case DISCONNECTED:  break;
-        case NETWORKERROR: 
-        {
-            if (webClient == nullptr)
-            {
-                SAPLOG_INFO("Secured connection to %s interrupted.", m_url.c_str());
-                break;
-            }
+        player->m_stats.underrun();
+        if(player->m_jitter)
+            player->m_jitter->underrun(JitterBuffer::Clock::now());
+    }
 
-            if (webClient->getConnectionType() == impl::ConnectionType::Secured)
-            {
-                SAPLOG_WARNING("Secured connection to %s failed. Retrying with unsecured.", m_url.c_str());
-                m_fallbackToUnsecuredConnection = true;
-                // This callback is called on websocket thread so cannot destroy websocket on it.
-                // WebSocket needs to be destroyed on different thread, for example on gstreamer one.
-                gst_element_set_state(m_pipeline, GST_STATE_PAUSED);
-                gst_element_set_state(m_pipeline, GST_STATE_PLAYING);
-            }
-            else
-            {
-                SAPLOG_ERROR("Connection to %s failed.", m_url.c_str());
-                m_callback->onSAPEvent(getObjectIdentifier(),NETWORK_ERROR);
-            }
-            break;
-        }
-    } 
+    {
+        std::lock_guard<std::mutex> lock(player->m_feedMutex);
+        player->m_appsrcFull = false;
+    }
+    player->m_feedCondition.notify_all();
+    if(player->bufferQueue)
+        FeederPool::instance().notify(player);
+
+    // BufferQueue drives the PlayBuffer client, appsrc the websocket
+    if(player->sourceType == WEBSOCKET)
+        player->setFeedPaused(false);
 }
 
-void AudioPlayer::push_data(const void *ptr,int length)
+void AudioPlayer::appsrcEnoughData(GstElement *, gpointer data)
 {
-    if(!bufferQueue->isFull())
+    AudioPlayer *player = static_cast<AudioPlayer*>(data);
     {
-	Buffer *buffer = new Buffer();
-        buffer->fillBuffer(ptr,length);
-        bufferQueue->add(buffer);
+        std::lock_guard<std::mutex> lock(player->m_feedMutex);
+        player->m_appsrcFull = true;
     }
+    if(player->sourceType == WEBSOCKET)
+        player->setFeedPaused(true);
 }
 
-bool AudioPlayer::handleMessage(GstMessage *message) 
+void AudioPlayer::setFeedPaused(bool paused)
 {
-    GError* error = NULL;
-    gchar* debug = NULL;
-    if(!m_pipeline) 
+    if(m_feedPaused.exchange(paused) == paused)
+        return;
+
+    if(paused)
+        m_stats.feedPaused();
+    SAPLOG_INFO("SAP: %s feeding Playerid %d\n", paused ? "Pause" : "Resume", getObjectIdentifier());
+
+    if(sourceType == WEBSOCKET)
     {
-        SAPLOG_ERROR("SAP: NULL Pipeline...\n"); 
-        return false;
+        // Stop reading the socket so TCP flow control slows the sender down
+        std::lock_guard<std::mutex> lock(m_webClientMutex);
+        if(webClient != nullptr)
+        {
+            if(paused)
+                webClient->pauseReading();
+            else
+                webClient->resumeReading();
+        }
     }
-    switch (GST_MESSAGE_TYPE(message)){
+    else
+    {
+        m_callback->onSAPEvent(getObjectIdentifier(), paused ? PAUSE_FEEDING : RESUME_FEEDING);
+    }
+}
 
-        case GST_MESSAGE_ERROR: {
-                gst_message_parse_error(message, &error, &debug);
-                SAPLOG_ERROR("error! code: %d, %s, Debug: %s", error->code, error->message, debug);
-                GST_DEBUG_BIN_TO_DOT_FILE_WITH_TS(GST_BIN(m_pipeline), GST_DEBUG_GRAPH_SHOW_ALL, "error-pipeline");
-                std::string source = GST_MESSAGE_SRC_NAME(message);
-                if(source.find("httpsrc") != std::string::npos)
-                {
-                    SAPLOG_INFO("Network Error event on id:%d\n",getObjectIdentifier());
-                    m_callback->onSAPEvent(getObjectIdentifier(),NETWORK_ERROR);
-                }
-                else
-                {
-                    SAPLOG_INFO("Playback Error event on id:%d\n",getObjectIdentifier());
-                    m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_ERROR);
-                }
-                state = PLAYBACKERROR;
-                Stop();
-               		
-            }
-            break;
+void AudioPlayer::resetWebClient()
+{
+    impl::WebSocketClientPtr client;
+    {
+        std::lock_guard<std::mutex> lock(m_webClientMutex);
+        client.swap(webClient);
+    }
+    // Destroying the client waits for the websocket event loop to finish
+    // the connection's handlers, which may be waiting for m_webClientMutex
+    if(client != nullptr)
+    {
+        client->disconnect();
+        client.reset();
+    }
+}
 
-        case GST_MESSAGE_WARNING: {
-                gst_message_parse_warning(message, &error, &debug);
-                SAPLOG_WARNING("warning! code: %d, %s, Debug: %s", error->code, error->message, debug);
-            }
-            break;
+std::string AudioPlayer::getShmPath()
+{
+    return m_shmRing ? m_shmRing->path() : std::string();
+}
 
-        case GST_MESSAGE_EOS: {
-                SAPLOG_INFO("Audio EOS message received");
-                if(state != PLAYBACKERROR)
-                {
-                    appsrc_firstpacket = true;
-                    SAPLOG_INFO("Playback Finished event\n");
-                    m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_FINISHED);
-                    Stop();
-                    state = READY;
-                }
-            }
-            break;
+size_t AudioPlayer::getShmSize()
+{
+    return m_shmRing ? m_shmRing->capacity() : 0;
+}
 
-        case GST_MESSAGE_ELEMENT:{
-                const GstStructure* structure = gst_message_get_structure(message);
-                if (gst_structure_has_name(structure, "cutter")) {
-                     gboolean signal_status;
-                     gst_structure_get_boolean(structure,"above", &signal_status);
-                     if(signal_status) {
-                         SAPLOG_INFO("Speech Started.! Player Volume=%d .setting Player Hold Time=%d ",m_thisVolume, m_holdTimeMs);
-			 SAPLOG_INFO("SAP: Primary program volume is set to <%d> percent",m_duckPercent);
-                         if(m_thisVolume != 0 )
-                         {
-                            setHoldTime(m_holdTimeMs);
-                            setPrimaryVolume(m_duckPercent);
-                         }
-                     }
-                     else {
-                         SAPLOG_INFO("Speech Ends.! Player Volume=%d .setting Player Detect Time=%d ",m_thisVolume,m_detectTimeMs);
-                         SAPLOG_INFO("SAP: Primary program volume is set to <%d> percent",m_primVolume);
-                         if(m_thisVolume != 0 )
-                         {
-                            setDetectTime(m_detectTimeMs);
-                            setPrimaryVolume(m_primVolume );
-                         }
-                      }
-                  }
-           }
-           break;
+JitterBuffer::Stats AudioPlayer::getJitterStats()
+{
+    if(m_jitter)
+        return m_jitter->stats(JitterBuffer::Clock::now());
+    return JitterBuffer::Stats();
+}
 
-        case GST_MESSAGE_DURATION_CHANGED: {
-                gst_element_query_duration(m_pipeline, GST_FORMAT_TIME, &m_duration);
-                SAPLOG_INFO("Duration %" GST_TIME_FORMAT, GST_TIME_ARGS(m_duration));
+ReconnectBackoff::Stats AudioPlayer::getReconnectStats()
+{
+    std::lock_guard<std::mutex> lock(m_webClientMutex);
+    return m_backoff.stats();
+}
+
+void AudioPlayer::configureReconnect(int giveUpMs)
+{
+    m_reconnectGiveUpMs = std::max(0, giveUpMs);
+    SAPLOG_INFO("SAP: Dropped websocket sessions reconnected for %d ms\n", m_reconnectGiveUpMs);
+}
+
+void AudioPlayer::configureJitterBuffer(int targetMs, int maxMs)
+{
+    m_jitterTargetMs = std::max(0, targetMs);
+    m_jitterMaxMs = std::max(m_jitterTargetMs, maxMs > 0 ? maxMs : m_jitterMaxMs);
+    SAPLOG_INFO("SAP: Websocket jitter buffer %d ms, up to %d ms\n", m_jitterTargetMs, m_jitterMaxMs);
+}
+
+AudioPlayer::FlowStats AudioPlayer::getFlowStats()
+{
+    PlaybackStats::Snapshot snapshot = m_stats.snapshot();
+    FlowStats stats;
+    stats.feedPauses = snapshot.feedPauses;
+    stats.underruns = snapshot.underruns;
+    stats.droppedBytes = snapshot.bytesDropped;
+    return stats;
+}
+
+PlaybackStats::Snapshot AudioPlayer::getPlaybackStats()
+{
+    return m_stats.snapshot();
+}
+
+void AudioPlayer::pushToAppSrc(GstBuffer *gbuffer)
+{
+    //GstFlowReturn ret = gst_app_src_push_buffer(GST_APP_SRC(player->m_source), gbuffer);
+    gsize size = gst_buffer_get_size(gbuffer);
+    GstFlowReturn ret;
+    g_signal_emit_by_name (m_source, "push-buffer", gbuffer, &ret);
+
+    gst_buffer_unref (gbuffer);
+
+    if (ret != GST_FLOW_OK)
+    {
+        m_stats.dropped(size);
+        SAPLOG_WARNING("SAP: appsrc not accepting buffer\n");
+    }
+    else
+    {
+        m_stats.pushed(size);
+    }
+    // Set before the hold is checked, PlayAt clears it before checking this
+    m_dataPushed = true;
+    if(!m_holdStart && appsrc_firstpacket.exchange(false))
+        dataStarted();
+}
+
+void AudioPlayer::dataStarted()
+{
+    logFirstSample();
+    m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_STARTED);
+    setPrimaryVolume(m_primVolume);
+    setVolume(m_thisVolume);
+}
+
+static void freePayload(gpointer data)
+{
+    delete static_cast<std::string*>(data);
+}
+
+void AudioPlayer::push_message(std::string &&payload)
+{
+    if(payload.empty())
+        return;
+    m_stats.received(payload.size());
+    PlaybackStats::CpuTimer cpu(m_stats);
+    if(m_jitter)
+    {
+        m_jitter->push(std::move(payload), JitterBuffer::Clock::now());
+        releaseJitterFrames();
+        return;
+    }
+    pushFrame(std::move(payload));
+}
+
+void AudioPlayer::releaseJitterFrames()
+{
+    // Keeps the frames in order between the websocket thread and the timer
+    std::lock_guard<std::mutex> lock(m_jitterMutex);
+    JitterBuffer::Clock::time_point now = JitterBuffer::Clock::now();
+    std::string frame;
+    while(m_jitter->pop(frame, now))
+        pushFrame(std::move(frame));
+
+    int delay = m_jitter->releaseDelayMs(now);
+    // The timeout calls back in here, and schedules the next one if
+    // frames are still held
+    if(delay >= 0 && !m_jitterTimer.pending())
+        m_jitterTimer.start(m_main_context, std::max(delay, 1));
+}
+
+void AudioPlayer::clearJitterBuffer()
+{
+    // Outside the lock a running timeout waits for
+    m_jitterTimer.stop();
+    std::lock_guard<std::mutex> lock(m_jitterMutex);
+    m_jitter->clear();
+}
+
+void AudioPlayer::pushFrame(std::string &&payload)
+{
+    // The GstBuffer takes over the received payload, and the fragments of a
+    // large frame are sub-buffers sharing its memory, so nothing is copied
+    std::string *owned = new std::string(std::move(payload));
+    gsize size = owned->size();
+    GstBuffer *whole = gst_buffer_new_wrapped_full((GstMemoryFlags)0, &(*owned)[0], size, 0, size, owned, freePayload);
+    if(size <= AUDIO_GST_FRAGMENT_MAX_SIZE)
+    {
+        pushToAppSrc(whole);
+        return;
+    }
+
+    for(gsize offset = 0; offset < size; offset += AUDIO_GST_FRAGMENT_MAX_SIZE)
+    {
+        gsize len = std::min(size - offset, (gsize)AUDIO_GST_FRAGMENT_MAX_SIZE);
+        pushToAppSrc(gst_buffer_copy_region(whole, GST_BUFFER_COPY_MEMORY, offset, len));
+    }
+    gst_buffer_unref(whole);
+}
+
+void AudioPlayer::scheduleReconnect()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_webClientMutex);
+        // Not while the client is being destroyed, and once per drop
+        if(webClient == nullptr || !m_wsReconnect || m_reconnectTimer.pending())
+            return;
+        int delay = m_backoff.nextDelayMs(ReconnectBackoff::Clock::now());
+        if(delay >= 0)
+        {
+            SAPLOG_INFO("SAP: Playerid %d reconnecting to %s in %d ms\n", getObjectIdentifier(), m_url.c_str(), delay);
+            m_reconnectTimer.start(m_main_context, delay);
+            return;
+        }
+        m_wsReconnect = false;
+    }
+    SAPLOG_ERROR("SAP: Playerid %d gave up reconnecting to %s\n", getObjectIdentifier(), m_url.c_str());
+    m_callback->onSAPEvent(getObjectIdentifier(),NETWORK_ERROR);
+}
+
+void AudioPlayer::reconnectTimeout()
+{
+    impl::WebSocketClientPtr dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_webClientMutex);
+        if(!m_wsReconnect)
+            return;
+        dropped.swap(webClient);
+    }
+    // Destroying the dropped client waits for the websocket event loop to
+    // let go of its connection, which can take seconds; the main loop is
+    // shared by all pipelines and only starts the new connection
+    if(dropped != nullptr)
+        m_clientReaper = std::thread(&AudioPlayer::reapWebClient, dropped.release(), std::move(m_clientReaper));
+    std::lock_guard<std::mutex> lock(m_webClientMutex);
+    if(m_wsReconnect && webClient == nullptr)
+    {
+        if (impl::ConnectionType::Secured == impl::getConnectionType(m_url))
+            webClient.reset(new impl::SecuredWebSocketClient(this, m_secParams));
+        else
+            webClient.reset(new impl::UnsecuredWebSocketClient(this));
+        webClient->connect(m_url);
+    }
+}
+
+void AudioPlayer::reapWebClient(impl::IWebSocketClient *client, std::thread previous)
+{
+    if(previous.joinable())
+        previous.join();
+    impl::WebSocketClientPtr dropped(client);
+    dropped->disconnect();
+}
+
+void AudioPlayer::cancelReconnect()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_webClientMutex);
+        m_wsReconnect = false;
+    }
+    // Waits for a reconnect in progress, and none is scheduled once the
+    // flag is down
+    m_reconnectTimer.stop();
+    {
+        std::lock_guard<std::mutex> lock(m_webClientMutex);
+        m_backoff.reset();
+    }
+    resetWebClient();
+    // The dropped clients still call back into this player
+    if(m_clientReaper.joinable())
+        m_clientReaper.join();
+}
+
+void AudioPlayer::wsConnectionStatus(WSStatus status)
+{
+    switch (status)
+    {
+        case CONNECTED:
+        {
+            std::lock_guard<std::mutex> lock(m_webClientMutex);
+            m_wsReconnect = (m_reconnectGiveUpMs > 0);
+            if(m_backoff.inOutage())
+            {
+                m_backoff.connected(ReconnectBackoff::Clock::now());
+                ReconnectBackoff::Stats stats = m_backoff.stats();
+                SAPLOG_INFO("SAP: Playerid %d reconnected to %s, %llu reconnects, longest outage %.0f ms\n", getObjectIdentifier(),
+                        m_url.c_str(), (unsigned long long)stats.reconnects, stats.maxOutageMs);
+            }
+            break;
+        }
+        case DISCONNECTED:
+        case CLOSED:
+            // Plays out what the jitter buffer holds; the next connection
+            // is prebuffered again
+            if(m_jitter)
+            {
+                m_jitter->drain();
+                releaseJitterFrames();
+                clearJitterBuffer();
+            }
+            // The pipeline stays in PLAYING and plays what it holds while
+            // a dropped session is reconnected
+            if(status == DISCONNECTED)
+                scheduleReconnect();
+            break;
+        case NETWORKERROR: 
+        {
+            bool secured = false;
+            bool reconnect = false;
+            {
+                std::lock_guard<std::mutex> lock(m_webClientMutex);
+                if (webClient == nullptr)
+                {
+                    SAPLOG_INFO("Secured connection to %s interrupted.", m_url.c_str());
+                    break;
+                }
+                secured = (webClient->getConnectionType() == impl::ConnectionType::Secured);
+                reconnect = m_wsReconnect;
+            }
+
+            if (reconnect)
+            {
+                // A reconnect of a session that was connected before failed
+                scheduleReconnect();
+                break;
+            }
+
+            if (secured)
+            {
+                SAPLOG_WARNING("Secured connection to %s failed. Retrying with unsecured.", m_url.c_str());
+                m_fallbackToUnsecuredConnection = true;
+                // This callback is called on websocket thread so cannot destroy websocket on it.
+                // WebSocket needs to be destroyed on different thread, for example on gstreamer one.
+                gst_element_set_state(m_pipeline, GST_STATE_PAUSED);
+                gst_element_set_state(m_pipeline, GST_STATE_PLAYING);
+            }
+            else
+            {
+                SAPLOG_ERROR("Connection to %s failed.", m_url.c_str());
+                m_callback->onSAPEvent(getObjectIdentifier(),NETWORK_ERROR);
+            }
+            break;
+        }
+    } 
+}
+
+void AudioPlayer::push_data(const void *ptr,int length)
+{
+    if(length <= 0)
+        return;
+    if(bufferQueue == nullptr)
+    {
+        SAPLOG_ERROR("SAP: Player id %d does not take data buffers\n", getObjectIdentifier());
+        return;
+    }
+    m_stats.received(length);
+
+    // Queued in pieces with the feeder scheduled after each, so a full
+    // BufferQueue is always being drained while add() waits for room
+    const char *data = static_cast<const char*>(ptr);
+    size_t piece = std::max(bufferQueue->capacity() / 4, (size_t)AUDIO_GST_FRAGMENT_MAX_SIZE);
+    size_t queued = 0;
+    while(queued < (size_t)length)
+    {
+        size_t len = std::min(piece, (size_t)length - queued);
+        size_t added = bufferQueue->add(data + queued, len, BUFFER_QUEUE_ADD_TIMEOUT_MS);
+        queued += added;
+        m_stats.queued(bufferQueue->count());
+        FeederPool::instance().notify(this);
+        if(added < len)
+            break;
+    }
+    if(bufferQueue->count() * 100 >= bufferQueue->capacity() * FEED_HIGH_WATERMARK_PERCENT)
+        setFeedPaused(true);
+    if(queued < (size_t)length)
+    {
+        m_stats.dropped(length - queued);
+        SAPLOG_WARNING("SAP: BufferQueue full, dropped %zu of %d bytes Playerid %d\n", length - queued, length, getObjectIdentifier());
+    }
+}
+
+bool AudioPlayer::handleMessage(GstMessage *message) 
+{
+    GError* error = NULL;
+    gchar* debug = NULL;
+    if(!m_pipeline) 
+    {
+        SAPLOG_ERROR("SAP: NULL Pipeline...\n"); 
+        return false;
+    }
+    switch (GST_MESSAGE_TYPE(message)){
+
+        case GST_MESSAGE_ERROR: {
+                gst_message_parse_error(message, &error, &debug);
+                SAPLOG_ERROR("error! code: %d, %s, Debug: %s", error->code, error->message, debug);
+                GST_DEBUG_BIN_TO_DOT_FILE_WITH_TS(GST_BIN(m_pipeline), GST_DEBUG_GRAPH_SHOW_ALL, "error-pipeline");
+                std::string source = GST_MESSAGE_SRC_NAME(message);
+                if(source.find("httpsrc") != std::string::npos)
+                {
+                    SAPLOG_INFO("Network Error event on id:%d\n",getObjectIdentifier());
+                    m_callback->onSAPEvent(getObjectIdentifier(),NETWORK_ERROR);
+                }
+                else
+                {
+                    SAPLOG_INFO("Playback Error event on id:%d\n",getObjectIdentifier());
+                    m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_ERROR);
+                }
+                state = PLAYBACKERROR;
+                Stop();
+               		
+            }
+            break;
+
+        case GST_MESSAGE_WARNING: {
+                gst_message_parse_warning(message, &error, &debug);
+                SAPLOG_WARNING("warning! code: %d, %s, Debug: %s", error->code, error->message, debug);
+            }
+            break;
+
+        case GST_MESSAGE_EOS: {
+                SAPLOG_INFO("Audio EOS message received");
+                if(state != PLAYBACKERROR)
+                {
+                    if(playNext())
+                        break;
+                    appsrc_firstpacket = true;
+                    SAPLOG_INFO("Playback Finished event\n");
+                    m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_FINISHED);
+                    Stop();
+                    state = READY;
+                }
+            }
+            break;
+
+        case GST_MESSAGE_ELEMENT:{
+                const GstStructure* structure = gst_message_get_structure(message);
+                if (gst_structure_has_name(structure, "cutter")) {
+                     gboolean signal_status;
+                     gst_structure_get_boolean(structure,"above", &signal_status);
+                     if(signal_status) {
+                         SAPLOG_INFO("Speech Started.! Player Volume=%d .setting Player Hold Time=%d ",m_thisVolume, m_holdTimeMs);
+			 SAPLOG_INFO("SAP: Primary program volume is set to <%d> percent",m_duckPercent);
+                         if(m_thisVolume != 0 )
+                         {
+                            setHoldTime(m_holdTimeMs);
+                            setPrimaryVolume(m_duckPercent);
+                         }
+                     }
+                     else {
+                         SAPLOG_INFO("Speech Ends.! Player Volume=%d .setting Player Detect Time=%d ",m_thisVolume,m_detectTimeMs);
+                         SAPLOG_INFO("SAP: Primary program volume is set to <%d> percent",m_primVolume);
+                         if(m_thisVolume != 0 )
+                         {
+                            setDetectTime(m_detectTimeMs);
+                            setPrimaryVolume(m_primVolume );
+                         }
+                      }
+                  }
+                else if (gst_structure_has_name(structure, "loudness")) {
+                    gboolean above = FALSE;
+                    gst_structure_get_boolean(structure, "above", &above);
+                    SAPLOG_INFO("SAP: Speech %s Player id %d, primary program volume is set to <%d> percent\n", above ? "started" : "ended",
+                            getObjectIdentifier(), above ? m_duckPercent : m_primVolume);
+                    // Posted from the streaming thread; dropped if disabled since
+                    if(m_thisVolume != 0 && m_loudness.isEnabled())
+                        setPrimaryVolume(above ? m_duckPercent : m_primVolume);
+                }
+           }
+           break;
+
+        case GST_MESSAGE_DURATION_CHANGED: {
+                gst_element_query_duration(m_pipeline, GST_FORMAT_TIME, &m_duration);
+                SAPLOG_INFO("Duration %" GST_TIME_FORMAT, GST_TIME_ARGS(m_duration));
             }
             break;
 
@@ -633,17 +1311,23 @@ bool AudioPlayer::handleMessage(GstMessage *message)
                 } else if (oldstate == GST_STATE_READY && newstate == GST_STATE_PAUSED) {
 
                     GST_DEBUG_BIN_TO_DOT_FILE_WITH_TS(GST_BIN(m_pipeline), GST_DEBUG_GRAPH_SHOW_ALL, "paused-pipeline");
+                    m_stats.reachedPaused(PlaybackStats::Clock::now());
 		    state = PAUSED;
                 } else if (oldstate == GST_STATE_PAUSED && newstate == GST_STATE_PAUSED) {
 			state = PAUSED;
                 } else if (oldstate == GST_STATE_PAUSED && newstate == GST_STATE_PLAYING) {
                     GST_DEBUG_BIN_TO_DOT_FILE_WITH_TS(GST_BIN(m_pipeline), GST_DEBUG_GRAPH_SHOW_ALL, "playing-pipeline");
+                    m_stats.reachedPlaying(PlaybackStats::Clock::now());
 			   
 			    SAPLOG_INFO("moved to playing state id:%d\n",getObjectIdentifier());
-			    state = PLAYING;
+			    // Pause already set the state for its transition still to come
+			    bool pausing = m_isPaused && state == PAUSED;
+			    if(!pausing)
+			        state = PLAYING;
                             //Fix audio delay for web socket
                             if(sourceType == WEBSOCKET)
                             {
+                                std::unique_lock<std::mutex> lock(m_webClientMutex);
                                 if (nullptr == webClient)
                                 {
                                     if (impl::ConnectionType::Secured == impl::getConnectionType(m_url))
@@ -656,9 +1340,10 @@ bool AudioPlayer::handleMessage(GstMessage *message)
                                 {
                                     SAPLOG_INFO("Fallback to unsecured websocket connection requested. Changing sockets.");
                                     m_fallbackToUnsecuredConnection = false;
-                                    webClient->disconnect();
-                                    webClient.reset();
+                                    lock.unlock();
+                                    resetWebClient();
                                     SAPLOG_INFO("Secured websocket client destroyed. Creating unsecured one and connecting to %s.", m_url.c_str());
+                                    lock.lock();
                                     webClient.reset(new impl::UnsecuredWebSocketClient(this));
                                     webClient->connect(m_url);
                                 }
@@ -668,7 +1353,8 @@ bool AudioPlayer::handleMessage(GstMessage *message)
                             {
                                 if(m_isPaused)
                                 {
-                                    m_isPaused = false;
+                                    if(!pausing)
+                                        m_isPaused = false;
                                     SAPLOG_INFO("Playback Resume event on id:%d\n",getObjectIdentifier());
                                     //playback resume event
                                     m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_RESUMED);
@@ -677,6 +1363,7 @@ bool AudioPlayer::handleMessage(GstMessage *message)
                                 {
                                     //playback start event
                                     SAPLOG_INFO("Playback started event on id:%d\n",getObjectIdentifier());
+                                    logFirstSample();
                                     m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_STARTED);
                                 }
                                 //Multiple player might have set different primary volume.
@@ -687,7 +1374,9 @@ bool AudioPlayer::handleMessage(GstMessage *message)
                             }
 
                 } else if (oldstate == GST_STATE_PLAYING && newstate == GST_STATE_PAUSED) {
-			state = PAUSED;
+                        // Resume already set the state for its transition still to come
+                        if(!m_isPaused || state != PLAYING)
+                            state = PAUSED;
                         if(m_isPaused)
                         {
                              //playback paused event
@@ -718,6 +1407,8 @@ bool AudioPlayer::handleMessage(GstMessage *message)
       //if neither APP or SYSTEM mode is playing  now, then set primary volume to Max
       //TODO if( !app_playing && !sys_playing )
         setPrimaryVolume ( MAX_PRIM_VOL_LEVEL );
+        // The next speech ducks the primary again
+        m_loudness.reset();
     }
 
     return true;
@@ -752,7 +1443,7 @@ void AudioPlayer::resetPipelineForSmartVolumeControl(bool smartVolumeEnable)
 {
     SAPLOG_WARNING("Resetting Pipeline Smart Volume Control...player id %d\n",getObjectIdentifier());
 
-    destroyPipeline();
+    releasePipeline();
 
 
     if(!m_pipeline)
@@ -793,9 +1484,395 @@ void AudioPlayer::destroyPipeline()
     if(m_pipeline) {
         gst_element_set_state(m_pipeline, GST_STATE_NULL);
         waitForStatus(GST_STATE_NULL, 200);
+        removeLoudnessProbe();
+        Utils::Gst::removeWatch(m_busWatch);
         gst_object_unref(m_pipeline);
     }
     m_pipeline = NULL;
+    m_scheduledClock = false;
+}
+
+void AudioPlayer::releasePipeline()
+{
+    if(!m_pipeline)
+        return;
+    // Only a healthy pipeline set up like a new one is handed to the next player
+    if(state == PLAYBACKERROR || m_capsChanged || m_busWatch == nullptr || PipelinePool::instance().size() == 0)
+    {
+        destroyPipeline();
+        return;
+    }
+
+    Utils::Gst::removeWatch(m_busWatch);
+    if(sourceType == DATA || sourceType == WEBSOCKET)
+        g_signal_handlers_disconnect_by_data(m_source, this);
+    clearSchedule();
+
+    GstState current = GST_STATE_NULL;
+    gst_element_set_state(m_pipeline, GST_STATE_READY);
+    if(gst_element_get_state(m_pipeline, &current, NULL, PIPELINE_POOL_READY_TIMEOUT) != GST_STATE_CHANGE_SUCCESS
+            || current != GST_STATE_READY)
+    {
+        SAPLOG_WARNING("SAP: Pipeline of Player id %d did not reach READY, not pooled\n",getObjectIdentifier());
+        destroyPipeline();
+        return;
+    }
+    // No buffers flow in READY
+    removeLoudnessProbe();
+    // Messages left for this player must not reach the next one
+    GstBus *bus = gst_element_get_bus(m_pipeline);
+    gst_bus_set_flushing(bus, TRUE);
+    gst_bus_set_flushing(bus, FALSE);
+    gst_object_unref(bus);
+
+    PooledPipeline pooled = { m_pipeline, m_source, m_capsfilter, m_audioSink, m_audioVolume };
+    if(!PipelinePool::instance().put(getPipelineKey(), pooled))
+    {
+        gst_element_set_state(m_pipeline, GST_STATE_NULL);
+        gst_object_unref(m_pipeline);
+    }
+    PipelinePool::Stats stats = PipelinePool::instance().stats();
+    SAPLOG_INFO("SAP: Pipeline pool %zu idle, %llu hits, %llu misses, %llu discarded\n", stats.idle,
+            (unsigned long long)stats.hits, (unsigned long long)stats.misses, (unsigned long long)stats.discarded);
+    m_pipeline = NULL;
+    m_source = NULL;
+    m_capsfilter = NULL;
+    m_audioSink = NULL;
+    m_audioVolume = NULL;
+}
+
+void AudioPlayer::addLoudnessProbe()
+{
+    if(m_audioVolume == NULL || m_loudnessPad)
+        return;
+    m_loudnessPad = gst_element_get_static_pad(m_audioVolume, "sink");
+    if(m_loudnessPad == NULL)
+    {
+        SAPLOG_WARNING("SAP: No volume sink pad to measure loudness on, Player id %d\n",getObjectIdentifier());
+        return;
+    }
+    m_loudnessProbe = gst_pad_add_probe(m_loudnessPad, (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM),
+            AudioPlayer::loudnessProbe, this, NULL);
+    GstCaps *caps = gst_pad_get_current_caps(m_loudnessPad);
+    if(caps)
+    {
+        setLoudnessFormat(caps);
+        gst_caps_unref(caps);
+    }
+}
+
+void AudioPlayer::removeLoudnessProbe()
+{
+    if(m_loudnessPad == NULL)
+        return;
+    gst_pad_remove_probe(m_loudnessPad, m_loudnessProbe);
+    gst_object_unref(m_loudnessPad);
+    m_loudnessPad = NULL;
+    m_loudnessProbe = 0;
+    m_loudness.setFormat(LoudnessDetector::FORMAT_NONE, 0, 0);
+}
+
+void AudioPlayer::setLoudnessFormat(GstCaps *caps)
+{
+    GstAudioInfo info;
+    LoudnessDetector::Format format = LoudnessDetector::FORMAT_NONE;
+    if(gst_audio_info_from_caps(&info, caps) && GST_AUDIO_INFO_LAYOUT(&info) == GST_AUDIO_LAYOUT_INTERLEAVED)
+        format = LoudnessDetector::parseFormat(gst_audio_format_to_string(GST_AUDIO_INFO_FORMAT(&info)));
+    if(format == LoudnessDetector::FORMAT_NONE)
+    {
+        SAPLOG_WARNING("SAP: Loudness of Player id %d cannot be measured in this format\n",getObjectIdentifier());
+        m_loudness.setFormat(format, 0, 0);
+        return;
+    }
+    m_loudness.setFormat(format, GST_AUDIO_INFO_RATE(&info), GST_AUDIO_INFO_CHANNELS(&info));
+}
+
+GstPadProbeReturn AudioPlayer::loudnessProbe(GstPad *, GstPadProbeInfo *info, gpointer data)
+{
+    AudioPlayer *player = (AudioPlayer*) data;
+    if(GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM)
+    {
+        GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+        if(GST_EVENT_TYPE(event) == GST_EVENT_CAPS)
+        {
+            GstCaps *caps = NULL;
+            gst_event_parse_caps(event, &caps);
+            player->setLoudnessFormat(caps);
+        }
+        return GST_PAD_PROBE_OK;
+    }
+
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if(buffer == NULL || !player->m_loudness.isEnabled())
+        return GST_PAD_PROBE_OK;
+    GstMapInfo map;
+    if(!gst_buffer_map(buffer, &map, GST_MAP_READ))
+        return GST_PAD_PROBE_OK;
+    LoudnessDetector::Event change = player->m_loudness.process(map.data, map.size);
+    gst_buffer_unmap(buffer, &map);
+    if(change != LoudnessDetector::EVENT_NONE)
+    {
+        // Ducking is applied on the main loop, like the cutter messages
+        GstStructure *structure = gst_structure_new("loudness", "above", G_TYPE_BOOLEAN, change == LoudnessDetector::EVENT_ABOVE, NULL);
+        gst_element_post_message(player->m_audioVolume, gst_message_new_element(GST_OBJECT(player->m_audioVolume), structure));
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+void AudioPlayer::logLoudnessStats()
+{
+    LoudnessDetector::Stats stats = m_loudness.stats();
+    if(stats.buffers == 0)
+        return;
+    SAPLOG_INFO("SAP: Player id %d loudness detection used %.4f%% of a core over %llu frames, %llu level changes\n",getObjectIdentifier(),
+            m_loudness.cpuPercent(), (unsigned long long)stats.frames, (unsigned long long)stats.transitions);
+}
+
+void AudioPlayer::Prewarm(AudioType audioType, SourceType sourceType, PlayMode playMode, int count)
+{
+    // Players closing right away leave their pipelines in the pool
+    std::vector<std::unique_ptr<AudioPlayer>> players;
+    for(int i = 0; i < count; i++)
+        players.emplace_back(new AudioPlayer(audioType, sourceType, playMode, 0));
+}
+
+void AudioPlayer::logFirstSample()
+{
+    // Called where PLAYBACK_STARTED is sent
+    m_stats.started(PlaybackStats::Clock::now());
+    if(m_firstSampleLogged.exchange(true))
+        return;
+    long long latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_openTime).count();
+    SAPLOG_INFO("SAP: Player id %d first sample %lld us after Open (%s pipeline in %lld us)\n", getObjectIdentifier(),
+            latencyUs, m_pooledPipeline ? "pooled" : "new", (long long)m_pipelineSetupUs);
+}
+
+static void freeEarcon(gpointer data)
+{
+    delete static_cast<std::shared_ptr<const Earcon>*>(data);
+}
+
+bool AudioPlayer::playEarcon(const std::string &path)
+{
+    EarconCache &cache = EarconCache::instance();
+    if(!cache.enabled())
+        return false;
+    std::chrono::steady_clock::time_point trigger = std::chrono::steady_clock::now();
+    std::shared_ptr<const Earcon> earcon = cache.get(path);
+    if(!earcon)
+        return false;
+
+    GstCaps *caps = getPCMAudioCaps(earcon->format, earcon->rate, earcon->channels, "interleaved");
+    GstAudioInfo info;
+    if(caps == NULL || !gst_audio_info_from_caps(&info, caps) || (!m_earconPipeline && !createEarconPipeline(caps)))
+    {
+        if(caps)
+            gst_caps_unref(caps);
+        return false;
+    }
+    gst_app_src_set_caps(GST_APP_SRC(m_earconSource), caps);
+    gst_caps_unref(caps);
+
+    m_earconTrigger = trigger;
+    m_earconActive = true;
+    // appsrc only takes buffers once it is started
+    gst_element_set_state(m_earconPipeline, GST_STATE_PLAYING);
+
+    // The whole clip in one buffer wrapping the cached samples, which the
+    // buffer keeps alive even if the cache evicts the clip meanwhile
+    gsize size = earcon->data.size();
+    GstBuffer *buffer = gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY, (gpointer)earcon->data.data(), size, 0, size,
+            new std::shared_ptr<const Earcon>(earcon), freeEarcon);
+    GST_BUFFER_PTS(buffer) = 0;
+    GST_BUFFER_DURATION(buffer) = gst_util_uint64_scale(size / GST_AUDIO_INFO_BPF(&info), GST_SECOND, GST_AUDIO_INFO_RATE(&info));
+    gst_app_src_push_buffer(GST_APP_SRC(m_earconSource), buffer);
+    gst_app_src_end_of_stream(GST_APP_SRC(m_earconSource));
+
+    EarconCache::Stats stats = cache.stats();
+    SAPLOG_INFO("SAP: Player id %d earcon %s from memory, queued in %lld us (cache %llu hits, %llu misses, %zu clips, %zu bytes)\n",
+            getObjectIdentifier(), path.c_str(),
+            (long long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - trigger).count(),
+            (unsigned long long)stats.hits, (unsigned long long)stats.misses, stats.clips, stats.bytes);
+    return true;
+}
+
+bool AudioPlayer::createEarconPipeline(GstCaps *caps)
+{
+    bool result = false;
+    m_earconPipeline = gst_pipeline_new(NULL);
+    m_earconSource = gst_element_factory_make("appsrc", NULL);
+    if(m_earconPipeline && m_earconSource)
+    {
+        gst_app_src_set_caps(GST_APP_SRC(m_earconSource), caps);
+        g_object_set(m_earconSource, "format", GST_FORMAT_TIME, NULL);
+#ifndef UNIT_TESTING
+        result = systemAudioGeneratePipeline(m_earconPipeline,m_earconSource,NULL,&m_earconSink,&m_earconVolume,PCM,playMode,DATA,false);
+#else
+        result = systemAudioGeneratePipeline(&m_earconPipeline,&m_earconSource,NULL,&m_earconSink,&m_earconVolume,PCM,playMode,DATA,false);
+#endif
+    }
+    if(!result)
+    {
+        SAPLOG_ERROR("SAP: Failed to create earcon pipeline Player id %d\n",getObjectIdentifier());
+        if(m_earconPipeline)
+            gst_object_unref(m_earconPipeline);
+        m_earconPipeline = NULL;
+        m_earconSource = NULL;
+        return false;
+    }
+
+    GstBus *bus = gst_element_get_bus(m_earconPipeline);
+    m_earconBusWatch = Utils::Gst::addWatch(bus, m_main_context, (GstBusFunc) EarconBusCallback, (gpointer)(this), &m_busLatency);
+    gst_object_unref(bus);
+    return true;
+}
+
+void AudioPlayer::destroyEarconPipeline()
+{
+    Utils::Gst::removeWatch(m_earconBusWatch);
+    if(m_earconPipeline)
+    {
+        gst_element_set_state(m_earconPipeline, GST_STATE_NULL);
+        gst_object_unref(m_earconPipeline);
+    }
+    m_earconPipeline = NULL;
+    m_earconSource = NULL;
+}
+
+int AudioPlayer::EarconBusCallback(GstBus *, GstMessage *message, gpointer data)
+{
+    AudioPlayer *player  = (AudioPlayer*) data;
+    return player->handleEarconMessage(message);
+}
+
+bool AudioPlayer::handleEarconMessage(GstMessage *message)
+{
+    switch (GST_MESSAGE_TYPE(message)){
+
+        case GST_MESSAGE_ERROR: {
+                GError* error = NULL;
+                gchar* debug = NULL;
+                gst_message_parse_error(message, &error, &debug);
+                SAPLOG_ERROR("SAP: Earcon error on id:%d code: %d, %s\n", getObjectIdentifier(), error->code, error->message);
+                g_error_free(error);
+                g_free(debug);
+                if(m_earconActive.exchange(false))
+                {
+                    m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_ERROR);
+                    Stop();
+                }
+            }
+            break;
+
+        case GST_MESSAGE_EOS:
+            if(m_earconActive.exchange(false))
+            {
+                if(playNext())
+                    break;
+                SAPLOG_INFO("Playback Finished event\n");
+                m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_FINISHED);
+                Stop();
+            }
+            break;
+
+        case GST_MESSAGE_STATE_CHANGED: {
+                GstState oldstate, newstate, pending;
+                gst_message_parse_state_changed (message, &oldstate, &newstate, &pending);
+                // Transitions of a stopped earcon must not touch the player state
+                if (GST_ELEMENT(GST_MESSAGE_SRC(message)) != m_earconPipeline || !m_earconActive)
+                    break;
+
+                if (oldstate == GST_STATE_PAUSED && newstate == GST_STATE_PLAYING) {
+                    // As for the file pipeline, Pause and Resume set the state ahead
+                    bool pausing = m_isPaused && state == PAUSED;
+                    if(!pausing)
+                        state = PLAYING;
+                    if(m_isPaused)
+                    {
+                        if(!pausing)
+                            m_isPaused = false;
+                        m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_RESUMED);
+                    }
+                    else
+                    {
+                        SAPLOG_INFO("SAP: Earcon playing on id:%d %lld us after Play\n", getObjectIdentifier(),
+                                (long long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_earconTrigger).count());
+                        logFirstSample();
+                        m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_STARTED);
+                    }
+                    setPrimaryVolume(m_primVolume);
+                    systemAudioSetVolume(m_earconVolume,PCM,playMode,m_thisVolume);
+                } else if (oldstate == GST_STATE_PLAYING && newstate == GST_STATE_PAUSED) {
+                    if(!m_isPaused || state != PLAYING)
+                        state = PAUSED;
+                    if(m_isPaused)
+                        m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_PAUSED);
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+    return true;
+}
+
+bool AudioPlayer::decodeEarcon(const std::string &path, size_t maxBytes, Earcon &earcon)
+{
+    GError *error = NULL;
+    GstElement *pipeline = gst_parse_launch("filesrc name=src ! decodebin ! audioconvert ! audioresample ! "
+            "audio/x-raw,format=S16LE,layout=interleaved ! appsink name=sink sync=false", &error);
+    if(pipeline == NULL || error != NULL)
+    {
+        SAPLOG_ERROR("SAP: Cannot create earcon decoder: %s\n", error ? error->message : "");
+        if(error)
+            g_error_free(error);
+        if(pipeline)
+            gst_object_unref(pipeline);
+        return false;
+    }
+    GstElement *src = gst_bin_get_by_name(GST_BIN(pipeline), "src");
+    g_object_set(src, "location", path.c_str(), NULL);
+    gst_object_unref(src);
+    GstElement *sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+    gst_element_set_state(pipeline, GST_STATE_PLAYING);
+
+    bool ok = true;
+    earcon.format = "S16LE";
+    earcon.rate = 0;
+    earcon.channels = 0;
+    while(ok)
+    {
+        GstSample *sample = gst_app_sink_try_pull_sample(GST_APP_SINK(sink), EARCON_DECODE_TIMEOUT);
+        if(sample == NULL)
+        {
+            // End of the file, or a decoding error or timeout
+            ok = gst_app_sink_is_eos(GST_APP_SINK(sink));
+            break;
+        }
+        GstAudioInfo info;
+        if(earcon.rate == 0 && gst_audio_info_from_caps(&info, gst_sample_get_caps(sample)))
+        {
+            earcon.rate = GST_AUDIO_INFO_RATE(&info);
+            earcon.channels = GST_AUDIO_INFO_CHANNELS(&info);
+        }
+        GstMapInfo map;
+        GstBuffer *buffer = gst_sample_get_buffer(sample);
+        if(buffer && gst_buffer_map(buffer, &map, GST_MAP_READ))
+        {
+            if(earcon.data.size() + map.size > maxBytes)
+                ok = false;
+            else
+                earcon.data.insert(earcon.data.end(), map.data, map.data + map.size);
+            gst_buffer_unmap(buffer, &map);
+        }
+        gst_sample_unref(sample);
+    }
+
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(sink);
+    gst_object_unref(pipeline);
+    return ok && earcon.rate > 0 && earcon.channels > 0 && !earcon.data.empty();
 }
 
 void AudioPlayer::Play(std::string url)
@@ -806,6 +1883,15 @@ void AudioPlayer::Play(std::string url)
     if(m_pipeline)
     {
         Stop();
+        m_stats.playRequested(PlaybackStats::Clock::now());
+        // Cached UI sounds skip filesrc and the decoder
+        if(sourceType == FILESRC && playEarcon(m_url))
+            return;
+        if(m_earconPipeline)
+        {
+            // Let the file pipeline have the sink
+            gst_element_set_state(m_earconPipeline, GST_STATE_NULL);
+        }
         if(sourceType == HTTPSRC || sourceType == FILESRC)
         {
             g_object_set(G_OBJECT(m_source), "location", m_url.c_str(), NULL);
@@ -816,6 +1902,264 @@ void AudioPlayer::Play(std::string url)
     }    
 }
 
+bool AudioPlayer::Prepare(std::string url)
+{
+    std::lock_guard<std::mutex> lock(m_playMutex);
+    return prepare(url);
+}
+
+bool AudioPlayer::prepare(const std::string &url)
+{
+    m_url = url;
+    SAPLOG_INFO("SAP: AudioPlayer Prepare invoked Playerid %d..URL %s\n",getObjectIdentifier(),m_url.c_str());
+    // A websocket player only connects once PLAYING
+    if(!m_pipeline || sourceType == WEBSOCKET)
+    {
+        SAPLOG_WARNING("SAP: Playerid %d cannot be prepared\n",getObjectIdentifier());
+        return false;
+    }
+    Stop();
+    m_stats.playRequested(PlaybackStats::Clock::now());
+    // Earcons are not prerolled, the file pipeline plays them too
+    if(m_earconPipeline)
+        gst_element_set_state(m_earconPipeline, GST_STATE_NULL);
+    if(sourceType == HTTPSRC || sourceType == FILESRC)
+        g_object_set(G_OBJECT(m_source), "location", m_url.c_str(), NULL);
+    else
+        m_holdStart = true;
+    gst_element_set_state(m_pipeline, GST_STATE_PAUSED);
+    m_prepared = true;
+    return true;
+}
+
+bool AudioPlayer::PlayAt(std::string url, int64_t monotonicNs, int64_t &lateUs)
+{
+    std::lock_guard<std::mutex> lock(m_playMutex);
+    SAPLOG_INFO("SAP: AudioPlayer PlayAt invoked Playerid %d..URL %s at %lld ns\n",getObjectIdentifier(),url.c_str(),(long long)monotonicNs);
+    if((!m_prepared || m_url != url) && !prepare(url))
+        return false;
+
+    // Without the API lock: a DATA player prerolls on PlayBuffer data
+    GstState current = GST_STATE_NULL;
+    GstStateChangeReturn ret = gst_element_get_state(m_pipeline, &current, NULL, PLAY_AT_PREROLL_TIMEOUT_MS * GST_MSECOND);
+
+    std::lock_guard<std::mutex> apiLock(m_apiMutex);
+    if(!m_prepared || !m_pipeline)
+        return false;
+    if(ret == GST_STATE_CHANGE_FAILURE || current != GST_STATE_PAUSED)
+    {
+        // Left prepared for another PlayAt
+        SAPLOG_WARNING("SAP: Playerid %d did not preroll within %d ms\n",getObjectIdentifier(),PLAY_AT_PREROLL_TIMEOUT_MS);
+        return false;
+    }
+    GstClock *clock = gst_pipeline_get_clock(GST_PIPELINE(m_pipeline));
+    if(clock == NULL)
+        return false;
+
+    // Only a live pipeline delays its output by the latency it reports
+    GstQuery *query = gst_query_new_latency();
+    gboolean live = FALSE;
+    GstClockTime latency = 0;
+    if(gst_element_query(m_pipeline, query))
+        gst_query_parse_latency(query, &live, &latency, NULL);
+    gst_query_unref(query);
+    if(!live || !GST_CLOCK_TIME_IS_VALID(latency))
+        latency = 0;
+
+    // Kept on the clock the target was mapped onto, with the base time
+    // left as set instead of taken from the clock on PLAYING
+    gst_pipeline_use_clock(GST_PIPELINE(m_pipeline), clock);
+    gst_element_set_start_time(m_pipeline, GST_CLOCK_TIME_NONE);
+    m_scheduledClock = true;
+    int64_t clockNow = (int64_t)gst_clock_get_time(clock);
+    ScheduledStart::Plan plan = ScheduledStart::plan(monotonicNs, ScheduledStart::monotonicNowNs(), clockNow, (int64_t)latency);
+    int64_t leadNs = plan.targetClock - clockNow;
+    gst_object_unref(clock);
+    gst_element_set_base_time(m_pipeline, (GstClockTime)plan.baseTime);
+
+    m_prepared = false;
+    m_holdStart = false;
+    gst_element_set_state(m_pipeline, GST_STATE_PLAYING);
+    // A data player that prerolled on all its data sends no more pushes
+    if(m_dataPushed && appsrc_firstpacket.exchange(false))
+        dataStarted();
+
+    lateUs = plan.lateNs / 1000;
+    SAPLOG_INFO("SAP: Playerid %d starts in %lld us, %lld us late\n",getObjectIdentifier(),
+            (long long)(std::max<int64_t>(0, leadNs) / 1000),(long long)lateUs);
+    // A check still running reads the plan
+    m_startCheck.stop();
+    m_startPlan = plan;
+    m_startCheck.start(m_main_context, (int)(std::max<int64_t>(0, leadNs) / 1000000) + PLAY_AT_CHECK_DELAY_MS);
+    return true;
+}
+
+void AudioPlayer::startCheckTimeout()
+{
+    // A pause since the start would count as lateness
+    if(!m_pipeline || state != PLAYING || m_isPaused)
+        return;
+
+    GstClock *clock = gst_pipeline_get_clock(GST_PIPELINE(m_pipeline));
+    gint64 position = 0;
+    if(clock && gst_element_query_position(m_pipeline, GST_FORMAT_TIME, &position))
+    {
+        int64_t offsetUs = ScheduledStart::offsetNs(m_startPlan, (int64_t)gst_clock_get_time(clock), position) / 1000;
+        m_stats.scheduledStart(offsetUs);
+        SAPLOG_INFO("SAP: Playerid %d started %lld us %s the requested time\n",getObjectIdentifier(),
+                (long long)std::llabs(offsetUs), offsetUs < 0 ? "before" : "after");
+    }
+    if(clock)
+        gst_object_unref(clock);
+}
+
+void AudioPlayer::clearSchedule()
+{
+    if(!m_scheduledClock || !m_pipeline)
+        return;
+    gst_pipeline_auto_clock(GST_PIPELINE(m_pipeline));
+    gst_element_set_start_time(m_pipeline, 0);
+    m_scheduledClock = false;
+}
+
+bool AudioPlayer::Enqueue(std::string url)
+{
+    std::lock_guard<std::mutex> lock(m_apiMutex);
+    SAPLOG_INFO("SAP: AudioPlayer Enqueue invoked Playerid %d..URL %s\n",getObjectIdentifier(),url.c_str());
+    if(sourceType != FILESRC && sourceType != HTTPSRC)
+        return false;
+    // Between Play and PAUSED the state is still READY
+    if(!m_pipeline || (GST_STATE_TARGET(m_pipeline) < GST_STATE_PAUSED && !m_earconActive))
+    {
+        SAPLOG_WARNING("SAP: Nothing playing on Playerid %d to enqueue after\n",getObjectIdentifier());
+        return false;
+    }
+    if(m_playlist.size() + (m_next.pipeline ? 1 : 0) >= PLAYLIST_MAX_ITEMS)
+    {
+        SAPLOG_WARNING("SAP: Playlist of Playerid %d is full\n",getObjectIdentifier());
+        return false;
+    }
+    m_playlist.push_back(url);
+    prerollNext();
+    return true;
+}
+
+void AudioPlayer::prerollNext()
+{
+    while(!m_next.pipeline && !m_playlist.empty())
+    {
+        std::string url = m_playlist.front();
+        m_playlist.pop_front();
+
+        PooledPipeline next;
+        if(!PipelinePool::instance().take(getPipelineKey(), next))
+        {
+            // buildPipeline() sets up the members of the current pipeline
+            PooledPipeline current = { m_pipeline, m_source, m_capsfilter, m_audioSink, m_audioVolume };
+            bool built = buildPipeline(m_smartVolume);
+            next = { m_pipeline, m_source, m_capsfilter, m_audioSink, m_audioVolume };
+            m_pipeline = current.pipeline;
+            m_source = current.source;
+            m_capsfilter = current.capsfilter;
+            m_audioSink = current.audioSink;
+            m_audioVolume = current.audioVolume;
+            if(!built)
+            {
+                SAPLOG_ERROR("SAP: No pipeline for playlist item %s of Playerid %d\n",url.c_str(),getObjectIdentifier());
+                continue;
+            }
+        }
+        // Opens the source and fills the sink while the current item plays
+        g_object_set(G_OBJECT(next.source), "location", url.c_str(), NULL);
+        gst_element_set_state(next.pipeline, GST_STATE_PAUSED);
+        m_next = next;
+        m_nextUrl = url;
+        SAPLOG_INFO("SAP: Prerolling playlist item %s of Playerid %d, %zu more queued\n",url.c_str(),getObjectIdentifier(),m_playlist.size());
+    }
+}
+
+bool AudioPlayer::playNext()
+{
+    std::lock_guard<std::mutex> lock(m_apiMutex);
+    prerollNext();
+    while(m_next.pipeline)
+    {
+        GstBus *bus = gst_element_get_bus(m_next.pipeline);
+        GstMessage *error = gst_bus_pop_filtered(bus, GST_MESSAGE_ERROR);
+        // The preroll messages must not reach handleMessage() as those of
+        // the playing pipeline
+        gst_bus_set_flushing(bus, TRUE);
+        gst_bus_set_flushing(bus, FALSE);
+        gst_object_unref(bus);
+        if(error == NULL)
+            break;
+        // Skipped; the items after it still play
+        SAPLOG_ERROR("SAP: Playlist item %s of Playerid %d failed to preroll\n",m_nextUrl.c_str(),getObjectIdentifier());
+        gst_message_unref(error);
+        gst_element_set_state(m_next.pipeline, GST_STATE_NULL);
+        gst_object_unref(m_next.pipeline);
+        m_next = PooledPipeline();
+        m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_ERROR);
+        prerollNext();
+    }
+    if(!m_next.pipeline)
+        return false;
+
+    // A PlayAt start check would measure the next item, nor may a queued
+    // Pause or Resume of the finished one apply to it
+    m_startCheck.stop();
+    (*m_generation)++;
+    // Started before anything else so the gap is only the handoff
+    m_stats.playRequested(PlaybackStats::Clock::now());
+    gst_element_set_state(m_next.pipeline, GST_STATE_PLAYING);
+    SAPLOG_INFO("SAP: Playlist item finished on Playerid %d, playing %s\n",getObjectIdentifier(),m_nextUrl.c_str());
+    // Found by the URL of the item before the event is seen
+    m_callback->onSAPUrlChanged(getObjectIdentifier(),m_nextUrl);
+    m_callback->onSAPEvent(getObjectIdentifier(),PLAYLIST_ITEM_FINISHED);
+
+    if(m_earconPipeline && GST_STATE_TARGET(m_earconPipeline) > GST_STATE_READY)
+        gst_element_set_state(m_earconPipeline, GST_STATE_READY);
+    // The finished pipeline goes back to the pool as on Close
+    releasePipeline();
+    m_pipeline = m_next.pipeline;
+    m_source = m_next.source;
+    m_capsfilter = m_next.capsfilter;
+    m_audioSink = m_next.audioSink;
+    m_audioVolume = m_next.audioVolume;
+    m_next = PooledPipeline();
+    m_url = m_nextUrl;
+    m_isPaused = false;
+    m_prevThisVolume = -1;
+    // PLAYBACK_STARTED of the item follows from its PLAYING transition
+    attachPipeline();
+    prerollNext();
+    return true;
+}
+
+void AudioPlayer::releaseNext()
+{
+    m_playlist.clear();
+    if(!m_next.pipeline)
+        return;
+    GstState current = GST_STATE_NULL;
+    gst_element_set_state(m_next.pipeline, GST_STATE_READY);
+    bool ready = gst_element_get_state(m_next.pipeline, &current, NULL, PIPELINE_POOL_READY_TIMEOUT) == GST_STATE_CHANGE_SUCCESS
+            && current == GST_STATE_READY;
+    if(ready)
+    {
+        GstBus *bus = gst_element_get_bus(m_next.pipeline);
+        gst_bus_set_flushing(bus, TRUE);
+        gst_bus_set_flushing(bus, FALSE);
+        gst_object_unref(bus);
+    }
+    if(!ready || !PipelinePool::instance().put(getPipelineKey(), m_next))
+    {
+        gst_element_set_state(m_next.pipeline, GST_STATE_NULL);
+        gst_object_unref(m_next.pipeline);
+    }
+    m_next = PooledPipeline();
+}
+
 void AudioPlayer::configWsSecParams(const impl::SecurityParameters& secParams)
 {
     std::lock_guard<std::mutex> lock(m_playMutex);
@@ -826,31 +2170,66 @@ void AudioPlayer::configWsSecParams(const impl::SecurityParameters& secParams)
 
 void AudioPlayer::PlayBuffer(const char *data,int length)
 {  
-    std::lock_guard<std::mutex> lock(m_apiMutex);
-    SAPLOG_INFO("SAP: AudioPlayer PlayBuffer invoked Playerid %d\n",getObjectIdentifier());
-    if(m_pipeline)
     {
-        if(state != PLAYING)
-            gst_element_set_state(m_pipeline, GST_STATE_PLAYING);      
-        push_data(data,length);
+        std::lock_guard<std::mutex> lock(m_apiMutex);
+        SAPLOG_INFO("SAP: AudioPlayer PlayBuffer invoked Playerid %d\n",getObjectIdentifier());
+        // Timed from the first buffer after Open or Stop
+        if(appsrc_firstpacket && !m_stats.requestPending())
+            m_stats.playRequested(PlaybackStats::Clock::now());
+        if(m_mixer)
+        {
+            // A paused player keeps queueing until it is resumed
+            if(state == READY)
+                state = PLAYING;
+        }
+        else if(m_pipeline)
+        {
+            // A prepared player prerolls on the data until PlayAt
+            if(state != PLAYING && !m_holdStart)
+                gst_element_set_state(m_pipeline, GST_STATE_PLAYING);      
+        }
+        else
+        {
+            return;
+        }
     }
+    // Not under the API lock: add() may wait for room, and the Stop,
+    // Pause or Close that would end the wait needs that lock. The clear
+    // in Stop wakes it instead.
+    std::lock_guard<std::mutex> pushLock(m_pushMutex);
+    push_data(data,length);
 }
 
 bool AudioPlayer::Pause()
 {
     std::lock_guard<std::mutex> lock(m_apiMutex);
     SAPLOG_INFO("SAP: AudioPlayer Pause Playerid %d\n",getObjectIdentifier());
-    if( m_pipeline )
+    if(m_mixer)
+    {
+        // Only this session leaves the mix, the others keep playing
+        if(!m_isPaused && state == PLAYING)
+        {
+            m_isPaused = true;
+            m_mixer->setPaused(m_mixerStream, true);
+            state = PAUSED;
+            m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_PAUSED);
+            return true;
+        }
+    }
+    else if( m_pipeline )
     {
 
         if(sourceType == FILESRC || sourceType == HTTPSRC)
         {
 	   
-            if(!m_isPaused && state == PLAYING) 
+            // Also while a Resume is still on its way
+            if(state == PLAYING) 
             {
                 m_isPaused = true;
+                // Set ahead of the transition so a Resume right away works
+                state = PAUSED;
                 SAPLOG_INFO("SAP: AudioPlayer Pause invoked\n");
-                gst_element_set_state(m_pipeline, GST_STATE_PAUSED);
+                Utils::Gst::invokeStateChange(m_main_context, m_earconActive ? m_earconPipeline : m_pipeline, GST_STATE_PAUSED, m_generation);
                 return true;
             } 
         }
@@ -862,20 +2241,69 @@ void AudioPlayer::Stop()
 {
     SAPLOG_INFO("SAP: AudioPlayer Stop Playerid %d\n",getObjectIdentifier());
     std::lock_guard<std::mutex> lock(m_apiMutex);
+    // A Pause or Resume still queued must not reach the next Play
+    (*m_generation)++;
+    m_stats.cancelRequest();
+    releaseNext();
+    m_startCheck.stop();
+    m_prepared = false;
+    m_holdStart = false;
+    m_dataPushed = false;
     if(sourceType == DATA || sourceType == WEBSOCKET )
     {
-        if(webClient != nullptr)
+        if(sourceType == WEBSOCKET)
         {
-            webClient->disconnect();
-            webClient.reset();
+            ReconnectBackoff::Stats reconnect = getReconnectStats();
+            SAPLOG_INFO("SAP: Playerid %d websocket: %llu outages, %llu reconnects, %llu given up, %.0f ms in outages (longest %.0f ms)\n",
+                    getObjectIdentifier(), (unsigned long long)reconnect.outages, (unsigned long long)reconnect.reconnects,
+                    (unsigned long long)reconnect.givenUp, reconnect.outageMs, reconnect.maxOutageMs);
         }
+        cancelReconnect();
 
+        FlowStats stats = getFlowStats();
+        SAPLOG_INFO("SAP: Playerid %d flow: %llu feed pauses, %llu underruns, %llu bytes dropped\n", getObjectIdentifier(),
+                (unsigned long long)stats.feedPauses, (unsigned long long)stats.underruns, (unsigned long long)stats.droppedBytes);
+        if(m_jitter)
+        {
+            JitterBuffer::Stats jitter = getJitterStats();
+            SAPLOG_INFO("SAP: Playerid %d jitter buffer: %llu frames, %llu late, %llu underruns, depth %d ms of %d ms target (max %d ms), jitter %.1f ms\n",
+                    getObjectIdentifier(), (unsigned long long)jitter.frames, (unsigned long long)jitter.lateFrames,
+                    (unsigned long long)jitter.underruns, jitter.depthMs, jitter.targetMs, jitter.maxDepthMs, jitter.jitterMs);
+            clearJitterBuffer();
+        }
+        setFeedPaused(false);
+        {
+            std::lock_guard<std::mutex> feedLock(m_feedMutex);
+            m_appsrcFull = false;
+        }
+        m_feedCondition.notify_all();
         appsrc_firstpacket = true;
-        bufferQueue->clear();
-	SAPLOG_INFO("size of Buffer queue after clear %d\n",bufferQueue->count());
-	  
+        if(m_shmRing)
+            m_shmRing->clear();
+        if(bufferQueue)
+        {
+            bufferQueue->clear();
+            SAPLOG_INFO("size of Buffer queue after clear %zu\n",bufferQueue->count());
+        }
+    }
+    logLoudnessStats();
+    if(m_mixer)
+    {
+        // The shared pipeline plays on for the other sessions
+        m_mixer->mixer().flush(m_mixerStream);
+        m_mixer->setPaused(m_mixerStream, false);
+        m_isPaused = false;
+        state = READY;
+        return;
+    }
+    m_earconActive = false;
+    if(m_earconPipeline && GST_STATE_TARGET(m_earconPipeline) > GST_STATE_READY)
+    {
+        // READY flushes the clip but keeps the sink open for the next one
+        gst_element_set_state(m_earconPipeline, GST_STATE_READY);
     }
     resetPipeline();
+    clearSchedule();
     state = READY;
     
 }
@@ -883,14 +2311,27 @@ bool AudioPlayer::Resume()
 {  
     std::lock_guard<std::mutex> lock(m_apiMutex);
     SAPLOG_INFO("SAP: AudioPlayer Resume Playerid %d\n",getObjectIdentifier());
-    if(m_pipeline )
+    if(m_mixer)
+    {
+        if(m_isPaused && state == PAUSED)
+        {
+            m_isPaused = false;
+            m_mixer->setPaused(m_mixerStream, false);
+            state = PLAYING;
+            m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_RESUMED);
+            return true;
+        }
+    }
+    else if(m_pipeline )
     {
         if(sourceType == FILESRC || sourceType == HTTPSRC)
         {
             if(m_isPaused && state == PAUSED)
             {
                 SAPLOG_INFO("SAP: AudioPlayer Resume invoked\n");
-                gst_element_set_state(m_pipeline, GST_STATE_PLAYING);
+                // m_isPaused stays set until PLAYING, for PLAYBACK_RESUMED
+                state = PLAYING;
+                Utils::Gst::invokeStateChange(m_main_context, m_earconActive ? m_earconPipeline : m_pipeline, GST_STATE_PLAYING, m_generation);
                 return true;
             } 
         }
@@ -940,7 +2381,10 @@ void AudioPlayer::setVolume( int thisVol)
     SAPLOG_INFO(" Prev Player Volume=%d cur Vol=%d",m_prevThisVolume , thisVol );
     if( m_prevThisVolume != thisVol )
     {
-        systemAudioSetVolume(m_audioVolume,audioType,playMode,thisVol);
+        if(m_mixer)
+            m_mixer->mixer().setGain(m_mixerStream, thisVol / 100.0f);
+        else
+            systemAudioSetVolume(m_audioVolume,audioType,playMode,thisVol);
         m_prevThisVolume = thisVol;
     }
 }
@@ -999,7 +2443,16 @@ void AudioPlayer::setThreshold( double thresHold)
 // Provision for Volume Control
 void AudioPlayer::SetSmartVolControl(bool smartVolumeEnable, double threshold, int detectTimeMs, int holdTimeMs, int duckPercent)
 {
-   if( isPlaying())
+   if(m_mixer)
+   {
+      // Mixed players have no pipeline of their own to measure
+      SAPLOG_ERROR("SAP: Smart volume control is not available to mixed Player id %d\n",getObjectIdentifier());
+      return;
+   }
+
+   // The loudness probe is reconfigured in place, the cutter needs a new pipeline
+   bool probed = (m_loudnessPad != NULL);
+   if(!probed && isPlaying())
    {
       SAPLOG_ERROR("playback is in progress, smart volume control cannot be applied");
       m_callback->onSAPEvent(getObjectIdentifier(),PLAYBACK_INPROGRESS);
@@ -1014,7 +2467,7 @@ void AudioPlayer::SetSmartVolControl(bool smartVolumeEnable, double threshold, i
        m_thresHold=0.0, m_detectTimeMs=0, m_holdTimeMs=0,m_duckPercent=0;
 
        SAPLOG_INFO("SAP: Smart Volume Control is enabled");
-       if(m_audioCutter == false)
+       if(!probed && m_audioCutter == false)
        {
           SAPLOG_INFO("SAP: %s:%d Resetting Pipeline for Smart Volume Enabled.",__FUNCTION__ ,__LINE__ );
           resetPipelineForSmartVolumeControl(smartVolumeEnable);
@@ -1030,13 +2483,29 @@ void AudioPlayer::SetSmartVolControl(bool smartVolumeEnable, double threshold, i
        }
 
        SAPLOG_INFO("SAP:GLOBAL m_thresHold=%f m_detectTimeMs=%d m_holdTimeMs=%d m_duckPercent=%d \n",m_thresHold, m_detectTimeMs, m_holdTimeMs, m_duckPercent );
-       setHoldTime(m_holdTimeMs);
-       setThreshold(m_thresHold);
+       if(probed)
+       {
+          m_loudness.configure(m_thresHold, m_detectTimeMs, m_holdTimeMs);
+          m_loudness.setEnabled(true);
+       }
+       else
+       {
+          setHoldTime(m_holdTimeMs);
+          setThreshold(m_thresHold);
+       }
     }
     else
     {
        SAPLOG_INFO("SAP: Smart Volume Control is disabled");
-       if ( m_audioCutter != false)
+       if(probed)
+       {
+          bool ducked = m_loudness.isAbove();
+          m_loudness.setEnabled(false);
+          logLoudnessStats();
+          if(ducked && isPlaying())
+             setPrimaryVolume(m_primVolume);
+       }
+       else if ( m_audioCutter != false)
        {
           SAPLOG_INFO("SAP: %s:%d Resetting Pipeline due to Smart Volume Disabled.",__FUNCTION__ ,__LINE__ );
           resetPipelineForSmartVolumeControl(smartVolumeEnable);
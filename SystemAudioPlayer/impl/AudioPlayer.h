@@ -20,14 +20,29 @@
 #ifndef AUDIO_PLAYER
 #define AUDIO_PLAYER
 #include <atomic>
+#include <chrono>
+#include <memory>
 #include <gst/gst.h>
 #include <gst/audio/audio.h>
 #include <string>
 #include "BufferQueue.h"
+#include "EarconCache.h"
+#include "FeederPool.h"
+#include "JitterBuffer.h"
+#include "LoudnessDetector.h"
+#include "MainLoopTimer.h"
+#include "MixerOutput.h"
+#include "PlaybackStats.h"
+#include "PipelinePool.h"
+#include "ReconnectBackoff.h"
+#include "ScheduledStart.h"
+#include "ShmRing.h"
 #include "IWebSocketClient.h"
 #include "SecurityParameters.h"
 #include <systemaudioplatform.h>
+#include "UtilsGstBus.h"
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -42,12 +57,15 @@ public:
     SAPEventCallback() {}
     virtual ~SAPEventCallback() {}
     virtual void onSAPEvent(uint32_t id,std::string message) { (void)id; }
+    // A player moved on to url without a Play, e.g. to its next playlist item
+    virtual void onSAPUrlChanged(uint32_t id,const std::string &url) { (void)id; (void)url; }
 };
 
 enum WSStatus
 {
     CONNECTED,
-    DISCONNECTED,
+    DISCONNECTED,   // dropped, reconnected if enabled
+    CLOSED,         // closed normally by the server
     NETWORKERROR
 };
 
@@ -59,7 +77,7 @@ enum State
     PLAYBACKERROR
 };
 
-class AudioPlayer
+class AudioPlayer : public FeederSession
 {
     private:
     GstElement  *m_pipeline;
@@ -77,13 +95,17 @@ class AudioPlayer
     int m_holdTimeMs;
     int m_duckPercent;
     static GMainLoop   *m_main_loop;
+    static GMainContext *m_main_context;
     static GThread     *m_main_loop_thread;
+    static Utils::GstBusLatencyHistogram m_busLatency;
     static bool m_isLoopStarted;
     static std::mutex m_eventMutex;
     static std::condition_variable m_eventCondition;
     static SAPEventCallback *m_callback;
     int objectIdentifier;
     std::atomic<bool> m_isPaused;
+    // Bumped on Stop and at each playlist item, see invokeStateChange
+    Utils::Gst::PipelineGeneration m_generation;
     bool m_running;
     std::atomic<bool> appsrc_firstpacket;    
     std::mutex m_queueMutex;
@@ -91,25 +113,130 @@ class AudioPlayer
     std::mutex m_apiMutex;
     std::condition_variable m_condition;
     std::string m_url;
-    guint       m_busWatch;  
+    GSource     *m_busWatch;
     gint64      m_duration;
     std::thread *m_thread;
+    // Guards webClient against the streaming and websocket threads
+    std::mutex m_webClientMutex;
     impl::WebSocketClientPtr webClient;
     impl::SecurityParameters m_secParams;
     std::atomic_bool m_fallbackToUnsecuredConnection{false};
     BufferQueue *bufferQueue;
+    // Serialises the PlayBuffer producers in place of m_apiMutex, which
+    // is not held while they wait for room
+    std::mutex m_pushMutex;
+    std::unique_ptr<ShmRing> m_shmRing;
     GstElement  *m_source;
     AudioType audioType;
     SourceType sourceType;
     PlayMode playMode;
     WSStatus wsStatus;
     std::atomic<State> state;
+    //Flow control
+    std::mutex m_feedMutex;
+    std::condition_variable m_feedCondition;
+    std::atomic<bool> m_appsrcFull;
+    // NEED_DATA was sent for the current drain of BufferQueue
+    std::atomic<bool> m_drained;
+    std::atomic<bool> m_feedPaused;
+    //GetStatistics counters, lock free
+    PlaybackStats m_stats;
+    //Prebuffering of websocket PCM audio, released on the main loop
+    //once a frame waited long enough
+    std::unique_ptr<JitterBuffer> m_jitter;
+    std::mutex m_jitterMutex;
+    MainLoopTimer m_jitterTimer;
+    static int m_jitterTargetMs;
+    static int m_jitterMaxMs;
+    //Reconnecting of a dropped websocket session on the main loop; the
+    //pipeline keeps playing what it holds meanwhile. The backoff and flag
+    //are guarded by m_webClientMutex
+    ReconnectBackoff m_backoff;
+    MainLoopTimer m_reconnectTimer;
+    //Destroys the dropped clients off the main loop, each after the one
+    //before it; joined by cancelReconnect()
+    std::thread m_clientReaper;
+    bool m_wsReconnect;
+    static int m_reconnectGiveUpMs;
+    //Pipeline pool
+    bool m_smartVolume;
+    bool m_pooledPipeline;
+    bool m_capsChanged;
+    int64_t m_pipelineSetupUs;
+    std::atomic<bool> m_firstSampleLogged;
+    std::chrono::steady_clock::time_point m_openTime;
+    //Earcons played from EarconCache by FILESRC players
+    GstElement  *m_earconPipeline;
+    GstElement  *m_earconSource;
+    GstElement  *m_earconSink;
+    GstElement  *m_earconVolume;
+    GSource     *m_earconBusWatch;
+    std::atomic<bool> m_earconActive;
+    std::chrono::steady_clock::time_point m_earconTrigger;
+    //Mixed PCM players feed a MixerOutput stream instead of a pipeline
+    MixerOutput *m_mixer;
+    int m_mixerStream;
+    //Smart volume control, measured on the sink pad of the volume element
+    LoudnessDetector m_loudness;
+    GstPad *m_loudnessPad;
+    gulong m_loudnessProbe;
+    //Gapless playlist of FILESRC and HTTPSRC players, guarded by m_apiMutex.
+    //The next item waits prerolled in a pipeline of its own and takes over
+    //on the EOS of the current one
+    std::deque<std::string> m_playlist;
+    PooledPipeline m_next;
+    std::string m_nextUrl;
+    //Preroll without starting, for PlayAt. A prepared DATA player takes
+    //PlayBuffer data in PAUSED until it is started
+    std::atomic<bool> m_prepared;
+    std::atomic<bool> m_holdStart;
+    std::atomic<bool> m_dataPushed;
+    //The pipeline runs on a fixed clock and base time for a PlayAt, and
+    //its start is measured once on the main loop
+    bool m_scheduledClock;
+    ScheduledStart::Plan m_startPlan;
+    MainLoopTimer m_startCheck;
     //PCM audio caps
     std::string m_PCMFormat;
     std::string m_Layout;
     int  m_Rate;
     int  m_Channels;
+    // Takes a pipeline from PipelinePool or builds one
     void createPipeline(bool smartVolumeControl);    
+    bool buildPipeline(bool smartVolumeControl);
+    // Bus watch, probes and signals of the pipeline the player plays
+    void attachPipeline();
+    // Hands the pipeline to PipelinePool, or destroys it if it cannot be reused
+    void releasePipeline();
+    PipelinePool::Key getPipelineKey();
+    void logFirstSample();
+    // Plays a cached decoded clip from memory, false to use filesrc instead
+    bool playEarcon(const std::string &path);
+    bool createEarconPipeline(GstCaps *caps);
+    void destroyEarconPipeline();
+    bool handleEarconMessage(GstMessage *message);
+    static int EarconBusCallback(GstBus *bus, GstMessage *message, gpointer data);
+    // feed() of a mixed player
+    bool feedMixer();
+    // Without the probe smart volume control falls back to the cutter
+    void addLoudnessProbe();
+    void removeLoudnessProbe();
+    void setLoudnessFormat(GstCaps *caps);
+    void logLoudnessStats();
+    static GstPadProbeReturn loudnessProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+    // Builds and prerolls the pipeline of the next playlist item, if none is
+    void prerollNext();
+    // Starts the prerolled item in place of the finished one
+    bool playNext();
+    // Drops the playlist and the prerolled item
+    void releaseNext();
+    // Stops and prerolls url; under m_playMutex
+    bool prepare(const std::string &url);
+    // Back to the clock and base time a pipeline picks itself
+    void clearSchedule();
+    void startCheckTimeout();
+    // PLAYBACK_STARTED of a DATA or WEBSOCKET player
+    void dataStarted();
     void resetPipeline();
     void resetPipelineForSmartVolumeControl(bool smartVolumeEnable);
     void destroyPipeline();
@@ -121,12 +248,47 @@ class AudioPlayer
     void setThresholdDB( double thresHold_dB);
     bool waitForStatus(GstState expected_state, uint32_t timeout_ms);
     GstCaps * getPCMAudioCaps( const std::string format, int rate, int channels, const std::string layout);
+    size_t getBufferQueueSize();
+    // Of the PCM caps
+    size_t getBytesPerSecond();
+    // Pushes gbuffer and drops the caller's reference
+    void pushToAppSrc(GstBuffer *gbuffer);
+    void setFeedPaused(bool paused);
+    // Hands a websocket frame to appsrc
+    void pushFrame(std::string &&payload);
+    void releaseJitterFrames();
+    void clearJitterBuffer();
+    void resetWebClient();
+    // Sends NETWORK_ERROR once the backoff gives up
+    void scheduleReconnect();
+    void cancelReconnect();
+    void reconnectTimeout();
+    static void reapWebClient(impl::IWebSocketClient *client, std::thread previous);
+    static void appsrcNeedData(GstElement *appsrc, guint length, gpointer data);
+    static void appsrcEnoughData(GstElement *appsrc, gpointer data);
 
     public:
+    struct FlowStats
+    {
+        uint64_t feedPauses;    // pause feeding requests sent to the source
+        uint64_t underruns;     // appsrc ran dry during playback
+        uint64_t droppedBytes;  // bytes lost to a full queue or a refused push
+    };
+
     AudioPlayer() {}
-    AudioPlayer(AudioType,SourceType,PlayMode,int objectIdentifier);
+    // shmSize > 0 makes a DATA player read a shared memory ring instead of PlayBuffer
+    AudioPlayer(AudioType,SourceType,PlayMode,int objectIdentifier,size_t shmSize = 0);
     ~AudioPlayer();
     void Play(std::string url);
+    // Plays url gaplessly after the current item; false without one
+    bool Enqueue(std::string url);
+    // Prerolls url to PAUSED without starting; false for mixed and
+    // websocket players
+    bool Prepare(std::string url);
+    // Starts url, prerolled if it was not, so that it is heard at the
+    // CLOCK_MONOTONIC time monotonicNs. lateUs is how far behind it the
+    // start had to be scheduled
+    bool PlayAt(std::string url, int64_t monotonicNs, int64_t &lateUs);
     void PlayBuffer(const char*,int);
     bool Resume();
     bool Pause();
@@ -137,18 +299,44 @@ class AudioPlayer
     PlayMode  getPlayMode();
     SourceType getSourceType();
     void push_data(const void *ptr,int length);
+    // Websocket frames; the payload is handed to GStreamer without a copy
+    void push_message(std::string &&payload);
     void wsConnectionStatus(WSStatus status);
     bool handleMessage(GstMessage*);
-    gboolean PushDataAppSrc();
+    // FeederPool turn: pushes one fragment of BufferQueue to appsrc
+    bool feed() override;
+    gboolean PushShmAppSrc();
     static void Init(SAPEventCallback *callback);
+    // Target and largest depth of the websocket jitter buffer; a target of 0
+    // disables it, a largest depth of 0 keeps the current one
+    static void configureJitterBuffer(int targetMs, int maxMs);
+    // How long a dropped websocket session is reconnected, 0 disables it
+    static void configureReconnect(int giveUpMs);
+    // Leaves count pipelines of this kind in PipelinePool
+    static void Prewarm(AudioType,SourceType,PlayMode,int count);
     static void DeInit();
+    // In place of DeInit while abandoned players are still being torn down:
+    // their events go nowhere, and the main loop and shared state they use
+    // are left running
+    static void Abandon();
     static void waitForMainLoop();
     static int GstBusCallback(GstBus *bus, GstMessage *message, gpointer data); 
+    // EarconCache decoder for files other than WAV
+    static bool decodeEarcon(const std::string &path, size_t maxBytes, Earcon &earcon);
     static void event_loop();
     int getObjectIdentifier();
     std::string getUrl();
     bool isPlaying();
+    // Plays alongside other mixed players of its play mode
+    bool isMixed();
     bool configPCMCaps(const std::string format, int rate, int channels, const std::string layout);
     void configWsSecParams(const impl::SecurityParameters& secParams);
+    FlowStats getFlowStats();
+    PlaybackStats::Snapshot getPlaybackStats();
+    // All zero without a jitter buffer
+    JitterBuffer::Stats getJitterStats();
+    ReconnectBackoff::Stats getReconnectStats();
+    std::string getShmPath();
+    size_t getShmSize();
 };
 #endif
@@ -0,0 +1,250 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "Base64Decoder.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <tmmintrin.h>
+#define BASE64_SSSE3 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BASE64_NEON 1
+#endif
+
+// A pooled buffer grown past this is released after use
+#define POOLED_BUFFER_KEEP_SIZE (1024 * 1024)
+
+namespace {
+
+const int8_t kInvalid = -1;
+
+struct DecodeTable
+{
+    int8_t value[256];
+
+    DecodeTable()
+    {
+        static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        memset(value, kInvalid, sizeof(value));
+        for(int i = 0; i < 64; i++)
+            value[(uint8_t)alphabet[i]] = (int8_t)i;
+    }
+};
+
+const DecodeTable kTable;
+
+#if BASE64_SSSE3
+// Decodes whole 16 character blocks, never the last 4 characters since they
+// may hold padding. Stops at the first block with an invalid character.
+// Returns the characters consumed.
+__attribute__((target("ssse3")))
+size_t decodeBlocks(const char *input, size_t length, uint8_t *&output)
+{
+    const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    size_t i = 0;
+    uint8_t block[16];
+
+    while(length - i > 16)
+    {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+
+        // Bytes past 0x7F are negative and fail every range below
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(in, _mm_set1_epi8('Z' + 1)));
+        __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(in, _mm_set1_epi8('z' + 1)));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(in, _mm_set1_epi8('9' + 1)));
+        __m128i plus = _mm_cmpeq_epi8(in, _mm_set1_epi8('+'));
+        __m128i slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+
+        __m128i valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, plus)), slash);
+        if(_mm_movemask_epi8(valid) != 0xFFFF)
+            break;
+
+        __m128i offset = _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-'A')), _mm_and_si128(lower, _mm_set1_epi8(26 - 'a'))),
+            _mm_or_si128(_mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(52 - '0')), _mm_and_si128(plus, _mm_set1_epi8(62 - '+'))),
+                _mm_and_si128(slash, _mm_set1_epi8(63 - '/'))));
+        __m128i sextets = _mm_add_epi8(in, offset);
+
+        // Packs each 4 x 6 bits into 24 bits per 32 bit lane, then moves the
+        // three bytes of every lane to the front in big endian order
+        __m128i merged = _mm_maddubs_epi16(sextets, _mm_set1_epi32(0x01400140));
+        merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        merged = _mm_shuffle_epi8(merged, shuffle);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(block), merged);
+        memcpy(output, block, 12);
+        output += 12;
+        i += 16;
+    }
+    return i;
+}
+
+bool haveSimd()
+{
+#if defined(__SSSE3__)
+    return true;
+#else
+    static const bool ssse3 = __builtin_cpu_supports("ssse3");
+    return ssse3;
+#endif
+}
+#elif BASE64_NEON
+inline uint8x16_t rangeMask(uint8x16_t in, uint8_t low, uint8_t high)
+{
+    return vandq_u8(vcgeq_u8(in, vdupq_n_u8(low)), vcleq_u8(in, vdupq_n_u8(high)));
+}
+
+// Maps one register of characters to sextets, clearing bits of valid for
+// characters outside the alphabet
+inline uint8x16_t toSextets(uint8x16_t in, uint8x16_t &valid)
+{
+    uint8x16_t upper = rangeMask(in, 'A', 'Z');
+    uint8x16_t lower = rangeMask(in, 'a', 'z');
+    uint8x16_t digit = rangeMask(in, '0', '9');
+    uint8x16_t plus = vceqq_u8(in, vdupq_n_u8('+'));
+    uint8x16_t slash = vceqq_u8(in, vdupq_n_u8('/'));
+
+    valid = vandq_u8(valid, vorrq_u8(vorrq_u8(vorrq_u8(upper, lower), vorrq_u8(digit, plus)), slash));
+
+    uint8x16_t offset = vorrq_u8(
+        vorrq_u8(vandq_u8(upper, vdupq_n_u8((uint8_t)-'A')), vandq_u8(lower, vdupq_n_u8((uint8_t)(26 - 'a')))),
+        vorrq_u8(vorrq_u8(vandq_u8(digit, vdupq_n_u8((uint8_t)(52 - '0'))), vandq_u8(plus, vdupq_n_u8((uint8_t)(62 - '+')))),
+            vandq_u8(slash, vdupq_n_u8((uint8_t)(63 - '/')))));
+    return vaddq_u8(in, offset);
+}
+
+// Same contract as the SSSE3 version, in 64 character blocks. vld4/vst3
+// do the de- and re-interleaving of the 4 character / 3 byte groups.
+size_t decodeBlocks(const char *input, size_t length, uint8_t *&output)
+{
+    size_t i = 0;
+
+    while(length - i > 64)
+    {
+        uint8x16x4_t in = vld4q_u8(reinterpret_cast<const uint8_t*>(input + i));
+        uint8x16_t valid = vdupq_n_u8(0xFF);
+        uint8x16_t a = toSextets(in.val[0], valid);
+        uint8x16_t b = toSextets(in.val[1], valid);
+        uint8x16_t c = toSextets(in.val[2], valid);
+        uint8x16_t d = toSextets(in.val[3], valid);
+
+        uint8x8_t folded = vand_u8(vget_low_u8(valid), vget_high_u8(valid));
+        if(vget_lane_u64(vreinterpret_u64_u8(folded), 0) != ~(uint64_t)0)
+            break;
+
+        uint8x16x3_t out;
+        out.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+        out.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(c, 2));
+        out.val[2] = vorrq_u8(vshlq_n_u8(c, 6), d);
+        vst3q_u8(output, out);
+        output += 48;
+        i += 64;
+    }
+    return i;
+}
+
+bool haveSimd()
+{
+    return true;
+}
+#else
+size_t decodeBlocks(const char *, size_t, uint8_t *&)
+{
+    return 0;
+}
+
+bool haveSimd()
+{
+    return false;
+}
+#endif
+
+}
+
+size_t Base64Decoder::decodeScalar(const char *input, size_t length, uint8_t *output)
+{
+    const uint8_t *in = reinterpret_cast<const uint8_t*>(input);
+    uint8_t *out = output;
+    size_t i = 0;
+
+    for(; i + 4 < length; i += 4)
+    {
+        int8_t a = kTable.value[in[i]];
+        int8_t b = kTable.value[in[i + 1]];
+        int8_t c = kTable.value[in[i + 2]];
+        int8_t d = kTable.value[in[i + 3]];
+        if((a | b | c | d) < 0)
+            return 0;
+        *out++ = (uint8_t)((a << 2) | (b >> 4));
+        *out++ = (uint8_t)((b << 4) | (c >> 2));
+        *out++ = (uint8_t)((c << 6) | d);
+    }
+
+    // Last group, with optional "=" or "==" padding
+    int8_t a = kTable.value[in[i]];
+    int8_t b = kTable.value[in[i + 1]];
+    if((a | b) < 0)
+        return 0;
+    *out++ = (uint8_t)((a << 2) | (b >> 4));
+    if(in[i + 2] == '=')
+        return (in[i + 3] == '=') ? (size_t)(out - output) : 0;
+
+    int8_t c = kTable.value[in[i + 2]];
+    if(c < 0)
+        return 0;
+    *out++ = (uint8_t)((b << 4) | (c >> 2));
+    if(in[i + 3] == '=')
+        return out - output;
+
+    int8_t d = kTable.value[in[i + 3]];
+    if(d < 0)
+        return 0;
+    *out++ = (uint8_t)((c << 6) | d);
+    return out - output;
+}
+
+size_t Base64Decoder::decode(const char *input, size_t length, uint8_t *output)
+{
+    if(input == nullptr || output == nullptr || length < 4 || length % 4 != 0)
+        return 0;
+
+    uint8_t *out = output;
+    size_t consumed = haveSimd() ? decodeBlocks(input, length, out) : 0;
+
+    // Blocks are a multiple of 4 characters, so the rest is too
+    size_t decoded = decodeScalar(input + consumed, length - consumed, out);
+    if(decoded == 0)
+        return 0;
+    return (out - output) + decoded;
+}
+
+const uint8_t *Base64Decoder::decodePooled(const char *input, size_t length, size_t &decoded)
+{
+    static thread_local std::vector<uint8_t> pool;
+
+    // Do not keep a one-off large buffer for the lifetime of the thread
+    if(pool.capacity() > POOLED_BUFFER_KEEP_SIZE && decodedSize(length) <= POOLED_BUFFER_KEEP_SIZE)
+        std::vector<uint8_t>().swap(pool);
+    if(pool.size() < decodedSize(length))
+        pool.resize(decodedSize(length));
+
+    decoded = decode(input, length, pool.data());
+    return pool.data();
+}
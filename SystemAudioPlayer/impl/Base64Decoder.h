@@ -0,0 +1,51 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef BASE64DECODER_H_
+#define BASE64DECODER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Base64 decoder for PlayBuffer payloads.
+//
+// Takes the standard alphabet with '=' padding and a length that is a
+// multiple of 4, like the trower-base64 decoder it replaces. Whole 16/64
+// character blocks are decoded with SSSE3 (picked at runtime) or NEON, the
+// tail and any block holding an invalid character go through a scalar table.
+class Base64Decoder
+{
+    public:
+    // Upper bound of the decoded size of length characters
+    static size_t decodedSize(size_t length) { return length / 4 * 3; }
+
+    // Decodes into output, which holds at least decodedSize(length) bytes.
+    // Returns the decoded size, 0 for malformed input.
+    static size_t decode(const char *input, size_t length, uint8_t *output);
+
+    // Decodes into a per thread buffer that is reused across calls, so a
+    // PlayBuffer stream does no allocation once it reached its chunk size.
+    // The result stays valid until the next call on the same thread.
+    static const uint8_t *decodePooled(const char *input, size_t length, size_t &decoded);
+
+    private:
+    static size_t decodeScalar(const char *input, size_t length, uint8_t *output);
+};
+#endif
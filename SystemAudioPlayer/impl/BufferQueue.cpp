@@ -18,126 +18,216 @@
 **/
 
 #include "BufferQueue.h"
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 
-void Buffer::fillBuffer(const void *ptr,int len)
+size_t BufferQueue::roundCapacity(size_t capacity)
 {
-    this->length = len;
-    buff = new char[length];
-    std::memcpy(buff,ptr,length);
+    size_t rounded = 4096;
+    while(rounded < capacity)
+        rounded <<= 1;
+    return rounded;
 }
 
-int Buffer::getLength()
+BufferQueue::BufferQueue(size_t capacity)
+    : m_data(nullptr)
+    , m_capacity(roundCapacity(capacity))
+    , m_mask(m_capacity - 1)
+    , m_writePos(0)
+    , m_readPos(0)
+    , m_flushPos(0)
+    , m_flushPending(false)
+    , m_clears(0)
+    , m_consumerWaiting(false)
+    , m_producerWaiting(false)
+    , m_shutdown(false)
 {
-    return length;
+    m_data = new char[m_capacity];
+    SAPLOG_INFO("SAP: BufferQueue of %zu bytes\n", m_capacity);
 }
 
-char* Buffer::getBuffer()
+BufferQueue::~BufferQueue()
 {
-    return buff;
+    delete[] m_data;
 }
 
-void Buffer::deleteBuffer()
-{  
-    SAPLOG_TRACE("SAP: delete Buffer..."); 
-    if(buff != NULL)
+void BufferQueue::wakeUp()
+{
     {
-       delete[] buff;
-       buff = NULL;
+        // Pairs with the waiting side checking its predicate under the lock
+        std::lock_guard<std::mutex> lock(m_mutex);
     }
+    m_condition.notify_all();
 }
 
-BufferQueue::BufferQueue(int size)
+size_t BufferQueue::write(const char *data, size_t length)
 {
-    pthread_mutex_init(&m_mutex, NULL);
-    sem_init(&m_sem_full,0,0);
-    sem_init(&m_sem_empty,0,size);
+    size_t writePos = m_writePos.load(std::memory_order_relaxed);
+    size_t readPos = m_readPos.load(std::memory_order_acquire);
+    size_t len = std::min(length, m_capacity - (writePos - readPos));
+    if(len == 0)
+        return 0;
+
+    size_t offset = writePos & m_mask;
+    size_t first = std::min(len, m_capacity - offset);
+    std::memcpy(m_data + offset, data, first);
+    std::memcpy(m_data, data + first, len - first);
+
+    m_writePos.store(writePos + len);
+    if(m_consumerWaiting.load())
+        wakeUp();
+    return len;
 }
 
-BufferQueue::~BufferQueue()
+bool BufferQueue::tryAdd(const void *data, size_t length)
 {
-    pthread_mutex_destroy(&m_mutex);
-    sem_destroy(&m_sem_empty);
-    sem_destroy(&m_sem_full);
+    if(m_shutdown)
+        return false;
+
+    size_t used = m_writePos.load(std::memory_order_relaxed) - m_readPos.load(std::memory_order_acquire);
+    if(m_capacity - used < length)
+        return false;
+
+    write(static_cast<const char*>(data), length);
+    return true;
 }
-void BufferQueue::preDelete()
+
+size_t BufferQueue::add(const void *data, size_t length, uint32_t timeoutMs)
 {
-    clear();
-    sem_post(&m_sem_full);           
+    const char *src = static_cast<const char*>(data);
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    size_t queued = 0;
+    uint32_t clears = m_clears.load();
+
+    while(queued < length && !m_shutdown && m_clears.load() == clears)
+    {
+        size_t len = write(src + queued, length - queued);
+        queued += len;
+        if(len != 0)
+            continue;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_producerWaiting.store(true);
+        bool room = m_condition.wait_until(lock, deadline, [this, clears] {
+            return m_shutdown || m_clears.load() != clears
+                    || m_writePos.load(std::memory_order_relaxed) - m_readPos.load() < m_capacity;
+        });
+        m_producerWaiting.store(false);
+        if(!room)
+            break;
+    }
+    return queued;
+}
+
+size_t BufferQueue::applyFlush()
+{
+    size_t readPos = m_readPos.load(std::memory_order_relaxed);
+    if(m_flushPending.exchange(false, std::memory_order_acq_rel))
+    {
+        // A flush point the consumer has already read past is ignored
+        size_t flushPos = m_flushPos.load(std::memory_order_relaxed);
+        if(flushPos - readPos <= m_writePos.load(std::memory_order_acquire) - readPos)
+        {
+            readPos = flushPos;
+            m_readPos.store(readPos);
+            if(m_producerWaiting.load())
+                wakeUp();
+        }
+    }
+    return readPos;
 }
 
-void BufferQueue::add(Buffer *data)
+size_t BufferQueue::peek(const char *&data, size_t maxLength, bool block)
 {
-    sem_wait(&m_sem_empty);
-    pthread_mutex_lock(&m_mutex);
-    m_buffer.push(data);
-    sem_post(&m_sem_full);
-    pthread_mutex_unlock(&m_mutex);
+    size_t readPos = applyFlush();
+    size_t writePos = m_writePos.load(std::memory_order_acquire);
+
+    if(writePos == readPos && block)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_consumerWaiting.store(true);
+        m_condition.wait(lock, [&] {
+            readPos = applyFlush();
+            writePos = m_writePos.load();
+            return writePos != readPos || m_shutdown;
+        });
+        m_consumerWaiting.store(false);
+    }
+
+    if(writePos == readPos || m_shutdown)
+        return 0;
+
+    size_t offset = readPos & m_mask;
+    size_t len = std::min(std::min(writePos - readPos, m_capacity - offset), maxLength);
+    data = m_data + offset;
+    return len;
 }
 
-int BufferQueue::count()
+void BufferQueue::remove(size_t length)
 {
-    int count;
-    pthread_mutex_lock(&m_mutex);
-    //count = m_buffer.size();
-    sem_getvalue(&m_sem_full,&count); 
-    pthread_mutex_unlock(&m_mutex);
-    return count;
+    m_readPos.store(m_readPos.load(std::memory_order_relaxed) + length);
+    if(m_producerWaiting.load())
+        wakeUp();
 }
 
 void BufferQueue::clear()
 {
-    Buffer *item;
-    int value;
-    pthread_mutex_lock(&m_mutex);
-    while(!m_buffer.empty())
-    {
-        item = m_buffer.front();
-        m_buffer.pop();
-        item->deleteBuffer();
-	delete item;
-        sem_getvalue(&m_sem_full,&value);
-        if(value != 0)
-            sem_wait(&m_sem_full);
-        sem_post(&m_sem_empty);
-    }
-    pthread_mutex_unlock(&m_mutex);
+    // The consumer owns the read position, so it skips ahead on its next peek
+    m_flushPos.store(m_writePos.load(std::memory_order_acquire), std::memory_order_relaxed);
+    m_flushPending.store(true, std::memory_order_release);
+    m_clears++;
+    if(m_producerWaiting.load())
+        wakeUp();
 }
 
-bool BufferQueue::isFull()
+void BufferQueue::preDelete()
+{
+    clear();
+    m_shutdown = true;
+    wakeUp();
+}
+
+bool BufferQueue::resize(size_t capacity)
+{
+    capacity = roundCapacity(capacity);
+    if(capacity == m_capacity)
+        return true;
+    // Flushed bytes may still be read by the consumer, so wait for it to
+    // have actually caught up
+    if(m_readPos.load(std::memory_order_acquire) != m_writePos.load(std::memory_order_acquire))
+        return false;
+
+    // Positions are kept; any offset is valid for an empty ring
+    char *data = new char[capacity];
+    std::lock_guard<std::mutex> lock(m_mutex);
+    delete[] m_data;
+    m_data = data;
+    m_capacity = capacity;
+    m_mask = capacity - 1;
+    SAPLOG_INFO("SAP: BufferQueue resized to %zu bytes\n", m_capacity);
+    return true;
+}
+
+size_t BufferQueue::count()
 {
-    int value;
-    sem_getvalue(&m_sem_empty,&value);
-    if(value == 0)
+    size_t readPos = m_readPos.load(std::memory_order_acquire);
+    size_t writePos = m_writePos.load(std::memory_order_acquire);
+    if(m_flushPending.load(std::memory_order_acquire))
     {
-       return true;
+        size_t flushPos = m_flushPos.load(std::memory_order_relaxed);
+        if(flushPos - readPos <= writePos - readPos)
+            readPos = flushPos;
     }
-    return false;
+    return writePos - readPos;
 }
 
 bool BufferQueue::isEmpty()
 {
-    pthread_mutex_lock(&m_mutex);
-    if(m_buffer.empty())
-    {
-       pthread_mutex_unlock(&m_mutex);
-       return true;
-    }  
-    pthread_mutex_unlock(&m_mutex);
-    return false;
+    return count() == 0;
 }
 
-Buffer* BufferQueue::remove()
+bool BufferQueue::isFull()
 {
-    Buffer *item = NULL;
-    sem_wait(&m_sem_full);
-    pthread_mutex_lock(&m_mutex);
-    if(!m_buffer.empty())
-    {
-        item = m_buffer.front();
-        m_buffer.pop();
-        sem_post(&m_sem_empty);
-    }
-    pthread_mutex_unlock(&m_mutex);
-    return item;
+    return m_writePos.load(std::memory_order_acquire) - m_readPos.load(std::memory_order_acquire) >= m_capacity;
 }
@@ -20,45 +20,73 @@
 #ifndef BUFFERQUEUE_H_
 #define BUFFERQUEUE_H_
 
-#include <pthread.h>
-#include <semaphore.h>
-#include <stdlib.h>
-#include <cstring>
-#include <queue>
-#include <stdio.h>
-#include <unistd.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
 #include "logger.h"
 
-struct Buffer
-{
-    Buffer()
-    {
-    }
-    void fillBuffer(const void *ptr,int len);
-    int getLength();
-    char *getBuffer();   
-    void deleteBuffer();
-    char *buff;
-    int length;
-};
-
+// Single producer / single consumer byte ring between the data source
+// (PlayBuffer or the websocket callback) and the appsrc feeder thread.
+//
+// The arena is allocated once; the producer copies into it and the consumer
+// reads the bytes in place, so queueing does no heap allocation. Read and
+// write positions are free running counters published with atomics; the
+// mutex is only taken to put a side to sleep or to wake it up.
 class BufferQueue
 {
     public:
-    void add(Buffer* item);
-    Buffer* remove();
-    BufferQueue(int);
-    bool isEmpty();
-    bool isFull();
+    // capacity is rounded up to a power of two
+    explicit BufferQueue(size_t capacity);
+    ~BufferQueue();
+
+    // Producer: queues all of data or nothing, never blocks
+    bool tryAdd(const void *data, size_t length);
+    // Producer: waits up to timeoutMs for room, returns the bytes queued;
+    // gives up early on clear() as the rest would be flushed anyway
+    size_t add(const void *data, size_t length, uint32_t timeoutMs);
+
+    // Consumer: points data at up to maxLength contiguous queued bytes and
+    // returns their count. With block set waits for data or preDelete().
+    size_t peek(const char *&data, size_t maxLength, bool block);
+    // Consumer: releases length bytes returned by peek()
+    void remove(size_t length);
+
+    // Drops everything queued so far and wakes a waiting producer; may be
+    // called from any thread
     void clear();
+    // Clears and wakes up both sides for shutdown
     void preDelete();
-    int count();
-    ~BufferQueue();
+    // Reallocates the arena; only while empty with no producer running
+    bool resize(size_t capacity);
+
+    bool isEmpty();
+    bool isFull();
+    size_t count();
+    size_t capacity() const { return m_capacity; }
 
     private:
-    std::queue<Buffer*> m_buffer;
-    pthread_mutex_t m_mutex;
-    sem_t m_sem_full;
-    sem_t m_sem_empty;
+    BufferQueue(const BufferQueue&) = delete;
+    BufferQueue& operator=(const BufferQueue&) = delete;
+
+    static size_t roundCapacity(size_t capacity);
+    size_t write(const char *data, size_t length);
+    size_t applyFlush();
+    void wakeUp();
+
+    char *m_data;
+    size_t m_capacity;
+    size_t m_mask;
+    std::atomic<size_t> m_writePos;
+    std::atomic<size_t> m_readPos;
+    std::atomic<size_t> m_flushPos;
+    std::atomic<bool> m_flushPending;
+    std::atomic<uint32_t> m_clears;
+    std::atomic<bool> m_consumerWaiting;
+    std::atomic<bool> m_producerWaiting;
+    std::atomic<bool> m_shutdown;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
 };
 #endif
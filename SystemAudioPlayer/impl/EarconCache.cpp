@@ -0,0 +1,267 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "EarconCache.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+
+#define WAVE_FORMAT_PCM         0x0001
+#define WAVE_FORMAT_IEEE_FLOAT  0x0003
+#define WAVE_FORMAT_EXTENSIBLE  0xFFFE
+// Room for the RIFF header and metadata chunks on top of the samples
+#define WAV_HEADER_SLACK        (64 * 1024)
+
+namespace {
+
+uint16_t readLE16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+uint32_t readLE32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+const char* wavFormatName(uint16_t format, uint16_t bits)
+{
+    if(format == WAVE_FORMAT_PCM)
+    {
+        switch(bits)
+        {
+            case 8: return "U8";
+            case 16: return "S16LE";
+            case 24: return "S24LE";
+            case 32: return "S32LE";
+        }
+    }
+    else if(format == WAVE_FORMAT_IEEE_FLOAT)
+    {
+        switch(bits)
+        {
+            case 32: return "F32LE";
+            case 64: return "F64LE";
+        }
+    }
+    return nullptr;
+}
+
+}
+
+EarconCache::EarconCache(size_t budgetBytes, size_t maxClipBytes)
+    : m_budget(budgetBytes)
+    , m_maxClip(maxClipBytes ? maxClipBytes : budgetBytes)
+    , m_bytes(0)
+    , m_hits(0)
+    , m_misses(0)
+    , m_evictions(0)
+    , m_rejected(0)
+{
+}
+
+EarconCache& EarconCache::instance()
+{
+    static EarconCache cache;
+    return cache;
+}
+
+void EarconCache::configure(size_t budgetBytes, size_t maxClipBytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = budgetBytes;
+    m_maxClip = maxClipBytes ? std::min(maxClipBytes, budgetBytes) : budgetBytes;
+    evict();
+    SAPLOG_INFO("SAP: EarconCache budget %zu bytes, %zu per clip\n", m_budget, m_maxClip);
+}
+
+void EarconCache::setDecoder(const Decoder &decoder)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_decoder = decoder;
+}
+
+bool EarconCache::enabled()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_budget > 0;
+}
+
+std::shared_ptr<const Earcon> EarconCache::get(const std::string &path)
+{
+    struct stat st;
+    if(stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+        return nullptr;
+    int64_t mtimeNs = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+
+    Decoder decoder;
+    size_t maxClip;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_budget == 0)
+            return nullptr;
+        auto it = m_index.find(path);
+        if(it != m_index.end())
+        {
+            if(it->second->size == st.st_size && it->second->mtimeNs == mtimeNs)
+            {
+                m_lru.splice(m_lru.begin(), m_lru, it->second);
+                m_hits++;
+                return it->second->earcon;
+            }
+            // The file was replaced since it was cached
+            m_bytes -= it->second->earcon->data.size();
+            m_lru.erase(it->second);
+            m_index.erase(it);
+        }
+        m_misses++;
+        decoder = m_decoder;
+        maxClip = m_maxClip;
+    }
+
+    std::shared_ptr<Earcon> earcon = std::make_shared<Earcon>();
+    bool loaded = decodeWav(path, maxClip, *earcon);
+    if(!loaded && decoder)
+    {
+        *earcon = Earcon();
+        loaded = decoder(path, maxClip, *earcon);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(!loaded || earcon->data.empty() || earcon->data.size() > m_maxClip)
+    {
+        m_rejected++;
+        SAPLOG_WARNING("SAP: EarconCache cannot cache %s\n", path.c_str());
+        return nullptr;
+    }
+
+    // Another player may have loaded it meanwhile
+    auto it = m_index.find(path);
+    if(it != m_index.end())
+    {
+        m_bytes -= it->second->earcon->data.size();
+        m_lru.erase(it->second);
+        m_index.erase(it);
+    }
+    Entry entry = { path, st.st_size, mtimeNs, earcon };
+    m_lru.push_front(entry);
+    m_index[path] = m_lru.begin();
+    m_bytes += earcon->data.size();
+    evict();
+    SAPLOG_INFO("SAP: EarconCache loaded %s: %zu bytes %s %dHz %d channels\n", path.c_str(),
+            earcon->data.size(), earcon->format.c_str(), earcon->rate, earcon->channels);
+    return earcon;
+}
+
+void EarconCache::evict()
+{
+    // Players still holding an evicted clip keep it alive until they are done
+    while(m_bytes > m_budget && !m_lru.empty())
+    {
+        Entry &oldest = m_lru.back();
+        m_bytes -= oldest.earcon->data.size();
+        m_index.erase(oldest.path);
+        m_lru.pop_back();
+        m_evictions++;
+    }
+}
+
+void EarconCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lru.clear();
+    m_index.clear();
+    m_bytes = 0;
+}
+
+EarconCache::Stats EarconCache::stats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    stats.rejected = m_rejected;
+    stats.clips = m_lru.size();
+    stats.bytes = m_bytes;
+    return stats;
+}
+
+bool EarconCache::decodeWav(const std::string &path, size_t maxBytes, Earcon &earcon)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if(!file)
+        return false;
+    std::streamoff fileSize = file.tellg();
+    if(fileSize < 12 || (uint64_t)fileSize > (uint64_t)maxBytes + WAV_HEADER_SLACK)
+        return false;
+    std::vector<uint8_t> bytes((size_t)fileSize);
+    file.seekg(0);
+    if(!file.read(reinterpret_cast<char*>(bytes.data()), fileSize))
+        return false;
+
+    const uint8_t *p = bytes.data();
+    if(memcmp(p, "RIFF", 4) != 0 || memcmp(p + 8, "WAVE", 4) != 0)
+        return false;
+
+    const char *format = nullptr;
+    uint16_t channels = 0, blockAlign = 0;
+    uint32_t rate = 0;
+    size_t offset = 12;
+    while(offset + 8 <= bytes.size())
+    {
+        uint32_t chunkSize = readLE32(p + offset + 4);
+        size_t body = offset + 8;
+        size_t available = bytes.size() - body;
+
+        if(memcmp(p + offset, "fmt ", 4) == 0 && chunkSize >= 16 && chunkSize <= available)
+        {
+            uint16_t tag = readLE16(p + body);
+            channels = readLE16(p + body + 2);
+            rate = readLE32(p + body + 4);
+            blockAlign = readLE16(p + body + 12);
+            uint16_t bits = readLE16(p + body + 14);
+            // The sub format GUID starts with the real format tag
+            if(tag == WAVE_FORMAT_EXTENSIBLE && chunkSize >= 40)
+                tag = readLE16(p + body + 24);
+            format = wavFormatName(tag, bits);
+        }
+        else if(memcmp(p + offset, "data", 4) == 0)
+        {
+            if(format == nullptr || channels == 0 || rate == 0 || blockAlign == 0)
+                return false;
+            // Writers streaming a WAV may leave the size unset
+            size_t dataSize = std::min((size_t)chunkSize, available);
+            dataSize -= dataSize % blockAlign;
+            if(dataSize > maxBytes)
+                return false;
+            earcon.format = format;
+            earcon.rate = (int)rate;
+            earcon.channels = channels;
+            earcon.data.assign(p + body, p + body + dataSize);
+            return true;
+        }
+        // Chunks are padded to an even size
+        offset = body + (size_t)chunkSize + (chunkSize & 1);
+    }
+    return false;
+}
@@ -0,0 +1,110 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef EARCONCACHE_H_
+#define EARCONCACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <unordered_map>
+#include <vector>
+
+// A fully decoded clip, interleaved raw audio
+struct Earcon
+{
+    std::string format;     // GStreamer raw audio format, e.g. S16LE
+    int rate;
+    int channels;
+    std::vector<uint8_t> data;
+};
+
+// LRU cache of decoded UI sounds played by file players, so playing the
+// same clip again skips filesrc, parsing and decoding.
+//
+// WAV files are parsed here; other formats go through the decoder set by
+// AudioPlayer. A clip is reloaded when its file changes size or mtime.
+// Loading happens outside the lock, so a slow decode does not hold up
+// hits on other clips.
+class EarconCache
+{
+    public:
+    typedef std::function<bool(const std::string &path, size_t maxBytes, Earcon &earcon)> Decoder;
+
+    struct Stats
+    {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        uint64_t rejected;      // undecodable or over the per clip budget
+        size_t clips;
+        size_t bytes;
+    };
+
+    // budgetBytes 0 disables the cache
+    EarconCache(size_t budgetBytes = 0, size_t maxClipBytes = 0);
+
+    // Cache shared by all players
+    static EarconCache& instance();
+
+    void configure(size_t budgetBytes, size_t maxClipBytes);
+    void setDecoder(const Decoder &decoder);
+    bool enabled();
+
+    // Returns the clip, loading it on a miss; nullptr if it cannot be cached
+    std::shared_ptr<const Earcon> get(const std::string &path);
+    void clear();
+    Stats stats();
+
+    // Parses a PCM or IEEE float WAV file of at most maxBytes of samples
+    static bool decodeWav(const std::string &path, size_t maxBytes, Earcon &earcon);
+
+    private:
+    EarconCache(const EarconCache&) = delete;
+    EarconCache& operator=(const EarconCache&) = delete;
+
+    struct Entry
+    {
+        std::string path;
+        off_t size;
+        int64_t mtimeNs;
+        std::shared_ptr<const Earcon> earcon;
+    };
+
+    void evict();
+
+    std::mutex m_mutex;
+    // Most recently used first
+    std::list<Entry> m_lru;
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+    Decoder m_decoder;
+    size_t m_budget;
+    size_t m_maxClip;
+    size_t m_bytes;
+    uint64_t m_hits;
+    uint64_t m_misses;
+    uint64_t m_evictions;
+    uint64_t m_rejected;
+};
+#endif
@@ -0,0 +1,164 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "FeederPool.h"
+#include "logger.h"
+
+#include <algorithm>
+
+#define FEEDER_POOL_MAX_THREADS 8
+
+FeederPool::FeederPool(unsigned threads)
+    : m_threadCount(std::max(1u, std::min(threads, (unsigned)FEEDER_POOL_MAX_THREADS)))
+    , m_running(true)
+    , m_sessions(0)
+    , m_peakSessions(0)
+    , m_wakeups(0)
+    , m_feeds(0)
+    , m_start(std::chrono::steady_clock::now())
+{
+}
+
+FeederPool::~FeederPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_work.notify_all();
+    for(auto &thread : m_threads)
+        thread.join();
+}
+
+FeederPool& FeederPool::instance()
+{
+    static FeederPool pool;
+    return pool;
+}
+
+void FeederPool::setThreads(unsigned threads)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    threads = std::max(1u, std::min(threads, (unsigned)FEEDER_POOL_MAX_THREADS));
+    if(!m_threads.empty())
+    {
+        SAPLOG_WARNING("SAP: FeederPool already runs %u threads, ignoring %u\n", m_threadCount, threads);
+        return;
+    }
+    m_threadCount = threads;
+}
+
+void FeederPool::add(FeederSession *session)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Threads are started with the first session, after setThreads()
+    while(m_threads.size() < m_threadCount)
+        m_threads.emplace_back(&FeederPool::run, this);
+
+    session->m_attached = true;
+    m_sessions++;
+    m_peakSessions = std::max(m_peakSessions, m_sessions);
+}
+
+void FeederPool::remove(FeederSession *session)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if(!session->m_attached)
+        return;
+    session->m_attached = false;
+    if(session->m_queued)
+    {
+        m_ready.erase(std::find(m_ready.begin(), m_ready.end(), session));
+        session->m_queued = false;
+    }
+    m_idle.wait(lock, [session] { return !session->m_running; });
+    m_sessions--;
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    SAPLOG_INFO("SAP: FeederPool %u threads for %u sessions (peak %u, %d threads saved), %.1f wakeups/s, %.1f feeds/s\n",
+        m_threadCount, m_sessions, m_peakSessions, (int)m_peakSessions - (int)m_threadCount,
+        m_wakeups / seconds, m_feeds / seconds);
+}
+
+void FeederPool::notify(FeederSession *session)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(!session->m_attached)
+        return;
+    if(session->m_running)
+    {
+        // Fed again right after the current turn
+        session->m_pending = true;
+        return;
+    }
+    if(!session->m_queued)
+    {
+        session->m_queued = true;
+        m_ready.push_back(session);
+        m_work.notify_one();
+    }
+}
+
+FeederPool::Stats FeederPool::stats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.threads = m_threadCount;
+    stats.sessions = m_sessions;
+    stats.peakSessions = m_peakSessions;
+    stats.wakeups = m_wakeups;
+    stats.feeds = m_feeds;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    return stats;
+}
+
+void FeederPool::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(m_running)
+    {
+        if(m_ready.empty())
+        {
+            m_work.wait(lock);
+            m_wakeups++;
+            continue;
+        }
+
+        FeederSession *session = m_ready.front();
+        m_ready.pop_front();
+        session->m_queued = false;
+        session->m_pending = false;
+        session->m_running = true;
+
+        lock.unlock();
+        bool more = session->feed();
+        lock.lock();
+
+        m_feeds++;
+        session->m_running = false;
+        // Back of the queue, so every ready session gets a turn first
+        if(session->m_attached && (more || session->m_pending))
+        {
+            session->m_pending = false;
+            session->m_queued = true;
+            m_ready.push_back(session);
+        }
+        m_idle.notify_all();
+    }
+}
@@ -0,0 +1,104 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef FEEDERPOOL_H_
+#define FEEDERPOOL_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A player whose queued data is pushed to appsrc by the FeederPool
+class FeederSession
+{
+    public:
+    FeederSession() : m_attached(false), m_queued(false), m_running(false), m_pending(false) {}
+    virtual ~FeederSession() {}
+
+    // Pushes at most one chunk without blocking. Returns true while more
+    // data is ready; otherwise the session sleeps until notify().
+    virtual bool feed() = 0;
+
+    private:
+    friend class FeederPool;
+    // Guarded by the pool mutex
+    bool m_attached;
+    bool m_queued;
+    bool m_running;
+    bool m_pending;
+};
+
+// Small thread pool feeding all PlayBuffer sessions.
+//
+// Sessions are scheduled by notify() when data arrives or appsrc asks for
+// more, and get one chunk per turn in round robin order, so a busy stream
+// cannot starve the others. A session is fed by one thread at a time.
+class FeederPool
+{
+    public:
+    struct Stats
+    {
+        unsigned threads;
+        unsigned sessions;
+        unsigned peakSessions;
+        uint64_t wakeups;       // worker threads woken up from idle
+        uint64_t feeds;         // feed() calls
+        double seconds;         // since the pool started
+    };
+
+    explicit FeederPool(unsigned threads = 1);
+    ~FeederPool();
+
+    // Pool shared by all players
+    static FeederPool& instance();
+
+    // Only takes effect before the first session is added
+    void setThreads(unsigned threads);
+
+    void add(FeederSession *session);
+    // Returns once no thread is feeding the session any more
+    void remove(FeederSession *session);
+    void notify(FeederSession *session);
+
+    Stats stats();
+
+    private:
+    FeederPool(const FeederPool&) = delete;
+    FeederPool& operator=(const FeederPool&) = delete;
+
+    void run();
+
+    std::mutex m_mutex;
+    std::condition_variable m_work;
+    std::condition_variable m_idle;
+    std::deque<FeederSession*> m_ready;
+    std::vector<std::thread> m_threads;
+    unsigned m_threadCount;
+    bool m_running;
+    unsigned m_sessions;
+    unsigned m_peakSessions;
+    uint64_t m_wakeups;
+    uint64_t m_feeds;
+    std::chrono::steady_clock::time_point m_start;
+};
+#endif
@@ -50,6 +50,8 @@ public:
     virtual ~IWebSocketClient() = default;
     virtual void connect(const std::string& uri) = 0;
     virtual void disconnect() = 0;
+    virtual void pauseReading() = 0;
+    virtual void resumeReading() = 0;
     virtual ConnectionType getConnectionType() const = 0;
 };
 
@@ -0,0 +1,225 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "JitterBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Target depth in multiples of the jitter estimate
+#define JITTER_TARGET_FACTOR    4
+// Depth added after an underrun, at least
+#define JITTER_UNDERRUN_STEP_MS 10
+// Share of the audio played on time that the depth added after underruns
+// shrinks by
+#define JITTER_EXTRA_DECAY      0.01
+
+namespace {
+
+double msBetween(JitterBuffer::Clock::time_point from, JitterBuffer::Clock::time_point to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+}
+
+JitterBuffer::JitterBuffer(int targetMs, int maxMs)
+    : m_baseMs(std::max(0, targetMs))
+    , m_maxMs(std::max(m_baseMs, maxMs))
+    , m_bytesPerSecond(0)
+    , m_heldBytes(0)
+    , m_receivedBytes(0)
+    , m_releasedBytes(0)
+    , m_playing(false)
+    , m_draining(false)
+    , m_startBytes(0)
+    , m_haveTransit(false)
+    , m_lastTransitMs(0.0)
+    , m_jitterMs(0.0)
+    , m_extraMs(0.0)
+    , m_framesCount(0)
+    , m_lateFrames(0)
+    , m_underruns(0)
+    , m_rebuffers(0)
+    , m_maxDepthMs(0)
+{
+}
+
+void JitterBuffer::setRate(size_t bytesPerSecond)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bytesPerSecond = bytesPerSecond;
+}
+
+double JitterBuffer::toMs(uint64_t bytes) const
+{
+    return m_bytesPerSecond ? bytes * 1000.0 / m_bytesPerSecond : 0.0;
+}
+
+int JitterBuffer::target() const
+{
+    double jitter = std::max((double)m_baseMs, JITTER_TARGET_FACTOR * m_jitterMs);
+    return (int)std::min((double)m_maxMs, std::ceil(jitter + m_extraMs));
+}
+
+double JitterBuffer::playedMs(Clock::time_point now) const
+{
+    return msBetween(m_start, now);
+}
+
+int JitterBuffer::depthMs(Clock::time_point now) const
+{
+    double depth = toMs(m_heldBytes);
+    if(m_playing)
+        depth += std::max(0.0, toMs(m_releasedBytes - m_startBytes) - playedMs(now));
+    return (int)std::lround(depth);
+}
+
+void JitterBuffer::push(std::string &&frame, Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(frame.empty())
+        return;
+    const size_t size = frame.size();
+    m_framesCount++;
+
+    if(m_bytesPerSecond)
+    {
+        // Transit time up to a constant; only frames later than their
+        // predecessor's audio count, a sender running ahead is no jitter
+        if(!m_haveTransit)
+        {
+            m_haveTransit = true;
+            m_epoch = now;
+            m_lastTransitMs = -toMs(m_receivedBytes);
+        }
+        else
+        {
+            double transit = msBetween(m_epoch, now) - toMs(m_receivedBytes);
+            m_jitterMs += (std::max(0.0, transit - m_lastTransitMs) - m_jitterMs) / 16.0;
+            m_lastTransitMs = transit;
+        }
+
+        if(m_playing)
+        {
+            if(playedMs(now) > toMs(m_receivedBytes - m_startBytes))
+            {
+                // Playout waited for this frame and goes on from here
+                m_lateFrames++;
+                m_start = now;
+                m_startBytes = m_receivedBytes;
+            }
+            else
+            {
+                m_extraMs = std::max(0.0, m_extraMs - toMs(size) * JITTER_EXTRA_DECAY);
+            }
+        }
+        if(!m_playing && m_frames.empty())
+            m_firstHeld = now;
+    }
+
+    m_frames.push_back(std::move(frame));
+    m_heldBytes += size;
+    m_receivedBytes += size;
+    m_maxDepthMs = std::max(m_maxDepthMs, depthMs(now));
+}
+
+bool JitterBuffer::pop(std::string &frame, Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_frames.empty())
+        return false;
+    if(m_bytesPerSecond && !m_playing)
+    {
+        int depth = target();
+        if(!m_draining && toMs(m_heldBytes) < depth && msBetween(m_firstHeld, now) < depth)
+            return false;
+        m_playing = true;
+        m_start = now;
+        m_startBytes = m_releasedBytes;
+    }
+    frame = std::move(m_frames.front());
+    m_frames.pop_front();
+    m_heldBytes -= frame.size();
+    m_releasedBytes += frame.size();
+    return true;
+}
+
+int JitterBuffer::releaseDelayMs(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_frames.empty() || m_playing || m_bytesPerSecond == 0)
+        return -1;
+    int depth = target();
+    if(m_draining || toMs(m_heldBytes) >= depth)
+        return 0;
+    return std::max(0, (int)std::ceil(depth - msBetween(m_firstHeld, now)));
+}
+
+void JitterBuffer::rebuffer(Clock::time_point now)
+{
+    m_playing = false;
+    m_rebuffers++;
+    if(!m_frames.empty())
+        m_firstHeld = now;
+}
+
+void JitterBuffer::underrun(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(!m_playing || m_draining || m_bytesPerSecond == 0)
+        return;
+    m_underruns++;
+    m_extraMs = std::min((double)m_maxMs, m_extraMs + std::max(JITTER_UNDERRUN_STEP_MS, m_baseMs / 2));
+    rebuffer(now);
+}
+
+void JitterBuffer::drain()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_draining = true;
+}
+
+void JitterBuffer::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_frames.clear();
+    m_heldBytes = 0;
+    m_receivedBytes = 0;
+    m_releasedBytes = 0;
+    m_startBytes = 0;
+    m_playing = false;
+    m_draining = false;
+    m_haveTransit = false;
+}
+
+JitterBuffer::Stats JitterBuffer::stats(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.frames = m_framesCount;
+    stats.lateFrames = m_lateFrames;
+    stats.underruns = m_underruns;
+    stats.rebuffers = m_rebuffers;
+    stats.depthMs = depthMs(now);
+    stats.maxDepthMs = m_maxDepthMs;
+    stats.targetMs = target();
+    stats.jitterMs = m_jitterMs;
+    return stats;
+}
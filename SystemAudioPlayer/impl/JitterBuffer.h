@@ -0,0 +1,117 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef JITTERBUFFER_H_
+#define JITTERBUFFER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+// Prebuffering of the PCM frames a websocket session receives.
+//
+// Frames are held until the target depth of audio has arrived, or the
+// first of them waited that long, and then pass straight through while
+// the playout keeps up; appsrc holds the depth from there on. The target
+// grows with the jitter of the arrivals, estimated as in RFC 3550 from
+// frames coming later than their audio duration, and after every
+// underrun, which also starts the prebuffering over.
+//
+// Playout is assumed to run at the PCM rate from the moment frames are
+// released; a frame arriving after its audio was due to play is late.
+class JitterBuffer
+{
+    public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Stats
+    {
+        uint64_t frames;
+        uint64_t lateFrames;    // arrived after their audio was due
+        uint64_t underruns;     // the playout ran dry
+        uint64_t rebuffers;     // prebuffering started over
+        int depthMs;            // held plus released and not yet played
+        int maxDepthMs;
+        int targetMs;
+        double jitterMs;
+    };
+
+    // targetMs is the depth prebuffered at first, maxMs bounds its growth
+    JitterBuffer(int targetMs, int maxMs);
+
+    // Bytes of audio per second; 0 passes frames straight through
+    void setRate(size_t bytesPerSecond);
+
+    void push(std::string &&frame, Clock::time_point now);
+    // The next frame to play, false while prebuffering
+    bool pop(std::string &frame, Clock::time_point now);
+    // Time after which held frames are released anyway, -1 if none are held
+    int releaseDelayMs(Clock::time_point now);
+
+    // Reported by the player; prebuffering starts over
+    void underrun(Clock::time_point now);
+    // Releases what is held, e.g. at the end of the stream
+    void drain();
+    // Drops everything for a new stream; the learnt target is kept
+    void clear();
+
+    Stats stats(Clock::time_point now);
+
+    private:
+    JitterBuffer(const JitterBuffer&) = delete;
+    JitterBuffer& operator=(const JitterBuffer&) = delete;
+
+    double toMs(uint64_t bytes) const;
+    int target() const;
+    double playedMs(Clock::time_point now) const;
+    int depthMs(Clock::time_point now) const;
+    void rebuffer(Clock::time_point now);
+
+    std::mutex m_mutex;
+    int m_baseMs;
+    int m_maxMs;
+    size_t m_bytesPerSecond;
+    std::deque<std::string> m_frames;
+    uint64_t m_heldBytes;
+    // Stream positions in bytes
+    uint64_t m_receivedBytes;
+    uint64_t m_releasedBytes;
+    // Playout runs from m_startBytes at m_start
+    bool m_playing;
+    bool m_draining;
+    Clock::time_point m_start;
+    uint64_t m_startBytes;
+    Clock::time_point m_firstHeld;
+    // Jitter estimate
+    bool m_haveTransit;
+    Clock::time_point m_epoch;
+    double m_lastTransitMs;
+    double m_jitterMs;
+    double m_extraMs;
+
+    uint64_t m_framesCount;
+    uint64_t m_lateFrames;
+    uint64_t m_underruns;
+    uint64_t m_rebuffers;
+    int m_maxDepthMs;
+};
+#endif
@@ -0,0 +1,352 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "LoudnessDetector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <tmmintrin.h>
+#define LOUDNESS_SSSE3 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define LOUDNESS_NEON 1
+#endif
+
+// Audio measured per decision
+#define LOUDNESS_WINDOW_MS  5
+#define LOUDNESS_S16_SCALE  (1.0f / 32768.0f)
+
+namespace {
+
+// Both add the squares of the samples, scaled to -1..1, to sumSquares and
+// raise peak to their largest magnitude
+void measureS16Scalar(const int16_t *samples, size_t count, float &sumSquares, float &peak)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        float value = samples[i] * LOUDNESS_S16_SCALE;
+        sumSquares += value * value;
+        peak = std::max(peak, std::fabs(value));
+    }
+}
+
+void measureF32Scalar(const float *samples, size_t count, float &sumSquares, float &peak)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        sumSquares += samples[i] * samples[i];
+        peak = std::max(peak, std::fabs(samples[i]));
+    }
+}
+
+#if LOUDNESS_SSSE3
+// The kernels below do whole registers and return the samples done
+__attribute__((target("ssse3")))
+inline void reduce(__m128 sum, __m128 max, float &sumSquares, float &peak)
+{
+    float sums[4], maxes[4];
+    _mm_storeu_ps(sums, sum);
+    _mm_storeu_ps(maxes, max);
+    sumSquares += (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    peak = std::max(peak, std::max(std::max(maxes[0], maxes[1]), std::max(maxes[2], maxes[3])));
+}
+
+__attribute__((target("ssse3")))
+size_t measureS16Simd(const int16_t *samples, size_t count, float &sumSquares, float &peak)
+{
+    const __m128 scale = _mm_set1_ps(LOUDNESS_S16_SCALE);
+    const __m128 magnitude = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 sum = _mm_setzero_ps();
+    __m128 max = _mm_setzero_ps();
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8)
+    {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        // Sign extends by moving each sample to the top half first
+        __m128 low = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16)), scale);
+        __m128 high = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16)), scale);
+        sum = _mm_add_ps(sum, _mm_add_ps(_mm_mul_ps(low, low), _mm_mul_ps(high, high)));
+        max = _mm_max_ps(max, _mm_max_ps(_mm_and_ps(low, magnitude), _mm_and_ps(high, magnitude)));
+    }
+    reduce(sum, max, sumSquares, peak);
+    return i;
+}
+
+__attribute__((target("ssse3")))
+size_t measureF32Simd(const float *samples, size_t count, float &sumSquares, float &peak)
+{
+    const __m128 magnitude = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 sum = _mm_setzero_ps();
+    __m128 max = _mm_setzero_ps();
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 s = _mm_loadu_ps(samples + i);
+        sum = _mm_add_ps(sum, _mm_mul_ps(s, s));
+        max = _mm_max_ps(max, _mm_and_ps(s, magnitude));
+    }
+    reduce(sum, max, sumSquares, peak);
+    return i;
+}
+
+bool haveSimd()
+{
+#if defined(__SSSE3__)
+    return true;
+#else
+    static const bool ssse3 = __builtin_cpu_supports("ssse3");
+    return ssse3;
+#endif
+}
+#elif LOUDNESS_NEON
+inline void reduce(float32x4_t sum, float32x4_t max, float &sumSquares, float &peak)
+{
+    sumSquares += (vgetq_lane_f32(sum, 0) + vgetq_lane_f32(sum, 1)) + (vgetq_lane_f32(sum, 2) + vgetq_lane_f32(sum, 3));
+    peak = std::max(peak, std::max(std::max(vgetq_lane_f32(max, 0), vgetq_lane_f32(max, 1)),
+            std::max(vgetq_lane_f32(max, 2), vgetq_lane_f32(max, 3))));
+}
+
+size_t measureS16Simd(const int16_t *samples, size_t count, float &sumSquares, float &peak)
+{
+    float32x4_t sum = vdupq_n_f32(0.0f);
+    float32x4_t max = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8)
+    {
+        int16x8_t s = vld1q_s16(samples + i);
+        float32x4_t low = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))), LOUDNESS_S16_SCALE);
+        float32x4_t high = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))), LOUDNESS_S16_SCALE);
+        sum = vmlaq_f32(vmlaq_f32(sum, low, low), high, high);
+        max = vmaxq_f32(max, vmaxq_f32(vabsq_f32(low), vabsq_f32(high)));
+    }
+    reduce(sum, max, sumSquares, peak);
+    return i;
+}
+
+size_t measureF32Simd(const float *samples, size_t count, float &sumSquares, float &peak)
+{
+    float32x4_t sum = vdupq_n_f32(0.0f);
+    float32x4_t max = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    {
+        float32x4_t s = vld1q_f32(samples + i);
+        sum = vmlaq_f32(sum, s, s);
+        max = vmaxq_f32(max, vabsq_f32(s));
+    }
+    reduce(sum, max, sumSquares, peak);
+    return i;
+}
+
+bool haveSimd()
+{
+    return true;
+}
+#endif
+
+void measureS16(const int16_t *samples, size_t count, float &sumSquares, float &peak)
+{
+    size_t done = 0;
+#if LOUDNESS_SSSE3 || LOUDNESS_NEON
+    if(haveSimd())
+        done = measureS16Simd(samples, count, sumSquares, peak);
+#endif
+    measureS16Scalar(samples + done, count - done, sumSquares, peak);
+}
+
+void measureF32(const float *samples, size_t count, float &sumSquares, float &peak)
+{
+    size_t done = 0;
+#if LOUDNESS_SSSE3 || LOUDNESS_NEON
+    if(haveSimd())
+        done = measureF32Simd(samples, count, sumSquares, peak);
+#endif
+    measureF32Scalar(samples + done, count - done, sumSquares, peak);
+}
+
+}
+
+LoudnessDetector::LoudnessDetector()
+    : m_enabled(false)
+    , m_above(false)
+    , m_threshold(0.0f)
+    , m_attackMs(0)
+    , m_holdMs(0)
+    , m_format(FORMAT_NONE)
+    , m_rate(0)
+    , m_channels(0)
+    , m_windowSamples(0)
+    , m_windowFill(0)
+    , m_sumSquares(0.0f)
+    , m_peak(0.0f)
+    , m_aboveMs(0.0)
+    , m_belowMs(0.0)
+    , m_buffers(0)
+    , m_frames(0)
+    , m_audioNs(0)
+    , m_transitions(0)
+    , m_processNs(0)
+    , m_lastRms(0.0f)
+    , m_lastPeak(0.0f)
+{
+}
+
+LoudnessDetector::Format LoudnessDetector::parseFormat(const std::string &name)
+{
+    if(name == "S16LE")
+        return FORMAT_S16;
+    if(name == "F32LE")
+        return FORMAT_F32;
+    return FORMAT_NONE;
+}
+
+void LoudnessDetector::configure(double threshold, int attackMs, int holdMs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_threshold = (float)std::max(0.0, std::min(1.0, threshold));
+    m_attackMs = std::max(0, attackMs);
+    m_holdMs = std::max(0, holdMs);
+}
+
+void LoudnessDetector::setEnabled(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_enabled != enabled)
+        restart();
+    m_enabled = enabled;
+}
+
+void LoudnessDetector::setFormat(Format format, int rate, int channels)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(rate <= 0 || channels <= 0)
+        format = FORMAT_NONE;
+    m_format = format;
+    m_rate = rate;
+    m_channels = channels;
+    m_windowSamples = (format == FORMAT_NONE) ? 0 : std::max(1, rate * LOUDNESS_WINDOW_MS / 1000) * (size_t)channels;
+    restart();
+}
+
+void LoudnessDetector::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    restart();
+}
+
+void LoudnessDetector::restart()
+{
+    m_windowFill = 0;
+    m_sumSquares = 0.0f;
+    m_peak = 0.0f;
+    m_aboveMs = 0.0;
+    m_belowMs = 0.0;
+    m_above = false;
+}
+
+void LoudnessDetector::endWindow()
+{
+    const double windowMs = 1000.0 * (m_windowSamples / m_channels) / m_rate;
+    m_lastRms = std::sqrt(m_sumSquares / m_windowSamples);
+    m_lastPeak = m_peak;
+    if(m_lastRms >= m_threshold)
+    {
+        m_aboveMs += windowMs;
+        m_belowMs = 0.0;
+        if(!m_above && m_aboveMs >= m_attackMs)
+        {
+            m_above = true;
+            m_transitions++;
+        }
+    }
+    else
+    {
+        m_belowMs += windowMs;
+        m_aboveMs = 0.0;
+        if(m_above && m_belowMs >= m_holdMs)
+        {
+            m_above = false;
+            m_transitions++;
+        }
+    }
+    m_windowFill = 0;
+    m_sumSquares = 0.0f;
+    m_peak = 0.0f;
+}
+
+LoudnessDetector::Event LoudnessDetector::process(const void *data, size_t bytes)
+{
+    if(!m_enabled)
+        return EVENT_NONE;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(!m_enabled || m_format == FORMAT_NONE || data == nullptr)
+        return EVENT_NONE;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    const bool wasAbove = m_above;
+    const size_t sampleSize = (m_format == FORMAT_S16) ? sizeof(int16_t) : sizeof(float);
+    const size_t count = bytes / sampleSize;
+    size_t done = 0;
+    while(done < count)
+    {
+        size_t step = std::min(count - done, m_windowSamples - m_windowFill);
+        if(m_format == FORMAT_S16)
+            measureS16(static_cast<const int16_t*>(data) + done, step, m_sumSquares, m_peak);
+        else
+            measureF32(static_cast<const float*>(data) + done, step, m_sumSquares, m_peak);
+        done += step;
+        m_windowFill += step;
+        if(m_windowFill == m_windowSamples)
+            endWindow();
+    }
+
+    uint64_t frames = count / m_channels;
+    m_buffers++;
+    m_frames += frames;
+    m_audioNs += frames * 1000000000ULL / m_rate;
+    m_processNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    if(m_above == wasAbove)
+        return EVENT_NONE;
+    return m_above ? EVENT_ABOVE : EVENT_BELOW;
+}
+
+LoudnessDetector::Stats LoudnessDetector::stats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.buffers = m_buffers;
+    stats.frames = m_frames;
+    stats.transitions = m_transitions;
+    stats.audioNs = m_audioNs;
+    stats.processNs = m_processNs;
+    stats.rms = m_lastRms;
+    stats.peak = m_lastPeak;
+    return stats;
+}
+
+double LoudnessDetector::cpuPercent()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_audioNs == 0)
+        return 0.0;
+    return 100.0 * m_processNs / m_audioNs;
+}
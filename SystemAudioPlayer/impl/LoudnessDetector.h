@@ -0,0 +1,121 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef LOUDNESSDETECTOR_H_
+#define LOUDNESSDETECTOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Speech detector for smart volume control, replacing the platform
+// cutter element so it can be switched and tuned while playing.
+//
+// The audio is measured in 5ms windows, RMS and peak, with SSSE3 (picked
+// at runtime) or NEON. A window at or above the threshold counts towards
+// the attack time, one below it towards the hold time; the level goes
+// "above" once the attack time is reached and back "below" once the hold
+// time is. Decisions are made at the end of each window.
+class LoudnessDetector
+{
+    public:
+    enum Format
+    {
+        FORMAT_NONE,
+        FORMAT_S16,
+        FORMAT_F32
+    };
+
+    enum Event
+    {
+        EVENT_NONE,
+        EVENT_ABOVE,
+        EVENT_BELOW
+    };
+
+    struct Stats
+    {
+        uint64_t buffers;
+        uint64_t frames;
+        uint64_t transitions;
+        uint64_t audioNs;       // duration of the frames
+        uint64_t processNs;     // time spent in process()
+        float rms;              // of the last window, 0 to 1
+        float peak;
+    };
+
+    LoudnessDetector();
+
+    // Maps a PCM caps format, FORMAT_NONE if it is not measured
+    static Format parseFormat(const std::string &name);
+
+    // Takes effect with the next window; may be called while playing.
+    // threshold is a linear level from 0 to 1.
+    void configure(double threshold, int attackMs, int holdMs);
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+    // Starts over below the threshold
+    void setFormat(Format format, int rate, int channels);
+    bool isAbove() const { return m_above; }
+    // Drops the partial window and goes back below the threshold, e.g.
+    // when the audio stops
+    void reset();
+
+    // Measures interleaved audio in the format set. Returns the change of
+    // level over the call, if any.
+    Event process(const void *data, size_t bytes);
+
+    Stats stats();
+    // Share of one core process() used for the audio it was given
+    double cpuPercent();
+
+    private:
+    LoudnessDetector(const LoudnessDetector&) = delete;
+    LoudnessDetector& operator=(const LoudnessDetector&) = delete;
+
+    void restart();
+    void endWindow();
+
+    std::atomic<bool> m_enabled;
+    std::atomic<bool> m_above;
+    // Guards everything below
+    std::mutex m_mutex;
+    float m_threshold;
+    int m_attackMs;
+    int m_holdMs;
+    Format m_format;
+    int m_rate;
+    int m_channels;
+    size_t m_windowSamples;
+    size_t m_windowFill;
+    float m_sumSquares;
+    float m_peak;
+    double m_aboveMs;
+    double m_belowMs;
+    uint64_t m_buffers;
+    uint64_t m_frames;
+    uint64_t m_audioNs;
+    uint64_t m_transitions;
+    uint64_t m_processNs;
+    float m_lastRms;
+    float m_lastPeak;
+};
+#endif
@@ -0,0 +1,107 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "MainLoopTimer.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct MainLoopTimer::State
+{
+    explicit State(const Callback &callback) : callback(callback), source(nullptr), running(false) {}
+
+    const Callback callback;
+    std::mutex mutex;
+    std::condition_variable idle;
+    // The pending source, owned by the timer
+    GSource *source;
+    bool running;
+    std::thread::id runner;
+};
+
+MainLoopTimer::MainLoopTimer(const Callback &callback) : m_state(std::make_shared<State>(callback))
+{
+}
+
+MainLoopTimer::~MainLoopTimer()
+{
+    stop();
+}
+
+void MainLoopTimer::start(GMainContext *context, int delayMs)
+{
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    if(m_state->source)
+    {
+        g_source_destroy(m_state->source);
+        g_source_unref(m_state->source);
+    }
+    m_state->source = g_timeout_source_new(std::max(delayMs, 0));
+    g_source_set_callback(m_state->source, MainLoopTimer::dispatch, new std::shared_ptr<State>(m_state), MainLoopTimer::release);
+    g_source_attach(m_state->source, context);
+}
+
+bool MainLoopTimer::pending()
+{
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->source != nullptr;
+}
+
+void MainLoopTimer::stop()
+{
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    if(m_state->source)
+    {
+        g_source_destroy(m_state->source);
+        g_source_unref(m_state->source);
+        m_state->source = nullptr;
+    }
+    if(m_state->runner != std::this_thread::get_id())
+        m_state->idle.wait(lock, [this] { return !m_state->running; });
+}
+
+gboolean MainLoopTimer::dispatch(gpointer data)
+{
+    std::shared_ptr<State> state = *static_cast<std::shared_ptr<State>*>(data);
+    std::unique_lock<std::mutex> lock(state->mutex);
+    // Stopped, or started again, since it fired
+    if(state->source == nullptr || state->source != g_main_current_source())
+        return G_SOURCE_REMOVE;
+    g_source_unref(state->source);
+    state->source = nullptr;
+    state->running = true;
+    state->runner = std::this_thread::get_id();
+    lock.unlock();
+
+    // May start or stop the timer again
+    state->callback();
+
+    lock.lock();
+    state->running = false;
+    state->runner = std::thread::id();
+    state->idle.notify_all();
+    return G_SOURCE_REMOVE;
+}
+
+void MainLoopTimer::release(gpointer data)
+{
+    delete static_cast<std::shared_ptr<State>*>(data);
+}
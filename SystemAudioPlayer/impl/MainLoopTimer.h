@@ -0,0 +1,64 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef MAINLOOPTIMER_H_
+#define MAINLOOPTIMER_H_
+
+#include <glib.h>
+
+#include <functional>
+#include <memory>
+
+// A one-shot timeout on a GMainContext that its owner can stop from any
+// thread and then be destroyed.
+//
+// The source does not point at the owner, only at a refcounted state that
+// outlives both, so a dispatch racing with stop() finds the timer stopped
+// instead of a freed owner. stop() also waits for a callback already
+// running on the main loop, so none runs once it returned; the callback
+// must therefore not wait for a lock held around stop().
+class MainLoopTimer
+{
+    public:
+    typedef std::function<void()> Callback;
+
+    explicit MainLoopTimer(const Callback &callback);
+    // Stops the timer
+    ~MainLoopTimer();
+
+    // Fires once after delayMs, in place of a timeout still pending
+    void start(GMainContext *context, int delayMs);
+    // Started and not fired yet
+    bool pending();
+    // No callback runs after this returns, except the one calling it
+    void stop();
+
+    private:
+    MainLoopTimer(const MainLoopTimer&) = delete;
+    MainLoopTimer& operator=(const MainLoopTimer&) = delete;
+
+    // Shared with the sources
+    struct State;
+
+    static gboolean dispatch(gpointer data);
+    static void release(gpointer data);
+
+    std::shared_ptr<State> m_state;
+};
+#endif
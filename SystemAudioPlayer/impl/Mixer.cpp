@@ -0,0 +1,486 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "Mixer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <tmmintrin.h>
+#define MIXER_SSSE3 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MIXER_NEON 1
+#endif
+
+// Input frames converted per step, bounding the scratch buffers
+#define MIXER_CHUNK_FRAMES  256
+#define MIXER_MAX_CHANNELS  8
+// Q15 gain of 1.0
+#define MIXER_UNITY_GAIN    32768
+
+namespace {
+
+inline int16_t saturate16(int32_t value)
+{
+    return (int16_t)std::max(-32768, std::min(32767, value));
+}
+
+// dst += src * gain / 32768, saturated
+void mixS16Scalar(int16_t *dst, const int16_t *src, size_t samples, int gain)
+{
+    for(size_t i = 0; i < samples; i++)
+        dst[i] = saturate16(dst[i] + ((src[i] * gain + 0x4000) >> 15));
+}
+
+void mixF32Scalar(float *dst, const float *src, size_t samples, float gain)
+{
+    for(size_t i = 0; i < samples; i++)
+        dst[i] += src[i] * gain;
+}
+
+void clampF32Scalar(float *samples, size_t count)
+{
+    for(size_t i = 0; i < count; i++)
+        samples[i] = std::max(-1.0f, std::min(1.0f, samples[i]));
+}
+
+#if MIXER_SSSE3
+// The kernels below do whole registers and return the samples done
+__attribute__((target("ssse3")))
+size_t mixS16Simd(int16_t *dst, const int16_t *src, size_t samples, int gain)
+{
+    size_t i = 0;
+    if(gain >= MIXER_UNITY_GAIN)
+    {
+        for(; i + 8 <= samples; i += 8)
+        {
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_adds_epi16(d, s));
+        }
+        return i;
+    }
+    // mulhrs rounds like the scalar loop: (s * g + 0x4000) >> 15
+    const __m128i g = _mm_set1_epi16((int16_t)gain);
+    for(; i + 8 <= samples; i += 8)
+    {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_adds_epi16(d, _mm_mulhrs_epi16(s, g)));
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+size_t mixF32Simd(float *dst, const float *src, size_t samples, float gain)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+    for(; i + 4 <= samples; i += 4)
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+    return i;
+}
+
+__attribute__((target("ssse3")))
+size_t clampF32Simd(float *samples, size_t count)
+{
+    const __m128 low = _mm_set1_ps(-1.0f);
+    const __m128 high = _mm_set1_ps(1.0f);
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+        _mm_storeu_ps(samples + i, _mm_max_ps(low, _mm_min_ps(high, _mm_loadu_ps(samples + i))));
+    return i;
+}
+
+bool haveSimd()
+{
+#if defined(__SSSE3__)
+    return true;
+#else
+    static const bool ssse3 = __builtin_cpu_supports("ssse3");
+    return ssse3;
+#endif
+}
+#elif MIXER_NEON
+size_t mixS16Simd(int16_t *dst, const int16_t *src, size_t samples, int gain)
+{
+    size_t i = 0;
+    if(gain >= MIXER_UNITY_GAIN)
+    {
+        for(; i + 8 <= samples; i += 8)
+            vst1q_s16(dst + i, vqaddq_s16(vld1q_s16(dst + i), vld1q_s16(src + i)));
+        return i;
+    }
+    // vqrdmulh rounds like the scalar loop: (s * g + 0x4000) >> 15
+    for(; i + 8 <= samples; i += 8)
+        vst1q_s16(dst + i, vqaddq_s16(vld1q_s16(dst + i), vqrdmulhq_n_s16(vld1q_s16(src + i), (int16_t)gain)));
+    return i;
+}
+
+size_t mixF32Simd(float *dst, const float *src, size_t samples, float gain)
+{
+    size_t i = 0;
+    for(; i + 4 <= samples; i += 4)
+        vst1q_f32(dst + i, vmlaq_n_f32(vld1q_f32(dst + i), vld1q_f32(src + i), gain));
+    return i;
+}
+
+size_t clampF32Simd(float *samples, size_t count)
+{
+    const float32x4_t low = vdupq_n_f32(-1.0f);
+    const float32x4_t high = vdupq_n_f32(1.0f);
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+        vst1q_f32(samples + i, vmaxq_f32(low, vminq_f32(high, vld1q_f32(samples + i))));
+    return i;
+}
+
+bool haveSimd()
+{
+    return true;
+}
+#endif
+
+void mixS16(int16_t *dst, const int16_t *src, size_t samples, int gain)
+{
+    size_t done = 0;
+#if MIXER_SSSE3 || MIXER_NEON
+    if(haveSimd())
+        done = mixS16Simd(dst, src, samples, gain);
+#endif
+    mixS16Scalar(dst + done, src + done, samples - done, gain);
+}
+
+void mixF32(float *dst, const float *src, size_t samples, float gain)
+{
+    size_t done = 0;
+#if MIXER_SSSE3 || MIXER_NEON
+    if(haveSimd())
+        done = mixF32Simd(dst, src, samples, gain);
+#endif
+    mixF32Scalar(dst + done, src + done, samples - done, gain);
+}
+
+void clampF32(float *samples, size_t count)
+{
+    size_t done = 0;
+#if MIXER_SSSE3 || MIXER_NEON
+    if(haveSimd())
+        done = clampF32Simd(samples, count);
+#endif
+    clampF32Scalar(samples + done, count - done);
+}
+
+}
+
+Mixer::Mixer(SampleFormat format, int rate, int channels, int bufferMs)
+    : m_nextId(1)
+    , m_format(format)
+    , m_rate(rate)
+    , m_channels(channels)
+    , m_capacity(std::max((size_t)MIXER_CHUNK_FRAMES, (size_t)rate * bufferMs / 1000))
+    , m_mixedFrames(0)
+    , m_streamFrames(0)
+{
+}
+
+bool Mixer::parseFormat(const std::string &name, SampleFormat &format)
+{
+    if(name == "S16LE")
+        format = S16;
+    else if(name == "F32LE")
+        format = F32;
+    else
+        return false;
+    return true;
+}
+
+int Mixer::addStream(SampleFormat format, int rate, int channels)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stream stream;
+    if(!resetStream(stream, format, rate, channels))
+        return -1;
+    stream.gain = 1.0f;
+    stream.paused = false;
+    stream.ring.resize(m_capacity * bytesPerFrame());
+    int id = m_nextId++;
+    m_streams[id] = std::move(stream);
+    return id;
+}
+
+bool Mixer::setInput(int id, SampleFormat format, int rate, int channels)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_streams.find(id);
+    return it != m_streams.end() && resetStream(it->second, format, rate, channels);
+}
+
+bool Mixer::resetStream(Stream &stream, SampleFormat format, int rate, int channels)
+{
+    if(rate <= 0 || channels <= 0 || channels > MIXER_MAX_CHANNELS)
+        return false;
+    stream.format = format;
+    stream.rate = rate;
+    stream.channels = channels;
+    stream.step = (double)rate / m_rate;
+    stream.position = 0;
+    stream.last.assign(m_channels, 0.0f);
+    stream.haveLast = false;
+    stream.head = 0;
+    stream.count = 0;
+    return true;
+}
+
+void Mixer::removeStream(int id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_streams.erase(id);
+}
+
+size_t Mixer::write(int id, const void *data, size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_streams.find(id);
+    if(it == m_streams.end())
+        return 0;
+    Stream &stream = it->second;
+
+    const uint8_t *input = static_cast<const uint8_t*>(data);
+    size_t frameSize = stream.channels * sampleSize(stream.format);
+    size_t frames = bytes / frameSize;
+    size_t taken = 0;
+
+    if(stream.format == m_format && stream.channels == m_channels && stream.rate == m_rate)
+    {
+        // Already in the output format
+        taken = std::min(frames, m_capacity - stream.count);
+        append(stream, input, taken);
+        return taken * frameSize;
+    }
+
+    while(taken < frames)
+    {
+        size_t chunk = std::min(frames - taken, (size_t)MIXER_CHUNK_FRAMES);
+        // A chunk makes at most chunk / step + 1 output frames
+        size_t room = m_capacity - stream.count;
+        if((size_t)std::ceil(chunk / stream.step) + 1 > room)
+        {
+            chunk = room > 1 ? (size_t)((room - 1) * stream.step) : 0;
+            while(chunk > 0 && (size_t)std::ceil(chunk / stream.step) + 1 > room)
+                chunk--;
+            if(chunk == 0)
+                break;
+        }
+        size_t produced = convert(stream, input + taken * frameSize, chunk);
+        append(stream, m_converted.data(), produced);
+        taken += chunk;
+    }
+    return taken * frameSize;
+}
+
+// Converts frames of input to the output format in m_converted, returns
+// the output frames made
+size_t Mixer::convert(Stream &stream, const uint8_t *data, size_t frames)
+{
+    // Channel mapping to float: mono is copied to every channel, a
+    // mono output takes the average, otherwise extra channels are dropped
+    m_input.resize(frames * m_channels);
+    float frame[MIXER_MAX_CHANNELS];
+    for(size_t i = 0; i < frames; i++)
+    {
+        for(int c = 0; c < stream.channels; c++)
+        {
+            if(stream.format == S16)
+            {
+                int16_t sample;
+                memcpy(&sample, data + (i * stream.channels + c) * sizeof(int16_t), sizeof(sample));
+                frame[c] = sample / 32768.0f;
+            }
+            else
+            {
+                memcpy(&frame[c], data + (i * stream.channels + c) * sizeof(float), sizeof(float));
+            }
+        }
+        float *out = &m_input[i * m_channels];
+        if(m_channels == 1 && stream.channels > 1)
+        {
+            float sum = 0;
+            for(int c = 0; c < stream.channels; c++)
+                sum += frame[c];
+            out[0] = sum / stream.channels;
+        }
+        else
+        {
+            for(int c = 0; c < m_channels; c++)
+                out[c] = frame[c % stream.channels];
+        }
+    }
+
+    const float *samples = m_input.data();
+    size_t produced = frames;
+    if(stream.rate != m_rate)
+    {
+        // Linear interpolation between the input frames, carrying the
+        // last frame and the fractional position over to the next write
+        if(!stream.haveLast)
+        {
+            // Start right on the first frame
+            std::copy(samples, samples + m_channels, stream.last.begin());
+            stream.haveLast = true;
+            stream.position = 1.0;
+        }
+        m_resampled.resize(((size_t)std::ceil(frames / stream.step) + 1) * m_channels);
+        produced = 0;
+        while(stream.position < frames)
+        {
+            size_t index = (size_t)stream.position;
+            float fraction = (float)(stream.position - index);
+            const float *a = index == 0 ? stream.last.data() : samples + (index - 1) * m_channels;
+            const float *b = samples + index * m_channels;
+            float *out = &m_resampled[produced * m_channels];
+            for(int c = 0; c < m_channels; c++)
+                out[c] = a[c] + (b[c] - a[c]) * fraction;
+            produced++;
+            stream.position += stream.step;
+        }
+        stream.position -= frames;
+        std::copy(samples + (frames - 1) * m_channels, samples + frames * m_channels, stream.last.begin());
+        samples = m_resampled.data();
+    }
+
+    size_t count = produced * m_channels;
+    m_converted.resize(count * sampleSize(m_format));
+    if(m_format == S16)
+    {
+        int16_t *out = reinterpret_cast<int16_t*>(m_converted.data());
+        for(size_t i = 0; i < count; i++)
+            out[i] = saturate16((int32_t)lrintf(samples[i] * 32768.0f));
+    }
+    else
+    {
+        memcpy(m_converted.data(), samples, count * sizeof(float));
+    }
+    return produced;
+}
+
+void Mixer::append(Stream &stream, const uint8_t *data, size_t frames)
+{
+    if(frames == 0)
+        return;
+    size_t frameSize = bytesPerFrame();
+    size_t tail = (stream.head + stream.count) % m_capacity;
+    size_t first = std::min(frames, m_capacity - tail);
+    memcpy(&stream.ring[tail * frameSize], data, first * frameSize);
+    memcpy(&stream.ring[0], data + first * frameSize, (frames - first) * frameSize);
+    stream.count += frames;
+}
+
+void Mixer::setGain(int id, float gain)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_streams.find(id);
+    if(it != m_streams.end())
+        it->second.gain = std::max(0.0f, std::min(1.0f, gain));
+}
+
+void Mixer::setPaused(int id, bool paused)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_streams.find(id);
+    if(it != m_streams.end())
+        it->second.paused = paused;
+}
+
+void Mixer::flush(int id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_streams.find(id);
+    if(it != m_streams.end())
+        resetStream(it->second, it->second.format, it->second.rate, it->second.channels);
+}
+
+size_t Mixer::queuedFrames(int id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_streams.find(id);
+    return it != m_streams.end() ? it->second.count : 0;
+}
+
+size_t Mixer::mix(void *out, size_t frames)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint8_t *output = static_cast<uint8_t*>(out);
+    bool mixed = false;
+    for(auto &entry : m_streams)
+    {
+        Stream &stream = entry.second;
+        if(stream.paused || stream.count == 0)
+            continue;
+        if(!mixed)
+        {
+            memset(output, 0, frames * bytesPerFrame());
+            mixed = true;
+        }
+        mixInto(output, stream, frames);
+    }
+    if(!mixed)
+        return 0;
+    // Float sums are only clipped once all streams are in
+    if(m_format == F32)
+        clampF32(reinterpret_cast<float*>(output), frames * m_channels);
+    m_mixedFrames += frames;
+    return frames;
+}
+
+void Mixer::mixInto(uint8_t *out, Stream &stream, size_t frames)
+{
+    size_t frameSize = bytesPerFrame();
+    size_t todo = std::min(stream.count, frames);
+    int gainQ15 = (int)lrintf(stream.gain * MIXER_UNITY_GAIN);
+    size_t done = 0;
+    while(done < todo)
+    {
+        // At most two runs, split where the ring wraps
+        size_t run = std::min(todo - done, m_capacity - stream.head);
+        const uint8_t *src = &stream.ring[stream.head * frameSize];
+        uint8_t *dst = out + done * frameSize;
+        if(m_format == S16)
+            mixS16(reinterpret_cast<int16_t*>(dst), reinterpret_cast<const int16_t*>(src), run * m_channels, gainQ15);
+        else
+            mixF32(reinterpret_cast<float*>(dst), reinterpret_cast<const float*>(src), run * m_channels, stream.gain);
+        stream.head = (stream.head + run) % m_capacity;
+        stream.count -= run;
+        done += run;
+    }
+    m_streamFrames += todo;
+}
+
+Mixer::Stats Mixer::stats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.streams = m_streams.size();
+    stats.mixedFrames = m_mixedFrames;
+    stats.streamFrames = m_streamFrames;
+    return stats;
+}
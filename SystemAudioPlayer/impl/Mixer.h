@@ -0,0 +1,127 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef MIXER_H_
+#define MIXER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Sums several interleaved PCM streams into one output stream.
+//
+// Every stream is converted to the output format, rate and channel count
+// as it is written, and queued until mix() takes it. Mixing applies the
+// stream gain and saturates, with SSSE3 (picked at runtime) or NEON for
+// whole registers and a scalar loop for the rest. A paused stream keeps
+// its queued audio and is left out of the mix.
+class Mixer
+{
+    public:
+    enum SampleFormat
+    {
+        S16,
+        F32
+    };
+
+    struct Stats
+    {
+        size_t streams;
+        uint64_t mixedFrames;   // output frames with audio from any stream
+        uint64_t streamFrames;  // input frames summed, over all streams
+    };
+
+    Mixer(SampleFormat format, int rate, int channels, int bufferMs);
+
+    // Maps a PCM caps format, S16LE or F32LE, false for anything else
+    static bool parseFormat(const std::string &name, SampleFormat &format);
+
+    // Returns the stream id, -1 for an unsupported input
+    int addStream(SampleFormat format, int rate, int channels);
+    // Changes the input of a stream, dropping what it has queued
+    bool setInput(int id, SampleFormat format, int rate, int channels);
+    void removeStream(int id);
+
+    // Converts and queues whole frames of data while there is room.
+    // Returns the bytes of data taken.
+    size_t write(int id, const void *data, size_t bytes);
+    // gain from 0 to 1
+    void setGain(int id, float gain);
+    void setPaused(int id, bool paused);
+    // Drops the queued audio, e.g. when the session is stopped
+    void flush(int id);
+    size_t queuedFrames(int id);
+
+    // Fills frames output frames, silence where streams run out. Returns
+    // 0 and leaves out untouched when no playing stream has audio.
+    size_t mix(void *out, size_t frames);
+
+    SampleFormat format() const { return m_format; }
+    int rate() const { return m_rate; }
+    int channels() const { return m_channels; }
+    size_t bytesPerFrame() const { return m_channels * sampleSize(m_format); }
+    Stats stats();
+
+    static size_t sampleSize(SampleFormat format) { return format == S16 ? sizeof(int16_t) : sizeof(float); }
+
+    private:
+    Mixer(const Mixer&) = delete;
+    Mixer& operator=(const Mixer&) = delete;
+
+    struct Stream
+    {
+        SampleFormat format;
+        int rate;
+        int channels;
+        float gain;
+        bool paused;
+        // Input frames per output frame
+        double step;
+        // Position of the next output frame, 0 being the last input frame
+        double position;
+        std::vector<float> last;
+        bool haveLast;
+        // Queue of output frames
+        std::vector<uint8_t> ring;
+        size_t head;
+        size_t count;
+    };
+
+    bool resetStream(Stream &stream, SampleFormat format, int rate, int channels);
+    size_t convert(Stream &stream, const uint8_t *data, size_t frames);
+    void append(Stream &stream, const uint8_t *data, size_t frames);
+    void mixInto(uint8_t *out, Stream &stream, size_t frames);
+
+    std::mutex m_mutex;
+    std::map<int, Stream> m_streams;
+    int m_nextId;
+    SampleFormat m_format;
+    int m_rate;
+    int m_channels;
+    size_t m_capacity;
+    uint64_t m_mixedFrames;
+    uint64_t m_streamFrames;
+    std::vector<float> m_input;
+    std::vector<float> m_resampled;
+    std::vector<uint8_t> m_converted;
+};
+#endif
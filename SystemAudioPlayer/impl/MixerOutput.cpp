@@ -0,0 +1,301 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "MixerOutput.h"
+#include "logger.h"
+#include <gst/app/gstappsrc.h>
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#define MIXER_CHANNELS          2
+#define MIXER_PERIOD_MS         10
+// Mixed audio waiting in appsrc, the latency the mixer adds
+#define MIXER_APPSRC_PERIODS    4
+// Audio a session can queue in the mixer on top of its BufferQueue
+#define MIXER_STREAM_BUFFER_MS  200
+// Silence is played for this long before the sink is released
+#define MIXER_IDLE_TIMEOUT_MS   500
+
+namespace {
+
+std::mutex g_outputsMutex;
+std::map<int, MixerOutput*> g_outputs;
+bool g_enabled = false;
+Mixer::SampleFormat g_format = Mixer::S16;
+int g_rate = 48000;
+
+}
+
+void MixerOutput::configure(bool enabled, const std::string &format, int rate)
+{
+    std::lock_guard<std::mutex> lock(g_outputsMutex);
+    g_enabled = enabled;
+    if(!Mixer::parseFormat(format, g_format))
+    {
+        SAPLOG_WARNING("SAP: Mixer cannot output %s, using S16LE\n", format.c_str());
+        g_format = Mixer::S16;
+    }
+    if(rate > 0)
+        g_rate = rate;
+    SAPLOG_INFO("SAP: Mixer %s, %s %dHz\n", enabled ? "enabled" : "disabled", g_format == Mixer::S16 ? "S16LE" : "F32LE", g_rate);
+}
+
+MixerOutput* MixerOutput::get(PlayMode playMode)
+{
+    std::lock_guard<std::mutex> lock(g_outputsMutex);
+    if(!g_enabled)
+        return nullptr;
+    auto it = g_outputs.find(playMode);
+    if(it != g_outputs.end())
+        return it->second;
+
+    MixerOutput *output = new MixerOutput(playMode, g_format, g_rate);
+    if(output->m_pipeline == nullptr)
+    {
+        delete output;
+        return nullptr;
+    }
+    g_outputs[playMode] = output;
+    return output;
+}
+
+void MixerOutput::shutdown()
+{
+    std::lock_guard<std::mutex> lock(g_outputsMutex);
+    for(auto &entry : g_outputs)
+        delete entry.second;
+    g_outputs.clear();
+}
+
+MixerOutput::MixerOutput(PlayMode playMode, Mixer::SampleFormat format, int rate)
+    : m_mixer(format, rate, MIXER_CHANNELS, MIXER_STREAM_BUFFER_MS)
+    , m_playMode(playMode)
+    , m_pipeline(nullptr)
+    , m_source(nullptr)
+    , m_audioSink(nullptr)
+    , m_audioVolume(nullptr)
+    , m_playing(false)
+    , m_pushedFrames(0)
+    , m_dataPending(false)
+    , m_running(true)
+{
+    if(buildPipeline())
+        m_thread = std::thread(&MixerOutput::run, this);
+}
+
+MixerOutput::~MixerOutput()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+    if(m_pipeline)
+    {
+        // Flushing appsrc releases a push blocked on a full queue
+        gst_element_set_state(m_pipeline, GST_STATE_NULL);
+    }
+    if(m_thread.joinable())
+        m_thread.join();
+    if(m_pipeline)
+    {
+        gst_element_set_state(m_pipeline, GST_STATE_NULL);
+        gst_object_unref(m_pipeline);
+    }
+    Mixer::Stats stats = m_mixer.stats();
+    SAPLOG_INFO("SAP: Mixer of play mode %d mixed %llu frames from %llu stream frames\n", m_playMode,
+            (unsigned long long)stats.mixedFrames, (unsigned long long)stats.streamFrames);
+}
+
+bool MixerOutput::buildPipeline()
+{
+    m_pipeline = gst_pipeline_new(NULL);
+    m_source = gst_element_factory_make("appsrc", NULL);
+    bool result = false;
+    if(m_pipeline && m_source)
+    {
+        GstCaps *caps = gst_caps_new_simple("audio/x-raw", "format", G_TYPE_STRING, m_mixer.format() == Mixer::S16 ? "S16LE" : "F32LE",
+                "rate", G_TYPE_INT, m_mixer.rate(), "channels", G_TYPE_INT, m_mixer.channels(), "layout", G_TYPE_STRING, "interleaved", NULL);
+        gst_app_src_set_caps(GST_APP_SRC(m_source), caps);
+        gst_caps_unref(caps);
+        gst_app_src_set_max_bytes(GST_APP_SRC(m_source), MIXER_APPSRC_PERIODS * m_mixer.rate() * MIXER_PERIOD_MS / 1000 * m_mixer.bytesPerFrame());
+        g_object_set(m_source, "format", GST_FORMAT_TIME, "block", TRUE, NULL);
+#ifndef UNIT_TESTING
+        result = systemAudioGeneratePipeline(m_pipeline,m_source,NULL,&m_audioSink,&m_audioVolume,PCM,m_playMode,DATA,false);
+#else
+        result = systemAudioGeneratePipeline(&m_pipeline,&m_source,NULL,&m_audioSink,&m_audioVolume,PCM,m_playMode,DATA,false);
+#endif
+    }
+    if(!result)
+    {
+        SAPLOG_ERROR("SAP: Failed to create mixer pipeline for play mode %d\n", m_playMode);
+        if(m_pipeline)
+            gst_object_unref(m_pipeline);
+        m_pipeline = nullptr;
+        m_source = nullptr;
+        return false;
+    }
+    return true;
+}
+
+int MixerOutput::addSession(FeederSession *session, const std::string &format, int rate, int channels)
+{
+    Mixer::SampleFormat input;
+    if(!Mixer::parseFormat(format, input))
+        return -1;
+    int id = m_mixer.addStream(input, rate, channels);
+    if(id < 0)
+        return -1;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sessions[id] = session;
+    SAPLOG_INFO("SAP: Mixer of play mode %d has %zu sessions\n", m_playMode, m_sessions.size());
+    return id;
+}
+
+void MixerOutput::removeSession(int id)
+{
+    // Once this returns the mixer thread no longer notifies the session
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sessions.erase(id);
+    m_mixer.removeStream(id);
+}
+
+size_t MixerOutput::write(int id, const void *data, size_t bytes)
+{
+    size_t taken = m_mixer.write(id, data, bytes);
+    if(taken > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_dataPending = true;
+        }
+        m_wake.notify_one();
+    }
+    return taken;
+}
+
+void MixerOutput::setPaused(int id, bool paused)
+{
+    m_mixer.setPaused(id, paused);
+    if(!paused)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_dataPending = true;
+        }
+        m_wake.notify_one();
+    }
+}
+
+bool MixerOutput::setPlaying(bool playing)
+{
+    if(m_playing == playing)
+        return true;
+    GstStateChangeReturn ret = gst_element_set_state(m_pipeline, playing ? GST_STATE_PLAYING : GST_STATE_READY);
+    if(ret == GST_STATE_CHANGE_FAILURE)
+    {
+        SAPLOG_ERROR("SAP: Mixer pipeline of play mode %d failed to go to %s\n", m_playMode, playing ? "PLAYING" : "READY");
+        return false;
+    }
+    // Timestamps start over with the new segment
+    m_pushedFrames = 0;
+    m_playing = playing;
+    SAPLOG_INFO("SAP: Mixer pipeline of play mode %d %s\n", m_playMode, playing ? "started" : "idle");
+    return true;
+}
+
+void MixerOutput::checkBus()
+{
+    GstBus *bus = gst_element_get_bus(m_pipeline);
+    GstMessage *message;
+    while((message = gst_bus_pop_filtered(bus, GST_MESSAGE_ERROR)) != NULL)
+    {
+        GError *error = NULL;
+        gchar *debug = NULL;
+        gst_message_parse_error(message, &error, &debug);
+        SAPLOG_ERROR("SAP: Mixer pipeline of play mode %d error: %s\n", m_playMode, error ? error->message : "");
+        if(error)
+            g_error_free(error);
+        g_free(debug);
+        gst_message_unref(message);
+        // Started again with the next period
+        gst_element_set_state(m_pipeline, GST_STATE_NULL);
+        m_playing = false;
+    }
+    gst_object_unref(bus);
+}
+
+void MixerOutput::run()
+{
+    const size_t period = (size_t)m_mixer.rate() * MIXER_PERIOD_MS / 1000;
+    const size_t periodBytes = period * m_mixer.bytesPerFrame();
+    std::vector<uint8_t> mixed(periodBytes);
+    std::chrono::steady_clock::time_point lastAudio = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(m_running)
+    {
+        m_dataPending = false;
+        lock.unlock();
+        size_t frames = m_mixer.mix(mixed.data(), period);
+        lock.lock();
+
+        if(frames > 0)
+        {
+            lastAudio = std::chrono::steady_clock::now();
+            // There is room in the session queues again
+            for(auto &entry : m_sessions)
+                FeederPool::instance().notify(entry.second);
+        }
+        else if(m_playing && std::chrono::steady_clock::now() - lastAudio < std::chrono::milliseconds(MIXER_IDLE_TIMEOUT_MS))
+        {
+            // Bridges a gap, so the next audio is not late at the sink
+            memset(mixed.data(), 0, periodBytes);
+        }
+        else
+        {
+            lock.unlock();
+            setPlaying(false);
+            lock.lock();
+            m_wake.wait(lock, [this] { return m_dataPending || !m_running; });
+            continue;
+        }
+        lock.unlock();
+
+        if(setPlaying(true))
+        {
+            GstBuffer *buffer = gst_buffer_new_allocate(NULL, periodBytes, NULL);
+            gst_buffer_fill(buffer, 0, mixed.data(), periodBytes);
+            GST_BUFFER_PTS(buffer) = gst_util_uint64_scale(m_pushedFrames, GST_SECOND, m_mixer.rate());
+            GST_BUFFER_DURATION(buffer) = gst_util_uint64_scale(period, GST_SECOND, m_mixer.rate());
+            m_pushedFrames += period;
+            // Blocks while appsrc holds MIXER_APPSRC_PERIODS, pacing the loop
+            gst_app_src_push_buffer(GST_APP_SRC(m_source), buffer);
+            checkBus();
+        }
+        else
+        {
+            // The sink is busy; the audio of this period is lost
+            std::this_thread::sleep_for(std::chrono::milliseconds(MIXER_PERIOD_MS));
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,86 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef MIXEROUTPUT_H_
+#define MIXEROUTPUT_H_
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <gst/gst.h>
+#include <systemaudioplatform.h>
+#include "FeederPool.h"
+#include "Mixer.h"
+
+// The one sink pipeline of a play mode that mixed PCM players share.
+//
+// A thread mixes a period at a time and pushes it to a blocking appsrc,
+// which paces it to the sink. Silence keeps the pipeline running through
+// short gaps; after a longer idle time it goes to READY, releasing the
+// sink until a session has audio again. Sessions are fed by FeederPool
+// and are notified whenever the mix made room in their queue.
+class MixerOutput
+{
+    public:
+    // Must be called before the first player opens
+    static void configure(bool enabled, const std::string &format, int rate);
+    // Output of the play mode, nullptr if mixing is off or the pipeline
+    // cannot be built
+    static MixerOutput* get(PlayMode playMode);
+    static void shutdown();
+
+    // Returns the stream id, -1 if the input cannot be mixed
+    int addSession(FeederSession *session, const std::string &format, int rate, int channels);
+    void removeSession(int id);
+    // Takes as much of data as fits, in bytes
+    size_t write(int id, const void *data, size_t bytes);
+    // Resuming wakes the mixer for audio queued while paused
+    void setPaused(int id, bool paused);
+    Mixer& mixer() { return m_mixer; }
+
+    private:
+    MixerOutput(PlayMode playMode, Mixer::SampleFormat format, int rate);
+    ~MixerOutput();
+    MixerOutput(const MixerOutput&) = delete;
+    MixerOutput& operator=(const MixerOutput&) = delete;
+
+    bool buildPipeline();
+    bool setPlaying(bool playing);
+    void checkBus();
+    void run();
+
+    Mixer m_mixer;
+    PlayMode m_playMode;
+    GstElement *m_pipeline;
+    GstElement *m_source;
+    GstElement *m_audioSink;
+    GstElement *m_audioVolume;
+    bool m_playing;
+    uint64_t m_pushedFrames;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::map<int, FeederSession*> m_sessions;
+    bool m_dataPending;
+    bool m_running;
+    std::thread m_thread;
+};
+#endif
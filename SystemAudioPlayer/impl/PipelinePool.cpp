@@ -0,0 +1,105 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "PipelinePool.h"
+
+#include <tuple>
+
+bool PipelinePool::Key::operator<(const Key &other) const
+{
+    return std::make_tuple((int)audioType, (int)sourceType, (int)playMode, smartVolume)
+        < std::make_tuple((int)other.audioType, (int)other.sourceType, (int)other.playMode, other.smartVolume);
+}
+
+PipelinePool::PipelinePool(size_t perKey)
+    : m_perKey(perKey)
+    , m_hits(0)
+    , m_misses(0)
+    , m_discarded(0)
+{
+}
+
+PipelinePool& PipelinePool::instance()
+{
+    static PipelinePool pool;
+    return pool;
+}
+
+void PipelinePool::setSize(size_t perKey)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_perKey = perKey;
+}
+
+size_t PipelinePool::size()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_perKey;
+}
+
+bool PipelinePool::take(const Key &key, PooledPipeline &pipeline)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_idle.find(key);
+    if(it == m_idle.end() || it->second.empty())
+    {
+        m_misses++;
+        return false;
+    }
+    pipeline = it->second.back();
+    it->second.pop_back();
+    m_hits++;
+    return true;
+}
+
+bool PipelinePool::put(const Key &key, const PooledPipeline &pipeline)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<PooledPipeline> &idle = m_idle[key];
+    if(idle.size() >= m_perKey)
+    {
+        m_discarded++;
+        return false;
+    }
+    idle.push_back(pipeline);
+    return true;
+}
+
+std::vector<PooledPipeline> PipelinePool::drain()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<PooledPipeline> all;
+    for(auto &entry : m_idle)
+        all.insert(all.end(), entry.second.begin(), entry.second.end());
+    m_idle.clear();
+    return all;
+}
+
+PipelinePool::Stats PipelinePool::stats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.discarded = m_discarded;
+    stats.idle = 0;
+    for(auto &entry : m_idle)
+        stats.idle += entry.second.size();
+    return stats;
+}
@@ -0,0 +1,98 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef PIPELINEPOOL_H_
+#define PIPELINEPOOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <systemaudioplatform.h>
+
+typedef struct _GstElement GstElement;
+
+// Elements of a pipeline built by AudioPlayer::createPipeline()
+struct PooledPipeline
+{
+    GstElement *pipeline;
+    GstElement *source;
+    GstElement *capsfilter;
+    GstElement *audioSink;
+    GstElement *audioVolume;
+};
+
+// Idle pipelines of closed players, kept in READY state so the next Open
+// of the same kind skips systemAudioGeneratePipeline() and the sink setup.
+//
+// The pool only keeps the elements; AudioPlayer detaches its signals and
+// bus watch before handing a pipeline back and destroys what put() or
+// drain() does not keep.
+class PipelinePool
+{
+    public:
+    struct Key
+    {
+        AudioType audioType;
+        SourceType sourceType;
+        PlayMode playMode;
+        bool smartVolume;
+
+        bool operator<(const Key &other) const;
+    };
+
+    struct Stats
+    {
+        uint64_t hits;          // Opens served from the pool
+        uint64_t misses;        // Opens that built a pipeline
+        uint64_t discarded;     // pipelines not kept because the pool was full
+        size_t idle;
+    };
+
+    explicit PipelinePool(size_t perKey = 0);
+
+    // Pool shared by all players
+    static PipelinePool& instance();
+
+    // Idle pipelines kept per key, 0 (the default) disables pooling
+    void setSize(size_t perKey);
+    size_t size();
+
+    // Returns false and counts a miss when no pipeline of that kind is idle
+    bool take(const Key &key, PooledPipeline &pipeline);
+    // Returns false when the pool for key is full; the caller keeps ownership
+    bool put(const Key &key, const PooledPipeline &pipeline);
+    // Empties the pool, handing every pipeline back to the caller
+    std::vector<PooledPipeline> drain();
+
+    Stats stats();
+
+    private:
+    PipelinePool(const PipelinePool&) = delete;
+    PipelinePool& operator=(const PipelinePool&) = delete;
+
+    std::mutex m_mutex;
+    std::map<Key, std::vector<PooledPipeline>> m_idle;
+    size_t m_perKey;
+    uint64_t m_hits;
+    uint64_t m_misses;
+    uint64_t m_discarded;
+};
+#endif
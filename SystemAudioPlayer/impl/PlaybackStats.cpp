@@ -0,0 +1,192 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "PlaybackStats.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <time.h>
+
+namespace {
+
+// Events timed from a play request, each once
+enum
+{
+    REACHED_PAUSED  = 1 << 0,
+    REACHED_PLAYING = 1 << 1,
+    STARTED         = 1 << 2
+};
+
+int64_t toNs(PlaybackStats::Clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+}
+
+PlaybackStats::Snapshot& PlaybackStats::Snapshot::operator+=(const Snapshot &other)
+{
+    bytesReceived += other.bytesReceived;
+    bytesPushed += other.bytesPushed;
+    buffersDropped += other.buffersDropped;
+    bytesDropped += other.bytesDropped;
+    queueHighWater = std::max(queueHighWater, other.queueHighWater);
+    underruns += other.underruns;
+    feedPauses += other.feedPauses;
+    starts += other.starts;
+    // The latest of a total is meaningless, the largest is kept
+    startupUs = std::max(startupUs, other.startupUs);
+    maxStartupUs = std::max(maxStartupUs, other.maxStartupUs);
+    pausedUs = std::max(pausedUs, other.pausedUs);
+    playingUs = std::max(playingUs, other.playingUs);
+    maxPlayingUs = std::max(maxPlayingUs, other.maxPlayingUs);
+    feederCpuUs += other.feederCpuUs;
+    scheduledStarts += other.scheduledStarts;
+    if(std::llabs(other.startOffsetUs) > std::llabs(startOffsetUs))
+        startOffsetUs = other.startOffsetUs;
+    if(std::llabs(other.maxStartOffsetUs) > std::llabs(maxStartOffsetUs))
+        maxStartOffsetUs = other.maxStartOffsetUs;
+    return *this;
+}
+
+PlaybackStats::PlaybackStats()
+    : m_bytesReceived(0)
+    , m_bytesPushed(0)
+    , m_buffersDropped(0)
+    , m_bytesDropped(0)
+    , m_queueHighWater(0)
+    , m_underruns(0)
+    , m_feedPauses(0)
+    , m_starts(0)
+    , m_requestNs(0)
+    , m_pending(0)
+    , m_startupUs(-1)
+    , m_maxStartupUs(-1)
+    , m_pausedUs(-1)
+    , m_playingUs(-1)
+    , m_maxPlayingUs(-1)
+    , m_feederCpuNs(0)
+    , m_scheduledStarts(0)
+    , m_startOffsetUs(0)
+    , m_maxStartOffsetUs(0)
+{
+}
+
+void PlaybackStats::dropped(size_t bytes)
+{
+    m_buffersDropped.fetch_add(1, std::memory_order_relaxed);
+    m_bytesDropped.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void PlaybackStats::queued(size_t bytes)
+{
+    raise(m_queueHighWater, (int64_t)bytes);
+}
+
+void PlaybackStats::playRequested(Clock::time_point now)
+{
+    m_requestNs.store(toNs(now), std::memory_order_relaxed);
+    // Released with the time, which the events read after acquiring
+    m_pending.store(REACHED_PAUSED | REACHED_PLAYING | STARTED, std::memory_order_release);
+}
+
+void PlaybackStats::reachedPaused(Clock::time_point now)
+{
+    int64_t us = since(REACHED_PAUSED, now);
+    if(us >= 0)
+        m_pausedUs.store(us, std::memory_order_relaxed);
+}
+
+void PlaybackStats::reachedPlaying(Clock::time_point now)
+{
+    int64_t us = since(REACHED_PLAYING, now);
+    if(us < 0)
+        return;
+    m_playingUs.store(us, std::memory_order_relaxed);
+    raise(m_maxPlayingUs, us);
+}
+
+void PlaybackStats::started(Clock::time_point now)
+{
+    m_starts.fetch_add(1, std::memory_order_relaxed);
+    int64_t us = since(STARTED, now);
+    if(us < 0)
+        return;
+    m_startupUs.store(us, std::memory_order_relaxed);
+    raise(m_maxStartupUs, us);
+}
+
+void PlaybackStats::scheduledStart(int64_t offsetUs)
+{
+    m_scheduledStarts.fetch_add(1, std::memory_order_relaxed);
+    m_startOffsetUs.store(offsetUs, std::memory_order_relaxed);
+    // Only measured once per PlayAt, on the main loop
+    if(std::llabs(offsetUs) > std::llabs(m_maxStartOffsetUs.load(std::memory_order_relaxed)))
+        m_maxStartOffsetUs.store(offsetUs, std::memory_order_relaxed);
+}
+
+void PlaybackStats::cancelRequest()
+{
+    m_pending.store(0, std::memory_order_relaxed);
+}
+
+PlaybackStats::Snapshot PlaybackStats::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.bytesReceived = m_bytesReceived.load(std::memory_order_relaxed);
+    snapshot.bytesPushed = m_bytesPushed.load(std::memory_order_relaxed);
+    snapshot.buffersDropped = m_buffersDropped.load(std::memory_order_relaxed);
+    snapshot.bytesDropped = m_bytesDropped.load(std::memory_order_relaxed);
+    snapshot.queueHighWater = (uint64_t)m_queueHighWater.load(std::memory_order_relaxed);
+    snapshot.underruns = m_underruns.load(std::memory_order_relaxed);
+    snapshot.feedPauses = m_feedPauses.load(std::memory_order_relaxed);
+    snapshot.starts = m_starts.load(std::memory_order_relaxed);
+    snapshot.startupUs = m_startupUs.load(std::memory_order_relaxed);
+    snapshot.maxStartupUs = m_maxStartupUs.load(std::memory_order_relaxed);
+    snapshot.pausedUs = m_pausedUs.load(std::memory_order_relaxed);
+    snapshot.playingUs = m_playingUs.load(std::memory_order_relaxed);
+    snapshot.maxPlayingUs = m_maxPlayingUs.load(std::memory_order_relaxed);
+    snapshot.feederCpuUs = (uint64_t)(m_feederCpuNs.load(std::memory_order_relaxed) / 1000);
+    snapshot.scheduledStarts = m_scheduledStarts.load(std::memory_order_relaxed);
+    snapshot.startOffsetUs = m_startOffsetUs.load(std::memory_order_relaxed);
+    snapshot.maxStartOffsetUs = m_maxStartOffsetUs.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+int64_t PlaybackStats::threadCpuNs()
+{
+    struct timespec now;
+    if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) != 0)
+        return 0;
+    return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+void PlaybackStats::raise(std::atomic<int64_t> &max, int64_t value)
+{
+    int64_t current = max.load(std::memory_order_relaxed);
+    while(value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        ;
+}
+
+int64_t PlaybackStats::since(int event, Clock::time_point now)
+{
+    if((m_pending.fetch_and(~event, std::memory_order_acquire) & event) == 0)
+        return -1;
+    return std::max<int64_t>(0, (toNs(now) - m_requestNs.load(std::memory_order_relaxed)) / 1000);
+}
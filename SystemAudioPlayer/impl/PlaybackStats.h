@@ -0,0 +1,137 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef PLAYBACKSTATS_H_
+#define PLAYBACKSTATS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Counters of one player for GetStatistics.
+//
+// Updated from the API, streaming, feeder and websocket threads with
+// relaxed atomics only, so they stay on in production. A snapshot is not
+// taken atomically as a whole; each counter is exact on its own.
+class PlaybackStats
+{
+    public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Snapshot
+    {
+        uint64_t bytesReceived;     // from PlayBuffer, the websocket or the shm ring
+        uint64_t bytesPushed;       // accepted by appsrc or the mixer
+        uint64_t buffersDropped;    // PlayBuffer calls or pushes that lost data
+        uint64_t bytesDropped;
+        uint64_t queueHighWater;    // most bytes BufferQueue held
+        uint64_t underruns;         // appsrc ran dry during playback
+        uint64_t feedPauses;        // pause feeding requests sent to the source
+        uint64_t starts;            // PLAYBACK_STARTED events
+        int64_t startupUs;          // Play to PLAYBACK_STARTED, last and largest
+        int64_t maxStartupUs;
+        int64_t pausedUs;           // Play to the pipeline reaching PAUSED
+        int64_t playingUs;          // Play to the pipeline reaching PLAYING
+        int64_t maxPlayingUs;
+        uint64_t feederCpuUs;       // CPU time of the threads feeding the session
+        uint64_t scheduledStarts;   // PlayAt starts measured
+        int64_t startOffsetUs;      // achieved less requested start, late if positive
+        int64_t maxStartOffsetUs;   // the largest either way
+
+        Snapshot& operator+=(const Snapshot &other);
+    };
+
+    PlaybackStats();
+
+    void received(size_t bytes) { m_bytesReceived.fetch_add(bytes, std::memory_order_relaxed); }
+    void pushed(size_t bytes) { m_bytesPushed.fetch_add(bytes, std::memory_order_relaxed); }
+    void dropped(size_t bytes);
+    // BufferQueue fill level after an add
+    void queued(size_t bytes);
+    void underrun() { m_underruns.fetch_add(1, std::memory_order_relaxed); }
+    void feedPaused() { m_feedPauses.fetch_add(1, std::memory_order_relaxed); }
+
+    // The pipeline was asked to play; the start and state changes that
+    // follow are timed from here
+    void playRequested(Clock::time_point now);
+    void reachedPaused(Clock::time_point now);
+    void reachedPlaying(Clock::time_point now);
+    void started(Clock::time_point now);
+    // Forgets a request that will not start, e.g. on Stop
+    void cancelRequest();
+    bool requestPending() const { return m_pending.load(std::memory_order_relaxed) != 0; }
+
+    void feederCpu(int64_t ns) { m_feederCpuNs.fetch_add(ns > 0 ? ns : 0, std::memory_order_relaxed); }
+
+    // How far the output of a PlayAt started from the requested time
+    void scheduledStart(int64_t offsetUs);
+
+    Snapshot snapshot() const;
+
+    // CPU time of the calling thread
+    static int64_t threadCpuNs();
+
+    // Adds the CPU time the thread spends in its scope to a session
+    class CpuTimer
+    {
+        public:
+        explicit CpuTimer(PlaybackStats &stats) : m_stats(stats), m_start(threadCpuNs()) {}
+        ~CpuTimer() { m_stats.feederCpu(threadCpuNs() - m_start); }
+
+        private:
+        CpuTimer(const CpuTimer&) = delete;
+        CpuTimer& operator=(const CpuTimer&) = delete;
+
+        PlaybackStats &m_stats;
+        int64_t m_start;
+    };
+
+    private:
+    PlaybackStats(const PlaybackStats&) = delete;
+    PlaybackStats& operator=(const PlaybackStats&) = delete;
+
+    static void raise(std::atomic<int64_t> &max, int64_t value);
+    // Microseconds since the request if event is still pending for it, -1
+    // otherwise
+    int64_t since(int event, Clock::time_point now);
+
+    std::atomic<uint64_t> m_bytesReceived;
+    std::atomic<uint64_t> m_bytesPushed;
+    std::atomic<uint64_t> m_buffersDropped;
+    std::atomic<uint64_t> m_bytesDropped;
+    std::atomic<int64_t> m_queueHighWater;
+    std::atomic<uint64_t> m_underruns;
+    std::atomic<uint64_t> m_feedPauses;
+    std::atomic<uint64_t> m_starts;
+    // Of the last play request in steady clock nanoseconds, and which of
+    // the events timed from it did not happen yet
+    std::atomic<int64_t> m_requestNs;
+    std::atomic<int> m_pending;
+    std::atomic<int64_t> m_startupUs;
+    std::atomic<int64_t> m_maxStartupUs;
+    std::atomic<int64_t> m_pausedUs;
+    std::atomic<int64_t> m_playingUs;
+    std::atomic<int64_t> m_maxPlayingUs;
+    std::atomic<int64_t> m_feederCpuNs;
+    std::atomic<uint64_t> m_scheduledStarts;
+    std::atomic<int64_t> m_startOffsetUs;
+    std::atomic<int64_t> m_maxStartOffsetUs;
+};
+#endif
@@ -0,0 +1,92 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "ReconnectBackoff.h"
+
+#include <algorithm>
+
+#define WEBSOCKET_CLOSE_NORMAL 1000
+
+ReconnectBackoff::ReconnectBackoff(int initialMs, int maxDelayMs, int giveUpMs, unsigned seed)
+    : m_initialMs(std::max(1, initialMs))
+    , m_maxDelayMs(std::max(m_initialMs, maxDelayMs))
+    , m_giveUpMs(std::max(0, giveUpMs))
+    , m_random(seed)
+    , m_inOutage(false)
+    , m_attempt(0)
+    , m_stats()
+{
+}
+
+bool ReconnectBackoff::reconnectsAfter(uint16_t closeCode)
+{
+    return closeCode != WEBSOCKET_CLOSE_NORMAL;
+}
+
+int ReconnectBackoff::nextDelayMs(Clock::time_point now)
+{
+    if(!m_inOutage)
+    {
+        m_inOutage = true;
+        m_outageStart = now;
+        m_attempt = 0;
+        m_stats.outages++;
+    }
+
+    // Doubled per attempt, without shifting past the cap
+    int ceiling = m_initialMs;
+    for(unsigned i = 0; i < m_attempt && ceiling < m_maxDelayMs; i++)
+        ceiling = std::min(m_maxDelayMs, ceiling * 2);
+    std::uniform_int_distribution<int> upperHalf(ceiling / 2, ceiling);
+    int delay = upperHalf(m_random);
+
+    double elapsed = std::chrono::duration<double, std::milli>(now - m_outageStart).count();
+    if(elapsed + delay > m_giveUpMs)
+    {
+        m_stats.givenUp++;
+        endOutage(now);
+        return -1;
+    }
+    m_attempt++;
+    m_stats.attempts++;
+    return delay;
+}
+
+void ReconnectBackoff::connected(Clock::time_point now)
+{
+    if(!m_inOutage)
+        return;
+    m_stats.reconnects++;
+    endOutage(now);
+}
+
+void ReconnectBackoff::reset()
+{
+    m_inOutage = false;
+    m_attempt = 0;
+}
+
+void ReconnectBackoff::endOutage(Clock::time_point now)
+{
+    double ms = std::chrono::duration<double, std::milli>(now - m_outageStart).count();
+    m_stats.outageMs += ms;
+    m_stats.maxOutageMs = std::max(m_stats.maxOutageMs, ms);
+    m_inOutage = false;
+    m_attempt = 0;
+}
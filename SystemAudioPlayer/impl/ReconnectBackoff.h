@@ -0,0 +1,79 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef RECONNECTBACKOFF_H_
+#define RECONNECTBACKOFF_H_
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+// When a websocket session reconnects after its connection dropped.
+//
+// The delay before each attempt doubles from initialMs up to maxDelayMs
+// and is drawn from its upper half, so players that lost the same server
+// do not come back all at once. The outage is given up once the next
+// attempt would start more than giveUpMs after the connection dropped.
+//
+// Not thread safe; AudioPlayer guards it with the web client mutex.
+class ReconnectBackoff
+{
+    public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Stats
+    {
+        uint64_t outages;
+        uint64_t attempts;
+        uint64_t reconnects;    // outages ended by a connection
+        uint64_t givenUp;
+        double outageMs;        // total of the ended outages
+        double maxOutageMs;
+    };
+
+    ReconnectBackoff(int initialMs, int maxDelayMs, int giveUpMs, unsigned seed = std::random_device()());
+
+    // Delay before the next attempt, starting an outage if none is going
+    // on; -1 once the outage is given up
+    int nextDelayMs(Clock::time_point now);
+    // Ends the outage, if any
+    void connected(Clock::time_point now);
+    // Forgets the outage without counting it, e.g. when the session stops
+    void reset();
+
+    // Whether a connection the server closed with closeCode is reconnected;
+    // a normal close (1000) ends the session rather than starting an outage
+    static bool reconnectsAfter(uint16_t closeCode);
+
+    bool inOutage() const { return m_inOutage; }
+    Stats stats() const { return m_stats; }
+
+    private:
+    void endOutage(Clock::time_point now);
+
+    int m_initialMs;
+    int m_maxDelayMs;
+    int m_giveUpMs;
+    std::minstd_rand m_random;
+    bool m_inOutage;
+    Clock::time_point m_outageStart;
+    unsigned m_attempt;
+    Stats m_stats;
+};
+#endif
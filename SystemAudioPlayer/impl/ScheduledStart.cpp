@@ -0,0 +1,49 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "ScheduledStart.h"
+
+#include <algorithm>
+#include <time.h>
+
+int64_t ScheduledStart::monotonicNowNs()
+{
+    struct timespec now;
+    if(clock_gettime(CLOCK_MONOTONIC, &now) != 0)
+        return 0;
+    return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+ScheduledStart::Plan ScheduledStart::plan(int64_t targetNs, int64_t monotonicNowNs, int64_t clockNowNs, int64_t latencyNs)
+{
+    int64_t lead = targetNs - monotonicNowNs;
+    latencyNs = std::max<int64_t>(0, latencyNs);
+
+    Plan plan;
+    plan.targetClock = clockNowNs + lead;
+    plan.baseTime = clockNowNs + std::max<int64_t>(0, lead - latencyNs);
+    plan.lateNs = std::max<int64_t>(0, latencyNs - lead);
+    return plan;
+}
+
+int64_t ScheduledStart::offsetNs(const Plan &plan, int64_t clockNowNs, int64_t positionNs)
+{
+    // Played out on time, the position is the time since the target
+    return clockNowNs - plan.targetClock - positionNs;
+}
@@ -0,0 +1,51 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef SCHEDULEDSTART_H_
+#define SCHEDULEDSTART_H_
+
+#include <cstdint>
+
+// Where a prerolled pipeline starts so that its first sample is heard at
+// a CLOCK_MONOTONIC time given by the client.
+//
+// The target is mapped onto the pipeline clock through the time left until
+// it, so the pipeline may use any clock. The base time is set that far
+// ahead, less the latency of the sink. A target too close or already past
+// starts at once instead: the sample is late, but not clipped, as it would
+// be with a base time in the past.
+class ScheduledStart
+{
+    public:
+    struct Plan
+    {
+        int64_t baseTime;       // on the pipeline clock
+        int64_t targetClock;    // the target on the pipeline clock
+        int64_t lateNs;         // how far behind the target the start is
+    };
+
+    static int64_t monotonicNowNs();
+
+    static Plan plan(int64_t targetNs, int64_t monotonicNowNs, int64_t clockNowNs, int64_t latencyNs);
+
+    // How far the output is behind the target, from the position played
+    // out by clockNowNs; negative if ahead
+    static int64_t offsetNs(const Plan &plan, int64_t clockNowNs, int64_t positionNs);
+};
+#endif
@@ -48,6 +48,16 @@ void SecuredWebSocketClient::disconnect()
     wsClient_.disconnect();
 }
 
+void SecuredWebSocketClient::pauseReading()
+{
+    wsClient_.pauseReading();
+}
+
+void SecuredWebSocketClient::resumeReading()
+{
+    wsClient_.resumeReading();
+}
+
 ConnectionType SecuredWebSocketClient::getConnectionType() const
 {
     return ConnectionType::Secured;
@@ -40,6 +40,8 @@ public:
     ~SecuredWebSocketClient();
     void connect(const std::string& uri) override;
     void disconnect() override;
+    void pauseReading() override;
+    void resumeReading() override;
     ConnectionType getConnectionType() const override;
 
 private:
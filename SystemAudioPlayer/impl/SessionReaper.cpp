@@ -0,0 +1,174 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "SessionReaper.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <utility>
+
+struct SessionReaper::State
+{
+    struct Job
+    {
+        int id;
+        Teardown teardown;
+    };
+
+    State() : running(true), busy(false), reaped(0), abandoned(0), peakPending(0), totalMs(0), maxMs(0) {}
+
+    size_t pending() const { return jobs.size() + (busy ? 1 : 0); }
+
+    std::mutex mutex;
+    std::condition_variable work;
+    std::condition_variable idle;
+    std::deque<Job> jobs;
+    Done done;
+    bool running;
+    bool busy;
+    uint64_t reaped;
+    uint64_t abandoned;
+    size_t peakPending;
+    double totalMs;
+    double maxMs;
+};
+
+SessionReaper::SessionReaper() : m_state(std::make_shared<State>())
+{
+}
+
+SessionReaper::~SessionReaper()
+{
+    if(m_thread.joinable())
+        shutdown(0);
+}
+
+void SessionReaper::setDone(const Done &done)
+{
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    m_state->done = done;
+}
+
+void SessionReaper::submit(int id, Teardown &&teardown)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if(m_state->running)
+        {
+            // Started with the first close
+            if(!m_thread.joinable())
+                m_thread = std::thread(&SessionReaper::run, m_state);
+            m_state->jobs.push_back(State::Job{ id, std::move(teardown) });
+            m_state->peakPending = std::max(m_state->peakPending, m_state->pending());
+            m_state->work.notify_one();
+            return;
+        }
+    }
+    SAPLOG_WARNING("SAP: Reaper shut down, tearing down player %d in place\n", id);
+    teardown();
+}
+
+bool SessionReaper::shutdown(int timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    m_state->running = false;
+    m_state->done = Done();
+    m_state->work.notify_all();
+    bool finished = m_state->idle.wait_for(lock, std::chrono::milliseconds(std::max(0, timeoutMs)),
+            [this] { return m_state->pending() == 0; });
+    if(!finished)
+    {
+        size_t left = m_state->pending();
+        m_state->abandoned += left;
+        // The players left behind are leaked rather than torn down here,
+        // where they could hang the caller just the same
+        static std::mutex graveyardMutex;
+        static std::deque<State::Job> *graveyard = new std::deque<State::Job>();
+        std::lock_guard<std::mutex> graveyardLock(graveyardMutex);
+        std::move(m_state->jobs.begin(), m_state->jobs.end(), std::back_inserter(*graveyard));
+        m_state->jobs.clear();
+        SAPLOG_ERROR("SAP: Reaper abandoned %zu player teardowns after %d ms\n", left, timeoutMs);
+    }
+    lock.unlock();
+
+    if(m_thread.joinable())
+    {
+        // A hung teardown keeps the thread, the rest of the state is shared
+        if(finished)
+            m_thread.join();
+        else
+            m_thread.detach();
+    }
+    return finished;
+}
+
+SessionReaper::Stats SessionReaper::stats()
+{
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    Stats stats;
+    stats.reaped = m_state->reaped;
+    stats.abandoned = m_state->abandoned;
+    stats.pending = m_state->pending();
+    stats.peakPending = m_state->peakPending;
+    stats.totalMs = m_state->totalMs;
+    stats.maxMs = m_state->maxMs;
+    return stats;
+}
+
+void SessionReaper::run(std::shared_ptr<State> state)
+{
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while(true)
+    {
+        state->work.wait(lock, [&state] { return !state->jobs.empty() || !state->running; });
+        if(state->jobs.empty())
+            break;
+        State::Job job = std::move(state->jobs.front());
+        state->jobs.pop_front();
+        state->busy = true;
+        lock.unlock();
+
+        auto start = std::chrono::steady_clock::now();
+        job.teardown();
+        // Whatever the teardown captured is released on this thread too
+        job.teardown = Teardown();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        lock.lock();
+        state->reaped++;
+        state->totalMs += ms;
+        state->maxMs = std::max(state->maxMs, ms);
+        // Still busy, so shutdown() waits for the callback as well
+        Done done = state->done;
+        if(done)
+        {
+            lock.unlock();
+            done(job.id, ms);
+            lock.lock();
+        }
+        state->busy = false;
+        if(state->pending() == 0)
+            state->idle.notify_all();
+    }
+}
@@ -0,0 +1,82 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef SESSIONREAPER_H_
+#define SESSIONREAPER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+
+// Tears closed players down on a thread of its own.
+//
+// Close only detaches a session; stopping the pipeline, joining its feeder
+// thread and disconnecting its websocket can take hundreds of milliseconds
+// and are left to the reaper, one session at a time in submission order.
+// Shutdown waits a bounded time for what is left; a teardown that hangs
+// past it is abandoned instead of blocking the caller.
+class SessionReaper
+{
+    public:
+    typedef std::function<void()> Teardown;
+    // Called on the reaper thread after the teardown of a session
+    typedef std::function<void(int id, double ms)> Done;
+
+    struct Stats
+    {
+        uint64_t reaped;
+        uint64_t abandoned;     // left behind by a shutdown that timed out
+        size_t pending;         // queued or in progress
+        size_t peakPending;
+        double totalMs;
+        double maxMs;
+    };
+
+    SessionReaper();
+    // Shuts down without waiting if shutdown() was not called
+    ~SessionReaper();
+
+    void setDone(const Done &done);
+
+    // Runs teardown on the reaper thread; after shutdown() it runs on the
+    // caller's
+    void submit(int id, Teardown &&teardown);
+
+    // Waits at most timeoutMs for the pending teardowns. Returns false and
+    // abandons what is left if they did not finish; no Done callback is
+    // made once this was called.
+    bool shutdown(int timeoutMs);
+
+    Stats stats();
+
+    private:
+    SessionReaper(const SessionReaper&) = delete;
+    SessionReaper& operator=(const SessionReaper&) = delete;
+
+    // Shared with the thread, which outlives the reaper if it is abandoned
+    struct State;
+
+    static void run(std::shared_ptr<State> state);
+
+    std::shared_ptr<State> m_state;
+    std::thread m_thread;
+};
+#endif
@@ -0,0 +1,274 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef SESSIONREGISTRY_H_
+#define SESSIONREGISTRY_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The open players by id, URL and group (the play mode), each with a lock
+// of its own.
+//
+// Lookups hand out refcounted handles and only hold the registry mutex for
+// the lookup, so a slow call on one session does not block the others. A
+// removed session stays alive until its last handle is dropped; calls
+// racing with its removal see it closed and leave it alone.
+template <typename Player>
+class SessionRegistry
+{
+    public:
+    class Session
+    {
+        public:
+        Session(int id, int group, Player *player) : m_id(id), m_group(group), m_player(player), m_closed(false) {}
+
+        int id() const { return m_id; }
+        int group() const { return m_group; }
+        // Safe to use without the lock for calls the player synchronizes
+        // itself, as long as the handle is held
+        Player* player() const { return m_player.get(); }
+        std::mutex& mutex() { return m_mutex; }
+        bool closed() const { return m_closed; }
+        // Under mutex()
+        void close() { m_closed = true; }
+
+        private:
+        Session(const Session&) = delete;
+        Session& operator=(const Session&) = delete;
+
+        const int m_id;
+        const int m_group;
+        std::unique_ptr<Player> m_player;
+        std::mutex m_mutex;
+        std::atomic<bool> m_closed;
+    };
+
+    typedef std::shared_ptr<Session> Handle;
+
+    // Holds the lock of a session for control calls; false if there is no
+    // such session or it was closed
+    class Locked
+    {
+        public:
+        explicit Locked(const Handle &session) : m_session(session)
+        {
+            if(m_session)
+                m_lock = std::unique_lock<std::mutex>(m_session->mutex());
+        }
+
+        explicit operator bool() const { return m_session && !m_session->closed(); }
+        Player* operator->() const { return m_session->player(); }
+        Player* get() const { return m_session->player(); }
+
+        private:
+        Handle m_session;
+        std::unique_lock<std::mutex> m_lock;
+    };
+
+    struct Stats
+    {
+        size_t sessions;
+        size_t peakSessions;
+        uint64_t lookups;
+        uint64_t misses;
+    };
+
+    SessionRegistry() : m_peakSessions(0), m_lookups(0), m_misses(0) {}
+
+    // Takes over player
+    Handle add(int id, int group, Player *player)
+    {
+        Handle session = std::make_shared<Session>(id, group, player);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sessions[id] = session;
+        m_groups[group].insert(id);
+        m_peakSessions = std::max(m_peakSessions, m_sessions.size());
+        return session;
+    }
+
+    Handle find(int id)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_lookups++;
+        auto it = m_sessions.find(id);
+        if(it == m_sessions.end())
+        {
+            m_misses++;
+            return Handle();
+        }
+        return it->second;
+    }
+
+    // The lowest id playing url
+    Handle findByUrl(const std::string &url)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_lookups++;
+        auto it = m_urls.find(url);
+        if(it == m_urls.end() || it->second.empty())
+        {
+            m_misses++;
+            return Handle();
+        }
+        return m_sessions[*it->second.begin()];
+    }
+
+    // What findByUrl finds the session by from now on
+    void setUrl(const Handle &session, const std::string &url)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_sessions.find(session->id()) == m_sessions.end())
+            return;
+        unindexUrl(session->id());
+        m_urls[url].insert(session->id());
+        m_urlOf[session->id()] = url;
+    }
+
+    // All sessions, in id order
+    std::vector<Handle> all()
+    {
+        std::vector<Handle> sessions;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        sessions.reserve(m_sessions.size());
+        for(auto &entry : m_sessions)
+            sessions.push_back(entry.second);
+        return sessions;
+    }
+
+    // The sessions of group, in id order
+    std::vector<Handle> group(int group)
+    {
+        std::vector<Handle> sessions;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_groups.find(group);
+        if(it == m_groups.end())
+            return sessions;
+        sessions.reserve(it->second.size());
+        for(int id : it->second)
+            sessions.push_back(m_sessions[id]);
+        return sessions;
+    }
+
+    // No longer found afterwards; the caller closes the returned session,
+    // which closing() lists until its player is destroyed
+    Handle remove(int id)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_sessions.find(id);
+        if(it == m_sessions.end())
+            return Handle();
+        Handle session = it->second;
+        m_sessions.erase(it);
+        m_groups[session->group()].erase(id);
+        unindexUrl(id);
+        pruneClosing();
+        m_closing[id] = session;
+        return session;
+    }
+
+    // The removed sessions of group whose player still exists, in id
+    // order; they may still be playing until whoever closed them stops them
+    std::vector<Handle> closing(int group)
+    {
+        std::vector<Handle> sessions;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pruneClosing();
+        for(auto &entry : m_closing)
+        {
+            Handle session = entry.second.lock();
+            if(session && session->group() == group)
+                sessions.push_back(session);
+        }
+        return sessions;
+    }
+
+    // Removes all sessions
+    std::vector<Handle> clear()
+    {
+        std::vector<Handle> sessions;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(auto &entry : m_sessions)
+            sessions.push_back(entry.second);
+        m_sessions.clear();
+        m_groups.clear();
+        m_urls.clear();
+        m_urlOf.clear();
+        m_closing.clear();
+        return sessions;
+    }
+
+    Stats stats()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stats stats;
+        stats.sessions = m_sessions.size();
+        stats.peakSessions = m_peakSessions;
+        stats.lookups = m_lookups;
+        stats.misses = m_misses;
+        return stats;
+    }
+
+    private:
+    void pruneClosing()
+    {
+        for(auto it = m_closing.begin(); it != m_closing.end();)
+        {
+            if(it->second.expired())
+                it = m_closing.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    void unindexUrl(int id)
+    {
+        auto it = m_urlOf.find(id);
+        if(it == m_urlOf.end())
+            return;
+        auto ids = m_urls.find(it->second);
+        if(ids != m_urls.end())
+        {
+            ids->second.erase(id);
+            if(ids->second.empty())
+                m_urls.erase(ids);
+        }
+        m_urlOf.erase(it);
+    }
+
+    std::mutex m_mutex;
+    std::map<int, Handle> m_sessions;
+    std::map<int, std::set<int>> m_groups;
+    std::unordered_map<std::string, std::set<int>> m_urls;
+    std::unordered_map<int, std::string> m_urlOf;
+    std::map<int, std::weak_ptr<Session>> m_closing;
+    size_t m_peakSessions;
+    uint64_t m_lookups;
+    uint64_t m_misses;
+};
+#endif
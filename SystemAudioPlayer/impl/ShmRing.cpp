@@ -0,0 +1,309 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "ShmRing.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC       0x0001U
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS   (1024 + 9)
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW   0x0004
+#endif
+
+#define SHM_RING_MIN_CAPACITY 4096
+#define SHM_RING_MAX_CAPACITY (64 * 1024 * 1024)
+
+namespace {
+
+size_t headerSize()
+{
+    // Data starts on its own page
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return (sizeof(ShmRingHeader) + page - 1) / page * page;
+}
+
+}
+
+ShmRing::ShmRing()
+    : m_fd(-1)
+    , m_base(MAP_FAILED)
+    , m_mappedSize(0)
+    , m_header(nullptr)
+    , m_data(nullptr)
+    , m_capacity(0)
+    , m_mask(0)
+    , m_flushPending(false)
+{
+}
+
+ShmRing::~ShmRing()
+{
+    if(m_header != nullptr)
+        close();
+    if(m_base != MAP_FAILED)
+        munmap(m_base, m_mappedSize);
+    if(m_fd >= 0)
+        ::close(m_fd);
+}
+
+bool ShmRing::map(int fd, size_t size)
+{
+    m_base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(m_base == MAP_FAILED)
+    {
+        SAPLOG_ERROR("SAP: ShmRing mmap of %zu bytes failed: %s\n", size, strerror(errno));
+        return false;
+    }
+    m_fd = fd;
+    m_mappedSize = size;
+    m_header = static_cast<ShmRingHeader*>(m_base);
+    return true;
+}
+
+std::unique_ptr<ShmRing> ShmRing::create(size_t capacity)
+{
+    uint32_t rounded = SHM_RING_MIN_CAPACITY;
+    while(rounded < capacity && rounded < SHM_RING_MAX_CAPACITY)
+        rounded <<= 1;
+
+#ifdef SYS_memfd_create
+    int fd = (int)syscall(SYS_memfd_create, "sap-shm-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+    int fd = -1;
+    errno = ENOSYS;
+#endif
+    if(fd < 0)
+    {
+        SAPLOG_ERROR("SAP: ShmRing memfd_create failed: %s\n", strerror(errno));
+        return nullptr;
+    }
+
+    size_t size = headerSize() + rounded;
+    std::unique_ptr<ShmRing> ring(new ShmRing());
+    if(ftruncate(fd, (off_t)size) != 0 || !ring->map(fd, size))
+    {
+        SAPLOG_ERROR("SAP: ShmRing setup of %zu bytes failed: %s\n", size, strerror(errno));
+        ::close(fd);
+        return nullptr;
+    }
+    // The client must not be able to truncate the file under our mapping
+    if(fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) != 0)
+        SAPLOG_WARNING("SAP: ShmRing could not seal memfd: %s\n", strerror(errno));
+
+    ShmRingHeader *header = new (ring->m_base) ShmRingHeader();
+    header->capacity = rounded;
+    header->dataOffset = (uint32_t)headerSize();
+    header->version = kVersion;
+    header->writePos.store(0);
+    header->dataSeq.store(0);
+    header->producerWaiting.store(0);
+    header->readPos.store(0);
+    header->spaceSeq.store(0);
+    header->consumerWaiting.store(0);
+    header->closed.store(0);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = kMagic;
+
+    ring->m_data = static_cast<char*>(ring->m_base) + header->dataOffset;
+    ring->m_capacity = rounded;
+    ring->m_mask = rounded - 1;
+    ring->m_path = "/proc/" + std::to_string(getpid()) + "/fd/" + std::to_string(fd);
+    SAPLOG_INFO("SAP: ShmRing of %u bytes at %s\n", rounded, ring->m_path.c_str());
+    return ring;
+}
+
+std::unique_ptr<ShmRing> ShmRing::attach(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if(fd < 0)
+    {
+        SAPLOG_ERROR("SAP: ShmRing cannot open %s: %s\n", path.c_str(), strerror(errno));
+        return nullptr;
+    }
+
+    struct stat st;
+    std::unique_ptr<ShmRing> ring(new ShmRing());
+    if(fstat(fd, &st) != 0 || (size_t)st.st_size < headerSize() || !ring->map(fd, (size_t)st.st_size))
+    {
+        ::close(fd);
+        return nullptr;
+    }
+
+    ShmRingHeader *header = ring->m_header;
+    uint32_t capacity = header->capacity;
+    if(header->magic != kMagic || header->version != kVersion || capacity == 0 || (capacity & (capacity - 1)) != 0
+            || (size_t)header->dataOffset + capacity > (size_t)st.st_size)
+    {
+        SAPLOG_ERROR("SAP: ShmRing %s is not a valid ring\n", path.c_str());
+        ring->m_header = nullptr;
+        return nullptr;
+    }
+
+    ring->m_data = static_cast<char*>(ring->m_base) + header->dataOffset;
+    ring->m_capacity = capacity;
+    ring->m_mask = capacity - 1;
+    ring->m_path = path;
+    return ring;
+}
+
+void ShmRing::wait(std::atomic<uint32_t> &word, uint32_t value, int timeoutMs)
+{
+    struct timespec timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_nsec = (timeoutMs % 1000) * 1000000L;
+    // Shared futex, the other side lives in another process
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, value, timeoutMs < 0 ? NULL : &timeout, NULL, 0);
+}
+
+void ShmRing::wake(std::atomic<uint32_t> &word)
+{
+    word.fetch_add(1);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+size_t ShmRing::write(const void *data, size_t length, int timeoutMs)
+{
+    const char *src = static_cast<const char*>(data);
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    size_t queued = 0;
+
+    while(queued < length && !isClosed())
+    {
+        uint32_t writePos = m_header->writePos.load(std::memory_order_relaxed);
+        uint32_t readPos = m_header->readPos.load(std::memory_order_acquire);
+        uint32_t len = (uint32_t)std::min(length - queued, (size_t)(m_capacity - (writePos - readPos)));
+        if(len != 0)
+        {
+            uint32_t offset = writePos & m_mask;
+            uint32_t first = std::min(len, m_capacity - offset);
+            memcpy(m_data + offset, src + queued, first);
+            memcpy(m_data, src + queued + first, len - first);
+            m_header->writePos.store(writePos + len);
+            if(m_header->consumerWaiting.load())
+                wake(m_header->dataSeq);
+            queued += len;
+            continue;
+        }
+
+        int remainingMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if(remainingMs <= 0)
+            break;
+        uint32_t seq = m_header->spaceSeq.load();
+        m_header->producerWaiting.store(1);
+        if(m_header->readPos.load() == readPos)
+            wait(m_header->spaceSeq, seq, remainingMs);
+        m_header->producerWaiting.store(0);
+    }
+    return queued;
+}
+
+uint32_t ShmRing::available(uint32_t readPos)
+{
+    uint32_t used = m_header->writePos.load(std::memory_order_acquire) - readPos;
+    if(used > m_capacity)
+    {
+        SAPLOG_ERROR("SAP: ShmRing %s corrupted (%u bytes queued), closing\n", m_path.c_str(), used);
+        close();
+        return 0;
+    }
+    return used;
+}
+
+size_t ShmRing::peek(const char *&data, size_t maxLength, int timeoutMs)
+{
+    uint32_t readPos = m_header->readPos.load(std::memory_order_relaxed);
+    if(m_flushPending.exchange(false))
+    {
+        readPos = m_header->writePos.load(std::memory_order_acquire);
+        m_header->readPos.store(readPos);
+        if(m_header->producerWaiting.load())
+            wake(m_header->spaceSeq);
+    }
+
+    uint32_t used = available(readPos);
+    if(used == 0 && !isClosed() && timeoutMs != 0)
+    {
+        uint32_t seq = m_header->dataSeq.load();
+        m_header->consumerWaiting.store(1);
+        if(available(readPos) == 0 && !isClosed())
+            wait(m_header->dataSeq, seq, timeoutMs);
+        m_header->consumerWaiting.store(0);
+        used = available(readPos);
+    }
+
+    if(used == 0 || isClosed())
+        return 0;
+
+    uint32_t offset = readPos & m_mask;
+    size_t len = std::min(std::min((size_t)used, (size_t)(m_capacity - offset)), maxLength);
+    data = m_data + offset;
+    return len;
+}
+
+void ShmRing::remove(size_t length)
+{
+    m_header->readPos.store(m_header->readPos.load(std::memory_order_relaxed) + (uint32_t)length);
+    if(m_header->producerWaiting.load())
+        wake(m_header->spaceSeq);
+}
+
+void ShmRing::clear()
+{
+    m_flushPending = true;
+}
+
+void ShmRing::close()
+{
+    if(m_header->closed.exchange(1) != 0)
+        return;
+    wake(m_header->dataSeq);
+    wake(m_header->spaceSeq);
+}
+
+bool ShmRing::isClosed() const
+{
+    return m_header->closed.load() != 0;
+}
+
+size_t ShmRing::count()
+{
+    uint32_t used = m_header->writePos.load(std::memory_order_acquire) - m_header->readPos.load(std::memory_order_acquire);
+    return std::min(used, m_capacity);
+}
+
+bool ShmRing::isEmpty()
+{
+    return count() == 0;
+}
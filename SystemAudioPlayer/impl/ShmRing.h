@@ -0,0 +1,117 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef SHMRING_H_
+#define SHMRING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Single producer / single consumer byte ring in a memfd shared with a
+// client process, used by "shm" players to take PCM without COM-RPC.
+//
+// SystemAudioPlayer creates the ring and hands out a path the client can
+// open (/proc/<pid>/fd/<fd>, so the client needs the same user as the
+// plugin or root). The client maps it with attach() and only ever calls
+// write(); the player thread reads in place with peek()/remove().
+//
+// The memfd starts with ShmRingHeader followed by the data area. Positions
+// are free running 32 bit counters; each side sleeps on a futex word of
+// the header and is only woken when it announced that it waits, so a
+// steady stream does no syscalls.
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "ShmRing needs lock free 32 bit atomics");
+
+struct ShmRingHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t dataOffset;
+    // Producer side
+    alignas(64) std::atomic<uint32_t> writePos;
+    std::atomic<uint32_t> dataSeq;          // futex word the consumer sleeps on
+    std::atomic<uint32_t> producerWaiting;
+    // Consumer side
+    alignas(64) std::atomic<uint32_t> readPos;
+    std::atomic<uint32_t> spaceSeq;         // futex word the producer sleeps on
+    std::atomic<uint32_t> consumerWaiting;
+    std::atomic<uint32_t> closed;
+};
+
+class ShmRing
+{
+    public:
+    static const uint32_t kMagic = 0x53415052;   // "SAPR"
+    static const uint32_t kVersion = 1;
+
+    // Player side: creates a ring of capacity bytes (rounded up to a power of two)
+    static std::unique_ptr<ShmRing> create(size_t capacity);
+    // Client side: maps the ring published at path
+    static std::unique_ptr<ShmRing> attach(const std::string &path);
+    ~ShmRing();
+
+    // Path a client process opens to attach
+    const std::string &path() const { return m_path; }
+    size_t capacity() const { return m_capacity; }
+
+    // Producer: waits up to timeoutMs for room, returns the bytes queued
+    size_t write(const void *data, size_t length, int timeoutMs);
+
+    // Consumer: points data at up to maxLength contiguous queued bytes and
+    // returns their count, waiting up to timeoutMs for data
+    size_t peek(const char *&data, size_t maxLength, int timeoutMs);
+    // Consumer: releases length bytes returned by peek()
+    void remove(size_t length);
+
+    // Drops everything queued so far; applied by the consumer on its next peek
+    void clear();
+    // Either side: no more data will be exchanged, wakes up both sides
+    void close();
+    bool isClosed() const;
+
+    bool isEmpty();
+    size_t count();
+
+    private:
+    ShmRing();
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    bool map(int fd, size_t size);
+    // Returns the readable bytes, closing the ring if the client wrote
+    // positions that cannot be valid
+    uint32_t available(uint32_t readPos);
+    static void wait(std::atomic<uint32_t> &word, uint32_t value, int timeoutMs);
+    static void wake(std::atomic<uint32_t> &word);
+
+    int m_fd;
+    void *m_base;
+    size_t m_mappedSize;
+    ShmRingHeader *m_header;
+    char *m_data;
+    // Local copies; the header could be rewritten by the other process
+    uint32_t m_capacity;
+    uint32_t m_mask;
+    std::atomic<bool> m_flushPending;
+    std::string m_path;
+};
+#endif
@@ -43,6 +43,16 @@ void UnsecuredWebSocketClient::disconnect()
     wsClient_.disconnect();
 }
 
+void UnsecuredWebSocketClient::pauseReading()
+{
+    wsClient_.pauseReading();
+}
+
+void UnsecuredWebSocketClient::resumeReading()
+{
+    wsClient_.resumeReading();
+}
+
 ConnectionType UnsecuredWebSocketClient::getConnectionType() const
 {
     return ConnectionType::Unsecured;
@@ -34,6 +34,8 @@ public:
     ~UnsecuredWebSocketClient();
     void connect(const std::string& uri) override;
     void disconnect() override;
+    void pauseReading() override;
+    void resumeReading() override;
     ConnectionType getConnectionType() const override;
 
 private:
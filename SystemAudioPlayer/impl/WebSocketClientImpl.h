@@ -23,6 +23,7 @@
 #include <functional>
 
 #include "AudioPlayer.h"
+#include "ReconnectBackoff.h"
 #include "logger.h"
 #include "WebSockets/WSEndpoint.h"
 #include "WebSockets/PingPong/PingPongEnabled.h"
@@ -40,6 +41,8 @@ public:
     explicit WebSocketClientImpl(AudioPlayer* player);
     void connect(const std::string& uri);
     void disconnect();
+    void pauseReading();
+    void resumeReading();
 
     WebSockets::WSEndpoint<
         WebSockets::Client,
@@ -53,8 +56,8 @@ private:
     WebSocketClientImpl& operator=(const WebSocketClientImpl&) = delete;
 
     void onServiceConnection(WebSockets::ConnectionInitializationResult result);
-    void onServiceDisconnected();
-    void onMessage(const std::string& msg);
+    void onServiceDisconnected(websocketpp::close::status::value code);
+    void onMessage(std::string&& msg);
     std::string removeProtocol(const std::string& uri) const;
     std::string ensureAddressHasPortNumber(std::string address) const;
 
@@ -83,7 +86,7 @@ void WebSocketClientImpl<Encryption>::connect(const std::string& uri)
 
     SAPLOG_INFO("Trying to connect to: %s", address.c_str());
     wsClient_.connect(address, std::bind(&WebSocketClientImpl<Encryption>::onServiceConnection, this, std::placeholders::_1),
-        std::bind(&WebSocketClientImpl<Encryption>::onServiceDisconnected, this));
+        std::bind(&WebSocketClientImpl<Encryption>::onServiceDisconnected, this, std::placeholders::_1));
 }
 
 template <template <typename, typename> typename Encryption>
@@ -94,11 +97,23 @@ void WebSocketClientImpl<Encryption>::disconnect()
 }
 
 template <template <typename, typename> typename Encryption>
-void WebSocketClientImpl<Encryption>::onMessage(const std::string& msg)
+void WebSocketClientImpl<Encryption>::pauseReading()
 {
-    const void* in = static_cast<const void*>(msg.c_str());
-    size_t len = msg.size();
-    player_->push_data(in, len);
+    if(connected_)
+        wsClient_.pauseReading();
+}
+
+template <template <typename, typename> typename Encryption>
+void WebSocketClientImpl<Encryption>::resumeReading()
+{
+    if(connected_)
+        wsClient_.resumeReading();
+}
+
+template <template <typename, typename> typename Encryption>
+void WebSocketClientImpl<Encryption>::onMessage(std::string&& msg)
+{
+    player_->push_message(std::move(msg));
 }
 
 template <template <typename, typename> typename Encryption>
@@ -119,11 +134,11 @@ void WebSocketClientImpl<Encryption>::onServiceConnection(WebSockets::Connection
 }
 
 template <template <typename, typename> typename Encryption>
-void WebSocketClientImpl<Encryption>::onServiceDisconnected()
+void WebSocketClientImpl<Encryption>::onServiceDisconnected(websocketpp::close::status::value code)
 {
-    SAPLOG_INFO("Websocket Connection Closed.");
+    SAPLOG_INFO("Websocket Connection Closed, code %u.", (unsigned)code);
     connected_ = false;
-    player_->wsConnectionStatus(WSStatus::DISCONNECTED);
+    player_->wsConnectionStatus(ReconnectBackoff::reconnectsAfter(code) ? WSStatus::DISCONNECTED : WSStatus::CLOSED);
 }
 
 template <template <typename, typename> typename Encryption>
@@ -24,6 +24,8 @@
 #include <cstdlib>
 #include <ctime>
 
+#include "UtilsAsyncLogWriter.h"
+
 #ifdef USE_RDK_LOGGER
 #include "rdk_debug.h"
 #endif
@@ -45,88 +47,40 @@ namespace SAP {
         return prettyFunction.substr(begin,end);
     }
 
-#ifdef USE_RDK_LOGGER
-
-    void logger_init()
-    {
-        sync_stdout();
-        SAP_logger_init("/etc/debug.ini");
-    }
-
-    void log(LogLevel level,
-            const char* func,
-            const char* file,
-            int line,
-            int, // thread id is already handled by SAP_logger
-            const char* format, ...)
-    {
-        const SAP_LogLevel levelMap[] =
-        {SAP_LOG_FATAL, SAP_LOG_ERROR, SAP_LOG_WARN, SAP_LOG_INFO, SAP_LOG_DEBUG, SAP_LOG_TRACE1};
-
-        const short kFormatMessageSize = 4096;
-        // SAPLogger is backed with log4c which has its own default level
-        // for filtering messages. Therefore, we don't check level here.
-        char userFormatted[kFormatMessageSize];
-        char finalFormatted[kFormatMessageSize];
-
-        va_list argptr;
-        va_start(argptr, format);
-        vsnprintf(userFormatted, kFormatMessageSize, format, argptr);
-        snprintf(finalFormatted, kFormatMessageSize, "%s:%s:%d %s", func,
-                basename(file),
-                line,
-                userFormatted);
-        va_end(argptr);
-
-        // Currently, we use customized layout 'comcast_dated_nocr' in log4c.
-        // This layout doesn't have trailing carriage return, so we need
-        // to add it explicitly.
-        // Once the default layout is used, this addition should be deleted.
-        RDK_LOG(levelMap[static_cast<int>(level)],
-                "LOG.RDK.SAP",
-                "%s\n",
-                finalFormatted);
-
-        if (FATAL_LEVEL == level)
-            std::abort();
-    }
-
-#else
-
-    static int gDefaultLogLevel = INFO_LEVEL;
-    // static int gDefaultLogLevel = VERBOSE_LEVEL;
-
-    void logger_init()
+    static int initialLogLevel()
     {
-        sync_stdout();
         const char* level = getenv("SAP_DEFAULT_LOG_LEVEL");
         if (level)
-            gDefaultLogLevel = static_cast<LogLevel>(atoi(level));
+            return atoi(level);
+#ifdef USE_RDK_LOGGER
+        // Left to log4c, whose level rdklogctrl can change at runtime
+        return TRACE_LEVEL;
+#else
+        return INFO_LEVEL;
+#endif
     }
 
-    void log(LogLevel level,
+    std::atomic<int> gLogLevel(initialLogLevel());
+
+    static const short kFormatMessageSize = 4096;
+
+    // Formats the complete log line into |buffer| and returns the number of
+    // characters the line needed, which may be larger than |size|.
+    static int formatLine(char* buffer, size_t size,
+            LogLevel level,
             const char* func,
             const char* file,
             int line,
             int threadID,
-            const char* format, ...)
+            const char* format, va_list args)
     {
-        if (gDefaultLogLevel < level)
-            return;
-
-        const char* levelMap[] = {"Fatal", "Error", "Warning", "Info", "Verbose", "Trace"};
-        const short kFormatMessageSize = 4096;
-        char formatted[kFormatMessageSize];
-
-        va_list argptr;
-        va_start(argptr, format);
-        vsnprintf(formatted, kFormatMessageSize, format, argptr);
-        va_end(argptr);
-
+        int prefix;
         char timestamp[0xFF] = {0};
         struct timespec spec;
         struct tm tm;
 
+        // Taken here on the logging thread, as the line may be written out
+        // by the asynchronous writer a drain interval later.
         clock_gettime(CLOCK_REALTIME, &spec);
         gmtime_r(&spec.tv_sec, &tm);
         long ms = spec.tv_nsec / 1.0e6;
@@ -139,32 +93,138 @@ namespace SAP {
                 tm.tm_min,
                 tm.tm_sec,
                 ms);
+#ifdef USE_RDK_LOGGER
+        (void) level;
+        prefix = snprintf(buffer, size, "%s [tid=%d] %s:%s:%d ",
+                timestamp, threadID, func, basename(file), line);
+#else
+        const char* levelMap[] = {"Fatal", "Error", "Warning", "Info", "Verbose", "Trace"};
 
         if (threadID)
         {
-            printf("%s [%s] [pid=%d,tid=%d] %s:%s:%d SAP: %s\n",
+            prefix = snprintf(buffer, size, "%s [%s] [pid=%d,tid=%d] %s:%s:%d SAP: ",
                     timestamp,
                     levelMap[static_cast<int>(level)],
                     getpid(),
                     threadID,
-                    func, basename(file), line,
-                    formatted);
+                    func, basename(file), line);
         }
         else
         {
-            printf("%s [%s] %s:%s:%d SAP: %s\n",
+            prefix = snprintf(buffer, size, "%s [%s] %s:%s:%d SAP: ",
                     timestamp,
                     levelMap[static_cast<int>(level)],
-                    func, basename(file), line,
-                    formatted);
+                    func, basename(file), line);
         }
+#endif
+        if (prefix < 0)
+            return prefix;
+        if (static_cast<size_t>(prefix) >= size)
+            return prefix + vsnprintf(NULL, 0, format, args);
+        return prefix + vsnprintf(buffer + prefix, size - prefix, format, args);
+    }
+
+#ifdef USE_RDK_LOGGER
+    static const SAP_LogLevel levelMap[] =
+    {SAP_LOG_FATAL, SAP_LOG_ERROR, SAP_LOG_WARN, SAP_LOG_INFO, SAP_LOG_DEBUG, SAP_LOG_TRACE1};
+#endif
 
+    static void emitLine(int level, const char* text)
+    {
+#ifdef USE_RDK_LOGGER
+        // Currently, we use customized layout 'comcast_dated_nocr' in log4c.
+        // This layout doesn't have trailing carriage return, so we need
+        // to add it explicitly.
+        // Once the default layout is used, this addition should be deleted.
+        RDK_LOG(levelMap[level],
+                "LOG.RDK.SAP",
+                "%s\n",
+                text);
+#else
+        (void) level;
+        fputs(text, stdout);
+        fputc('\n', stdout);
+#endif
+    }
+
+    // Writer of this plugin's log lines, see Utils::AsyncLogWriter
+    struct LogSink {
+        static void emit(int level, const char* text) { emitLine(level, text); }
+    };
+    typedef Utils::AsyncLogWriter<LogSink> AsyncLogWriter;
+
+    static bool gSyncLogging = (getenv("SAP_LOG_SYNC") != NULL);
+
+    static void logger_flush()
+    {
+        AsyncLogWriter* writer = AsyncLogWriter::instance();
+        if (writer)
+            writer->flush();
         fflush(stdout);
+    }
+
+    void logger_init()
+    {
+        sync_stdout();
+#ifdef USE_RDK_LOGGER
+        SAP_logger_init("/etc/debug.ini");
+#else
+        gLogLevel.store(initialLogLevel(), std::memory_order_relaxed);
+#endif
+    }
+
+    void log(LogLevel level,
+            const char* func,
+            const char* file,
+            int line,
+            int threadID,
+            const char* format, ...)
+    {
+        if (!isLogEnabled(level))
+            return;
+#ifdef USE_RDK_LOGGER
+        // Asked on every call rather than cached in gLogLevel, so a level
+        // changed through rdklogctrl applies at once; nothing is formatted
+        // for a disabled level.
+        if (!rdk_dbg_enabled("LOG.RDK.SAP", levelMap[level]))
+            return;
+#endif
+
+        va_list argptr;
+        AsyncLogWriter* writer = (gSyncLogging || FATAL_LEVEL == level) ? nullptr : AsyncLogWriter::instance();
+        if (writer) {
+            AsyncLogWriter::Ring& ring = writer->ring();
+            AsyncLogWriter::Record* record = ring.reserve();
+            if (record) {
+                va_start(argptr, format);
+                int length = formatLine(record->text, sizeof(record->text), level, func, file, line, threadID, format, argptr);
+                va_end(argptr);
+                if (length >= 0 && static_cast<size_t>(length) < sizeof(record->text)) {
+                    record->level = level;
+                    ring.commit();
+                    writer->wakeup();
+                    return;
+                }
+            }
+        }
+
+        // Synchronous path: FATAL, ring full or line longer than a record
+        char formatted[kFormatMessageSize];
+        va_start(argptr, format);
+        formatLine(formatted, sizeof(formatted), level, func, file, line, threadID, format, argptr);
+        va_end(argptr);
+
+        if (writer) {
+            writer->writeThrough(level, formatted);
+        } else {
+            if (FATAL_LEVEL == level)
+                logger_flush();
+            emitLine(level, formatted);
+            fflush(stdout);
+        }
 
         if (FATAL_LEVEL == level)
             std::abort();
     }
 
-#endif // USE_SAP_LOGGER
-
 } // namespace SAP
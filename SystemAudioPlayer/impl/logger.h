@@ -20,6 +20,7 @@
 #ifndef SAP_LOGGER_H
 #define SAP_LOGGER_H
 
+#include <atomic>
 #include <iostream>
 #include <string>
 #include <stdlib.h>
@@ -46,6 +47,19 @@ enum LogLevel {FATAL_LEVEL = 0, ERROR_LEVEL, WARNING_LEVEL, INFO_LEVEL, VERBOSE_
  */
 void logger_init();
 
+/**
+ * Most verbose level that is currently emitted. Checked by the log macros
+ * before any argument is evaluated or formatted. With the RDK logger it is
+ * left at TRACE unless set here, and the log4c level, which can change at
+ * runtime, is checked before formatting.
+ */
+extern std::atomic<int> gLogLevel;
+
+inline bool isLogEnabled(LogLevel level)
+{
+    return static_cast<int>(level) <= gLogLevel.load(std::memory_order_relaxed);
+}
+
 #define SAP_assert(expr) do { \
       if ( __builtin_expect(expr, true) ) \
         {} \
@@ -58,6 +72,11 @@ void logger_init();
  * The function is defined by logging backend.
  * Currently 2 variants are supported: TTS_logger (USE_TTS_LOGGER),
  *                                     stdout(default)
+ * The message is formatted on the calling thread into a per-thread ring and
+ * written out by a background writer thread. FATAL messages, messages that do
+ * not fit into a ring record and messages logged while the ring is full are
+ * written synchronously. Set <PREFIX>_LOG_SYNC in the environment to write
+ * every message synchronously.
  */
 void log(LogLevel level,
     const char* func,
@@ -66,19 +85,12 @@ void log(LogLevel level,
     int threadID,
     const char* format, ...);
 
-#ifdef USE_RDK_LOGGER
-#define _LOG(LEVEL, FORMAT, ...)          \
-         SAP::log(LEVEL,                       \
-         __func__, __FILE__, __LINE__, 0, \
-         FORMAT,                          \
-         ##__VA_ARGS__)
-#else
 #define _LOG(LEVEL, FORMAT, ...)          \
+    do { if (SAP::isLogEnabled(LEVEL))    \
          SAP::log(LEVEL,                       \
          __func__, __FILE__, __LINE__, syscall(__NR_gettid), \
          FORMAT,                          \
-         ##__VA_ARGS__)
-#endif
+         ##__VA_ARGS__); } while (0)
 
 #define SAPLOG_TRACE(FMT, ...)   _LOG(SAP::TRACE_LEVEL, FMT, ##__VA_ARGS__)
 #define SAPLOG_VERBOSE(FMT, ...) _LOG(SAP::VERBOSE_LEVEL, FMT, ##__VA_ARGS__)
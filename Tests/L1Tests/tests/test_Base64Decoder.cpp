@@ -0,0 +1,218 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "impl/Base64Decoder.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The scalar decoder PlayBuffer used before (trower-base64 b64_decode)
+int legacyValue(uint8_t ch)
+{
+    if(ch >= 'A' && ch <= 'Z')
+        return ch - 'A';
+    if(ch >= 'a' && ch <= 'z')
+        return ch - 'a' + 26;
+    if(ch >= '0' && ch <= '9')
+        return ch - '0' + 52;
+    if(ch == '+')
+        return 62;
+    if(ch == '/')
+        return 63;
+    return -1;
+}
+
+size_t legacyDecode(const uint8_t *input, size_t inputSize, uint8_t *output)
+{
+    if(input == nullptr || output == nullptr || inputSize < 4 || inputSize % 4 != 0)
+        return 0;
+
+    size_t written = 0;
+    for(size_t i = 0; i < inputSize; i += 4) {
+        int value[4];
+        int padding = 0;
+        for(int j = 0; j < 4; j++) {
+            value[j] = legacyValue(input[i + j]);
+            if(value[j] >= 0) {
+                if(padding)
+                    return 0;
+            } else if(input[i + j] == '=' && i + 4 == inputSize && j >= 2) {
+                value[j] = 0;
+                padding++;
+            } else {
+                return 0;
+            }
+        }
+        uint32_t group = (value[0] << 18) | (value[1] << 12) | (value[2] << 6) | value[3];
+        output[written++] = (uint8_t)(group >> 16);
+        if(padding < 2)
+            output[written++] = (uint8_t)(group >> 8);
+        if(padding < 1)
+            output[written++] = (uint8_t)group;
+    }
+    return written;
+}
+
+std::string encode(const std::vector<uint8_t> &data)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string result;
+    size_t i = 0;
+    for(; i + 3 <= data.size(); i += 3) {
+        uint32_t group = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        result += alphabet[(group >> 18) & 0x3F];
+        result += alphabet[(group >> 12) & 0x3F];
+        result += alphabet[(group >> 6) & 0x3F];
+        result += alphabet[group & 0x3F];
+    }
+    if(i < data.size()) {
+        uint32_t group = data[i] << 16;
+        if(i + 1 < data.size())
+            group |= data[i + 1] << 8;
+        result += alphabet[(group >> 18) & 0x3F];
+        result += alphabet[(group >> 12) & 0x3F];
+        result += (i + 1 < data.size()) ? alphabet[(group >> 6) & 0x3F] : '=';
+        result += '=';
+    }
+    return result;
+}
+
+std::vector<uint8_t> randomBytes(size_t size, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::vector<uint8_t> data(size);
+    for(auto &byte : data)
+        byte = (uint8_t)generator();
+    return data;
+}
+
+// Decodes with both decoders and checks they agree
+void expectSameAsLegacy(const std::string &input)
+{
+    std::vector<uint8_t> expected(Base64Decoder::decodedSize(input.size()) + 1);
+    std::vector<uint8_t> actual(Base64Decoder::decodedSize(input.size()) + 1);
+    size_t expectedSize = legacyDecode((const uint8_t*)input.data(), input.size(), expected.data());
+    size_t actualSize = Base64Decoder::decode(input.data(), input.size(), actual.data());
+    ASSERT_EQ(expectedSize, actualSize) << input.size() << " characters";
+    EXPECT_EQ(0, memcmp(expected.data(), actual.data(), actualSize));
+}
+
+}
+
+TEST(SAPBase64DecoderTest, KnownVectors)
+{
+    uint8_t out[16];
+    EXPECT_EQ(6u, Base64Decoder::decode("Zm9vYmFy", 8, out));
+    EXPECT_EQ(0, memcmp("foobar", out, 6));
+    EXPECT_EQ(5u, Base64Decoder::decode("Zm9vYmE=", 8, out));
+    EXPECT_EQ(0, memcmp("fooba", out, 5));
+    EXPECT_EQ(4u, Base64Decoder::decode("Zm9vYg==", 8, out));
+    EXPECT_EQ(0, memcmp("foob", out, 4));
+    EXPECT_EQ(2u, Base64Decoder::decode("+/8=", 4, out));
+    EXPECT_EQ(0xFB, out[0]);
+    EXPECT_EQ(0xFF, out[1]);
+}
+
+TEST(SAPBase64DecoderTest, MatchesLegacyOnAllLengths)
+{
+    // Covers the scalar tail after every number of SIMD blocks
+    for(size_t size = 1; size < 400; size++)
+        expectSameAsLegacy(encode(randomBytes(size, size)));
+}
+
+TEST(SAPBase64DecoderTest, RejectsMalformedInput)
+{
+    std::string valid = encode(randomBytes(300, 7));
+    expectSameAsLegacy("");
+    expectSameAsLegacy(valid.substr(0, valid.size() - 1));
+    expectSameAsLegacy("Zg=a");
+    expectSameAsLegacy("Z===");
+    expectSameAsLegacy("Zg==Zg==");
+
+    // An invalid character in every position of a SIMD block or the tail
+    for(size_t pos = 0; pos < valid.size(); pos += 7) {
+        for(char bad : {'=', '-', '_', ' ', '\n', '\0', (char)0x80, (char)0xFF}) {
+            std::string broken = valid;
+            broken[pos] = bad;
+            expectSameAsLegacy(broken);
+        }
+    }
+}
+
+TEST(SAPBase64DecoderTest, PooledBufferIsReused)
+{
+    std::string input = encode(randomBytes(4096, 3));
+    size_t decoded = 0;
+    const uint8_t *first = Base64Decoder::decodePooled(input.data(), input.size(), decoded);
+    EXPECT_EQ(4096u, decoded);
+    const uint8_t *second = Base64Decoder::decodePooled(input.data(), input.size(), decoded);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(0, memcmp(randomBytes(4096, 3).data(), second, decoded));
+}
+
+/**
+ * @name  : ThroughputVersusLegacyDecoder
+ * @brief : Decodes typical PlayBuffer chunk sizes (20ms to 500ms of 48kHz
+ *          stereo S16LE) with the legacy decoder and with Base64Decoder,
+ *          printing the throughput of both. Nothing is asserted on timings,
+ *          so it is disabled; pass --gtest_also_run_disabled_tests to run it.
+ */
+TEST(SAPBase64DecoderTest, DISABLED_ThroughputVersusLegacyDecoder)
+{
+    const size_t chunkSizes[] = { 3840, 19200, 96000 };
+    const size_t totalBytes = 64 * 1024 * 1024;
+
+    for(size_t chunk : chunkSizes) {
+        std::string input = encode(randomBytes(chunk, 11));
+        size_t rounds = totalBytes / chunk;
+
+        size_t legacyDecoded = 0;
+        auto start = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < rounds; i++) {
+            // The legacy path copied the string and allocated the output per call
+            std::vector<uint8_t> copy(input.begin(), input.end());
+            uint8_t *workspace = new uint8_t[Base64Decoder::decodedSize(copy.size())];
+            legacyDecoded += legacyDecode(copy.data(), copy.size(), workspace);
+            delete[] workspace;
+        }
+        double legacyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        size_t simdDecoded = 0;
+        start = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < rounds; i++) {
+            size_t decoded = 0;
+            Base64Decoder::decodePooled(input.data(), input.size(), decoded);
+            simdDecoded += decoded;
+        }
+        double simdMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        printf("[ BENCH    ] %6zu byte chunks: legacy %.0f MB/s, Base64Decoder %.0f MB/s\n", chunk,
+            totalBytes / 1048576.0 / (legacyMs / 1000), totalBytes / 1048576.0 / (simdMs / 1000));
+        EXPECT_EQ(rounds * chunk, legacyDecoded);
+        EXPECT_EQ(rounds * chunk, simdDecoded);
+    }
+}
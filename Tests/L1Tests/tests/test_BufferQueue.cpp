@@ -0,0 +1,254 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "impl/BufferQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Drains queue until total bytes were read, checking they follow the
+// pattern written by fillPattern()
+size_t drain(BufferQueue &queue, size_t total, bool &intact)
+{
+    size_t read = 0;
+    intact = true;
+    while(read < total) {
+        const char *data = nullptr;
+        size_t len = queue.peek(data, 4096, true);
+        if(len == 0)
+            break;
+        for(size_t i = 0; i < len; i++) {
+            if(data[i] != (char)((read + i) & 0xFF))
+                intact = false;
+        }
+        queue.remove(len);
+        read += len;
+    }
+    return read;
+}
+
+void fillPattern(std::vector<char> &chunk, size_t offset)
+{
+    for(size_t i = 0; i < chunk.size(); i++)
+        chunk[i] = (char)((offset + i) & 0xFF);
+}
+
+// The queue BufferQueue replaced: one heap chunk per push behind a lock
+class LegacyQueue {
+public:
+    void add(const void *data, size_t length, std::atomic<uint64_t> &allocations)
+    {
+        std::pair<char*, size_t> *item = new std::pair<char*, size_t>(new char[length], length);
+        allocations += 2;
+        memcpy(item->first, data, length);
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queue.push(item);
+        _condition.notify_one();
+    }
+
+    std::pair<char*, size_t> *remove()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait(lock, [this] { return !_queue.empty(); });
+        std::pair<char*, size_t> *item = _queue.front();
+        _queue.pop();
+        return item;
+    }
+
+private:
+    std::queue<std::pair<char*, size_t>*> _queue;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+};
+
+const size_t kChunk = 3840;             // 20ms of 48kHz stereo S16LE
+const size_t kTotal = kChunk * 65536;   // ~21 minutes of audio
+
+}
+
+TEST(SAPBufferQueueTest, WrapsAroundArena)
+{
+    BufferQueue queue(4096);
+    ASSERT_EQ(4096u, queue.capacity());
+
+    std::vector<char> chunk(3000);
+    fillPattern(chunk, 0);
+    EXPECT_TRUE(queue.tryAdd(chunk.data(), chunk.size()));
+    bool intact = false;
+    EXPECT_EQ(3000u, drain(queue, 3000, intact));
+    EXPECT_TRUE(intact);
+
+    // Second chunk straddles the end of the arena and comes back in two parts
+    fillPattern(chunk, 3000);
+    EXPECT_TRUE(queue.tryAdd(chunk.data(), chunk.size()));
+    const char *data = nullptr;
+    EXPECT_EQ(1096u, queue.peek(data, 4096, false));
+    queue.remove(1096);
+    EXPECT_EQ(1904u, queue.peek(data, 4096, false));
+    EXPECT_EQ((char)((3000 + 1096) & 0xFF), data[0]);
+    queue.remove(1904);
+    EXPECT_TRUE(queue.isEmpty());
+}
+
+TEST(SAPBufferQueueTest, TryAddIsAllOrNothing)
+{
+    BufferQueue queue(4096);
+    std::vector<char> chunk(3000);
+    EXPECT_TRUE(queue.tryAdd(chunk.data(), chunk.size()));
+    EXPECT_FALSE(queue.tryAdd(chunk.data(), chunk.size()));
+    EXPECT_EQ(3000u, queue.count());
+    EXPECT_EQ(1096u, queue.add(chunk.data(), chunk.size(), 10));
+    EXPECT_TRUE(queue.isFull());
+}
+
+TEST(SAPBufferQueueTest, ClearDropsOnlyQueuedBytes)
+{
+    BufferQueue queue(4096);
+    std::vector<char> chunk(1000, 'a');
+    EXPECT_TRUE(queue.tryAdd(chunk.data(), chunk.size()));
+    queue.clear();
+    EXPECT_EQ(0u, queue.count());
+
+    chunk.assign(500, 'b');
+    EXPECT_TRUE(queue.tryAdd(chunk.data(), chunk.size()));
+    const char *data = nullptr;
+    EXPECT_EQ(500u, queue.peek(data, 4096, false));
+    EXPECT_EQ('b', data[0]);
+}
+
+TEST(SAPBufferQueueTest, PreDeleteWakesConsumer)
+{
+    BufferQueue queue(4096);
+    std::thread consumer([&queue] {
+        const char *data = nullptr;
+        EXPECT_EQ(0u, queue.peek(data, 4096, true));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    queue.preDelete();
+    consumer.join();
+}
+
+TEST(SAPBufferQueueTest, ClearWakesWaitingProducer)
+{
+    BufferQueue queue(4096);
+    std::vector<char> chunk(4096, 'a');
+    ASSERT_TRUE(queue.tryAdd(chunk.data(), chunk.size()));
+
+    // Nothing drains the queue, so only the clear ends the wait
+    size_t queued = 1;
+    std::chrono::steady_clock::duration waited;
+    std::thread producer([&] {
+        auto start = std::chrono::steady_clock::now();
+        queued = queue.add(chunk.data(), chunk.size(), 5000);
+        waited = std::chrono::steady_clock::now() - start;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    queue.clear();
+    producer.join();
+    EXPECT_EQ(0u, queued);
+    EXPECT_LT(waited, std::chrono::milliseconds(2000));
+
+    // Adds after the clear go through
+    const char *data = nullptr;
+    EXPECT_EQ(0u, queue.peek(data, 4096, false));
+    EXPECT_EQ(100u, queue.add(chunk.data(), 100, 0));
+}
+
+TEST(SAPBufferQueueTest, BlockingProducerConsumer)
+{
+    BufferQueue queue(64 * 1024);
+    const size_t total = 8 * 1024 * 1024;
+    bool intact = false;
+    size_t read = 0;
+    std::thread consumer([&] { read = drain(queue, total, intact); });
+
+    std::vector<char> chunk(kChunk);
+    for(size_t offset = 0; offset < total; offset += kChunk) {
+        chunk.resize(std::min(kChunk, total - offset));
+        fillPattern(chunk, offset);
+        ASSERT_EQ(chunk.size(), queue.add(chunk.data(), chunk.size(), 1000));
+    }
+    consumer.join();
+    EXPECT_EQ(total, read);
+    EXPECT_TRUE(intact);
+}
+
+/**
+ * @name  : ThroughputVersusLegacyQueue
+ * @brief : Streams 240MB of 20ms PCM chunks through BufferQueue and through
+ *          the per-chunk heap queue it replaced, printing throughput and
+ *          data path allocations. Nothing is asserted on the timings; a
+ *          benchmark, run it with --gtest_also_run_disabled_tests.
+ */
+TEST(SAPBufferQueueTest, DISABLED_ThroughputVersusLegacyQueue)
+{
+    std::vector<char> chunk(kChunk, 0x55);
+    char sink[kChunk];
+
+    std::atomic<uint64_t> legacyAllocations(0);
+    LegacyQueue legacy;
+    auto start = std::chrono::steady_clock::now();
+    std::thread legacyConsumer([&] {
+        for(size_t read = 0; read < kTotal; ) {
+            std::pair<char*, size_t> *item = legacy.remove();
+            memcpy(sink, item->first, item->second);
+            read += item->second;
+            delete[] item->first;
+            delete item;
+        }
+    });
+    for(size_t written = 0; written < kTotal; written += kChunk)
+        legacy.add(chunk.data(), kChunk, legacyAllocations);
+    legacyConsumer.join();
+    double legacyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    BufferQueue queue(2 * 48000 * 2 * 2);
+    start = std::chrono::steady_clock::now();
+    std::thread consumer([&] {
+        for(size_t read = 0; read < kTotal; ) {
+            const char *data = nullptr;
+            size_t len = queue.peek(data, kChunk, true);
+            memcpy(sink, data, len);
+            queue.remove(len);
+            read += len;
+        }
+    });
+    for(size_t written = 0; written < kTotal; written += kChunk)
+        queue.add(chunk.data(), kChunk, 1000);
+    consumer.join();
+    double ringMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printf("[ BENCH    ] legacy queue: %.0f MB/s, %llu allocations\n",
+        kTotal / 1048576.0 / (legacyMs / 1000), (unsigned long long)legacyAllocations.load());
+    printf("[ BENCH    ] BufferQueue:  %.0f MB/s, 1 allocation (%zu byte arena)\n",
+        kTotal / 1048576.0 / (ringMs / 1000), queue.capacity());
+    EXPECT_TRUE(queue.isEmpty());
+}
@@ -0,0 +1,243 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "impl/EarconCache.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+void putLE16(std::vector<uint8_t> &out, uint16_t value)
+{
+    out.push_back(value & 0xFF);
+    out.push_back(value >> 8);
+}
+
+void putLE32(std::vector<uint8_t> &out, uint32_t value)
+{
+    for(int i = 0; i < 4; i++)
+        out.push_back((value >> (8 * i)) & 0xFF);
+}
+
+void putTag(std::vector<uint8_t> &out, const char *tag)
+{
+    out.insert(out.end(), tag, tag + 4);
+}
+
+// RIFF WAVE file with a "LIST" chunk of odd size before the samples
+std::vector<uint8_t> makeWav(uint16_t tag, uint16_t channels, uint32_t rate, uint16_t bits, const std::vector<uint8_t> &samples)
+{
+    std::vector<uint8_t> fmt;
+    uint16_t blockAlign = channels * bits / 8;
+    putLE16(fmt, tag == 0xFFFE ? 0xFFFE : tag);
+    putLE16(fmt, channels);
+    putLE32(fmt, rate);
+    putLE32(fmt, rate * blockAlign);
+    putLE16(fmt, blockAlign);
+    putLE16(fmt, bits);
+    if(tag == 0xFFFE) {
+        putLE16(fmt, 22);
+        putLE16(fmt, bits);
+        putLE32(fmt, 3);
+        // KSDATAFORMAT_SUBTYPE_IEEE_FLOAT
+        putLE16(fmt, 0x0003);
+        const uint8_t guid[] = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 };
+        fmt.insert(fmt.end(), guid, guid + sizeof(guid));
+    }
+
+    std::vector<uint8_t> body;
+    putTag(body, "WAVE");
+    putTag(body, "fmt ");
+    putLE32(body, fmt.size());
+    body.insert(body.end(), fmt.begin(), fmt.end());
+    putTag(body, "LIST");
+    putLE32(body, 3);
+    body.insert(body.end(), { 'a', 'b', 'c', 0 });
+    putTag(body, "data");
+    putLE32(body, samples.size());
+    body.insert(body.end(), samples.begin(), samples.end());
+
+    std::vector<uint8_t> file;
+    putTag(file, "RIFF");
+    putLE32(file, body.size());
+    file.insert(file.end(), body.begin(), body.end());
+    return file;
+}
+
+std::vector<uint8_t> ramp(size_t size, uint8_t seed)
+{
+    std::vector<uint8_t> samples(size);
+    for(size_t i = 0; i < size; i++)
+        samples[i] = (uint8_t)(i * 7 + seed);
+    return samples;
+}
+
+class TempFile
+{
+    public:
+    explicit TempFile(const std::vector<uint8_t> &content)
+    {
+        char name[] = "/tmp/sap-earcon-XXXXXX";
+        int fd = mkstemp(name);
+        close(fd);
+        m_path = name;
+        write(content);
+    }
+    ~TempFile() { unlink(m_path.c_str()); }
+
+    void write(const std::vector<uint8_t> &content)
+    {
+        std::ofstream file(m_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(content.data()), content.size());
+    }
+    const std::string &path() const { return m_path; }
+
+    private:
+    std::string m_path;
+};
+
+}
+
+TEST(SAPEarconCacheTest, DecodesPcmWav)
+{
+    std::vector<uint8_t> samples = ramp(4410 * 4, 1);
+    TempFile file(makeWav(1, 2, 44100, 16, samples));
+
+    Earcon earcon;
+    ASSERT_TRUE(EarconCache::decodeWav(file.path(), 1 << 20, earcon));
+    EXPECT_EQ("S16LE", earcon.format);
+    EXPECT_EQ(44100, earcon.rate);
+    EXPECT_EQ(2, earcon.channels);
+    EXPECT_EQ(samples, earcon.data);
+}
+
+TEST(SAPEarconCacheTest, DecodesExtensibleFloatWav)
+{
+    std::vector<uint8_t> samples = ramp(480 * 4, 2);
+    TempFile file(makeWav(0xFFFE, 1, 48000, 32, samples));
+
+    Earcon earcon;
+    ASSERT_TRUE(EarconCache::decodeWav(file.path(), 1 << 20, earcon));
+    EXPECT_EQ("F32LE", earcon.format);
+    EXPECT_EQ(48000, earcon.rate);
+    EXPECT_EQ(1, earcon.channels);
+    EXPECT_EQ(samples, earcon.data);
+}
+
+TEST(SAPEarconCacheTest, RejectsUnsupportedOrOversizedWav)
+{
+    Earcon earcon;
+    TempFile adpcm(makeWav(2, 1, 8000, 4, ramp(100, 3)));
+    EXPECT_FALSE(EarconCache::decodeWav(adpcm.path(), 1 << 20, earcon));
+    TempFile big(makeWav(1, 1, 8000, 16, ramp(4000, 3)));
+    EXPECT_FALSE(EarconCache::decodeWav(big.path(), 2000, earcon));
+    TempFile mp3({ 'I', 'D', '3', 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 });
+    EXPECT_FALSE(EarconCache::decodeWav(mp3.path(), 1 << 20, earcon));
+    EXPECT_FALSE(EarconCache::decodeWav("/nonexistent/earcon.wav", 1 << 20, earcon));
+}
+
+TEST(SAPEarconCacheTest, DisabledCacheReturnsNothing)
+{
+    TempFile file(makeWav(1, 1, 8000, 16, ramp(800, 4)));
+    EarconCache cache;
+    EXPECT_FALSE(cache.enabled());
+    EXPECT_EQ(nullptr, cache.get(file.path()));
+}
+
+TEST(SAPEarconCacheTest, HitsAndLruEviction)
+{
+    TempFile first(makeWav(1, 1, 8000, 16, ramp(4000, 5)));
+    TempFile second(makeWav(1, 1, 8000, 16, ramp(4000, 6)));
+    TempFile third(makeWav(1, 1, 8000, 16, ramp(4000, 7)));
+    EarconCache cache(10000, 5000);
+
+    auto clip = cache.get(first.path());
+    ASSERT_NE(nullptr, clip);
+    EXPECT_EQ(clip, cache.get(first.path()));
+    ASSERT_NE(nullptr, cache.get(second.path()));
+    // first is now the most recently used, so third pushes out second
+    cache.get(first.path());
+    ASSERT_NE(nullptr, cache.get(third.path()));
+
+    EarconCache::Stats stats = cache.stats();
+    EXPECT_EQ(2u, stats.hits);
+    EXPECT_EQ(3u, stats.misses);
+    EXPECT_EQ(1u, stats.evictions);
+    EXPECT_EQ(2u, stats.clips);
+    EXPECT_EQ(8000u, stats.bytes);
+
+    cache.get(first.path());
+    cache.get(second.path());
+    EXPECT_EQ(3u, cache.stats().hits);
+    EXPECT_EQ(4u, cache.stats().misses);
+    // Evicted clips stay valid for whoever still plays them
+    EXPECT_EQ(ramp(4000, 5), clip->data);
+}
+
+TEST(SAPEarconCacheTest, ClipOverBudgetIsRejected)
+{
+    TempFile big(makeWav(1, 1, 8000, 16, ramp(6000, 8)));
+    EarconCache cache(10000, 5000);
+    EXPECT_EQ(nullptr, cache.get(big.path()));
+    EXPECT_EQ(1u, cache.stats().rejected);
+    EXPECT_EQ(0u, cache.stats().bytes);
+}
+
+TEST(SAPEarconCacheTest, ChangedFileIsReloaded)
+{
+    TempFile file(makeWav(1, 1, 8000, 16, ramp(1000, 9)));
+    EarconCache cache(10000, 5000);
+    ASSERT_NE(nullptr, cache.get(file.path()));
+
+    file.write(makeWav(1, 1, 8000, 16, ramp(1200, 10)));
+    auto clip = cache.get(file.path());
+    ASSERT_NE(nullptr, clip);
+    EXPECT_EQ(ramp(1200, 10), clip->data);
+    EXPECT_EQ(2u, cache.stats().misses);
+    EXPECT_EQ(1200u, cache.stats().bytes);
+}
+
+TEST(SAPEarconCacheTest, OtherFormatsUseDecoder)
+{
+    TempFile mp3({ 'I', 'D', '3', 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 });
+    EarconCache cache(10000, 5000);
+    int calls = 0;
+    cache.setDecoder([&calls](const std::string &, size_t maxBytes, Earcon &earcon) {
+        calls++;
+        earcon.format = "S16LE";
+        earcon.rate = 22050;
+        earcon.channels = 1;
+        earcon.data.assign(std::min((size_t)2000, maxBytes), 0x55);
+        return true;
+    });
+
+    auto clip = cache.get(mp3.path());
+    ASSERT_NE(nullptr, clip);
+    EXPECT_EQ(22050, clip->rate);
+    EXPECT_EQ(2000u, clip->data.size());
+    cache.get(mp3.path());
+    EXPECT_EQ(1, calls);
+}
@@ -0,0 +1,346 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "WebSockets/EventLoop.h"
+
+#include <boost/asio.hpp>
+
+#include <sys/resource.h>
+#include <dirent.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using WebSockets::EventLoop;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+bool waitFor(const std::function<bool()> &condition)
+{
+    auto deadline = Clock::now() + std::chrono::seconds(5);
+    while(!condition()) {
+        if(Clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+int threadCount()
+{
+    int count = 0;
+    DIR *dir = opendir("/proc/self/task");
+    if(dir == nullptr)
+        return -1;
+    while(struct dirent *entry = readdir(dir))
+        if(entry->d_name[0] != '.')
+            count++;
+    closedir(dir);
+    return count;
+}
+
+long contextSwitches()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+// 20ms of S16LE stereo at 48kHz
+const size_t kFrameBytes = 3840;
+
+// Loopback connection whose frames are read on the given io_service, like
+// a websocket player's connection
+class Session
+{
+    public:
+    Session(boost::asio::io_service &service, boost::asio::io_service &senderService,
+            boost::asio::ip::tcp::acceptor &acceptor)
+        : m_socket(service), m_strand(service), m_sender(senderService), m_frame(kFrameBytes), m_frames(0), m_intact(true)
+    {
+        m_sender.connect(acceptor.local_endpoint());
+        acceptor.accept(m_socket);
+        m_socket.set_option(boost::asio::ip::tcp::no_delay(true));
+        m_sender.set_option(boost::asio::ip::tcp::no_delay(true));
+    }
+
+    void start(size_t frames)
+    {
+        m_sent.reserve(frames);
+        m_received.reserve(frames);
+        read();
+    }
+
+    // Each frame is filled with its number
+    void send(size_t number)
+    {
+        std::vector<char> frame(kFrameBytes, (char)number);
+        m_sent.push_back(Clock::now());
+        boost::asio::write(m_sender, boost::asio::buffer(frame));
+    }
+
+    void close()
+    {
+        boost::system::error_code ec;
+        m_sender.close(ec);
+    }
+
+    std::atomic<size_t> &frames() { return m_frames; }
+    bool intact() const { return m_intact; }
+
+    // Valid once frames() has counted every frame sent
+    std::vector<double> latenciesUs() const
+    {
+        std::vector<double> latencies;
+        for(size_t i = 0; i < m_received.size(); i++)
+            latencies.push_back(std::chrono::duration<double, std::micro>(m_received[i] - m_sent[i]).count());
+        return latencies;
+    }
+
+    private:
+    void read()
+    {
+        boost::asio::async_read(m_socket, boost::asio::buffer(m_frame), m_strand.wrap(
+            [this](const boost::system::error_code &ec, size_t) {
+                if(ec)
+                    return;
+                m_received.push_back(Clock::now());
+                std::vector<char> expected(kFrameBytes, (char)m_frames.load());
+                if(m_frame != expected)
+                    m_intact = false;
+                m_frames++;
+                read();
+            }));
+    }
+
+    boost::asio::ip::tcp::socket m_socket;
+    boost::asio::io_service::strand m_strand;
+    boost::asio::ip::tcp::socket m_sender;
+    std::vector<char> m_frame;
+    std::atomic<size_t> m_frames;
+    std::atomic<bool> m_intact;
+    std::vector<Clock::time_point> m_sent;
+    std::vector<Clock::time_point> m_received;
+};
+
+}
+
+TEST(SAPEventLoopTest, ThreadsStartOnceAndStop)
+{
+    EventLoop &loop = EventLoop::instance();
+    loop.setThreads(3);
+    loop.start();
+    loop.start();
+    EXPECT_EQ(3u, loop.stats().threads);
+    EXPECT_FALSE(loop.isLoopThread());
+
+    std::promise<bool> onLoop;
+    loop.ioService().post([&onLoop, &loop]() { onLoop.set_value(loop.isLoopThread()); });
+    EXPECT_TRUE(onLoop.get_future().get());
+
+    loop.addEndpoint();
+    loop.addEndpoint();
+    loop.removeEndpoint();
+    EventLoop::Stats stats = loop.stats();
+    EXPECT_EQ(1u, stats.endpoints);
+    EXPECT_EQ(2u, stats.peakEndpoints);
+    loop.removeEndpoint();
+
+    loop.stop();
+    EXPECT_EQ(0u, loop.stats().threads);
+
+    // Restarted for the next connection
+    loop.setThreads(1);
+    loop.start();
+    std::promise<void> ran;
+    loop.ioService().post([&ran]() { ran.set_value(); });
+    EXPECT_EQ(std::future_status::ready, ran.get_future().wait_for(std::chrono::seconds(5)));
+    loop.stop();
+}
+
+TEST(SAPEventLoopTest, StrandSerializesOneConnection)
+{
+    EventLoop &loop = EventLoop::instance();
+    loop.setThreads(4);
+    loop.start();
+
+    boost::asio::io_service::strand strand(loop.ioService());
+    std::atomic<int> inside(0);
+    std::atomic<int> overlaps(0);
+    std::atomic<int> done(0);
+    for(int i = 0; i < 200; i++)
+    {
+        loop.ioService().post(strand.wrap([&]() {
+            if(inside++ > 0)
+                overlaps++;
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            inside--;
+            done++;
+        }));
+    }
+    EXPECT_TRUE(waitFor([&] { return done == 200; }));
+    EXPECT_EQ(0, overlaps);
+    loop.stop();
+}
+
+/**
+ * @name  : MultiSessionDelivery
+ * @brief : Sixteen loopback sessions share an event loop of two threads;
+ *          every frame reaches its session whole and in order.
+ */
+TEST(SAPEventLoopTest, MultiSessionDelivery)
+{
+    const size_t sessions = 16;
+    const size_t frames = 100;
+
+    boost::asio::io_service senderService;
+    boost::asio::ip::tcp::acceptor acceptor(senderService,
+            boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+
+    EventLoop &loop = EventLoop::instance();
+    loop.setThreads(2);
+    loop.start();
+    std::vector<std::unique_ptr<Session> > players;
+    for(size_t i = 0; i < sessions; i++)
+    {
+        players.emplace_back(new Session(loop.ioService(), senderService, acceptor));
+        players.back()->start(frames);
+    }
+
+    for(size_t frame = 0; frame < frames; frame++)
+        for(auto &player : players)
+            player->send(frame);
+    ASSERT_TRUE(waitFor([&] {
+        for(auto &player : players)
+            if(player->frames() != frames)
+                return false;
+        return true;
+    }));
+    EXPECT_EQ(2u, loop.stats().threads);
+    for(auto &player : players)
+        EXPECT_TRUE(player->intact());
+
+    // The reads end with the closed senders
+    for(auto &player : players)
+        player->close();
+    loop.stop();
+    players.clear();
+}
+
+/**
+ * @name  : MultiSessionThreadsAndLatency
+ * @brief : Sixteen loopback sessions receive a 20ms frame every 10ms, once
+ *          on the shared event loop and once with a thread per session as
+ *          before. Prints the threads, context switches and frame delivery
+ *          latency of both. A benchmark without assertions on timings, run
+ *          with --gtest_also_run_disabled_tests.
+ */
+TEST(SAPEventLoopTest, DISABLED_MultiSessionThreadsAndLatency)
+{
+    const size_t sessions = 16;
+    const size_t frames = 100;
+
+    for(bool shared : { true, false })
+    {
+        boost::asio::io_service senderService;
+        boost::asio::ip::tcp::acceptor acceptor(senderService,
+                boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+
+        std::vector<std::unique_ptr<boost::asio::io_service> > services;
+        std::vector<std::unique_ptr<boost::asio::io_service::work> > works;
+        std::vector<std::thread> threads;
+        std::vector<std::unique_ptr<Session> > players;
+        if(shared)
+        {
+            EventLoop::instance().setThreads(2);
+            EventLoop::instance().start();
+        }
+        for(size_t i = 0; i < sessions; i++)
+        {
+            boost::asio::io_service *service = &EventLoop::instance().ioService();
+            if(!shared)
+            {
+                services.emplace_back(new boost::asio::io_service());
+                service = services.back().get();
+            }
+            players.emplace_back(new Session(*service, senderService, acceptor));
+            players.back()->start(frames);
+        }
+        for(auto &service : services)
+        {
+            works.emplace_back(new boost::asio::io_service::work(*service));
+            boost::asio::io_service *run = service.get();
+            threads.emplace_back([run]() { run->run(); });
+        }
+
+        int running = threadCount();
+        long switches = contextSwitches();
+        auto start = Clock::now();
+        for(size_t frame = 0; frame < frames; frame++)
+        {
+            for(auto &player : players)
+                player->send(frame);
+            std::this_thread::sleep_until(start + std::chrono::milliseconds(10 * (frame + 1)));
+        }
+        ASSERT_TRUE(waitFor([&] {
+            for(auto &player : players)
+                if(player->frames() != frames)
+                    return false;
+            return true;
+        }));
+        switches = contextSwitches() - switches;
+
+        std::vector<double> latencies;
+        for(auto &player : players)
+        {
+            std::vector<double> session = player->latenciesUs();
+            latencies.insert(latencies.end(), session.begin(), session.end());
+        }
+        std::sort(latencies.begin(), latencies.end());
+        double mean = 0;
+        for(double latency : latencies)
+            mean += latency / latencies.size();
+
+        printf("[ BENCH    ] %s: %d threads, %ld context switches, frame latency %.0f us mean, %.0f us p99\n",
+                shared ? "shared event loop" : "thread per session", running, switches, mean,
+                latencies[latencies.size() * 99 / 100]);
+
+        // The reads end with the closed senders, which lets the threads go
+        for(auto &player : players)
+            player->close();
+        if(shared)
+            EventLoop::instance().stop();
+        works.clear();
+        for(std::thread &thread : threads)
+            thread.join();
+        players.clear();
+        EXPECT_EQ(sessions * frames, latencies.size());
+    }
+}
@@ -0,0 +1,191 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "impl/FeederPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Session with a number of fragments ready, recording the order it is fed in
+class CountingSession : public FeederSession
+{
+    public:
+    CountingSession(int id, std::vector<int> *order, std::mutex *orderMutex)
+        : m_id(id), m_order(order), m_orderMutex(orderMutex), m_ready(0), m_fed(0), m_feedMs(0), m_inFeed(false) {}
+
+    bool feed() override
+    {
+        m_inFeed = true;
+        if(m_feedMs)
+            std::this_thread::sleep_for(std::chrono::milliseconds(m_feedMs));
+        bool more = false;
+        if(m_ready > 0) {
+            m_ready--;
+            m_fed++;
+            std::lock_guard<std::mutex> lock(*m_orderMutex);
+            m_order->push_back(m_id);
+            more = m_ready > 0;
+        }
+        m_inFeed = false;
+        return more;
+    }
+
+    int m_id;
+    std::vector<int> *m_order;
+    std::mutex *m_orderMutex;
+    std::atomic<int> m_ready;
+    std::atomic<int> m_fed;
+    int m_feedMs;
+    std::atomic<bool> m_inFeed;
+};
+
+bool waitFor(const std::function<bool()> &condition)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while(!condition()) {
+        if(std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+}
+
+/**
+ * @name  : RoundRobinBetweenSessions
+ * @brief : Two sessions with a backlog on a single thread are fed one
+ *          fragment at a time, alternately, so neither starves the other.
+ */
+TEST(SAPFeederPoolTest, RoundRobinBetweenSessions)
+{
+    std::vector<int> order;
+    std::mutex orderMutex;
+    FeederPool pool(1);
+    CountingSession first(1, &order, &orderMutex), second(2, &order, &orderMutex);
+    pool.add(&first);
+    pool.add(&second);
+
+    {
+        // Both are queued before the thread picks up either
+        std::lock_guard<std::mutex> lock(orderMutex);
+        first.m_ready = 5;
+        second.m_ready = 5;
+        pool.notify(&first);
+        pool.notify(&second);
+    }
+    ASSERT_TRUE(waitFor([&] { return first.m_fed == 5 && second.m_fed == 5; }));
+
+    std::lock_guard<std::mutex> lock(orderMutex);
+    for(size_t i = 1; i < order.size(); i++)
+        EXPECT_NE(order[i - 1], order[i]) << "at " << i;
+
+    pool.remove(&first);
+    pool.remove(&second);
+}
+
+TEST(SAPFeederPoolTest, NotifyDuringFeedIsNotLost)
+{
+    std::vector<int> order;
+    std::mutex orderMutex;
+    FeederPool pool(1);
+    CountingSession session(1, &order, &orderMutex);
+    session.m_feedMs = 20;
+    pool.add(&session);
+
+    session.m_ready = 1;
+    pool.notify(&session);
+    ASSERT_TRUE(waitFor([&] { return session.m_inFeed.load(); }));
+    // Arrives while the only fragment is being fed, which returns false
+    session.m_ready++;
+    pool.notify(&session);
+    EXPECT_TRUE(waitFor([&] { return session.m_fed == 2; }));
+    pool.remove(&session);
+}
+
+TEST(SAPFeederPoolTest, RemoveWaitsForRunningFeed)
+{
+    std::vector<int> order;
+    std::mutex orderMutex;
+    FeederPool pool(2);
+    CountingSession session(1, &order, &orderMutex);
+    session.m_feedMs = 50;
+    pool.add(&session);
+
+    session.m_ready = 1000;
+    pool.notify(&session);
+    ASSERT_TRUE(waitFor([&] { return session.m_inFeed.load(); }));
+    pool.remove(&session);
+    EXPECT_FALSE(session.m_inFeed);
+
+    // Nothing is fed after remove()
+    int fed = session.m_fed;
+    pool.notify(&session);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(fed, session.m_fed);
+    EXPECT_EQ(0u, pool.stats().sessions);
+}
+
+/**
+ * @name  : ManySessionsOnFewThreads
+ * @brief : Feeds 16 sessions from a pool of 2 threads; every fragment is
+ *          fed and the pool does not grow past its threads.
+ */
+TEST(SAPFeederPoolTest, ManySessionsOnFewThreads)
+{
+    const int sessions = 16;
+    std::vector<int> order;
+    std::mutex orderMutex;
+    FeederPool pool(2);
+    std::vector<std::unique_ptr<CountingSession>> players;
+    for(int i = 0; i < sessions; i++) {
+        players.emplace_back(new CountingSession(i, &order, &orderMutex));
+        pool.add(players.back().get());
+    }
+
+    for(int tick = 0; tick < 50; tick++) {
+        for(auto &player : players) {
+            player->m_ready++;
+            pool.notify(player.get());
+        }
+    }
+    ASSERT_TRUE(waitFor([&] {
+        for(auto &player : players)
+            if(player->m_fed != 50)
+                return false;
+        return true;
+    }));
+
+    FeederPool::Stats stats = pool.stats();
+    EXPECT_EQ(2u, stats.threads);
+    EXPECT_EQ((unsigned)sessions, stats.peakSessions);
+    EXPECT_GE(stats.feeds, (uint64_t)sessions * 50);
+
+    for(auto &player : players)
+        pool.remove(player.get());
+}
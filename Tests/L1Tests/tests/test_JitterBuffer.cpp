@@ -0,0 +1,200 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "impl/JitterBuffer.h"
+
+#include <string>
+
+namespace {
+
+// S16LE stereo at 48kHz, 20ms in a frame
+const size_t kBytesPerSecond = 48000 * 2 * 2;
+const size_t kFrameBytes = kBytesPerSecond / 50;
+
+typedef JitterBuffer::Clock Clock;
+
+Clock::time_point at(Clock::time_point start, int ms)
+{
+    return start + std::chrono::milliseconds(ms);
+}
+
+size_t popAll(JitterBuffer &buffer, Clock::time_point now)
+{
+    std::string frame;
+    size_t frames = 0;
+    while(buffer.pop(frame, now))
+        frames++;
+    return frames;
+}
+
+}
+
+TEST(SAPJitterBufferTest, PrebuffersTheTargetDepth)
+{
+    JitterBuffer buffer(60, 500);
+    buffer.setRate(kBytesPerSecond);
+    Clock::time_point t0 = Clock::now();
+
+    buffer.push(std::string(kFrameBytes, 'a'), t0);
+    buffer.push(std::string(kFrameBytes, 'b'), t0);
+    EXPECT_EQ(0u, popAll(buffer, t0));
+    EXPECT_EQ(40, buffer.stats(t0).depthMs);
+    buffer.push(std::string(kFrameBytes, 'c'), t0);
+
+    // In order, and from then on straight through
+    std::string frame;
+    ASSERT_TRUE(buffer.pop(frame, t0));
+    EXPECT_EQ('a', frame[0]);
+    EXPECT_EQ(2u, popAll(buffer, t0));
+    buffer.push(std::string(kFrameBytes, 'd'), at(t0, 20));
+    EXPECT_EQ(1u, popAll(buffer, at(t0, 20)));
+
+    JitterBuffer::Stats stats = buffer.stats(at(t0, 20));
+    EXPECT_EQ(4u, stats.frames);
+    EXPECT_EQ(60, stats.depthMs);
+    EXPECT_EQ(60, stats.maxDepthMs);
+    EXPECT_EQ(0u, stats.lateFrames);
+}
+
+TEST(SAPJitterBufferTest, ShortClipIsReleasedAfterTheTargetTime)
+{
+    JitterBuffer buffer(60, 500);
+    buffer.setRate(kBytesPerSecond);
+    Clock::time_point t0 = Clock::now();
+    EXPECT_EQ(-1, buffer.releaseDelayMs(t0));
+
+    buffer.push(std::string(kFrameBytes, 'a'), t0);
+    EXPECT_EQ(60, buffer.releaseDelayMs(t0));
+    EXPECT_EQ(0u, popAll(buffer, at(t0, 30)));
+    EXPECT_EQ(30, buffer.releaseDelayMs(at(t0, 30)));
+    EXPECT_EQ(1u, popAll(buffer, at(t0, 60)));
+    EXPECT_EQ(-1, buffer.releaseDelayMs(at(t0, 60)));
+
+    // The end of the stream releases at once
+    buffer.clear();
+    buffer.push(std::string(kFrameBytes, 'b'), t0);
+    buffer.drain();
+    EXPECT_EQ(0, buffer.releaseDelayMs(t0));
+    EXPECT_EQ(1u, popAll(buffer, t0));
+}
+
+TEST(SAPJitterBufferTest, CountsLateFrames)
+{
+    JitterBuffer buffer(40, 500);
+    buffer.setRate(kBytesPerSecond);
+    Clock::time_point t0 = Clock::now();
+
+    // 40ms prebuffered, then a frame every 20ms keeps the depth
+    buffer.push(std::string(kFrameBytes, 'a'), t0);
+    buffer.push(std::string(kFrameBytes, 'a'), t0);
+    EXPECT_EQ(2u, popAll(buffer, t0));
+    int ms = 0;
+    for(int i = 0; i < 10; i++)
+    {
+        ms += 20;
+        buffer.push(std::string(kFrameBytes, 'a'), at(t0, ms));
+        popAll(buffer, at(t0, ms));
+    }
+    EXPECT_EQ(0u, buffer.stats(at(t0, ms)).lateFrames);
+    EXPECT_EQ(40, buffer.stats(at(t0, ms)).depthMs);
+
+    // 100ms of silence from the network: the next frame was due 60ms ago
+    ms += 120;
+    buffer.push(std::string(kFrameBytes, 'a'), at(t0, ms));
+    EXPECT_EQ(1u, buffer.stats(at(t0, ms)).lateFrames);
+    EXPECT_EQ(1u, popAll(buffer, at(t0, ms)));
+    // Playout went on from the late frame
+    ms += 20;
+    buffer.push(std::string(kFrameBytes, 'a'), at(t0, ms));
+    EXPECT_EQ(1u, buffer.stats(at(t0, ms)).lateFrames);
+}
+
+TEST(SAPJitterBufferTest, TargetFollowsTheJitter)
+{
+    JitterBuffer steady(40, 300);
+    JitterBuffer jittery(40, 300);
+    steady.setRate(kBytesPerSecond);
+    jittery.setRate(kBytesPerSecond);
+    Clock::time_point t0 = Clock::now();
+
+    // Every other frame 50ms late, the next one right behind it
+    for(int i = 0; i < 100; i++)
+    {
+        steady.push(std::string(kFrameBytes, 'a'), at(t0, i * 20));
+        jittery.push(std::string(kFrameBytes, 'a'), at(t0, i * 20 + ((i % 2) ? 50 : 0)));
+    }
+    JitterBuffer::Stats calm = steady.stats(at(t0, 2000));
+    JitterBuffer::Stats noisy = jittery.stats(at(t0, 2000));
+    EXPECT_EQ(40, calm.targetMs);
+    EXPECT_NEAR(0.0, calm.jitterMs, 0.01);
+    EXPECT_NEAR(25.0, noisy.jitterMs, 3.0);
+    EXPECT_GT(noisy.targetMs, 80);
+    EXPECT_LE(noisy.targetMs, 300);
+}
+
+TEST(SAPJitterBufferTest, UnderrunRebuffersDeeper)
+{
+    JitterBuffer buffer(40, 100);
+    buffer.setRate(kBytesPerSecond);
+    Clock::time_point t0 = Clock::now();
+
+    buffer.underrun(t0);
+    EXPECT_EQ(0u, buffer.stats(t0).underruns);
+
+    buffer.push(std::string(2 * kFrameBytes, 'a'), t0);
+    EXPECT_EQ(1u, popAll(buffer, t0));
+    buffer.underrun(at(t0, 60));
+    JitterBuffer::Stats stats = buffer.stats(at(t0, 60));
+    EXPECT_EQ(1u, stats.underruns);
+    EXPECT_EQ(1u, stats.rebuffers);
+    EXPECT_EQ(60, stats.targetMs);
+
+    // Held again until the deeper target is reached
+    buffer.push(std::string(2 * kFrameBytes, 'a'), at(t0, 60));
+    EXPECT_EQ(0u, popAll(buffer, at(t0, 60)));
+    buffer.push(std::string(kFrameBytes, 'a'), at(t0, 60));
+    EXPECT_EQ(2u, popAll(buffer, at(t0, 60)));
+
+    // Bounded by the maximum
+    for(int i = 0; i < 10; i++)
+    {
+        buffer.push(std::string(5 * kFrameBytes, 'a'), at(t0, 100));
+        EXPECT_EQ(1u, popAll(buffer, at(t0, 100)));
+        buffer.underrun(at(t0, 100));
+        buffer.clear();
+    }
+    EXPECT_EQ(100, buffer.stats(at(t0, 100)).targetMs);
+}
+
+TEST(SAPJitterBufferTest, PassesThroughWithoutRate)
+{
+    JitterBuffer buffer(60, 500);
+    Clock::time_point t0 = Clock::now();
+    buffer.push(std::string(10, 'a'), t0);
+    buffer.push(std::string(), t0);
+    EXPECT_EQ(-1, buffer.releaseDelayMs(t0));
+    EXPECT_EQ(1u, popAll(buffer, t0));
+    buffer.underrun(t0);
+    JitterBuffer::Stats stats = buffer.stats(t0);
+    EXPECT_EQ(1u, stats.frames);
+    EXPECT_EQ(0u, stats.underruns);
+    EXPECT_EQ(0, stats.depthMs);
+}
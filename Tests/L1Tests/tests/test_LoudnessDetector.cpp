@@ -0,0 +1,173 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "impl/LoudnessDetector.h"
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// A 1kHz tone of the given peak level at 48kHz
+std::vector<int16_t> toneS16(size_t frames, int channels, float level)
+{
+    std::vector<int16_t> samples(frames * channels);
+    for(size_t i = 0; i < frames; i++)
+        for(int c = 0; c < channels; c++)
+            samples[i * channels + c] = (int16_t)std::lround(32767.0f * level * std::sin(2.0f * (float)M_PI * 1000.0f * i / 48000.0f));
+    return samples;
+}
+
+// Feeds 1ms buffers and returns the millisecond of the first event, -1 if
+// there is none
+int firstEventMs(LoudnessDetector &detector, const std::vector<int16_t> &audio, int channels, LoudnessDetector::Event &event)
+{
+    const size_t step = 48 * channels;
+    for(size_t offset = 0; offset + step <= audio.size(); offset += step)
+    {
+        event = detector.process(audio.data() + offset, step * sizeof(int16_t));
+        if(event != LoudnessDetector::EVENT_NONE)
+            return (int)((offset + step) / step);
+    }
+    return -1;
+}
+
+}
+
+TEST(SAPLoudnessDetectorTest, MeasuresRmsAndPeak)
+{
+    LoudnessDetector detector;
+    detector.setFormat(LoudnessDetector::FORMAT_S16, 48000, 2);
+    detector.configure(0.1, 0, 0);
+    detector.setEnabled(true);
+
+    // 5ms windows of 240 frames; 243 leaves a tail to the scalar loop
+    std::vector<int16_t> tone = toneS16(243, 2, 0.5f);
+    detector.process(tone.data(), tone.size() * sizeof(int16_t));
+    LoudnessDetector::Stats stats = detector.stats();
+    EXPECT_NEAR(0.5f / std::sqrt(2.0f), stats.rms, 0.005);
+    EXPECT_NEAR(0.5f, stats.peak, 0.001);
+    EXPECT_EQ(243u, stats.frames);
+
+    LoudnessDetector f32;
+    f32.setFormat(LoudnessDetector::parseFormat("F32LE"), 48000, 1);
+    f32.configure(0.1, 0, 0);
+    f32.setEnabled(true);
+    std::vector<float> square(245);
+    for(size_t i = 0; i < square.size(); i++)
+        square[i] = (i % 2) ? -0.25f : 0.25f;
+    square[17] = -0.75f;
+    f32.process(square.data(), square.size() * sizeof(float));
+    EXPECT_NEAR(std::sqrt((239 * 0.0625 + 0.5625) / 240), f32.stats().rms, 1e-5);
+    EXPECT_FLOAT_EQ(0.75f, f32.stats().peak);
+    EXPECT_TRUE(f32.isAbove());
+}
+
+TEST(SAPLoudnessDetectorTest, AttackAndHoldTimes)
+{
+    LoudnessDetector detector;
+    detector.setFormat(LoudnessDetector::FORMAT_S16, 48000, 2);
+    detector.configure(0.05, 20, 100);
+    detector.setEnabled(true);
+
+    LoudnessDetector::Event event;
+    std::vector<int16_t> speech = toneS16(48 * 200, 2, 0.3f);
+    EXPECT_EQ(20, firstEventMs(detector, speech, 2, event));
+    EXPECT_EQ(LoudnessDetector::EVENT_ABOVE, event);
+    EXPECT_TRUE(detector.isAbove());
+
+    // A pause shorter than the hold time keeps the primary ducked
+    std::vector<int16_t> silence(48 * 2 * 200, 0);
+    std::vector<int16_t> gap(silence.begin(), silence.begin() + 48 * 2 * 60);
+    EXPECT_EQ(-1, firstEventMs(detector, gap, 2, event));
+    EXPECT_EQ(-1, firstEventMs(detector, speech, 2, event));
+    EXPECT_EQ(100, firstEventMs(detector, silence, 2, event));
+    EXPECT_EQ(LoudnessDetector::EVENT_BELOW, event);
+
+    // Quieter than the threshold is not speech
+    std::vector<int16_t> hum = toneS16(48 * 200, 2, 0.05f);
+    EXPECT_EQ(-1, firstEventMs(detector, hum, 2, event));
+
+    // With no attack time the first window decides, within 5ms
+    detector.configure(0.05, 0, 100);
+    EXPECT_EQ(5, firstEventMs(detector, speech, 2, event));
+    EXPECT_EQ(3u, detector.stats().transitions);
+}
+
+TEST(SAPLoudnessDetectorTest, ReconfiguresWhilePlaying)
+{
+    LoudnessDetector detector;
+    std::vector<int16_t> speech = toneS16(48 * 100, 1, 0.3f);
+    LoudnessDetector::Event event;
+
+    // Nothing is measured until enabled and given a format
+    detector.setFormat(LoudnessDetector::FORMAT_S16, 48000, 1);
+    EXPECT_EQ(LoudnessDetector::EVENT_NONE, detector.process(speech.data(), speech.size() * sizeof(int16_t)));
+    EXPECT_EQ(0u, detector.stats().frames);
+
+    detector.configure(0.5, 0, 0);
+    detector.setEnabled(true);
+    EXPECT_EQ(-1, firstEventMs(detector, speech, 1, event));
+    detector.configure(0.1, 0, 0);
+    EXPECT_EQ(5, firstEventMs(detector, speech, 1, event));
+
+    // Disabling starts over below the threshold
+    detector.setEnabled(false);
+    EXPECT_FALSE(detector.isAbove());
+    detector.setEnabled(true);
+    EXPECT_EQ(5, firstEventMs(detector, speech, 1, event));
+    detector.reset();
+    EXPECT_FALSE(detector.isAbove());
+
+    detector.setFormat(LoudnessDetector::parseFormat("S24LE"), 48000, 1);
+    EXPECT_EQ(LoudnessDetector::EVENT_NONE, detector.process(speech.data(), speech.size() * sizeof(int16_t)));
+    detector.setFormat(LoudnessDetector::FORMAT_S16, 0, 1);
+    EXPECT_EQ(LoudnessDetector::EVENT_NONE, detector.process(speech.data(), speech.size() * sizeof(int16_t)));
+}
+
+/**
+ * @name  : CountsMeasuredAudio
+ * @brief : Measures 60 seconds of 48kHz stereo audio in 10ms buffers and
+ *          checks the frames and audio time the detector accounts for.
+ */
+TEST(SAPLoudnessDetectorTest, CountsMeasuredAudio)
+{
+    std::vector<int16_t> s16 = toneS16(480, 2, 0.3f);
+    std::vector<float> f32(480 * 2, 0.3f);
+    for(LoudnessDetector::Format format : { LoudnessDetector::FORMAT_S16, LoudnessDetector::FORMAT_F32 })
+    {
+        LoudnessDetector detector;
+        detector.setFormat(format, 48000, 2);
+        detector.configure(0.1, 20, 200);
+        detector.setEnabled(true);
+
+        const int buffers = 6000;
+        for(int i = 0; i < buffers; i++)
+        {
+            if(format == LoudnessDetector::FORMAT_S16)
+                detector.process(s16.data(), s16.size() * sizeof(int16_t));
+            else
+                detector.process(f32.data(), f32.size() * sizeof(float));
+        }
+        EXPECT_EQ((uint64_t)buffers * 480, detector.stats().frames);
+        EXPECT_EQ(60000000000ULL, detector.stats().audioNs);
+    }
+}
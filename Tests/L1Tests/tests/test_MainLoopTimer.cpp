@@ -0,0 +1,153 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "impl/MainLoopTimer.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// A main loop on a thread of its own, as AudioPlayer runs one
+class Loop
+{
+    public:
+    Loop() : m_context(g_main_context_new()), m_loop(g_main_loop_new(m_context, FALSE)), m_thread([this] { g_main_loop_run(m_loop); }) {}
+    ~Loop()
+    {
+        g_main_loop_quit(m_loop);
+        m_thread.join();
+        g_main_loop_unref(m_loop);
+        g_main_context_unref(m_context);
+    }
+
+    GMainContext* context() { return m_context; }
+
+    private:
+    GMainContext *m_context;
+    GMainLoop *m_loop;
+    std::thread m_thread;
+};
+
+bool waitFor(const std::function<bool()> &done, int ms = 2000)
+{
+    for(int i = 0; i < ms && !done(); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return done();
+}
+
+// Touches itself from the callback, as a player does
+struct Owner
+{
+    Owner() : fired(0), timer([this] { fired++; }) {}
+
+    std::atomic<int> fired;
+    MainLoopTimer timer;
+};
+
+}
+
+TEST(SAPMainLoopTimerTest, FiresOnceAfterTheDelay)
+{
+    Loop loop;
+    std::atomic<int> fired(0);
+    MainLoopTimer timer([&fired] { fired++; });
+    auto start = std::chrono::steady_clock::now();
+    timer.start(loop.context(), 20);
+    EXPECT_TRUE(timer.pending());
+    ASSERT_TRUE(waitFor([&fired] { return fired > 0; }));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    EXPECT_FALSE(timer.pending());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(1, fired.load());
+}
+
+TEST(SAPMainLoopTimerTest, StopCancelsAndStartReplaces)
+{
+    Loop loop;
+    std::atomic<int> fired(0);
+    MainLoopTimer timer([&fired] { fired++; });
+    timer.start(loop.context(), 30);
+    timer.stop();
+    EXPECT_FALSE(timer.pending());
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    EXPECT_EQ(0, fired.load());
+
+    // The second start takes the place of the first
+    timer.start(loop.context(), 500);
+    timer.start(loop.context(), 10);
+    ASSERT_TRUE(waitFor([&fired] { return fired > 0; }, 400));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(1, fired.load());
+}
+
+TEST(SAPMainLoopTimerTest, StopWaitsForTheRunningCallback)
+{
+    Loop loop;
+    std::atomic<bool> entered(false);
+    std::atomic<bool> finished(false);
+    MainLoopTimer timer([&] {
+        entered = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        finished = true;
+    });
+    timer.start(loop.context(), 0);
+    ASSERT_TRUE(waitFor([&entered] { return entered.load(); }));
+    timer.stop();
+    EXPECT_TRUE(finished.load());
+}
+
+TEST(SAPMainLoopTimerTest, OwnerDestroyedWhileTheTimerFires)
+{
+    Loop loop;
+    // Each owner goes away right as its timer is due; a dispatch that lost
+    // the race must not touch it
+    for(int i = 0; i < 200; i++)
+    {
+        std::unique_ptr<Owner> owner(new Owner());
+        owner->timer.start(loop.context(), 0);
+        if(i % 2)
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        owner.reset();
+    }
+}
+
+TEST(SAPMainLoopTimerTest, CallbackRestartsAndStopsItself)
+{
+    Loop loop;
+    std::atomic<int> fired(0);
+    std::unique_ptr<MainLoopTimer> timer;
+    timer.reset(new MainLoopTimer([&] {
+        if(++fired < 3)
+            timer->start(loop.context(), 1);
+        else
+            timer->stop();
+    }));
+    timer->start(loop.context(), 1);
+    ASSERT_TRUE(waitFor([&fired] { return fired >= 3; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(3, fired.load());
+    EXPECT_FALSE(timer->pending());
+}
@@ -0,0 +1,299 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "impl/Mixer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+std::vector<int16_t> constantS16(size_t samples, int16_t value)
+{
+    return std::vector<int16_t>(samples, value);
+}
+
+}
+
+TEST(SAPMixerTest, S16SaturatesAndAppliesGain)
+{
+    Mixer mixer(Mixer::S16, 48000, 2, 100);
+    int loud = mixer.addStream(Mixer::S16, 48000, 2);
+    int quiet = mixer.addStream(Mixer::S16, 48000, 2);
+    ASSERT_GE(loud, 0);
+    ASSERT_GE(quiet, 0);
+
+    // 37 frames, so the vector loop leaves a tail to the scalar one
+    const size_t frames = 37;
+    std::vector<int16_t> a(frames * 2), b(frames * 2);
+    for(size_t i = 0; i < frames; i++)
+    {
+        a[2 * i] = 30000;
+        a[2 * i + 1] = -30000;
+        b[2 * i] = 10000;
+        b[2 * i + 1] = -10000;
+    }
+    mixer.write(loud, a.data(), a.size() * sizeof(int16_t));
+    mixer.write(quiet, b.data(), b.size() * sizeof(int16_t));
+
+    std::vector<int16_t> out(frames * 2);
+    ASSERT_EQ(frames, mixer.mix(out.data(), frames));
+    for(size_t i = 0; i < frames; i++)
+    {
+        EXPECT_EQ(32767, out[2 * i]);
+        EXPECT_EQ(-32768, out[2 * i + 1]);
+    }
+
+    mixer.setGain(loud, 0.0f);
+    mixer.setGain(quiet, 0.5f);
+    mixer.write(loud, a.data(), a.size() * sizeof(int16_t));
+    mixer.write(quiet, b.data(), b.size() * sizeof(int16_t));
+    ASSERT_EQ(frames, mixer.mix(out.data(), frames));
+    for(size_t i = 0; i < frames; i++)
+    {
+        EXPECT_EQ(5000, out[2 * i]);
+        EXPECT_EQ(-5000, out[2 * i + 1]);
+    }
+}
+
+TEST(SAPMixerTest, F32ClampsOnlyTheSum)
+{
+    Mixer mixer(Mixer::F32, 48000, 2, 100);
+    int first = mixer.addStream(Mixer::F32, 48000, 2);
+    int second = mixer.addStream(Mixer::F32, 48000, 2);
+    int third = mixer.addStream(Mixer::S16, 48000, 2);
+
+    const size_t frames = 21;
+    std::vector<float> high(frames * 2, 0.8f), low(frames * 2, -0.9f);
+    std::vector<int16_t> half = constantS16(frames * 2, 16384);
+    mixer.write(first, high.data(), high.size() * sizeof(float));
+    mixer.write(second, high.data(), high.size() * sizeof(float));
+    mixer.write(third, half.data(), half.size() * sizeof(int16_t));
+
+    std::vector<float> out(frames * 2);
+    ASSERT_EQ(frames, mixer.mix(out.data(), frames));
+    for(float sample : out)
+        EXPECT_FLOAT_EQ(1.0f, sample);
+
+    // 0.8 + 0.8 - 0.9 - 0.9 + 0.5 stays in range, however it is summed up
+    mixer.write(first, high.data(), high.size() * sizeof(float));
+    mixer.write(second, high.data(), high.size() * sizeof(float));
+    mixer.write(third, half.data(), half.size() * sizeof(int16_t));
+    int fourth = mixer.addStream(Mixer::F32, 48000, 2);
+    int fifth = mixer.addStream(Mixer::F32, 48000, 2);
+    mixer.write(fourth, low.data(), low.size() * sizeof(float));
+    mixer.write(fifth, low.data(), low.size() * sizeof(float));
+    ASSERT_EQ(frames, mixer.mix(out.data(), frames));
+    for(float sample : out)
+        EXPECT_NEAR(0.3f, sample, 1e-5);
+}
+
+TEST(SAPMixerTest, ConvertsRateAndChannels)
+{
+    Mixer mixer(Mixer::S16, 48000, 2, 500);
+    int tts = mixer.addStream(Mixer::S16, 22050, 1);
+
+    // 100ms of mono 22050Hz in uneven pieces
+    std::vector<int16_t> input = constantS16(2205, 8192);
+    size_t offset = 0;
+    for(size_t piece : { 1, 300, 7, 1000, 897 })
+    {
+        EXPECT_EQ(piece * sizeof(int16_t), mixer.write(tts, input.data() + offset, piece * sizeof(int16_t)));
+        offset += piece;
+    }
+    size_t queued = mixer.queuedFrames(tts);
+    EXPECT_NEAR(4800.0, (double)queued, 3.0);
+
+    std::vector<int16_t> out(queued * 2);
+    ASSERT_EQ(queued, mixer.mix(out.data(), queued));
+    for(int16_t sample : out)
+        EXPECT_EQ(8192, sample);
+}
+
+TEST(SAPMixerTest, ResamplingDoesNotDependOnWriteSizes)
+{
+    Mixer whole(Mixer::F32, 48000, 1, 500);
+    Mixer pieces(Mixer::F32, 48000, 1, 500);
+    int a = whole.addStream(Mixer::F32, 44100, 2);
+    int b = pieces.addStream(Mixer::F32, 44100, 2);
+
+    std::vector<float> input(2 * 4410);
+    for(size_t i = 0; i < input.size() / 2; i++)
+    {
+        input[2 * i] = 0.5f * std::sin(i * 0.05f);
+        input[2 * i + 1] = 0.5f * std::cos(i * 0.03f);
+    }
+    whole.write(a, input.data(), input.size() * sizeof(float));
+    for(size_t frame = 0; frame < input.size() / 2; frame += 97)
+    {
+        size_t count = std::min((size_t)97, input.size() / 2 - frame);
+        pieces.write(b, input.data() + 2 * frame, count * 2 * sizeof(float));
+    }
+    ASSERT_EQ(whole.queuedFrames(a), pieces.queuedFrames(b));
+
+    size_t frames = whole.queuedFrames(a);
+    std::vector<float> x(frames), y(frames);
+    whole.mix(x.data(), frames);
+    pieces.mix(y.data(), frames);
+    for(size_t i = 0; i < frames; i++)
+        EXPECT_NEAR(x[i], y[i], 1e-6) << "frame " << i;
+    // Stereo was averaged down to mono
+    EXPECT_NEAR(0.25f, x[0], 1e-6);
+}
+
+TEST(SAPMixerTest, PausedStreamKeepsItsAudio)
+{
+    Mixer mixer(Mixer::S16, 48000, 2, 100);
+    int id = mixer.addStream(Mixer::S16, 48000, 2);
+    std::vector<int16_t> input = constantS16(2 * 100, 1000);
+    mixer.write(id, input.data(), input.size() * sizeof(int16_t));
+
+    std::vector<int16_t> out(2 * 50, 7);
+    mixer.setPaused(id, true);
+    EXPECT_EQ(0u, mixer.mix(out.data(), 50));
+    EXPECT_EQ(7, out[0]);
+    EXPECT_EQ(100u, mixer.queuedFrames(id));
+
+    mixer.setPaused(id, false);
+    EXPECT_EQ(50u, mixer.mix(out.data(), 50));
+    EXPECT_EQ(1000, out[0]);
+    EXPECT_EQ(50u, mixer.queuedFrames(id));
+
+    // Running out part way pads with silence
+    std::vector<int16_t> longer(2 * 80, 7);
+    EXPECT_EQ(80u, mixer.mix(longer.data(), 80));
+    EXPECT_EQ(1000, longer[2 * 49]);
+    EXPECT_EQ(0, longer[2 * 50]);
+
+    mixer.write(id, input.data(), input.size() * sizeof(int16_t));
+    mixer.flush(id);
+    EXPECT_EQ(0u, mixer.queuedFrames(id));
+    EXPECT_EQ(0u, mixer.mix(out.data(), 50));
+}
+
+TEST(SAPMixerTest, WriteTakesWholeFramesThatFit)
+{
+    // 10ms at 48kHz queues 480 frames
+    Mixer mixer(Mixer::S16, 48000, 2, 10);
+    int id = mixer.addStream(Mixer::S16, 48000, 2);
+    std::vector<int16_t> input = constantS16(2 * 1000, 1);
+    EXPECT_EQ(480u * 4, mixer.write(id, input.data(), input.size() * sizeof(int16_t)));
+    EXPECT_EQ(0u, mixer.write(id, input.data(), 4));
+
+    std::vector<int16_t> out(2 * 480);
+    mixer.mix(out.data(), 480);
+    EXPECT_EQ(4u, mixer.write(id, input.data(), 7));
+
+    int resampled = mixer.addStream(Mixer::S16, 16000, 1);
+    size_t taken = mixer.write(resampled, input.data(), input.size() * sizeof(int16_t));
+    EXPECT_GT(taken, 0u);
+    EXPECT_LT(taken, input.size() * sizeof(int16_t));
+    EXPECT_LE(mixer.queuedFrames(resampled), 480u);
+
+    EXPECT_EQ(-1, mixer.addStream(Mixer::S16, 0, 2));
+    EXPECT_EQ(-1, mixer.addStream(Mixer::S16, 48000, 0));
+    Mixer::SampleFormat format;
+    EXPECT_TRUE(Mixer::parseFormat("F32LE", format));
+    EXPECT_EQ(Mixer::F32, format);
+    EXPECT_FALSE(Mixer::parseFormat("S24LE", format));
+}
+
+/**
+ * @name  : FourSessions
+ * @brief : Mixes 10 seconds of four sessions, two already in the output
+ *          format, a 22050Hz mono voice and a 44100Hz float stream, in
+ *          10ms periods, and counts every period in the mixed frames.
+ */
+TEST(SAPMixerTest, FourSessions)
+{
+    for(Mixer::SampleFormat outputFormat : { Mixer::S16, Mixer::F32 })
+    {
+        Mixer mixer(outputFormat, 48000, 2, 200);
+        int music = mixer.addStream(Mixer::S16, 48000, 2);
+        int click = mixer.addStream(Mixer::S16, 48000, 2);
+        int voice = mixer.addStream(Mixer::S16, 22050, 1);
+        int effect = mixer.addStream(Mixer::F32, 44100, 2);
+        mixer.setGain(music, 0.7f);
+        mixer.setGain(effect, 0.5f);
+
+        std::vector<int16_t> s16(480 * 2, 1200);
+        std::vector<int16_t> mono(221, -800);
+        std::vector<float> f32(441 * 2, 0.1f);
+        std::vector<uint8_t> out(480 * mixer.bytesPerFrame());
+
+        const int periods = 1000;
+        for(int i = 0; i < periods; i++)
+        {
+            mixer.write(music, s16.data(), s16.size() * sizeof(int16_t));
+            mixer.write(click, s16.data(), s16.size() * sizeof(int16_t));
+            mixer.write(voice, mono.data(), (i % 2 ? 220 : 221) * sizeof(int16_t));
+            mixer.write(effect, f32.data(), f32.size() * sizeof(float));
+            mixer.mix(out.data(), 480);
+        }
+        EXPECT_EQ((uint64_t)periods * 480, mixer.stats().mixedFrames);
+    }
+}
+
+/**
+ * @name  : FourSessionCpu
+ * @brief : Mixes 10 seconds of four sessions, two already in the output
+ *          format, a 22050Hz mono voice and a 44100Hz float stream, in
+ *          10ms periods, and prints the CPU time per stream. Nothing is
+ *          asserted on timings; run it with --gtest_also_run_disabled_tests.
+ */
+TEST(SAPMixerTest, DISABLED_FourSessionCpu)
+{
+    for(Mixer::SampleFormat outputFormat : { Mixer::S16, Mixer::F32 })
+    {
+        Mixer mixer(outputFormat, 48000, 2, 200);
+        int music = mixer.addStream(Mixer::S16, 48000, 2);
+        int click = mixer.addStream(Mixer::S16, 48000, 2);
+        int voice = mixer.addStream(Mixer::S16, 22050, 1);
+        int effect = mixer.addStream(Mixer::F32, 44100, 2);
+        mixer.setGain(music, 0.7f);
+        mixer.setGain(effect, 0.5f);
+
+        std::vector<int16_t> s16(480 * 2, 1200);
+        std::vector<int16_t> mono(221, -800);
+        std::vector<float> f32(441 * 2, 0.1f);
+        std::vector<uint8_t> out(480 * mixer.bytesPerFrame());
+
+        const int periods = 1000;
+        auto start = std::chrono::steady_clock::now();
+        for(int i = 0; i < periods; i++)
+        {
+            mixer.write(music, s16.data(), s16.size() * sizeof(int16_t));
+            mixer.write(click, s16.data(), s16.size() * sizeof(int16_t));
+            mixer.write(voice, mono.data(), (i % 2 ? 220 : 221) * sizeof(int16_t));
+            mixer.write(effect, f32.data(), f32.size() * sizeof(float));
+            mixer.mix(out.data(), 480);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double audioSeconds = periods * 0.01;
+        printf("[ BENCH    ] %s out, 4 sessions: %.2f us per 10ms period, %.3f%% of a core per stream\n",
+                outputFormat == Mixer::S16 ? "S16" : "F32", seconds * 1e6 / periods, seconds / audioSeconds / 4 * 100);
+        EXPECT_EQ((uint64_t)periods * 480, mixer.stats().mixedFrames);
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "impl/PipelinePool.h"
+
+namespace {
+
+// The pool never touches the elements, so any distinct addresses will do
+PooledPipeline fakePipeline(uintptr_t tag)
+{
+    PooledPipeline pipeline;
+    pipeline.pipeline = reinterpret_cast<GstElement*>(tag);
+    pipeline.source = reinterpret_cast<GstElement*>(tag + 1);
+    pipeline.capsfilter = nullptr;
+    pipeline.audioSink = reinterpret_cast<GstElement*>(tag + 2);
+    pipeline.audioVolume = reinterpret_cast<GstElement*>(tag + 3);
+    return pipeline;
+}
+
+PipelinePool::Key key(AudioType audioType, SourceType sourceType, PlayMode playMode, bool smartVolume)
+{
+    PipelinePool::Key key;
+    key.audioType = audioType;
+    key.sourceType = sourceType;
+    key.playMode = playMode;
+    key.smartVolume = smartVolume;
+    return key;
+}
+
+}
+
+TEST(SAPPipelinePoolTest, TakeReturnsPipelineOfSameKind)
+{
+    PipelinePool pool(2);
+    PooledPipeline pipeline;
+    EXPECT_FALSE(pool.take(key(PCM, DATA, SYSTEM, false), pipeline));
+
+    ASSERT_TRUE(pool.put(key(PCM, DATA, SYSTEM, false), fakePipeline(0x1000)));
+    ASSERT_TRUE(pool.put(key(PCM, DATA, APP, false), fakePipeline(0x2000)));
+
+    // Neither the smart volume flag nor the other fields may be mixed up
+    EXPECT_FALSE(pool.take(key(PCM, DATA, SYSTEM, true), pipeline));
+    EXPECT_FALSE(pool.take(key(WAV, DATA, SYSTEM, false), pipeline));
+    EXPECT_FALSE(pool.take(key(PCM, WEBSOCKET, SYSTEM, false), pipeline));
+
+    ASSERT_TRUE(pool.take(key(PCM, DATA, APP, false), pipeline));
+    EXPECT_EQ(reinterpret_cast<GstElement*>(0x2000), pipeline.pipeline);
+    EXPECT_EQ(reinterpret_cast<GstElement*>(0x2003), pipeline.audioVolume);
+    ASSERT_TRUE(pool.take(key(PCM, DATA, SYSTEM, false), pipeline));
+    EXPECT_EQ(reinterpret_cast<GstElement*>(0x1000), pipeline.pipeline);
+    EXPECT_FALSE(pool.take(key(PCM, DATA, SYSTEM, false), pipeline));
+
+    PipelinePool::Stats stats = pool.stats();
+    EXPECT_EQ(2u, stats.hits);
+    EXPECT_EQ(5u, stats.misses);
+    EXPECT_EQ(0u, stats.idle);
+}
+
+TEST(SAPPipelinePoolTest, FullPoolLeavesPipelineToCaller)
+{
+    PipelinePool pool(1);
+    EXPECT_TRUE(pool.put(key(MP3, HTTPSRC, SYSTEM, false), fakePipeline(0x1000)));
+    EXPECT_FALSE(pool.put(key(MP3, HTTPSRC, SYSTEM, false), fakePipeline(0x2000)));
+    EXPECT_TRUE(pool.put(key(MP3, FILESRC, SYSTEM, false), fakePipeline(0x3000)));
+    EXPECT_EQ(1u, pool.stats().discarded);
+
+    pool.setSize(0);
+    EXPECT_FALSE(pool.put(key(WAV, FILESRC, APP, false), fakePipeline(0x4000)));
+}
+
+TEST(SAPPipelinePoolTest, DrainHandsBackEverything)
+{
+    PipelinePool pool(4);
+    for(uintptr_t i = 1; i <= 3; i++) {
+        pool.put(key(PCM, DATA, SYSTEM, false), fakePipeline(i << 12));
+        pool.put(key(WAV, FILESRC, APP, true), fakePipeline((i + 8) << 12));
+    }
+    EXPECT_EQ(6u, pool.stats().idle);
+
+    std::vector<PooledPipeline> drained = pool.drain();
+    EXPECT_EQ(6u, drained.size());
+    EXPECT_EQ(0u, pool.stats().idle);
+    PooledPipeline pipeline;
+    EXPECT_FALSE(pool.take(key(PCM, DATA, SYSTEM, false), pipeline));
+}
@@ -0,0 +1,186 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "impl/PlaybackStats.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef PlaybackStats::Clock Clock;
+
+Clock::time_point at(Clock::time_point start, int ms)
+{
+    return start + std::chrono::milliseconds(ms);
+}
+
+}
+
+TEST(SAPPlaybackStatsTest, CountsFromManyThreads)
+{
+    PlaybackStats stats;
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&stats, t]() {
+            for(int i = 0; i < 1000; i++)
+            {
+                stats.received(10);
+                stats.pushed(8);
+                stats.queued(t * 1000 + i);
+            }
+            stats.dropped(100);
+            stats.underrun();
+            stats.feedPaused();
+        });
+    }
+    for(std::thread &thread : threads)
+        thread.join();
+
+    PlaybackStats::Snapshot snapshot = stats.snapshot();
+    EXPECT_EQ(40000u, snapshot.bytesReceived);
+    EXPECT_EQ(32000u, snapshot.bytesPushed);
+    EXPECT_EQ(4u, snapshot.buffersDropped);
+    EXPECT_EQ(400u, snapshot.bytesDropped);
+    EXPECT_EQ(3999u, snapshot.queueHighWater);
+    EXPECT_EQ(4u, snapshot.underruns);
+    EXPECT_EQ(4u, snapshot.feedPauses);
+    EXPECT_EQ(0u, snapshot.starts);
+    EXPECT_EQ(-1, snapshot.startupUs);
+    EXPECT_EQ(-1, snapshot.playingUs);
+}
+
+TEST(SAPPlaybackStatsTest, TimesEachEventOncePerRequest)
+{
+    PlaybackStats stats;
+    Clock::time_point t0 = Clock::now();
+
+    // Nothing is timed without a request
+    stats.started(t0);
+    EXPECT_EQ(1u, stats.snapshot().starts);
+    EXPECT_EQ(-1, stats.snapshot().startupUs);
+
+    // A data player may start before the pipeline reaches PAUSED
+    stats.playRequested(t0);
+    EXPECT_TRUE(stats.requestPending());
+    stats.started(at(t0, 30));
+    stats.reachedPaused(at(t0, 40));
+    stats.reachedPlaying(at(t0, 60));
+    stats.started(at(t0, 500));
+    stats.reachedPlaying(at(t0, 500));
+    EXPECT_FALSE(stats.requestPending());
+
+    PlaybackStats::Snapshot snapshot = stats.snapshot();
+    EXPECT_EQ(3u, snapshot.starts);
+    EXPECT_EQ(30000, snapshot.startupUs);
+    EXPECT_EQ(40000, snapshot.pausedUs);
+    EXPECT_EQ(60000, snapshot.playingUs);
+
+    // The last and the largest are kept
+    stats.playRequested(at(t0, 1000));
+    stats.started(at(t0, 1010));
+    snapshot = stats.snapshot();
+    EXPECT_EQ(10000, snapshot.startupUs);
+    EXPECT_EQ(30000, snapshot.maxStartupUs);
+}
+
+TEST(SAPPlaybackStatsTest, CancelledRequestIsNotTimed)
+{
+    PlaybackStats stats;
+    Clock::time_point t0 = Clock::now();
+    stats.playRequested(t0);
+    stats.reachedPaused(at(t0, 5));
+    stats.cancelRequest();
+    EXPECT_FALSE(stats.requestPending());
+    stats.reachedPlaying(at(t0, 2000));
+    stats.started(at(t0, 2000));
+
+    PlaybackStats::Snapshot snapshot = stats.snapshot();
+    EXPECT_EQ(5000, snapshot.pausedUs);
+    EXPECT_EQ(-1, snapshot.playingUs);
+    EXPECT_EQ(-1, snapshot.startupUs);
+    EXPECT_EQ(1u, snapshot.starts);
+}
+
+TEST(SAPPlaybackStatsTest, TotalsSumCountersAndKeepTheLargestLatency)
+{
+    PlaybackStats a, b;
+    Clock::time_point t0 = Clock::now();
+    a.received(100);
+    a.queued(500);
+    a.playRequested(t0);
+    a.started(at(t0, 20));
+    b.received(50);
+    b.queued(300);
+    b.feederCpu(3000);
+    b.feederCpu(-5);
+
+    PlaybackStats::Snapshot totals = PlaybackStats().snapshot();
+    totals += a.snapshot();
+    totals += b.snapshot();
+    EXPECT_EQ(150u, totals.bytesReceived);
+    EXPECT_EQ(500u, totals.queueHighWater);
+    EXPECT_EQ(1u, totals.starts);
+    EXPECT_EQ(20000, totals.maxStartupUs);
+    EXPECT_EQ(-1, totals.maxPlayingUs);
+    EXPECT_EQ(3u, totals.feederCpuUs);
+}
+
+TEST(SAPPlaybackStatsTest, KeepsTheLargestStartOffsetEitherWay)
+{
+    PlaybackStats a, b;
+    a.scheduledStart(-4000);
+    a.scheduledStart(1500);
+    b.scheduledStart(-2500);
+
+    PlaybackStats::Snapshot snapshot = a.snapshot();
+    EXPECT_EQ(2u, snapshot.scheduledStarts);
+    EXPECT_EQ(1500, snapshot.startOffsetUs);
+    EXPECT_EQ(-4000, snapshot.maxStartOffsetUs);
+
+    PlaybackStats::Snapshot totals = PlaybackStats().snapshot();
+    totals += b.snapshot();
+    totals += a.snapshot();
+    EXPECT_EQ(3u, totals.scheduledStarts);
+    EXPECT_EQ(-2500, totals.startOffsetUs);
+    EXPECT_EQ(-4000, totals.maxStartOffsetUs);
+}
+
+TEST(SAPPlaybackStatsTest, CpuTimerAddsThreadTime)
+{
+    PlaybackStats stats;
+    {
+        PlaybackStats::CpuTimer timer(stats);
+        volatile uint64_t sum = 0;
+        for(int i = 0; i < 2000000; i++)
+            sum = sum + i;
+    }
+    // Sleeping does not count
+    {
+        PlaybackStats::CpuTimer timer(stats);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    uint64_t cpuUs = stats.snapshot().feederCpuUs;
+    EXPECT_GT(cpuUs, 0u);
+    EXPECT_LT(cpuUs, 50000u);
+}
@@ -0,0 +1,165 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "impl/ReconnectBackoff.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+
+namespace {
+
+typedef ReconnectBackoff::Clock Clock;
+
+Clock::time_point at(Clock::time_point start, int ms)
+{
+    return start + std::chrono::milliseconds(ms);
+}
+
+}
+
+TEST(SAPReconnectBackoffTest, DelaysDoubleUpToTheCap)
+{
+    ReconnectBackoff backoff(100, 800, 100000, 1);
+    Clock::time_point t0 = Clock::now();
+    EXPECT_FALSE(backoff.inOutage());
+
+    int ceiling = 100;
+    for(int attempt = 0; attempt < 8; attempt++)
+    {
+        int delay = backoff.nextDelayMs(t0);
+        EXPECT_GE(delay, ceiling / 2);
+        EXPECT_LE(delay, ceiling);
+        ceiling = std::min(800, ceiling * 2);
+    }
+    EXPECT_TRUE(backoff.inOutage());
+    EXPECT_EQ(1u, backoff.stats().outages);
+    EXPECT_EQ(8u, backoff.stats().attempts);
+}
+
+TEST(SAPReconnectBackoffTest, ReconnectEndsTheOutage)
+{
+    ReconnectBackoff backoff(100, 2000, 10000, 2);
+    Clock::time_point t0 = Clock::now();
+
+    // Nothing to end without an outage
+    backoff.connected(t0);
+    EXPECT_EQ(0u, backoff.stats().reconnects);
+
+    backoff.nextDelayMs(t0);
+    backoff.nextDelayMs(at(t0, 100));
+    backoff.connected(at(t0, 350));
+    EXPECT_FALSE(backoff.inOutage());
+    ReconnectBackoff::Stats stats = backoff.stats();
+    EXPECT_EQ(1u, stats.reconnects);
+    EXPECT_DOUBLE_EQ(350.0, stats.outageMs);
+    EXPECT_DOUBLE_EQ(350.0, stats.maxOutageMs);
+
+    // The next outage starts again from the initial delay
+    int delay = backoff.nextDelayMs(at(t0, 1000));
+    EXPECT_GE(delay, 50);
+    EXPECT_LE(delay, 100);
+    backoff.connected(at(t0, 1100));
+    stats = backoff.stats();
+    EXPECT_EQ(2u, stats.outages);
+    EXPECT_DOUBLE_EQ(450.0, stats.outageMs);
+    EXPECT_DOUBLE_EQ(350.0, stats.maxOutageMs);
+
+    // A stopped session does not count as reconnected
+    backoff.nextDelayMs(at(t0, 2000));
+    backoff.reset();
+    backoff.connected(at(t0, 2500));
+    EXPECT_EQ(2u, backoff.stats().reconnects);
+}
+
+TEST(SAPReconnectBackoffTest, GivesUpAfterTheLimit)
+{
+    ReconnectBackoff backoff(100, 2000, 3000, 3);
+    Clock::time_point t0 = Clock::now();
+
+    int elapsed = 0;
+    int delay;
+    int attempts = 0;
+    while((delay = backoff.nextDelayMs(at(t0, elapsed))) >= 0)
+    {
+        elapsed += delay;
+        attempts++;
+        ASSERT_LE(elapsed, 3000);
+    }
+    EXPECT_FALSE(backoff.inOutage());
+    ReconnectBackoff::Stats stats = backoff.stats();
+    EXPECT_EQ(1u, stats.givenUp);
+    EXPECT_EQ((uint64_t)attempts, stats.attempts);
+    EXPECT_EQ(0u, stats.reconnects);
+    EXPECT_DOUBLE_EQ((double)elapsed, stats.outageMs);
+
+    // Without a limit nothing is tried
+    ReconnectBackoff disabled(100, 2000, 0, 4);
+    EXPECT_EQ(-1, disabled.nextDelayMs(t0));
+}
+
+/**
+ * @name  : JitterSpreadsReconnects
+ * @brief : 200 players lose the same server at once. Without jitter their
+ *          first and second reconnects all land together; with jitter no
+ *          10 ms window takes more than a quarter of them.
+ */
+TEST(SAPReconnectBackoffTest, JitterSpreadsReconnects)
+{
+    const int players = 200;
+    Clock::time_point t0 = Clock::now();
+    std::mt19937 seeds(7);
+    for(bool jitter : { false, true })
+    {
+        std::map<int, int> windows;
+        for(int i = 0; i < players; i++)
+        {
+            // Without jitter every player draws the same delays
+            ReconnectBackoff backoff(100, 2000, 10000, jitter ? (unsigned)seeds() : 1);
+            int first = backoff.nextDelayMs(t0);
+            int second = first + backoff.nextDelayMs(at(t0, first));
+            windows[first / 10]++;
+            windows[second / 10]++;
+        }
+        int peak = 0;
+        for(const auto &window : windows)
+            peak = std::max(peak, window.second);
+        if(jitter)
+            EXPECT_LE(peak, players / 2);
+        else
+            EXPECT_EQ(players, peak);
+    }
+}
+
+/**
+ * @name  : CleanCloseIsNotReconnected
+ * @brief : A server ending the session with a normal close (1000) is not
+ *          reconnected, while going away, a protocol error or a connection
+ *          lost without a close frame (1006) are.
+ */
+TEST(SAPReconnectBackoffTest, CleanCloseIsNotReconnected)
+{
+    EXPECT_FALSE(ReconnectBackoff::reconnectsAfter(1000));
+    EXPECT_TRUE(ReconnectBackoff::reconnectsAfter(1001));
+    EXPECT_TRUE(ReconnectBackoff::reconnectsAfter(1002));
+    EXPECT_TRUE(ReconnectBackoff::reconnectsAfter(1006));
+    EXPECT_TRUE(ReconnectBackoff::reconnectsAfter(1011));
+}
@@ -0,0 +1,75 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "impl/ScheduledStart.h"
+
+#include <chrono>
+#include <thread>
+
+namespace {
+
+const int64_t MS = 1000000;
+
+}
+
+TEST(SAPScheduledStartTest, MapsTheTargetOntoThePipelineClock)
+{
+    // The pipeline clock runs 5 s behind CLOCK_MONOTONIC
+    ScheduledStart::Plan plan = ScheduledStart::plan(10500 * MS, 10000 * MS, 5000 * MS, 20 * MS);
+    EXPECT_EQ(5500 * MS, plan.targetClock);
+    // The sink adds its latency to the base time
+    EXPECT_EQ(5480 * MS, plan.baseTime);
+    EXPECT_EQ(0, plan.lateNs);
+
+    // Played out on time, the position is the time since the target
+    EXPECT_EQ(0, ScheduledStart::offsetNs(plan, 5700 * MS, 200 * MS));
+    EXPECT_EQ(15 * MS, ScheduledStart::offsetNs(plan, 5700 * MS, 185 * MS));
+    EXPECT_EQ(-3 * MS, ScheduledStart::offsetNs(plan, 5700 * MS, 203 * MS));
+}
+
+TEST(SAPScheduledStartTest, StartsAtOnceWhenTheTargetCannotBeMet)
+{
+    // Less time left than the latency
+    ScheduledStart::Plan plan = ScheduledStart::plan(10010 * MS, 10000 * MS, 5000 * MS, 30 * MS);
+    EXPECT_EQ(5000 * MS, plan.baseTime);
+    EXPECT_EQ(20 * MS, plan.lateNs);
+
+    // Already past; not clipped, so the position starts from 0 at the late start
+    plan = ScheduledStart::plan(9900 * MS, 10000 * MS, 5000 * MS, 0);
+    EXPECT_EQ(5000 * MS, plan.baseTime);
+    EXPECT_EQ(4900 * MS, plan.targetClock);
+    EXPECT_EQ(100 * MS, plan.lateNs);
+    EXPECT_EQ(100 * MS, ScheduledStart::offsetNs(plan, 5200 * MS, 200 * MS));
+
+    // A latency the pipeline could not report counts as none
+    plan = ScheduledStart::plan(10100 * MS, 10000 * MS, 5000 * MS, -1);
+    EXPECT_EQ(5100 * MS, plan.baseTime);
+    EXPECT_EQ(0, plan.lateNs);
+}
+
+TEST(SAPScheduledStartTest, MonotonicClock)
+{
+    int64_t before = ScheduledStart::monotonicNowNs();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    int64_t after = ScheduledStart::monotonicNowNs();
+    EXPECT_GT(before, 0);
+    EXPECT_GE(after - before, 10 * MS);
+}
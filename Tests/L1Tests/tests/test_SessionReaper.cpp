@@ -0,0 +1,143 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "impl/SessionReaper.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Stands in for a player whose destructor is slow
+struct SlowPlayer
+{
+    SlowPlayer(int ms, std::atomic<int> &alive) : m_ms(ms), m_alive(alive) { m_alive++; }
+    ~SlowPlayer()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(m_ms));
+        m_alive--;
+    }
+
+    int m_ms;
+    std::atomic<int> &m_alive;
+};
+
+// A teardown that blocks until released
+struct Gate
+{
+    Gate() : open(false) {}
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return open; });
+    }
+    void release()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        open = true;
+        condition.notify_all();
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool open;
+};
+
+}
+
+TEST(SAPSessionReaperTest, TearsDownOffTheCallerInOrder)
+{
+    std::atomic<int> alive(0);
+    std::mutex mutex;
+    std::vector<int> done;
+    std::thread::id caller = std::this_thread::get_id();
+    std::atomic<bool> offCaller(true);
+
+    SessionReaper reaper;
+    reaper.setDone([&](int id, double) {
+        std::lock_guard<std::mutex> lock(mutex);
+        done.push_back(id);
+    });
+    for(int id = 1; id <= 3; id++)
+    {
+        std::shared_ptr<SlowPlayer> player = std::make_shared<SlowPlayer>(20, alive);
+        auto start = std::chrono::steady_clock::now();
+        reaper.submit(id, [player, caller, &offCaller]() mutable {
+            if(std::this_thread::get_id() == caller)
+                offCaller = false;
+            player.reset();
+        });
+        player.reset();
+        // Returns without waiting for the player
+        EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    }
+    // Callbacks stop with the shutdown, so the teardowns are awaited first
+    for(int i = 0; i < 200 && reaper.stats().pending > 0; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_TRUE(reaper.shutdown(2000));
+    EXPECT_EQ(0, alive.load());
+    EXPECT_TRUE(offCaller.load());
+    EXPECT_EQ((std::vector<int>{ 1, 2, 3 }), done);
+
+    SessionReaper::Stats stats = reaper.stats();
+    EXPECT_EQ(3u, stats.reaped);
+    EXPECT_EQ(0u, stats.abandoned);
+    EXPECT_EQ(0u, stats.pending);
+    EXPECT_GE(stats.maxMs, 20.0);
+
+    // Once shut down, a close tears down in place
+    std::shared_ptr<SlowPlayer> late = std::make_shared<SlowPlayer>(0, alive);
+    reaper.submit(4, [late]() mutable { late.reset(); });
+    late.reset();
+    EXPECT_EQ(0, alive.load());
+    EXPECT_EQ(3u, done.size());
+}
+
+TEST(SAPSessionReaperTest, ShutdownIsBoundedByAHungTeardown)
+{
+    std::shared_ptr<Gate> gate = std::make_shared<Gate>();
+    std::atomic<int> ran(0);
+    std::atomic<int> done(0);
+    {
+        SessionReaper reaper;
+        reaper.setDone([&done](int, double) { done++; });
+        reaper.submit(1, [gate]() { gate->wait(); });
+        reaper.submit(2, [&ran]() { ran++; });
+
+        auto start = std::chrono::steady_clock::now();
+        EXPECT_FALSE(reaper.shutdown(50));
+        EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(1000));
+        SessionReaper::Stats stats = reaper.stats();
+        EXPECT_EQ(2u, stats.abandoned);
+        EXPECT_EQ(0u, stats.reaped);
+    }
+    // The abandoned thread finishes on its own, without callbacks
+    gate->release();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(0, ran.load());
+    EXPECT_EQ(0, done.load());
+}
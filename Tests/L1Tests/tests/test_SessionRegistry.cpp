@@ -0,0 +1,287 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "impl/SessionRegistry.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct FakePlayer
+{
+    explicit FakePlayer(std::atomic<int> *alive = nullptr) : m_alive(alive), m_calls(0)
+    {
+        if(m_alive)
+            (*m_alive)++;
+    }
+    ~FakePlayer()
+    {
+        if(m_alive)
+            (*m_alive)--;
+    }
+
+    // A short control call, or a slow one like a Stop tearing down a
+    // websocket
+    void call(int us)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+        m_calls++;
+    }
+
+    std::atomic<int> *m_alive;
+    std::atomic<int> m_calls;
+};
+
+typedef SessionRegistry<FakePlayer> Registry;
+
+}
+
+TEST(SAPSessionRegistryTest, FindsSessionsByIdUrlAndGroup)
+{
+    Registry registry;
+    Registry::Handle a = registry.add(1, 0, new FakePlayer());
+    Registry::Handle b = registry.add(2, 1, new FakePlayer());
+    Registry::Handle c = registry.add(3, 0, new FakePlayer());
+
+    EXPECT_EQ(b, registry.find(2));
+    EXPECT_EQ(nullptr, registry.find(4));
+
+    std::vector<Registry::Handle> system = registry.group(0);
+    ASSERT_EQ(2u, system.size());
+    EXPECT_EQ(1, system[0]->id());
+    EXPECT_EQ(3, system[1]->id());
+    EXPECT_TRUE(registry.group(2).empty());
+    EXPECT_EQ(3u, registry.all().size());
+
+    // The lowest id wins when sessions play the same URL
+    EXPECT_EQ(nullptr, registry.findByUrl("ws://host:40001"));
+    registry.setUrl(c, "ws://host:40001");
+    registry.setUrl(a, "ws://host:40001");
+    EXPECT_EQ(a, registry.findByUrl("ws://host:40001"));
+    registry.setUrl(a, "/tmp/beep.wav");
+    EXPECT_EQ(c, registry.findByUrl("ws://host:40001"));
+    EXPECT_EQ(a, registry.findByUrl("/tmp/beep.wav"));
+
+    EXPECT_EQ(c, registry.remove(3));
+    EXPECT_EQ(nullptr, registry.remove(3));
+    EXPECT_EQ(nullptr, registry.find(3));
+    EXPECT_EQ(nullptr, registry.findByUrl("ws://host:40001"));
+    EXPECT_EQ(1u, registry.group(0).size());
+    // A removed session is not indexed again
+    registry.setUrl(c, "ws://host:40001");
+    EXPECT_EQ(nullptr, registry.findByUrl("ws://host:40001"));
+
+    Registry::Stats stats = registry.stats();
+    EXPECT_EQ(2u, stats.sessions);
+    EXPECT_EQ(3u, stats.peakSessions);
+    EXPECT_EQ(2u, registry.clear().size());
+    EXPECT_EQ(0u, registry.stats().sessions);
+}
+
+TEST(SAPSessionRegistryTest, RemovedSessionLivesUntilTheLastHandle)
+{
+    std::atomic<int> alive(0);
+    Registry registry;
+    registry.add(1, 0, new FakePlayer(&alive));
+    Registry::Handle inFlight = registry.find(1);
+
+    Registry::Handle removed = registry.remove(1);
+    {
+        Registry::Locked locked(removed);
+        ASSERT_TRUE((bool)locked);
+        removed->close();
+    }
+    removed.reset();
+    EXPECT_EQ(1, alive.load());
+
+    // A call racing with Close sees the session closed
+    EXPECT_FALSE((bool)Registry::Locked(inFlight));
+    EXPECT_FALSE((bool)Registry::Locked(Registry::Handle()));
+    inFlight.reset();
+    EXPECT_EQ(0, alive.load());
+}
+
+TEST(SAPSessionRegistryTest, ClosingSessionsListedUntilDestroyed)
+{
+    Registry registry;
+    registry.add(1, 0, new FakePlayer());
+    registry.add(2, 1, new FakePlayer());
+    registry.add(3, 0, new FakePlayer());
+    EXPECT_TRUE(registry.closing(0).empty());
+
+    // Still listed while the reaper holds them, though no longer found
+    Registry::Handle first = registry.remove(1);
+    Registry::Handle second = registry.remove(2);
+    std::vector<Registry::Handle> closing = registry.closing(0);
+    ASSERT_EQ(1u, closing.size());
+    EXPECT_EQ(first, closing[0]);
+    EXPECT_EQ(second, registry.closing(1).at(0));
+    EXPECT_EQ(1u, registry.group(0).size());
+    closing.clear();
+
+    first.reset();
+    EXPECT_TRUE(registry.closing(0).empty());
+    EXPECT_EQ(1u, registry.closing(1).size());
+    EXPECT_EQ(1u, registry.clear().size());
+    EXPECT_TRUE(registry.closing(1).empty());
+}
+
+TEST(SAPSessionRegistryTest, SessionLockSerializesControlCalls)
+{
+    Registry registry;
+    Registry::Handle session = registry.add(1, 0, new FakePlayer());
+    std::atomic<int> inside(0);
+    std::atomic<int> overlaps(0);
+    std::vector<std::thread> callers;
+    for(int t = 0; t < 4; t++)
+    {
+        callers.emplace_back([&]() {
+            for(int i = 0; i < 50; i++)
+            {
+                Registry::Locked player(registry.find(1));
+                if(inside++ > 0)
+                    overlaps++;
+                player->call(10);
+                inside--;
+            }
+        });
+    }
+    for(std::thread &caller : callers)
+        caller.join();
+    EXPECT_EQ(0, overlaps.load());
+    EXPECT_EQ(200, session->player()->m_calls.load());
+}
+
+/**
+ * @name  : ConcurrentCallers
+ * @brief : Callers make short control calls on sessions of their own
+ *          while one session takes a 20 ms Stop over and over; every call
+ *          reaches its own session.
+ */
+TEST(SAPSessionRegistryTest, ConcurrentCallers)
+{
+    const int callers = 8;
+    const int calls = 200;
+    Registry registry;
+    for(int id = 0; id <= callers; id++)
+        registry.add(id, 0, new FakePlayer());
+    std::atomic<bool> done(false);
+
+    auto control = [&](int id, int us) {
+        Registry::Locked player(registry.find(id));
+        player->call(us);
+    };
+
+    std::thread stopper([&]() {
+        while(!done)
+            control(0, 20000);
+    });
+    std::vector<std::thread> threads;
+    for(int t = 1; t <= callers; t++)
+    {
+        threads.emplace_back([&, t]() {
+            for(int i = 0; i < calls; i++)
+                control(t, 50);
+        });
+    }
+    for(std::thread &thread : threads)
+        thread.join();
+    done = true;
+    stopper.join();
+
+    for(int t = 1; t <= callers; t++)
+        EXPECT_EQ(calls, registry.find(t)->player()->m_calls.load());
+    EXPECT_GT(registry.find(0)->player()->m_calls.load(), 0);
+}
+
+/**
+ * @name  : DISABLED_ContentionVersusSingleLock
+ * @brief : ConcurrentCallers, once with one lock for all sessions as
+ *          before and once with the session locks. Prints the calls per
+ *          second and the slowest short call; the one lock run is cut to
+ *          2 callers and 20 calls each to keep it short. Nothing about the
+ *          timing is asserted. Run it with --gtest_also_run_disabled_tests.
+ */
+TEST(SAPSessionRegistryTest, DISABLED_ContentionVersusSingleLock)
+{
+    for(bool global : { true, false })
+    {
+        const int callers = global ? 2 : 8;
+        const int calls = global ? 20 : 200;
+        Registry registry;
+        for(int id = 0; id <= callers; id++)
+            registry.add(id, 0, new FakePlayer());
+        std::mutex adminLock;
+        std::atomic<bool> done(false);
+        std::atomic<long long> slowestUs(0);
+
+        auto control = [&](int id, int us) {
+            Registry::Handle session = registry.find(id);
+            if(global)
+            {
+                std::lock_guard<std::mutex> lock(adminLock);
+                session->player()->call(us);
+            }
+            else
+            {
+                Registry::Locked player(session);
+                player->call(us);
+            }
+        };
+
+        std::thread stopper([&]() {
+            while(!done)
+                control(0, 20000);
+        });
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for(int t = 1; t <= callers; t++)
+        {
+            threads.emplace_back([&, t]() {
+                for(int i = 0; i < calls; i++)
+                {
+                    auto before = std::chrono::steady_clock::now();
+                    control(t, 50);
+                    long long us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - before).count();
+                    long long slowest = slowestUs;
+                    while(us > slowest && !slowestUs.compare_exchange_weak(slowest, us))
+                        ;
+                }
+            });
+        }
+        for(std::thread &thread : threads)
+            thread.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        done = true;
+        stopper.join();
+
+        printf("[ BENCH    ] %s: %.0f calls/s from %d callers, slowest call %.1f ms\n",
+                global ? "one lock" : "session locks", callers * calls / seconds, callers,
+                slowestUs / 1000.0);
+        for(int t = 1; t <= callers; t++)
+            EXPECT_EQ(calls, registry.find(t)->player()->m_calls.load());
+    }
+}
@@ -0,0 +1,268 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "impl/ShmRing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t kChunk = 3840;     // 20ms of 48kHz stereo S16LE
+
+// Chunk number index, recognisable wherever the ring wrapped it
+void fillChunk(std::vector<char> &chunk, int index)
+{
+    for(size_t i = 0; i < chunk.size(); i++)
+        chunk[i] = (char)(index * 7 + i);
+}
+
+uint64_t monotonicNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+double cpuMs(const struct rusage &usage)
+{
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0
+        + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+}
+
+}
+
+TEST(SAPShmRingTest, AttachSharesData)
+{
+    std::unique_ptr<ShmRing> player = ShmRing::create(8192);
+    ASSERT_NE(nullptr, player);
+    EXPECT_EQ(8192u, player->capacity());
+
+    std::unique_ptr<ShmRing> client = ShmRing::attach(player->path());
+    ASSERT_NE(nullptr, client);
+    EXPECT_EQ(8192u, client->capacity());
+
+    // Wraps around the end of the data area
+    std::vector<char> chunk(6000);
+    for(int round = 0; round < 3; round++) {
+        for(size_t i = 0; i < chunk.size(); i++)
+            chunk[i] = (char)(round + i);
+        EXPECT_EQ(chunk.size(), client->write(chunk.data(), chunk.size(), 0));
+
+        size_t read = 0;
+        while(read < chunk.size()) {
+            const char *data = nullptr;
+            size_t len = player->peek(data, chunk.size(), 0);
+            ASSERT_NE(0u, len);
+            EXPECT_EQ(0, memcmp(chunk.data() + read, data, len));
+            player->remove(len);
+            read += len;
+        }
+        EXPECT_TRUE(player->isEmpty());
+    }
+}
+
+TEST(SAPShmRingTest, AttachRejectsOtherFiles)
+{
+    EXPECT_EQ(nullptr, ShmRing::attach("/dev/null"));
+    EXPECT_EQ(nullptr, ShmRing::attach("/nonexistent"));
+}
+
+TEST(SAPShmRingTest, FullRingTimesOut)
+{
+    std::unique_ptr<ShmRing> player = ShmRing::create(4096);
+    std::unique_ptr<ShmRing> client = ShmRing::attach(player->path());
+    std::vector<char> chunk(3000);
+    EXPECT_EQ(3000u, client->write(chunk.data(), chunk.size(), 0));
+    EXPECT_EQ(1096u, client->write(chunk.data(), chunk.size(), 20));
+}
+
+TEST(SAPShmRingTest, ClearDropsQueuedBytes)
+{
+    std::unique_ptr<ShmRing> player = ShmRing::create(4096);
+    std::unique_ptr<ShmRing> client = ShmRing::attach(player->path());
+    std::vector<char> chunk(1000, 'a');
+    client->write(chunk.data(), chunk.size(), 0);
+    player->clear();
+
+    const char *data = nullptr;
+    EXPECT_EQ(0u, player->peek(data, 4096, 0));
+    chunk.assign(10, 'b');
+    client->write(chunk.data(), chunk.size(), 0);
+    EXPECT_EQ(10u, player->peek(data, 4096, 0));
+    EXPECT_EQ('b', data[0]);
+}
+
+TEST(SAPShmRingTest, CloseWakesConsumer)
+{
+    std::unique_ptr<ShmRing> player = ShmRing::create(4096);
+    std::thread consumer([&player] {
+        const char *data = nullptr;
+        EXPECT_EQ(0u, player->peek(data, 4096, 5000));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto start = std::chrono::steady_clock::now();
+    player->close();
+    consumer.join();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+}
+
+TEST(SAPShmRingTest, CorruptWritePositionClosesRing)
+{
+    std::unique_ptr<ShmRing> player = ShmRing::create(4096);
+    int fd = open(player->path().c_str(), O_RDWR);
+    ASSERT_GE(fd, 0);
+    void *shared = mmap(NULL, sizeof(ShmRingHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ASSERT_NE(MAP_FAILED, shared);
+
+    // A misbehaving client claims more data than the ring can hold
+    static_cast<ShmRingHeader*>(shared)->writePos.store(1 << 20);
+    const char *data = nullptr;
+    EXPECT_EQ(0u, player->peek(data, 4096, 0));
+    EXPECT_TRUE(player->isClosed());
+
+    munmap(shared, sizeof(ShmRingHeader));
+    close(fd);
+}
+
+/**
+ * @name  : ProducerProcess
+ * @brief : Forks a producer process that attaches to the ring and writes
+ *          numbered 20ms PCM chunks, while this process consumes them as the
+ *          player thread does and checks they arrive whole and in order.
+ */
+TEST(SAPShmRingTest, ProducerProcess)
+{
+    const int chunks = 500;
+    std::unique_ptr<ShmRing> player = ShmRing::create(kChunk * 4);
+    ASSERT_NE(nullptr, player);
+
+    pid_t producer = fork();
+    ASSERT_GE(producer, 0);
+    if(producer == 0) {
+        std::unique_ptr<ShmRing> client = ShmRing::attach(player->path());
+        std::vector<char> chunk(kChunk);
+        bool written = client != nullptr;
+        for(int i = 0; written && i < chunks; i++) {
+            fillChunk(chunk, i);
+            written = client->write(chunk.data(), chunk.size(), 1000) == chunk.size();
+        }
+        _exit(written ? 0 : 1);
+    }
+
+    std::vector<char> chunk(kChunk);
+    std::vector<char> expected(kChunk);
+    size_t filled = 0;
+    int received = 0;
+    while(received < chunks) {
+        const char *data = nullptr;
+        size_t len = player->peek(data, kChunk - filled, 1000);
+        ASSERT_NE(0u, len) << "producer stalled";
+        memcpy(chunk.data() + filled, data, len);
+        player->remove(len);
+        filled += len;
+        if(filled == kChunk) {
+            fillChunk(expected, received++);
+            ASSERT_EQ(expected, chunk);
+            filled = 0;
+        }
+    }
+
+    int status = 0;
+    waitpid(producer, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    EXPECT_TRUE(player->isEmpty());
+}
+
+/**
+ * @name  : LatencyAndCpuWithProducerProcess
+ * @brief : Forks a producer process that attaches to the ring and writes
+ *          timestamped 20ms PCM chunks paced like a live stream, while this
+ *          process consumes them as the player thread does. Prints the
+ *          write to read latency and the CPU time of both sides. Nothing is
+ *          asserted on the numbers. A benchmark, disabled unless run with
+ *          --gtest_also_run_disabled_tests.
+ */
+TEST(SAPShmRingTest, DISABLED_LatencyAndCpuWithProducerProcess)
+{
+    const int chunks = 500;                         // 10s of audio, sent 10x faster than real time
+    const uint64_t pacingNs = 2 * 1000 * 1000;
+    std::unique_ptr<ShmRing> player = ShmRing::create(kChunk * 64);
+    ASSERT_NE(nullptr, player);
+
+    pid_t producer = fork();
+    ASSERT_GE(producer, 0);
+    if(producer == 0) {
+        std::unique_ptr<ShmRing> client = ShmRing::attach(player->path());
+        std::vector<char> chunk(kChunk, 0);
+        for(int i = 0; client != nullptr && i < chunks; i++) {
+            uint64_t now = monotonicNs();
+            memcpy(chunk.data(), &now, sizeof(now));
+            client->write(chunk.data(), chunk.size(), 1000);
+            struct timespec pause = { 0, (long)pacingNs };
+            nanosleep(&pause, NULL);
+        }
+        _exit(client != nullptr ? 0 : 1);
+    }
+
+    std::vector<uint64_t> latencies;
+    std::vector<char> chunk(kChunk);
+    size_t filled = 0;
+    struct rusage before, after;
+    getrusage(RUSAGE_SELF, &before);
+    while(latencies.size() < (size_t)chunks) {
+        const char *data = nullptr;
+        size_t len = player->peek(data, kChunk - filled, 1000);
+        ASSERT_NE(0u, len) << "producer stalled";
+        memcpy(chunk.data() + filled, data, len);
+        player->remove(len);
+        filled += len;
+        if(filled == kChunk) {
+            uint64_t sent;
+            memcpy(&sent, chunk.data(), sizeof(sent));
+            latencies.push_back(monotonicNs() - sent);
+            filled = 0;
+        }
+    }
+    getrusage(RUSAGE_SELF, &after);
+
+    int status = 0;
+    waitpid(producer, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    struct rusage children;
+    getrusage(RUSAGE_CHILDREN, &children);
+
+    std::sort(latencies.begin(), latencies.end());
+    printf("[ BENCH    ] shm ring latency: median %.1f us, p99 %.1f us, max %.1f us\n",
+        latencies[latencies.size() / 2] / 1000.0, latencies[latencies.size() * 99 / 100] / 1000.0, latencies.back() / 1000.0);
+    printf("[ BENCH    ] shm ring CPU for %d chunks: consumer %.1f ms, producer %.1f ms\n",
+        chunks, cpuMs(after) - cpuMs(before), cpuMs(children));
+}
@@ -29,6 +29,9 @@
 #include "ThunderPortability.h"
 #include "systemaudioplatformmock.h"
 
+#include <chrono>
+#include <vector>
+
 using namespace WPEFramework;
 using ::testing::Test;
 using ::testing::NiceMock;
@@ -165,6 +168,12 @@ TEST_F(SAPInitializedTest,RegisteredMethods) {
     EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("setMixerLevels")));
     EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("setSmartVolControl")));
     EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("stop")));
+#ifdef SYSTEMAUDIOPLAYER_EXTENDED_API
+    EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("enqueue")));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("getStatistics")));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("playAt")));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("prepareOnly")));
+#endif
 }
 
 /*******************************************************************************************************************
@@ -636,6 +645,40 @@ TEST_F(SAPInitializedTest,SAPOpenInvalidPlayMode) {
     ));
     EXPECT_EQ(response, _T("{\"success\":false}"));
 }
+
+/**
+ * @name  : SAPOpenPCMShmSystem
+ * @brief : Opens a shared memory player and writes to its ring from the client side
+ *
+ * @param[in]   :  audiotype ,sourcetype, playmode, shmsize
+ * @return      :  {id, shm: {path, size}, success: true}
+ */
+
+TEST_F(SAPInitializedTest,SAPOpenPCMShmSystem) {
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+        _T("open"),
+        _T("{\"audiotype\": \"pcm\",\"sourcetype\": \"shm\",\"playmode\": \"system\",\"shmsize\": 65536 }"),
+         response
+    ));
+
+    JsonObject result;
+    result.FromString(response);
+    EXPECT_TRUE(result["success"].Boolean());
+    JsonObject shm = result["shm"].Object();
+    EXPECT_EQ(65536, shm["size"].Number());
+
+    std::unique_ptr<ShmRing> client = ShmRing::attach(shm["path"].String());
+    ASSERT_NE(nullptr, client);
+    std::vector<uint8_t> pcm(3840, 0);
+    EXPECT_EQ(pcm.size(), client->write(pcm.data(), pcm.size(), 100));
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+        _T("close"),
+        _T("{\"id\": ") + std::to_string((int)result["id"].Number()) + _T("}"),
+        response
+    ));
+    EXPECT_EQ(response, _T("{\"success\":true}"));
+}
 /*******************************************************************************************************************
  * Test function for config
  * Open                    :
@@ -1021,6 +1064,55 @@ TEST_F(SAPInitializedTest,SAPCloseWithoutOpen) {
     EXPECT_EQ(response, _T("{\"success\":false}"));
 }
 
+/**
+ * @name  : SAPCloseDetachesAtOnce
+ * @brief : A closed player is gone as soon as Close returns, while its teardown finishes in the background
+ *
+ * @param[in]   :  id
+ * @return      :  {success: false} for calls on the closed player
+ */
+
+TEST_F(SAPInitializedTest, SAPCloseDetachesAtOnce) {
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+        _T("open"),
+        _T("{\"audiotype\": \"pcm\",\"sourcetype\": \"data\",\"playmode\": \"system\" }"),
+         response
+    ));
+
+    size_t idPos = response.find("\"id\"");
+    if (idPos != string::npos) {
+        size_t idStart = response.find(':', idPos) + 1;
+        size_t idEnd = response.find(',', idPos);
+        int playerId = std::stoi(response.substr(idStart, idEnd - idStart));
+
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+            _T("close"),
+            _T("{\"id\": ") + std::to_string(playerId) + _T("}"),
+            response
+        ));
+        EXPECT_EQ(response, _T("{\"success\":true}"));
+
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+            _T("pause"),
+            _T("{\"id\": ") + std::to_string(playerId) + _T("}"),
+            response
+        ));
+        EXPECT_EQ(response, _T("{\"success\":false}"));
+
+#ifdef SYSTEMAUDIOPLAYER_EXTENDED_API
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+            _T("getStatistics"),
+            _T("{}"),
+            response
+        ));
+        EXPECT_NE(response.find("\"sessions\":0"), string::npos);
+        EXPECT_NE(response.find("\"reaper\""), string::npos);
+#endif
+    } else {
+        EXPECT_TRUE(false) << "Error: 'id' not found in the response.";
+    }
+}
+
 /*******************************************************************************************************************
  * Test function for resume
  * Resume                    :
@@ -1329,6 +1421,97 @@ TEST_F(SAPInitializedTest,SAPPlayBufferWithoutOpen) {
     EXPECT_EQ(response, _T("{\"success\":false}"));
 }
 
+#ifdef SYSTEMAUDIOPLAYER_EXTENDED_API
+/*******************************************************************************************************************
+ * Test function for PlayBufferRaw
+ * PlayBufferRaw              :
+ *                COM-RPC only PlayBuffer taking the raw audio bytes
+ *
+ *                @return Core::hresult
+ * Use case coverage:
+ *                @Success : 1
+ *                @Failure : 2
+ ********************************************************************************************************************/
+/**
+ * @name  : SAPPlayBufferRaw
+ * @brief : Queues raw bytes on an open data player, rejects an unknown player and an empty buffer
+ *
+ * @param[in]   :  id , data, length
+ * @return      :  ERROR_NONE / ERROR_UNKNOWN_KEY / ERROR_BAD_REQUEST
+ */
+
+TEST_F(SAPInitializedTest, SAPPlayBufferRaw) {
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+        _T("open"),
+        _T("{\"audiotype\": \"pcm\",\"sourcetype\": \"data\",\"playmode\": \"system\" }"),
+         response
+    ));
+
+    size_t idPos = response.find("\"id\"");
+    if (idPos != string::npos) {
+        size_t idStart = response.find(':', idPos) + 1;
+        size_t idEnd = response.find(',', idPos);
+        int playerId = std::stoi(response.substr(idStart, idEnd - idStart));
+
+        std::vector<uint8_t> pcm(3840, 0);
+        EXPECT_EQ(Core::ERROR_NONE, SystemAudioPlayerImplementation->PlayBufferRaw(playerId, pcm.data(), pcm.size()));
+        EXPECT_EQ(Core::ERROR_UNKNOWN_KEY, SystemAudioPlayerImplementation->PlayBufferRaw(playerId + 1, pcm.data(), pcm.size()));
+        EXPECT_EQ(Core::ERROR_BAD_REQUEST, SystemAudioPlayerImplementation->PlayBufferRaw(playerId, pcm.data(), 0));
+    } else {
+        EXPECT_TRUE(false) << "Error: 'id' not found in the response.";
+    }
+}
+
+/**
+ * @name  : SAPPlayBufferRawVersusJson
+ * @brief : Feeds the same 20ms PCM chunks through the JSON playbuffer method
+ *          (base64 + JSON) and through PlayBufferRaw, printing the time per
+ *          chunk for both. Nothing is asserted on the timings; disabled as a
+ *          benchmark, run with --gtest_also_run_disabled_tests.
+ */
+TEST_F(SAPInitializedTest, DISABLED_SAPPlayBufferRawVersusJson) {
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+        _T("open"),
+        _T("{\"audiotype\": \"pcm\",\"sourcetype\": \"data\",\"playmode\": \"system\" }"),
+         response
+    ));
+
+    size_t idPos = response.find("\"id\"");
+    ASSERT_NE(string::npos, idPos) << "Error: 'id' not found in the response.";
+    size_t idStart = response.find(':', idPos) + 1;
+    size_t idEnd = response.find(',', idPos);
+    int playerId = std::stoi(response.substr(idStart, idEnd - idStart));
+
+    // Stays below the player queue plus appsrc limits, so neither path waits for room
+    const int chunks = 100;
+    std::vector<uint8_t> pcm(3840);
+    for (size_t i = 0; i < pcm.size(); i++)
+        pcm[i] = (uint8_t)i;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < chunks; i++) {
+        string encoded;
+        Core::ToString(pcm.data(), pcm.size(), true, encoded);
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+            _T("playbuffer"),
+            _T("{\"id\": ") + std::to_string(playerId) + _T(",\"data\": \"") + encoded + _T("\"}"),
+            response
+        ));
+    }
+    double jsonUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("stop"), _T("{\"id\": ") + std::to_string(playerId) + _T("}"), response));
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < chunks; i++)
+        EXPECT_EQ(Core::ERROR_NONE, SystemAudioPlayerImplementation->PlayBufferRaw(playerId, pcm.data(), pcm.size()));
+    double rawUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    printf("[ BENCH    ] %zu byte chunks: playbuffer (JSON) %.1f us/chunk, PlayBufferRaw %.1f us/chunk\n",
+        pcm.size(), jsonUs / chunks, rawUs / chunks);
+}
+#endif
+
 /*******************************************************************************************************************
  * Test function for setMixerLevel
  * setMixerLevel                 :
@@ -1851,3 +2034,175 @@ TEST_F(SAPInitializedTest, SAPGetPlayerSessionIdInvalidUrl) {
         ));
     EXPECT_EQ(response, _T("{\"success\":false}")); 
 }
+
+#ifdef SYSTEMAUDIOPLAYER_EXTENDED_API
+/*******************************************************************************************************************
+ * Test function for getStatistics
+ * getStatistics           :
+ *                Playback counters of one player, or totals over all players
+ *                and the shared pools without an id
+ *
+ *                @return Response object contains statistics and success
+ * Use case coverage:
+ *                @Success : 2
+ *                @Failure : 1
+ ********************************************************************************************************************/
+/**
+ * @name  : SAPGetStatistics
+ * @brief : Statistics of an open data player, of all players, and of an unknown player
+ *
+ * @param[in]   :  id
+ * @return      :  {statistics: {...}, success: true} / {success: false}
+ */
+TEST_F(SAPInitializedTest, SAPGetStatistics) {
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+        _T("open"),
+        _T("{\"audiotype\": \"pcm\",\"sourcetype\": \"data\",\"playmode\": \"system\" }"),
+         response
+    ));
+
+    size_t idPos = response.find("\"id\"");
+    if (idPos != string::npos) {
+        size_t idStart = response.find(':', idPos) + 1;
+        size_t idEnd = response.find(',', idPos);
+        int playerId = std::stoi(response.substr(idStart, idEnd - idStart));
+
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+            _T("getStatistics"),
+            _T("{\"id\": ") + std::to_string(playerId) + _T("}"),
+            response
+        ));
+        EXPECT_NE(response.find("\"statistics\""), string::npos);
+        EXPECT_NE(response.find("\"bytesReceived\""), string::npos);
+        EXPECT_NE(response.find("\"success\":true"), string::npos);
+
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+            _T("getStatistics"),
+            _T("{}"),
+            response
+        ));
+        EXPECT_NE(response.find("\"sessions\":1"), string::npos);
+        EXPECT_NE(response.find("\"feederPool\""), string::npos);
+        EXPECT_NE(response.find("\"success\":true"), string::npos);
+
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+            _T("getStatistics"),
+            _T("{\"id\": ") + std::to_string(playerId + 1) + _T("}"),
+            response
+        ));
+        EXPECT_EQ(response, _T("{\"success\":false}"));
+    } else {
+        EXPECT_TRUE(false) << "Error: 'id' not found in the response.";
+    }
+}
+
+/*******************************************************************************************************************
+ * Test function for enqueue
+ * enqueue                 :
+ *                Plays a file or http item gaplessly after the current one
+ *
+ *                @return Response object success status
+ * Use case coverage:
+ *                @Failure : 3
+ ********************************************************************************************************************/
+/**
+ * @name  : SAPEnqueueRejected
+ * @brief : Enqueue on a data player, on a file player with nothing playing, and with a url of the wrong source
+ *
+ * @param[in]   :  id , url
+ * @return      :  {success: false}
+ */
+TEST_F(SAPInitializedTest, SAPEnqueueRejected) {
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+        _T("open"),
+        _T("{\"audiotype\": \"pcm\",\"sourcetype\": \"data\",\"playmode\": \"system\" }"),
+         response
+    ));
+    size_t idPos = response.find("\"id\"");
+    ASSERT_NE(idPos, string::npos);
+    int dataId = std::stoi(response.substr(response.find(':', idPos) + 1));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+        _T("enqueue"),
+        _T("{\"id\": ") + std::to_string(dataId) + _T(", \"url\": \"data://\"}"),
+        response
+    ));
+    EXPECT_EQ(response, _T("{\"success\":false}"));
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+        _T("open"),
+        _T("{\"audiotype\": \"pcm\",\"sourcetype\": \"filesrc\",\"playmode\": \"system\" }"),
+         response
+    ));
+    idPos = response.find("\"id\"");
+    ASSERT_NE(idPos, string::npos);
+    int fileId = std::stoi(response.substr(response.find(':', idPos) + 1));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+        _T("enqueue"),
+        _T("{\"id\": ") + std::to_string(fileId) + _T(", \"url\": \"file:///tmp/chime.wav\"}"),
+        response
+    ));
+    EXPECT_EQ(response, _T("{\"success\":false}"));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+        _T("enqueue"),
+        _T("{\"id\": ") + std::to_string(fileId) + _T(", \"url\": \"http://host/chime.wav\"}"),
+        response
+    ));
+    EXPECT_EQ(response, _T("{\"success\":false}"));
+}
+
+/*******************************************************************************************************************
+ * Test function for prepareOnly and playAt
+ * prepareOnly             :
+ *                Prerolls a url without starting it
+ * playAt                  :
+ *                Starts a url so that it is heard at a CLOCK_MONOTONIC time
+ *
+ *                @return Response object success status
+ * Use case coverage:
+ *                @Failure : 3
+ ********************************************************************************************************************/
+/**
+ * @name  : SAPPlayAtRejected
+ * @brief : Prepare a websocket player, and playAt without a time or with a url of the wrong source
+ *
+ * @param[in]   :  id , url , monotonicTimeNs
+ * @return      :  {success: false}
+ */
+TEST_F(SAPInitializedTest, SAPPlayAtRejected) {
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+        _T("open"),
+        _T("{\"audiotype\": \"pcm\",\"sourcetype\": \"websocket\",\"playmode\": \"system\" }"),
+         response
+    ));
+    size_t idPos = response.find("\"id\"");
+    ASSERT_NE(idPos, string::npos);
+    int wsId = std::stoi(response.substr(response.find(':', idPos) + 1));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+        _T("prepareOnly"),
+        _T("{\"id\": ") + std::to_string(wsId) + _T(", \"url\": \"ws://host/tts\"}"),
+        response
+    ));
+    EXPECT_EQ(response, _T("{\"success\":false}"));
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+        _T("open"),
+        _T("{\"audiotype\": \"pcm\",\"sourcetype\": \"filesrc\",\"playmode\": \"app\" }"),
+         response
+    ));
+    idPos = response.find("\"id\"");
+    ASSERT_NE(idPos, string::npos);
+    int fileId = std::stoi(response.substr(response.find(':', idPos) + 1));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+        _T("playAt"),
+        _T("{\"id\": ") + std::to_string(fileId) + _T(", \"url\": \"file:///tmp/chime.wav\"}"),
+        response
+    ));
+    EXPECT_EQ(response, _T("{\"success\":false}"));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection,
+        _T("playAt"),
+        _T("{\"id\": ") + std::to_string(fileId) + _T(", \"url\": \"http://host/chime.wav\", \"monotonicTimeNs\": 5000000000}"),
+        response
+    ));
+    EXPECT_EQ(response, _T("{\"success\":false}"));
+}
+#endif
@@ -0,0 +1,215 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "impl/TTSDuckingController.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using TTS::DuckingController;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Records the gains the controller sends to the mixer
+class Mixer
+{
+    public:
+    DuckingController::VolumeSetter setter()
+    {
+        return [this](int level) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_levels.push_back(level);
+            m_times.push_back(Clock::now());
+        };
+    }
+
+    std::vector<int> levels()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_levels;
+    }
+
+    Clock::time_point lastTime()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_times.empty() ? Clock::time_point() : m_times.back();
+    }
+
+    bool waitFor(int level, int ms = 2000)
+    {
+        for(int i = 0; i < ms; i++)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(!m_levels.empty() && m_levels.back() == level)
+                    return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+
+    private:
+    std::mutex m_mutex;
+    std::vector<int> m_levels;
+    std::vector<Clock::time_point> m_times;
+};
+
+}
+
+TEST(TTSDuckingControllerTest, AppliesAtOnceWithoutRamps)
+{
+    Mixer mixer;
+    DuckingController ducking(mixer.setter());
+    ducking.configure(0, 0, 0);
+    ducking.duck(30);
+    ducking.release();
+    ducking.duck(40);
+    ducking.release(false);
+    EXPECT_EQ(std::vector<int>({ 30, 100, 40, 100 }), mixer.levels());
+    EXPECT_EQ(4u, ducking.requests());
+    EXPECT_EQ(4u, ducking.mixerCalls());
+}
+
+TEST(TTSDuckingControllerTest, SkipsGainsAlreadyApplied)
+{
+    Mixer mixer;
+    DuckingController ducking(mixer.setter());
+    ducking.configure(0, 0, 0);
+    ducking.duck(30);
+    ducking.duck(30);
+    ducking.duck(30);
+    ducking.release(false);
+    ducking.release(false);
+    EXPECT_EQ(std::vector<int>({ 30, 100 }), mixer.levels());
+    EXPECT_EQ(5u, ducking.requests());
+    EXPECT_EQ(2u, ducking.mixerCalls());
+}
+
+TEST(TTSDuckingControllerTest, HoldKeepsBackToBackUtterancesDucked)
+{
+    Mixer mixer;
+    DuckingController ducking(mixer.setter());
+    ducking.configure(200, 0, 0);
+    ducking.duck(30);
+    ducking.release();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    // The next utterance within the hold cancels the release
+    ducking.duck(30);
+    ducking.release();
+    Clock::time_point released = Clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(std::vector<int>({ 30 }), mixer.levels());
+
+    ASSERT_TRUE(mixer.waitFor(100));
+    EXPECT_GE(mixer.lastTime() - released, std::chrono::milliseconds(200));
+    EXPECT_EQ(std::vector<int>({ 30, 100 }), mixer.levels());
+
+    // A release without hold does not wait
+    ducking.duck(30);
+    ducking.release(false);
+    EXPECT_EQ(std::vector<int>({ 30, 100, 30, 100 }), mixer.levels());
+}
+
+TEST(TTSDuckingControllerTest, RampsDownOverAttackAndUpOverRelease)
+{
+    Mixer mixer;
+    DuckingController ducking(mixer.setter());
+    ducking.configure(0, 200, 200);
+    // Nothing applied yet, so full volume is set without a ramp
+    ducking.release(false);
+    ASSERT_EQ(std::vector<int>({ 100 }), mixer.levels());
+
+    Clock::time_point start = Clock::now();
+    ducking.duck(20);
+    ASSERT_TRUE(mixer.waitFor(20));
+    EXPECT_GE(mixer.lastTime() - start, std::chrono::milliseconds(200));
+    std::vector<int> down = mixer.levels();
+    // Steps in between, each lower than the one before
+    EXPECT_GT(down.size(), 3u);
+    for(size_t i = 1; i < down.size(); i++)
+    {
+        EXPECT_LT(down[i], down[i - 1]);
+        EXPECT_GE(down[i], 20);
+    }
+
+    start = Clock::now();
+    ducking.release(false);
+    ASSERT_TRUE(mixer.waitFor(100));
+    EXPECT_GE(mixer.lastTime() - start, std::chrono::milliseconds(200));
+    std::vector<int> levels = mixer.levels();
+    std::vector<int> up(levels.begin() + down.size(), levels.end());
+    EXPECT_GT(up.size(), 2u);
+    EXPECT_GT(up.front(), 20);
+    for(size_t i = 1; i < up.size(); i++)
+        EXPECT_GT(up[i], up[i - 1]);
+}
+
+TEST(TTSDuckingControllerTest, DuckDuringReleaseRampTurnsBack)
+{
+    Mixer mixer;
+    DuckingController ducking(mixer.setter());
+    ducking.configure(0, 100, 400);
+    ducking.duck(20);
+    ducking.release(false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // Halfway up the release ramp, the next utterance ducks again
+    ducking.duck(20);
+    ASSERT_TRUE(mixer.waitFor(20));
+    std::vector<int> levels = mixer.levels();
+    int highest = 0;
+    for(int level : levels)
+        highest = std::max(highest, level);
+    EXPECT_GT(highest, 20);
+    EXPECT_LT(highest, 100);
+}
+
+TEST(TTSDuckingControllerTest, ShutdownRestoresFullVolume)
+{
+    Mixer mixer;
+    DuckingController ducking(mixer.setter());
+    ducking.configure(1000, 0, 0);
+    ducking.duck(30);
+    ducking.release();
+    ducking.shutdown();
+    EXPECT_EQ(std::vector<int>({ 30, 100 }), mixer.levels());
+
+    // Nothing reaches the mixer once shut down
+    ducking.duck(30);
+    ducking.shutdown();
+    EXPECT_EQ(std::vector<int>({ 30, 100 }), mixer.levels());
+}
+
+TEST(TTSDuckingControllerTest, ShutdownWithoutDucking)
+{
+    Mixer mixer;
+    {
+        DuckingController ducking(mixer.setter());
+        ducking.configure(100, 100, 100);
+    }
+    EXPECT_TRUE(mixer.levels().empty());
+}
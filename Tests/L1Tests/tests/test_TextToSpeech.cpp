@@ -36,6 +36,8 @@
 #include <fstream>
 #include <string>
 #include <regex>
+#include <atomic>
+#include <thread>
 
 class SpeakResponse : public WPEFramework::Core::JSON::Container {
 public:
@@ -127,6 +129,24 @@ protected:
             file.close();
         }
     }
+    void mockTTSConfigureLazyInit()
+    {
+        std::ofstream file(TTS_CONFIG_FILE_PATH, std::ios::out | std::ios::trunc);
+        if (file.is_open()) {
+            std::string json ="{\"endpoint\":\"http://example-tts-dummy.net/tts/v1/cdn/location?\","
+                    "\"secureendpoint\":\"https://example-tts-dummy.net/tts/v1/cdn/location?\","
+                    "\"speechrate\":\"medium\","
+                    "\"language\":\"en-us\","
+                    "\"volume\":100,"
+                    "\"rate\":50,"
+                    "\"lazyinit\":\"true\","
+                    "\"voices\":{\"en-us\":\"carol\",\"es-MX\":\"amelie\",\"fr-CA\":\"angelica\",\"en-GB\":\"ava\",\"de-DE\":\"de-DE\",\"it-IT\":\"it-IT\"}"
+                    "}";
+
+            file << json;
+            file.close();
+        }
+    }
     TTSTest()
         : plugin(Core::ProxyType<Plugin::TextToSpeech>::Create())
         , handler(*(plugin))
@@ -320,6 +340,9 @@ TEST_F(TTSInitializedTest,RegisteredMethods) {
     EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("resume")));
     EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("setttsconfiguration")));
     EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("speak")));
+#ifdef TEXTTOSPEECH_EXTENDED_API
+    EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("speakbatch")));
+#endif
     EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("setACL")));
 }
 
@@ -542,6 +565,44 @@ TEST_F(TTSInitializedTest,Speak) {
     EXPECT_THAT(response, ::testing::ContainsRegex(_T("\"success\":true")));
 }
 
+#ifdef TEXTTOSPEECH_EXTENDED_API
+/**
+ * @name  : SpeakBatch
+ * @brief : Queues several texts in one call and returns the first of their contiguous speech ids.
+ *
+ * @param[in]   :  texts
+ * @return      :  ERROR_NONE
+ */
+
+TEST_F(TTSInitializedTest,SpeakBatch) {
+    mockTTSConfigure();
+    EXPECT_EQ(string(""), plugin->Initialize(&service));
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("speakbatch"), _T("{\"texts\": [\"speech_1\", \"speech_2\", \"speech_3\"]}"), response));
+    sleep(3);
+
+    EXPECT_THAT(response, ::testing::ContainsRegex(_T("\"firstspeechid\"")));
+    EXPECT_THAT(response, ::testing::ContainsRegex(_T("\"count\":3")));
+    EXPECT_THAT(response, ::testing::ContainsRegex(_T("\"TTS_Status\":0")));
+    EXPECT_THAT(response, ::testing::ContainsRegex(_T("\"success\":true")));
+}
+
+/**
+ * @name  : SpeakBatchEmptyText
+ * @brief : A batch holding an empty text is rejected as a whole.
+ *
+ * @param[in]   :  texts with an empty entry
+ * @return      :  ERROR_GENERAL
+ */
+
+TEST_F(TTSInitializedTest,SpeakBatchEmptyText) {
+    mockTTSConfigure();
+    EXPECT_EQ(string(""), plugin->Initialize(&service));
+
+    EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("speakbatch"), _T("{\"texts\": [\"speech_1\", \"\"]}"), response));
+}
+#endif
+
 /*******************************************************************************************************************
  * Test function for IsSpeaking
  * SpeechState          :
@@ -1743,8 +1804,11 @@ TEST_F(TTSInitializedTest,SpeakWithRFCURL) {
     EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("enabletts"), _T("{\"enabletts\": true}"), response));
     EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("speak"), _T("{\"text\": \"speech_123\"}"), response));
     sleep(2);
-    g_timeout_add(100, (GSourceFunc)push_data, this->sourceMock); // every 100ms
-    sleep(2);
+    // TTS handles its bus on a private main context, so feed appsrc from here
+    for (int i = 0; i < 20; i++) {
+        push_data(this->sourceMock); // every 100ms
+        usleep(100 * 1000);
+    }
     g_signal_emit_by_name(this->sourceMock, "end-of-stream", NULL);
     sleep(2);
     EXPECT_THAT(response, ::testing::ContainsRegex(_T("\"speechid\"")));
@@ -1752,6 +1816,54 @@ TEST_F(TTSInitializedTest,SpeakWithRFCURL) {
     EXPECT_THAT(response, ::testing::ContainsRegex(_T("\"success\":true")));
 }
 
+/**
+ * @name  : SpeakWithLazyInit
+ * @brief : With lazyinit configured, Initialize only parses the configuration. RFC registration
+ *          and the audio platform are brought up off the calling thread or by the first speak.
+ *
+ * @param[in]   :  text
+ * @return      :  ERROR_NONE
+ */
+TEST_F(TTSInitializedTest,SpeakWithLazyInit) {
+    const std::thread::id caller = std::this_thread::get_id();
+    std::atomic<bool> initializing(false);
+    std::atomic<int> startedDuringInit(0);
+    std::atomic<int> platformInits(0);
+    std::atomic<int> rfcRegistrations(0);
+
+    EXPECT_CALL(*p_systemAudioPlatformMock, systemAudioInitialize())
+        .WillRepeatedly(::testing::Invoke([&]() {
+            if (initializing && std::this_thread::get_id() == caller)
+                startedDuringInit++;
+            platformInits++;
+        }));
+    EXPECT_CALL(service, QueryInterfaceByCallsign(::testing::_, ::testing::_))
+        .Times(::testing::AnyNumber());
+    EXPECT_CALL(service, QueryInterfaceByCallsign(::testing::_, string("org.rdk.System")))
+        .WillRepeatedly(::testing::Invoke([&](const uint32_t, const string&) -> void* {
+            if (initializing && std::this_thread::get_id() == caller)
+                startedDuringInit++;
+            rfcRegistrations++;
+            return nullptr;
+        }));
+
+    mockTTSConfigureLazyInit();
+    initializing = true;
+    EXPECT_EQ(string(""), plugin->Initialize(&service));
+    initializing = false;
+    EXPECT_EQ(0, startedDuringInit.load());
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("enabletts"), _T("{\"enabletts\": true}"), response));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("speak"), _T("{\"text\": \"speech_123\"}"), response));
+    // Startup is complete once the first speak has returned
+    EXPECT_EQ(1, platformInits.load());
+    EXPECT_EQ(1, rfcRegistrations.load());
+    sleep(2);
+    EXPECT_THAT(response, ::testing::ContainsRegex(_T("\"speechid\"")));
+    EXPECT_THAT(response, ::testing::ContainsRegex(_T("\"TTS_Status\":0")));
+    EXPECT_THAT(response, ::testing::ContainsRegex(_T("\"success\":true")));
+}
+
 TEST_F(TTSInitializedTest,SetACLWromgApp) {
     EXPECT_EQ(string(""), plugin->Initialize(&service));
     EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(
@@ -1811,8 +1923,11 @@ TEST_F(TTSInitializedTest, PauseResumeAfterSPeak) {
     int speechId = ExtractSpeechId(response);
     std::string speechIdParam = std::string("{\"speechid\": ") + std::to_string(speechId) +"}";
     sleep(2);
-    g_timeout_add(100, (GSourceFunc)push_data, this->sourceMock); // every 100ms
-    sleep(2);
+    // TTS handles its bus on a private main context, so feed appsrc from here
+    for (int i = 0; i < 20; i++) {
+        push_data(this->sourceMock); // every 100ms
+        usleep(100 * 1000);
+    }
     EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("pause"), speechIdParam, response));
     sleep(1);
     EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("resume"), speechIdParam, response));
@@ -0,0 +1,237 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "WebSockets/Encryption/TlsSessionCache.h"
+
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+
+#include <chrono>
+#include <ctime>
+
+using WebSockets::TlsSessionCache;
+
+namespace {
+
+SSL_SESSION* newSession(long timeout)
+{
+    SSL_SESSION* session = SSL_SESSION_new();
+    SSL_SESSION_set_time(session, (long)time(nullptr));
+    SSL_SESSION_set_timeout(session, timeout);
+    // A session without a master key or id does not count as resumable
+    const unsigned char secret[48] = { 1 };
+    SSL_SESSION_set1_master_key(session, secret, sizeof(secret));
+    const unsigned char id[32] = { 2 };
+    SSL_SESSION_set1_id(session, id, sizeof(id));
+    SSL_SESSION_set_protocol_version(session, TLS1_2_VERSION);
+    return session;
+}
+
+// Server with a self-signed RSA 2048 certificate, like a typical audio
+// streaming server behind wss://
+class Server
+{
+    public:
+    Server() : m_key(nullptr), m_cert(nullptr), m_ctx(SSL_CTX_new(TLS_server_method()))
+    {
+        EVP_PKEY_CTX* keyCtx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr);
+        EVP_PKEY_keygen_init(keyCtx);
+        EVP_PKEY_CTX_set_rsa_keygen_bits(keyCtx, 2048);
+        EVP_PKEY_keygen(keyCtx, &m_key);
+        EVP_PKEY_CTX_free(keyCtx);
+
+        m_cert = X509_new();
+        X509_set_version(m_cert, 2);
+        ASN1_INTEGER_set(X509_get_serialNumber(m_cert), 1);
+        X509_gmtime_adj(X509_getm_notBefore(m_cert), 0);
+        X509_gmtime_adj(X509_getm_notAfter(m_cert), 3600);
+        X509_set_pubkey(m_cert, m_key);
+        X509_NAME* name = X509_get_subject_name(m_cert);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"localhost", -1, -1, 0);
+        X509_set_issuer_name(m_cert, name);
+        X509_sign(m_cert, m_key, EVP_sha256());
+
+        SSL_CTX_use_certificate(m_ctx, m_cert);
+        SSL_CTX_use_PrivateKey(m_ctx, m_key);
+    }
+
+    ~Server()
+    {
+        SSL_CTX_free(m_ctx);
+        X509_free(m_cert);
+        EVP_PKEY_free(m_key);
+    }
+
+    SSL_CTX* ctx() { return m_ctx; }
+
+    private:
+    EVP_PKEY* m_key;
+    X509* m_cert;
+    SSL_CTX* m_ctx;
+};
+
+// Connects a client of clientCtx to the server over memory BIOs, returns
+// false if the handshake fails
+bool connect(TlsSessionCache& cache, SSL_CTX* clientCtx, Server& server, const std::string& key)
+{
+    SSL* client = SSL_new(clientCtx);
+    SSL* peer = SSL_new(server.ctx());
+    BIO* clientBio = nullptr;
+    BIO* serverBio = nullptr;
+    BIO_new_bio_pair(&clientBio, 0, &serverBio, 0);
+    SSL_set_bio(client, clientBio, clientBio);
+    SSL_set_bio(peer, serverBio, serverBio);
+    SSL_set_connect_state(client);
+    SSL_set_accept_state(peer);
+
+    auto start = std::chrono::steady_clock::now();
+    cache.attach(client, key);
+    bool clientDone = false;
+    bool serverDone = false;
+    for (int round = 0; round < 100 && !(clientDone && serverDone); round++)
+    {
+        if (!clientDone)
+        {
+            int ret = SSL_do_handshake(client);
+            if (ret == 1)
+                clientDone = true;
+            else if (SSL_get_error(client, ret) != SSL_ERROR_WANT_READ)
+                break;
+        }
+        if (!serverDone)
+        {
+            int ret = SSL_do_handshake(peer);
+            if (ret == 1)
+                serverDone = true;
+            else if (SSL_get_error(peer, ret) != SSL_ERROR_WANT_READ)
+                break;
+        }
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // TLS 1.3 tickets follow the handshake and are read with the data
+    char byte;
+    SSL_write(peer, "x", 1);
+    SSL_read(client, &byte, 1);
+
+    bool done = clientDone && serverDone;
+    if (done)
+        cache.handshakeDone(client, ms);
+    // OpenSSL does not resume sessions of connections that were not shut
+    // down cleanly
+    SSL_shutdown(client);
+    SSL_shutdown(peer);
+    SSL_free(client);
+    SSL_free(peer);
+    return done;
+}
+
+}
+
+TEST(SAPTlsSessionCacheTest, KeepsRecentSessionsUntilTheyExpire)
+{
+    TlsSessionCache cache(2);
+    EXPECT_EQ(nullptr, cache.get("a:443|"));
+
+    SSL_SESSION* first = newSession(300);
+    cache.put("a:443|", first);
+    SSL_SESSION* found = cache.get("a:443|");
+    EXPECT_EQ(first, found);
+    SSL_SESSION_free(found);
+
+    // Replaced by a newer session for the same key
+    SSL_SESSION* second = newSession(300);
+    cache.put("a:443|", second);
+    found = cache.get("a:443|");
+    EXPECT_EQ(second, found);
+    SSL_SESSION_free(found);
+    EXPECT_EQ(1u, cache.stats().sessions);
+
+    // The least recently used goes beyond the capacity
+    cache.put("b:443|", newSession(300));
+    found = cache.get("a:443|");
+    SSL_SESSION_free(found);
+    cache.put("c:443|", newSession(300));
+    EXPECT_EQ(2u, cache.stats().sessions);
+    EXPECT_EQ(nullptr, cache.get("b:443|"));
+    found = cache.get("a:443|");
+    EXPECT_NE(nullptr, found);
+    SSL_SESSION_free(found);
+
+    // Expired sessions are not offered
+    SSL_SESSION* old = newSession(10);
+    SSL_SESSION_set_time(old, (long)time(nullptr) - 20);
+    cache.put("d:443|", old);
+    EXPECT_EQ(nullptr, cache.get("d:443|"));
+
+    cache.remove("a:443|");
+    EXPECT_EQ(nullptr, cache.get("a:443|"));
+    cache.setCapacity(0);
+    EXPECT_EQ(0u, cache.stats().sessions);
+}
+
+TEST(SAPTlsSessionCacheTest, KeyCoversVerificationSettings)
+{
+    const std::vector<std::string> CAs = { "/etc/ssl/ca1.pem", "/etc/ssl/ca2.pem" };
+    const std::string key = TlsSessionCache::key("a", 443, "client.pem", "client.key", CAs);
+    EXPECT_EQ(key, TlsSessionCache::key("a", 443, "client.pem", "client.key", CAs));
+
+    EXPECT_NE(key, TlsSessionCache::key("a", 8443, "client.pem", "client.key", CAs));
+    EXPECT_NE(key, TlsSessionCache::key("a", 443, "other.pem", "client.key", CAs));
+    EXPECT_NE(key, TlsSessionCache::key("a", 443, "client.pem", "other.key", CAs));
+    // A stricter or different CA list does not resume sessions verified with this one
+    EXPECT_NE(key, TlsSessionCache::key("a", 443, "client.pem", "client.key", { "/etc/ssl/ca1.pem" }));
+    EXPECT_NE(key, TlsSessionCache::key("a", 443, "client.pem", "client.key", { "/etc/ssl/ca2.pem", "/etc/ssl/ca3.pem" }));
+    EXPECT_NE(key, TlsSessionCache::key("a", 443, "client.pem", "client.key", {}));
+}
+
+/**
+ * @name  : ResumedHandshakes
+ * @brief : Connects 50 times to a server with an RSA 2048 certificate over
+ *          memory BIOs, for TLS 1.2 and TLS 1.3. Every connection after
+ *          the first resumes the cached session.
+ */
+TEST(SAPTlsSessionCacheTest, ResumedHandshakes)
+{
+    Server server;
+    for (int version : { TLS1_2_VERSION, TLS1_3_VERSION })
+    {
+        TlsSessionCache cache;
+        SSL_CTX* clientCtx = SSL_CTX_new(TLS_client_method());
+        SSL_CTX_set_min_proto_version(clientCtx, version);
+        SSL_CTX_set_max_proto_version(clientCtx, version);
+        TlsSessionCache::enable(clientCtx);
+
+        const int connections = 50;
+        for (int i = 0; i < connections; i++)
+            ASSERT_TRUE(connect(cache, clientCtx, server, "localhost:443|"));
+        // A different server is not offered the session
+        ASSERT_TRUE(connect(cache, clientCtx, server, "other:443|"));
+
+        TlsSessionCache::Stats stats = cache.stats();
+        EXPECT_EQ((uint64_t)connections + 1, stats.handshakes);
+        EXPECT_EQ((uint64_t)connections - 1, stats.offered);
+        EXPECT_EQ((uint64_t)connections - 1, stats.resumed);
+        EXPECT_EQ(2u, stats.sessions);
+        SSL_CTX_free(clientCtx);
+    }
+}
@@ -21,7 +21,7 @@
 
 #define API_VERSION_NUMBER_MAJOR 1
 #define API_VERSION_NUMBER_MINOR 0
-#define API_VERSION_NUMBER_PATCH 35
+#define API_VERSION_NUMBER_PATCH 36
 #define API_VERSION_NUMBER 1
 
 namespace WPEFramework {
@@ -174,6 +174,9 @@ namespace Plugin {
         // Mandotory TTS APIs for client application
         uint32_t IsEnabled(const JsonObject& parameters, JsonObject& response);
         uint32_t Speak(const JsonObject& parameters, JsonObject& response);
+#ifdef TEXTTOSPEECH_EXTENDED_API
+        uint32_t SpeakBatch(const JsonObject& parameters, JsonObject& response);
+#endif
         uint32_t Cancel(const JsonObject& parameters, JsonObject& response);
 
         // These extended APIS can be used by Client application if needed
@@ -26,6 +26,7 @@
 
 #include "TextToSpeechValidator.h"
 #include "impl/RFCURLObserver.h"
+#include "impl/TTSStartupTrace.h"
 
 #define TTS_MAJOR_VERSION 1
 #define TTS_MINOR_VERSION 0
@@ -48,7 +49,7 @@ namespace Plugin {
 
     TTS::TTSManager* TextToSpeechImplementation::_ttsManager = NULL;
 
-    TextToSpeechImplementation::TextToSpeechImplementation() : _adminLock()
+    TextToSpeechImplementation::TextToSpeechImplementation() : _adminLock(), _service(nullptr), _startupPending(false)
     {
         if(!_ttsManager)
             _ttsManager = TTS::TTSManager::create(this);
@@ -56,6 +57,10 @@ namespace Plugin {
 
     TextToSpeechImplementation::~TextToSpeechImplementation()
     {
+        if(_service) {
+            _service->Release();
+            _service = nullptr;
+        }
         if(_ttsManager) {
             delete _ttsManager;
             _ttsManager = NULL;
@@ -91,8 +96,7 @@ namespace Plugin {
         InputValidation::Instance().addValidator("setPrimaryVolDuck", ExpectedValues<uint8_t>(0, 100));
 
         TTS::TTSConfiguration *ttsConfig = _ttsManager->configuration();
-        TTS::RFCURLObserver::getInstance()->triggerRFC(service, ttsConfig);
-        
+
         JsonObject config;
         std::string jsonText;
         if (!readTTSConfigFile(TTS_CONFIG_FILE_PATH, jsonText)) {
@@ -100,6 +104,20 @@ namespace Plugin {
         }
         TTSLOG_INFO("tts config %s\n", jsonText.c_str());
         config.FromString(jsonText);
+
+        // With lazy init only the configuration is parsed here; RFC, SAT and
+        // the GStreamer side are brought up in the background or on first Speak
+        bool lazyInit = (GET_STR(config, "lazyinit", "false") == "true");
+        if(lazyInit) {
+            _service = service;
+            _service->AddRef();
+            _startupPending = true;
+        } else {
+            TTS::StartupTrace::Phase phase("rfc");
+            TTS::RFCURLObserver::getInstance()->triggerRFC(service, ttsConfig);
+        }
+
+        TTS::StartupTrace::Phase configPhase("configure");
         ttsConfig->setEndPoint(GET_STR(config, "endpoint", ""));
         ttsConfig->setSecureEndPoint(GET_STR(config, "secureendpoint", ""));
         ttsConfig->setLocalEndPoint(GET_STR(config, "localendpoint", ""));
@@ -111,6 +129,9 @@ namespace Plugin {
         ttsConfig->setRate(std::stoi(GET_STR(config, "rate", "50")));
         ttsConfig->setPrimVolDuck(std::stoi(GET_STR(config,"primvolduckpercent", "25")));
         ttsConfig->setSATPluginCallsign(GET_STR(config, "satplugincallsign", ""));
+        _ttsManager->configureDucking(std::stoi(GET_STR(config, "duckholdms", "250")),
+                std::stoi(GET_STR(config, "duckattackms", "0")),
+                std::stoi(GET_STR(config, "duckreleasems", "0")));
 
         std::set<std::string> expectedLanguageSet;
         std::set<std::string> expectedVoicesSet;
@@ -188,10 +209,38 @@ namespace Plugin {
             }
         }
 
+        if(lazyInit) {
+            Core::IWorkerPool::Instance().Submit(StartupJob::Create(this));
+        } else {
+            _ttsManager->startSpeaker();
+        }
+
         _ttsManager->enableTTS(ttsConfig->enabled());
         return 0;
     }
 
+    void TextToSpeechImplementation::CompleteStartup()
+    {
+        std::lock_guard<std::mutex> lock(_startupLock);
+        if(!_startupPending)
+            return;
+
+        if(_service) {
+            {
+                TTS::StartupTrace::Phase phase("rfc");
+                TTS::RFCURLObserver::getInstance()->triggerRFC(_service, _ttsManager->configuration());
+            }
+            _service->Release();
+            _service = nullptr;
+        }
+
+        _ttsManager->startSpeaker();
+        _ttsManager->prefetchSAT();
+
+        _startupPending = false;
+        TTS::StartupTrace::instance().report("lazy startup");
+    }
+
     Core::hresult TextToSpeechImplementation::Register(Exchange::ITextToSpeech::INotification* sink)
     {
         _adminLock.Lock();
@@ -432,19 +481,30 @@ namespace Plugin {
         return (Core::ERROR_NONE);
     }
 
-    uint32_t nextSpeechId() {
+    // Returns the first of |count| consecutive ids. The counter restarts
+    // rather than wrapping in the middle of a batch.
+    uint32_t reserveSpeechIds(uint32_t count) {
         static uint32_t counter = 0;
 
-        if(counter >= 0xFFFFFFFF)
+        if(counter > 0xFFFFFFFF - count)
             counter = 0;
 
-        return ++counter;
+        uint32_t first = counter + 1;
+        counter += count;
+        return first;
+    }
+
+    uint32_t nextSpeechId() {
+        return reserveSpeechIds(1);
     }
 
     Core::hresult TextToSpeechImplementation::Speak(const string callsign, const string text, uint32_t &speechid, Exchange::ITextToSpeech::TTSErrorDetail &ttsStatus)
     {
         CHECK_TTS_MANAGER_RETURN_ON_FAIL();
 
+        if(_startupPending)
+            CompleteStartup();
+
         _adminLock.Lock();
         speechid = nextSpeechId();
         auto status = _ttsManager->speak(speechid,callsign,text);
@@ -461,6 +521,40 @@ namespace Plugin {
         return (status == TTS::TTS_OK) ? (Core::ERROR_NONE) : (Core::ERROR_GENERAL);
     }
 
+#ifdef TEXTTOSPEECH_EXTENDED_API
+    Core::hresult TextToSpeechImplementation::SpeakBatch(const string callsign, RPC::IStringIterator* const texts, uint32_t &firstspeechid, Exchange::ITextToSpeech::TTSErrorDetail &ttsStatus)
+    {
+        CHECK_TTS_MANAGER_RETURN_ON_FAIL();
+
+        std::vector<std::string> batch;
+        string text;
+        while(texts != nullptr && texts->Next(text))
+            batch.push_back(text);
+
+        if(batch.empty()) {
+            firstspeechid = -1;
+            ttsStatus = Exchange::ITextToSpeech::TTSErrorDetail::TTS_FAIL;
+            logResponse(TTS::TTS_FAIL);
+            return (Core::ERROR_GENERAL);
+        }
+
+        if(_startupPending)
+            CompleteStartup();
+
+        _adminLock.Lock();
+        firstspeechid = reserveSpeechIds(batch.size());
+        auto status = _ttsManager->speakBatch(firstspeechid, callsign, batch);
+        ttsStatus = (Exchange::ITextToSpeech::TTSErrorDetail) status;
+        _adminLock.Unlock();
+
+        if(status != TTS::TTS_OK)
+            firstspeechid = -1;
+        TTSLOG_INFO("SpeakBatch invoked with %u texts, first speech id returned %d\n", (uint32_t)batch.size(), firstspeechid);
+        logResponse(status);
+        return (status == TTS::TTS_OK) ? (Core::ERROR_NONE) : (Core::ERROR_GENERAL);
+    }
+#endif
+
     Core::hresult TextToSpeechImplementation::Cancel(const uint32_t speechid)
     {
         CHECK_TTS_MANAGER_RETURN_ON_FAIL();
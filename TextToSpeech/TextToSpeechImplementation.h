@@ -27,6 +27,8 @@
 #include "impl/TTSManager.h"
 #include "impl/TTSConfiguration.h"
 #include <vector>
+#include <atomic>
+#include <mutex>
 
 namespace WPEFramework {
 namespace Plugin {
@@ -89,6 +91,43 @@ namespace Plugin {
             const JsonValue _params;
         };
 
+        // Runs the deferred part of plugin startup when lazy init is configured
+        class EXTERNAL StartupJob : public Core::IDispatch {
+        protected:
+             StartupJob(TextToSpeechImplementation *tts)
+                : _tts(tts) {
+                if (_tts != nullptr) {
+                    _tts->AddRef();
+                }
+            }
+
+       public:
+            StartupJob() = delete;
+            StartupJob(const StartupJob&) = delete;
+            StartupJob& operator=(const StartupJob&) = delete;
+            ~StartupJob() {
+                if (_tts != nullptr) {
+                    _tts->Release();
+                }
+            }
+
+       public:
+            static Core::ProxyType<Core::IDispatch> Create(TextToSpeechImplementation *tts) {
+#ifndef USE_THUNDER_R4
+                return (Core::proxy_cast<Core::IDispatch>(Core::ProxyType<StartupJob>::Create(tts)));
+#else
+                return (Core::ProxyType<Core::IDispatch>(Core::ProxyType<StartupJob>::Create(tts)));
+#endif
+            }
+
+            virtual void Dispatch() {
+                _tts->CompleteStartup();
+            }
+
+        private:
+            TextToSpeechImplementation *_tts;
+        };
+
     public:
         // We do not allow this plugin to be copied !!
         TextToSpeechImplementation(const TextToSpeechImplementation&) = delete;
@@ -115,6 +154,9 @@ namespace Plugin {
         virtual Core::hresult SetACL(const string method, const string apps) override;
         virtual Core::hresult GetConfiguration(Exchange::ITextToSpeech::Configuration &object/* @out */) const override;
         virtual Core::hresult Speak(const string callsign, const string text, uint32_t &speechid/* @out */, Exchange::ITextToSpeech::TTSErrorDetail &status/* @out */) override;
+#ifdef TEXTTOSPEECH_EXTENDED_API
+        virtual Core::hresult SpeakBatch(const string callsign, RPC::IStringIterator* const texts, uint32_t &firstspeechid/* @out */, Exchange::ITextToSpeech::TTSErrorDetail &status/* @out */) override;
+#endif
         virtual Core::hresult Cancel(const uint32_t speechid) override;
         virtual Core::hresult Pause(const uint32_t speechid, Exchange::ITextToSpeech::TTSErrorDetail &status /* @out */) override;
         virtual Core::hresult Resume(const uint32_t speechid, Exchange::ITextToSpeech::TTSErrorDetail &status /* @out */) override;
@@ -145,12 +187,20 @@ namespace Plugin {
         void dispatchEvent(Event,string callsign, const JsonValue &params);
         void Dispatch(Event event,string callsign, const JsonValue params);
 
+        // Lazy init: RFC, speaker threads and SAT are brought up from a
+        // StartupJob or by the first Speak, whichever comes first
+        void CompleteStartup();
+        PluginHost::IShell* _service;
+        std::mutex _startupLock;
+        std::atomic<bool> _startupPending;
+
 
     public:
         TextToSpeechImplementation();
         virtual ~TextToSpeechImplementation();
 
         friend class Job;
+        friend class StartupJob;
     };
 
 } // namespace Plugin
@@ -37,6 +37,9 @@ namespace Plugin {
         Register("getttsconfiguration", &TextToSpeech::GetConfiguration, this);
         Register("isttsenabled", &TextToSpeech::IsEnabled, this);
         Register("speak", &TextToSpeech::Speak, this);
+#ifdef TEXTTOSPEECH_EXTENDED_API
+        Register("speakbatch", &TextToSpeech::SpeakBatch, this);
+#endif
         Register("cancel", &TextToSpeech::Cancel, this);
         Register("pause", &TextToSpeech::Pause, this);
         Register("resume", &TextToSpeech::Resume, this);
@@ -270,6 +273,32 @@ uint32_t TextToSpeech::SetACL(const JsonObject& parameters, JsonObject& response
         return Core::ERROR_NONE;
     }
 
+#ifdef TEXTTOSPEECH_EXTENDED_API
+    uint32_t TextToSpeech::SpeakBatch(const JsonObject& parameters, JsonObject& response)
+    {
+        CHECK_TTS_PARAMETER_RETURN_ON_FAIL("texts");
+        if(_tts) {
+            std::list<string> texts;
+            JsonArray list = parameters["texts"].Array();
+            for (JsonArray::Iterator it = list.Elements(); it.Next();)
+                texts.push_back(it.Current().String());
+
+            uint32_t firstspeechid;
+            Exchange::ITextToSpeech::TTSErrorDetail status;
+            RPC::IStringIterator* iterator = Core::Service<RPC::StringIterator>::Create<RPC::IStringIterator>(texts);
+            _tts->SpeakBatch(parameters["callsign"].String(), iterator, firstspeechid, status);
+            iterator->Release();
+
+            // Item i of the batch is spoken with id firstspeechid + i
+            response["firstspeechid"] = (int) firstspeechid;
+            response["count"] = (int) texts.size();
+            response["TTS_Status"] = static_cast<uint32_t>(status);
+            returnResponse(status ==  Exchange::ITextToSpeech::TTSErrorDetail::TTS_OK);
+        }
+        return Core::ERROR_NONE;
+    }
+#endif
+
     uint32_t TextToSpeech::Cancel(const JsonObject& parameters, JsonObject& response)
     {
         CHECK_TTS_PARAMETER_RETURN_ON_FAIL("speechid");
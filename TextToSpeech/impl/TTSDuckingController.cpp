@@ -0,0 +1,177 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TTSDuckingController.h"
+#include "logger.h"
+
+#include <systemaudioplatform.h>
+
+#define FULL_VOLUME 100
+#define RAMP_STEP_MS 20
+
+namespace TTS {
+
+DuckingController::DuckingController() :
+    DuckingController([](int level) { systemAudioChangePrimaryVol(MIXGAIN_PRIM, level); }) {
+}
+
+DuckingController::DuckingController(const VolumeSetter &setVolume) :
+    m_setVolume(setVolume),
+    m_running(true),
+    m_holdMs(0),
+    m_attackMs(0),
+    m_releaseMs(0),
+    m_applied(-1),
+    m_rampFrom(FULL_VOLUME),
+    m_rampTo(FULL_VOLUME),
+    m_ramping(false),
+    m_rampDuration(0),
+    m_releasePending(false),
+    m_requests(0),
+    m_mixerCalls(0) {
+}
+
+DuckingController::~DuckingController() {
+    shutdown();
+}
+
+void DuckingController::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!m_running)
+            return;
+        m_running = false;
+    }
+    m_condition.notify_one();
+    if(m_thread.joinable())
+        m_thread.join();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ramping = false;
+    m_releasePending = false;
+    if(m_applied >= 0)
+        apply(FULL_VOLUME);
+}
+
+void DuckingController::configure(uint32_t holdMs, uint32_t attackMs, uint32_t releaseMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_holdMs = holdMs;
+    m_attackMs = attackMs;
+    m_releaseMs = releaseMs;
+    TTSLOG_INFO("Ducking hold=%ums attack=%ums release=%ums", holdMs, attackMs, releaseMs);
+}
+
+void DuckingController::duck(int level) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(!m_running)
+        return;
+    m_requests++;
+    m_releasePending = false;
+    startRamp(level, m_attackMs);
+    startThread();
+    m_condition.notify_one();
+}
+
+void DuckingController::release(bool hold) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(!m_running)
+        return;
+    m_requests++;
+    if(hold && m_holdMs > 0) {
+        if(!m_releasePending) {
+            m_releasePending = true;
+            m_releaseAt = Clock::now() + std::chrono::milliseconds(m_holdMs);
+        }
+    } else {
+        m_releasePending = false;
+        startRamp(FULL_VOLUME, m_releaseMs);
+    }
+    startThread();
+    m_condition.notify_one();
+}
+
+void DuckingController::startThread() {
+    if(m_thread.joinable() || !(m_ramping || m_releasePending))
+        return;
+    m_thread = std::thread(&DuckingController::run, this);
+}
+
+void DuckingController::startRamp(int target, uint32_t durationMs) {
+    if(durationMs == 0 || m_applied < 0) {
+        m_ramping = false;
+        apply(target);
+        return;
+    }
+
+    m_rampFrom = m_applied;
+    m_rampTo = target;
+    m_rampStart = Clock::now();
+    m_rampDuration = std::chrono::milliseconds(durationMs);
+    m_ramping = (m_rampFrom != m_rampTo);
+}
+
+void DuckingController::apply(int level) {
+    if(level == m_applied)
+        return;
+
+    m_setVolume(level);
+    m_applied = level;
+    m_mixerCalls++;
+
+    if(level == FULL_VOLUME) {
+        uint32_t requests = m_requests;
+        uint32_t calls = m_mixerCalls;
+        TTSLOG_INFO("Ducking released: %u duck/release requests, %u mixer calls, %d saved",
+                requests, calls, (int)requests - (int)calls);
+    }
+}
+
+void DuckingController::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(m_running) {
+        if(m_ramping)
+            m_condition.wait_for(lock, std::chrono::milliseconds(RAMP_STEP_MS));
+        else if(m_releasePending)
+            m_condition.wait_until(lock, m_releaseAt);
+        else
+            m_condition.wait(lock);
+
+        if(!m_running)
+            break;
+
+        Clock::time_point now = Clock::now();
+        if(m_releasePending && now >= m_releaseAt) {
+            m_releasePending = false;
+            startRamp(FULL_VOLUME, m_releaseMs);
+        }
+
+        if(m_ramping) {
+            Clock::duration elapsed = now - m_rampStart;
+            if(elapsed >= m_rampDuration) {
+                m_ramping = false;
+                apply(m_rampTo);
+            } else {
+                double fraction = (double) elapsed.count() / m_rampDuration.count();
+                apply(m_rampFrom + (int)((m_rampTo - m_rampFrom) * fraction));
+            }
+        }
+    }
+}
+
+} // namespace TTS
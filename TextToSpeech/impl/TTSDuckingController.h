@@ -0,0 +1,99 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _TTS_DUCKING_CONTROLLER_H_
+#define _TTS_DUCKING_CONTROLLER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace TTS {
+
+// Drives the primary (program) mixer gain while TTS is speaking.
+//
+// duck() ramps the primary volume down over the attack time. release()
+// keeps the duck for the hold time and then ramps back to full volume over
+// the release time; a duck() within the hold time cancels the release, so
+// back to back utterances keep the program audio ducked. Gains already
+// applied to the mixer are not sent again.
+//
+// The ramp thread is only started by the first duck or held release, so a
+// speaker that never speaks costs no thread.
+class DuckingController {
+public:
+    typedef std::function<void(int level)> VolumeSetter;
+
+    // Drives MIXGAIN_PRIM through systemaudioplatform
+    DuckingController();
+    explicit DuckingController(const VolumeSetter &setVolume);
+    ~DuckingController();
+
+    void configure(uint32_t holdMs, uint32_t attackMs, uint32_t releaseMs);
+
+    void duck(int level);
+    // hold=false releases without waiting for the hold time (e.g. on pause)
+    void release(bool hold = true);
+    // Restores full volume at once and stops; must precede systemAudioDeinitialize
+    void shutdown();
+
+    uint32_t requests() const { return m_requests; }
+    uint32_t mixerCalls() const { return m_mixerCalls; }
+
+private:
+    DuckingController(const DuckingController&) = delete;
+    DuckingController& operator=(const DuckingController&) = delete;
+
+    typedef std::chrono::steady_clock Clock;
+
+    void run();
+    // Caller holds m_mutex
+    void startRamp(int target, uint32_t durationMs);
+    void startThread();
+    void apply(int level);
+
+    const VolumeSetter m_setVolume;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::thread m_thread;
+    bool m_running;
+
+    uint32_t m_holdMs;
+    uint32_t m_attackMs;
+    uint32_t m_releaseMs;
+
+    int m_applied;
+    int m_rampFrom;
+    int m_rampTo;
+    bool m_ramping;
+    Clock::time_point m_rampStart;
+    Clock::duration m_rampDuration;
+    bool m_releasePending;
+    Clock::time_point m_releaseAt;
+
+    std::atomic<uint32_t> m_requests;
+    std::atomic<uint32_t> m_mixerCalls;
+};
+
+} // namespace TTS
+
+#endif
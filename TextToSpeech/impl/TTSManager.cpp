@@ -18,6 +18,8 @@
  */
 
 #include "TTSManager.h"
+#include "SatToken.h"
+#include "TTSStartupTrace.h"
 
 namespace TTS {
 
@@ -56,6 +58,24 @@ TTSManager::~TTSManager() {
     }
 }
 
+void TTSManager::startSpeaker() {
+    if(m_speaker)
+        m_speaker->start();
+}
+
+void TTSManager::configureDucking(uint32_t holdMs, uint32_t attackMs, uint32_t releaseMs) {
+    if(m_speaker)
+        m_speaker->configureDucking(holdMs, attackMs, releaseMs);
+}
+
+void TTSManager::prefetchSAT() {
+    if(m_defaultConfiguration.endPointType().compare("TTS2") != 0)
+        return;
+
+    StartupTrace::Phase phase("sat");
+    WPEFramework::Plugin::TTS::SatToken::getInstance(m_defaultConfiguration.satPluginCallsign())->getSAT();
+}
+
 TTS_Error TTSManager::enableTTS(bool enable) {
     static bool force = true; 
     if(force || m_defaultConfiguration.setEnabled(enable)) {
@@ -327,6 +347,42 @@ TTS_Error TTSManager::speak(int speechId, std::string callsign, std::string text
     return TTS_OK;
 }
 
+TTS_Error TTSManager::speakBatch(uint32_t firstSpeechId, std::string callsign, const std::vector<std::string> &texts) {
+    TTSLOG_TRACE("SpeakBatch");
+
+    if(!m_defaultConfiguration.isValid()) {
+        TTSLOG_ERROR("Configuration is not set, can't speak");
+        return TTS_INVALID_CONFIGURATION;
+    }
+
+    // The batch is all or nothing, so ids stay contiguous
+    if(texts.empty()) {
+        TTSLOG_ERROR("Empty batch provided from app");
+        return TTS_FAIL;
+    }
+
+    for(auto &text : texts) {
+        if(text.empty() || text.find_first_not_of(' ') == std::string::npos) {
+            TTSLOG_ERROR("Invalid Text Provided from app");
+            return TTS_FAIL;
+        }
+    }
+
+    if(m_speaker) {
+        if(checkAccess("speak", callsign))
+        {
+            m_speaker->speakBatch(this, firstSpeechId, callsign, texts, true, m_defaultConfiguration.primVolDuck());
+        }
+        else
+        {
+            TTSLOG_WARNING("No Speak access for callsign %s\n",callsign.c_str());
+            return TTS_NO_ACCESS;
+        }
+    }
+
+    return TTS_OK;
+}
+
 TTS_Error TTSManager::pause(uint32_t id) {
     TTSLOG_TRACE("Pause");
 
@@ -67,6 +67,13 @@ public:
     TTSManager(TTSEventCallback *eventCallback);
     virtual ~TTSManager();
 
+    // Brings up the speaker threads; otherwise done on the first speak
+    void startSpeaker();
+    // Acquires the SAT ahead of the first TTS2 request
+    void prefetchSAT();
+    // Hold time and ramps applied to the primary volume while speaking
+    void configureDucking(uint32_t holdMs, uint32_t attackMs, uint32_t releaseMs);
+
     // TTS Global APIs
     TTS_Error enableTTS(bool enable);
     bool isTTSEnabled();
@@ -86,6 +93,7 @@ public:
 
     //Speak APIs
     TTS_Error speak(int speechId, std::string callsign, std::string text);
+    TTS_Error speakBatch(uint32_t firstSpeechId, std::string callsign, const std::vector<std::string> &texts);
     TTS_Error pause(uint32_t id);
     TTS_Error resume(uint32_t id);
     TTS_Error shut(uint32_t id);
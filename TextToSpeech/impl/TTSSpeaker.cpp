@@ -21,6 +21,7 @@
 #include "TTSURLConstructer.h"
 #include "NetworkStatusObserver.h"
 #include "SatToken.h"
+#include "TTSStartupTrace.h"
 #include <systemaudioplatform.h>
 #include <unistd.h>
 #include <regex>
@@ -367,6 +368,7 @@ TTSSpeaker::TTSSpeaker(TTSConfiguration &config) :
     m_currentSpeech(NULL),
     m_isSpeaking(false),
     m_isPaused(false),
+    m_generation(Utils::Gst::newPipelineGeneration()),
     m_pipeline(NULL),
     m_source(NULL),
     m_audioSink(NULL),
@@ -383,7 +385,9 @@ TTSSpeaker::TTSSpeaker(TTSConfiguration &config) :
     m_isEOS(false),
     m_pcmAudioEnabled(false),
     m_ensurePipeline(false),
-    m_busWatch(0),
+    m_gstThread(NULL),
+    m_started(false),
+    m_busWatch(NULL),
     m_duration(0),
     m_pipelineConstructionFailures(0),
     m_maxPipelineConstructionFailures(INT_FROM_ENV("MAX_PIPELINE_FAILURE_THRESHOLD", 1)) {
@@ -391,11 +395,27 @@ TTSSpeaker::TTSSpeaker(TTSConfiguration &config) :
         setenv("GST_DEBUG", "2", 0);
         setenv("GST_REGISTRY_UPDATE", "no", 0);
         setenv("GST_REGISTRY_FORK", "no", 0);
+}
+
+void TTSSpeaker::start() {
+    std::lock_guard<std::mutex> lock(m_startMutex);
+    if(m_started)
+        return;
 
-        m_main_loop_thread = g_thread_new("BusWatch", (void* (*)(void*)) event_loop, this);
-        m_gstThread = new std::thread(GStreamerThreadFunc, this);
-        systemAudioInitialize();
+    StartupTrace::Phase phase("speaker_start");
+    // Bus watches live on a context of our own so that other in-process
+    // plugins running the global default context are not woken up by TTS
+    m_main_context = g_main_context_new();
+    m_main_loop = g_main_loop_new(m_main_context, false);
+    m_main_loop_thread = g_thread_new("BusWatch", (void* (*)(void*)) event_loop, this);
+    m_gstThread = new std::thread(GStreamerThreadFunc, this);
+    systemAudioInitialize();
+    m_started = true;
+}
 
+bool TTSSpeaker::isStarted() {
+    std::lock_guard<std::mutex> lock(m_startMutex);
+    return m_started;
 }
 
 TTSSpeaker::~TTSSpeaker() {
@@ -404,6 +424,10 @@ TTSSpeaker::~TTSSpeaker() {
     m_runThread = false;
     m_busThread = false;
     m_pcmAudioEnabled = false;
+    if(!isStarted())
+        return;
+
+    m_ducking.shutdown();
     systemAudioDeinitialize();
     m_condition.notify_one();
 
@@ -413,7 +437,7 @@ TTSSpeaker::~TTSSpeaker() {
         m_gstThread = NULL;
     }
 
-    if(g_main_loop_is_running(m_main_loop))
+    if(m_main_loop)
         g_main_loop_quit(m_main_loop);
 
     if (m_main_loop_thread) {
@@ -421,12 +445,25 @@ TTSSpeaker::~TTSSpeaker() {
         g_thread_unref(m_main_loop_thread);
         m_main_loop_thread = nullptr;
     }
+
+    if(m_main_loop) {
+        g_main_loop_unref(m_main_loop);
+        m_main_loop = NULL;
+    }
+    if(m_main_context) {
+        g_main_context_unref(m_main_context);
+        m_main_context = NULL;
+    }
 }
 
 PipelineType TTSSpeaker::getPipelineType() {
    return m_pipelinetype;
 }
 
+void TTSSpeaker::configureDucking(uint32_t holdMs, uint32_t attackMs, uint32_t releaseMs) {
+    m_ducking.configure(holdMs, attackMs, releaseMs);
+}
+
 void TTSSpeaker::ensurePipeline(bool flag) {
     std::unique_lock<std::mutex> mlock(m_queueMutex);
     TTSLOG_WARNING("%s", __FUNCTION__);
@@ -444,6 +481,28 @@ int TTSSpeaker::speak(TTSSpeakerClient *client, uint32_t id, std::string callsig
     SpeechData data(client, id, callsign, text, secure,primVolDuck);
     queueData(data);
 
+    // Lazy startup: the first utterance brings up the speaker threads
+    start();
+
+    return 0;
+}
+
+int TTSSpeaker::speakBatch(TTSSpeakerClient *client, uint32_t firstId, std::string callsign, const std::vector<std::string> &texts, bool secure, int8_t primVolDuck) {
+    TTSLOG_TRACE("firstId=%u, count=%u", firstId, (uint32_t)texts.size());
+
+    // Preemption applies to what was queued before the batch, not within it
+    if(client->configuration()->isPreemptive())
+        reset();
+
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        for(size_t i = 0; i < texts.size(); i++)
+            m_queue.push_back(SpeechData(client, firstId + i, callsign, texts[i], secure, primVolDuck));
+        m_condition.notify_one();
+    }
+
+    start();
+
     return 0;
 }
 
@@ -502,6 +561,8 @@ bool TTSSpeaker::cancelSpeech(uint32_t id) {
     bool status = false;
     if(m_isSpeaking && m_currentSpeech && ((m_currentSpeech->id == id) || (id == 0))) {
         m_isPaused = false;
+        // A pause or resume still queued must not reach the next utterance
+        (*m_generation)++;
         m_flushed = true;
         status = true;
         m_condition.notify_one();
@@ -524,7 +585,7 @@ bool TTSSpeaker::pause(uint32_t id) {
     if(m_pipeline) {
         if(!m_isPaused) {
             m_isPaused = true;
-            gst_element_set_state(m_pipeline, GST_STATE_PAUSED);
+            Utils::Gst::invokeStateChange(m_main_context, m_pipeline, GST_STATE_PAUSED, m_generation);
             TTSLOG_INFO("Set state to PAUSED");
             return true;
         }
@@ -538,7 +599,7 @@ bool TTSSpeaker::resume(uint32_t id) {
 
     if(m_pipeline) {
         if(m_isPaused) {
-            gst_element_set_state(m_pipeline, GST_STATE_PLAYING);
+            Utils::Gst::invokeStateChange(m_main_context, m_pipeline, GST_STATE_PLAYING, m_generation);
             TTSLOG_INFO("Set state to PLAYING");
             return true;
         }
@@ -729,7 +790,7 @@ void TTSSpeaker::createPipeline(PipelineType type) {
     
     TTSLOG_WARNING ("gst_element_get_bus\n");
     GstBus *bus = gst_element_get_bus(m_pipeline);
-    m_busWatch = gst_bus_add_watch(bus, GstBusCallback, (gpointer)(this));
+    m_busWatch = Utils::Gst::addWatch(bus, m_main_context, (GstBusFunc) GstBusCallback, (gpointer)(this), &m_busLatency);
     gst_object_unref(bus);
 
     m_pipelineConstructionFailures = 0;
@@ -752,6 +813,7 @@ void TTSSpeaker::resetPipeline() {
     m_remoteError = false;
     m_networkError = false;
     m_isPaused = false;
+    (*m_generation)++;
     m_isEOS = false;
 
     if(!m_pipeline) {
@@ -770,11 +832,10 @@ void TTSSpeaker::destroyPipeline() {
     if(m_pipeline) {
         gst_element_set_state(m_pipeline, GST_STATE_NULL);
         waitForStatus(GST_STATE_NULL, 1*1000);
-        g_source_remove(m_busWatch);
         gst_object_unref(m_pipeline);
     }
 
-    m_busWatch = 0;
+    Utils::Gst::removeWatch(m_busWatch);
     m_pipeline = NULL;
     m_pipelineConstructionFailures = 0;
     m_condition.notify_one();
@@ -888,7 +949,7 @@ void TTSSpeaker::play(string url, SpeechData &data, bool authrequired, string to
 
     gst_element_set_state(m_pipeline, GST_STATE_PLAYING);
 
-    systemAudioChangePrimaryVol(MIXGAIN_PRIM, data.primVolDuck);
+    m_ducking.duck(data.primVolDuck);
     TTSLOG_VERBOSE("Speaking.... ( %d, \"%s\")", data.id, data.text.c_str());
 
     //Wait for EOS with a timeout incase EOS never comes
@@ -923,22 +984,31 @@ void TTSSpeaker::speakText(TTSConfiguration &config, SpeechData &data) {
 void TTSSpeaker::event_loop(void *data)
 {
     TTSSpeaker *speaker= (TTSSpeaker*) data;
-    speaker->m_main_context = g_main_context_new();
-    speaker->m_main_loop = g_main_loop_new(NULL, false);
+    g_main_context_push_thread_default(speaker->m_main_context);
     g_main_loop_run(speaker->m_main_loop);
+    g_main_context_pop_thread_default(speaker->m_main_context);
 }
 
 void TTSSpeaker::GStreamerThreadFunc(void *ctx) {
     TTSLOG_INFO("Starting GStreamerThread");
     TTSSpeaker *speaker = (TTSSpeaker*) ctx;
+    bool firstPipeline = true;
 
-    if(!gst_is_initialized())
+    if(!gst_is_initialized()) {
+        StartupTrace::Phase phase("gst_init");
         gst_init(NULL,NULL);
+    }
 
     while(speaker && speaker->m_runThread) {
         if(speaker->needsPipelineUpdate()) {
             if(speaker->m_ensurePipeline) {
-                speaker->createPipeline(speaker->getPipelineType());
+                if(firstPipeline) {
+                    StartupTrace::Phase phase("pipeline");
+                    speaker->createPipeline(speaker->getPipelineType());
+                    firstPipeline = !speaker->m_pipeline;
+                } else {
+                    speaker->createPipeline(speaker->getPipelineType());
+                }
 
                 // If pipeline creation fails, send playbackerror to the client and remove the req from queue
                 if(!speaker->m_pipeline && !speaker->m_queue.empty()) {
@@ -994,9 +1064,13 @@ void TTSSpeaker::GStreamerThreadFunc(void *ctx) {
             speaker->speakText(*data.client->configuration(), data);
         }
 
-	// when not speaking, set primary mixgain back to default.
-	if(speaker->m_flushed || speaker->m_networkError || !speaker->m_pipeline || speaker->m_pipelineError) {
-           systemAudioChangePrimaryVol(MIXGAIN_PRIM,100);
+        // when not speaking, set primary mixgain back to default. The duck is
+        // held while more utterances are queued so the program audio does
+        // not pump between sentences.
+        {
+            std::unique_lock<std::mutex> mlock(speaker->m_queueMutex);
+            if(speaker->m_queue.empty())
+                speaker->m_ducking.release();
         }
         // Inform the client after speaking
         if(speaker->m_flushed)
@@ -1005,11 +1079,10 @@ void TTSSpeaker::GStreamerThreadFunc(void *ctx) {
             data.client->networkerror(data.id, data.callsign);
         else if(!speaker->m_pipeline || speaker->m_pipelineError)
             data.client->playbackerror(data.id, data.callsign);
-        else {
-            systemAudioChangePrimaryVol(MIXGAIN_PRIM, 100);
+        else
             data.client->spoke(data.id, data.callsign, data.text);
-	}
         speaker->setSpeakingState(false);
+        TTSLOG_VERBOSE("Bus message handling latency: %s", speaker->m_busLatency.summary().c_str());
 
         // stop the pipeline until the next tts string...
         speaker->resetPipeline();
@@ -1099,7 +1172,7 @@ bool TTSSpeaker::handleMessage(GstMessage *message) {
                     if(m_clientSpeaking) {
                         if(m_isPaused) {
                             m_isPaused = false;
-                            systemAudioChangePrimaryVol(MIXGAIN_PRIM, m_currentSpeech->primVolDuck);
+                            m_ducking.duck(m_currentSpeech->primVolDuck);
                             m_clientSpeaking->resumed(m_currentSpeech->id, m_currentSpeech->callsign);
                             m_condition.notify_one();
                         } else {
@@ -1109,7 +1182,7 @@ bool TTSSpeaker::handleMessage(GstMessage *message) {
                 } else if (oldstate == GST_STATE_PLAYING && newstate == GST_STATE_PAUSED) {
                     std::lock_guard<std::mutex> lock(m_stateMutex);
                     if(m_clientSpeaking && m_isPaused) {
-                        systemAudioChangePrimaryVol(MIXGAIN_PRIM, 100);
+                        m_ducking.release(false);
                         m_clientSpeaking->paused(m_currentSpeech->id, m_currentSpeech->callsign);
                         m_condition.notify_one();
                     }
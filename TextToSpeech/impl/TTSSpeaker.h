@@ -33,6 +33,8 @@
 
 #include "TTSCommon.h"
 #include "TTSConfiguration.h"
+#include "TTSDuckingController.h"
+#include "UtilsGstBus.h"
 // --- //
 
 namespace TTS {
@@ -94,10 +96,18 @@ public:
     TTSSpeaker(TTSConfiguration &config);
     ~TTSSpeaker();
 
+    // Spawns the GStreamer & bus watch threads and initializes system audio.
+    // Safe to call more than once; only the first call does the work.
+    void start();
+    bool isStarted();
+
     void ensurePipeline(bool flag=true);
+    void configureDucking(uint32_t holdMs, uint32_t attackMs, uint32_t releaseMs);
 
     // Speak Functions
     int speak(TTSSpeakerClient* client, uint32_t id, std::string callsign, std::string text, bool secure,int8_t primVolDuck); // Formalize data to speak API
+    // Queues texts[i] with id firstId + i in one step, so no other request can interleave
+    int speakBatch(TTSSpeakerClient* client, uint32_t firstId, std::string callsign, const std::vector<std::string> &texts, bool secure, int8_t primVolDuck);
     bool isSpeaking(uint32_t id);
     SpeechState getSpeechState(uint32_t id);
     bool cancelSpeech(uint32_t id=0);
@@ -115,6 +125,8 @@ private:
     SpeechData *m_currentSpeech;
     bool m_isSpeaking;
     bool m_isPaused;
+    // Bumped per utterance, see invokeStateChange
+    Utils::Gst::PipelineGeneration m_generation;
 
     std::mutex m_stateMutex;
     std::condition_variable m_condition;
@@ -147,7 +159,11 @@ private:
     bool        m_pcmAudioEnabled;
     bool        m_ensurePipeline;
     std::thread *m_gstThread;
-    guint       m_busWatch;
+    std::mutex  m_startMutex;
+    bool        m_started;
+    GSource     *m_busWatch;
+    Utils::GstBusLatencyHistogram m_busLatency;
+    DuckingController m_ducking;
     gint64      m_duration;
     uint8_t     m_pipelineConstructionFailures;
     const uint8_t     m_maxPipelineConstructionFailures;
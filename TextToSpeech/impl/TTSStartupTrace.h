@@ -0,0 +1,83 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _TTS_STARTUP_TRACE_H_
+#define _TTS_STARTUP_TRACE_H_
+
+#include "logger.h"
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace TTS {
+
+// Records how long each plugin startup phase took. Phases may complete on
+// different threads (Configure, background startup job, GStreamer thread).
+class StartupTrace {
+public:
+    class Phase {
+    public:
+        explicit Phase(const char *name) : m_name(name), m_start(std::chrono::steady_clock::now()) {}
+        ~Phase() {
+            StartupTrace::instance().record(m_name, std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - m_start).count());
+        }
+
+    private:
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+
+        const char *m_name;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    static StartupTrace &instance() {
+        static StartupTrace trace;
+        return trace;
+    }
+
+    void record(const char *phase, long long durationMs) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        long long sinceLoad = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - m_loaded).count();
+        m_phases.push_back(std::string(phase) + "=" + std::to_string(durationMs) + "ms");
+        TTSLOG_INFO("Startup phase %s took %lldms (%lldms since load)", phase, durationMs, sinceLoad);
+    }
+
+    void report(const char *stage) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::string summary;
+        for(auto &phase : m_phases)
+            summary += (summary.empty() ? "" : ", ") + phase;
+        TTSLOG_INFO("Startup trace after %s: %s", stage, summary.c_str());
+    }
+
+private:
+    StartupTrace() : m_loaded(std::chrono::steady_clock::now()) {}
+
+    std::mutex m_mutex;
+    std::chrono::steady_clock::time_point m_loaded;
+    std::vector<std::string> m_phases;
+};
+
+} // namespace TTS
+
+#endif
@@ -0,0 +1,218 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Utils {
+
+/**
+ * Records are formatted by the logging thread into a ring it owns and
+ * written out by a single writer thread, so the logging thread never
+ * blocks on log4c or stdout. Lines from different threads are written
+ * in per-thread order.
+ *
+ * Sink provides static void emit(int level, const char* text), called on
+ * the writer thread. Each plugin instantiates the writer with a sink of its
+ * own, so plugins loaded into one process do not share a writer or its
+ * thread local rings.
+ */
+template <typename Sink>
+class AsyncLogWriter {
+public:
+    static const size_t kRecordSize = 512;
+    static const size_t kRingRecords = 64;
+
+    struct Record {
+        int level;
+        char text[kRecordSize];
+    };
+
+    // Single-producer/single-consumer ring. The owning thread produces;
+    // consumers are serialised by AsyncLogWriter::_drainLock.
+    class Ring {
+    public:
+        Ring() : _head(0), _tail(0) {}
+
+        Record* reserve()
+        {
+            size_t head = _head.load(std::memory_order_relaxed);
+            if (head - _tail.load(std::memory_order_acquire) == kRingRecords)
+                return nullptr;
+            return &_records[head % kRingRecords];
+        }
+
+        void commit()
+        {
+            _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        size_t drain()
+        {
+            size_t tail = _tail.load(std::memory_order_relaxed);
+            size_t head = _head.load(std::memory_order_acquire);
+            size_t count = head - tail;
+            for (; tail != head; ++tail) {
+                const Record& record = _records[tail % kRingRecords];
+                Sink::emit(record.level, record.text);
+                _tail.store(tail + 1, std::memory_order_release);
+            }
+            return count;
+        }
+
+        bool empty() const
+        {
+            return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::atomic<size_t> _head;
+        std::atomic<size_t> _tail;
+        Record _records[kRingRecords];
+    };
+
+    static AsyncLogWriter* instance()
+    {
+        static AsyncLogWriter writer;
+        return sAlive.load(std::memory_order_acquire) ? &writer : nullptr;
+    }
+
+    // Ring of the calling thread, registered with the writer on first use
+    Ring& ring()
+    {
+        thread_local std::shared_ptr<Ring> local;
+        if (!local) {
+            local = std::make_shared<Ring>();
+            std::lock_guard<std::mutex> lock(_registryLock);
+            _rings.push_back(local);
+        }
+        return *local;
+    }
+
+    void wakeup()
+    {
+        if (_sleeping.exchange(false, std::memory_order_acq_rel))
+            _wakeup.notify_one();
+    }
+
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock(_drainLock);
+        drainAll();
+    }
+
+    // Writes a line on the calling thread after everything it queued
+    // earlier so that per-thread ordering is kept.
+    void writeThrough(int level, const char* text)
+    {
+        std::lock_guard<std::mutex> lock(_drainLock);
+        drainAll();
+        Sink::emit(level, text);
+        fflush(stdout);
+    }
+
+private:
+    AsyncLogWriter() : _running(true), _sleeping(false)
+    {
+        _thread = std::thread(&AsyncLogWriter::run, this);
+        sAlive.store(true, std::memory_order_release);
+    }
+
+    ~AsyncLogWriter()
+    {
+        sAlive.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(_sleepLock);
+            _running = false;
+        }
+        _wakeup.notify_one();
+        if (_thread.joinable())
+            _thread.join();
+        flush();
+    }
+
+    AsyncLogWriter(const AsyncLogWriter&) = delete;
+    AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+    // Caller holds _drainLock
+    void drainAll()
+    {
+        std::vector<std::shared_ptr<Ring>> rings;
+        {
+            std::lock_guard<std::mutex> lock(_registryLock);
+            rings = _rings;
+        }
+        size_t count = 0;
+        for (auto& ring : rings)
+            count += ring->drain();
+        if (count)
+            fflush(stdout);
+    }
+
+    // Rings of exited threads are only referenced from the registry
+    void pruneRings()
+    {
+        std::lock_guard<std::mutex> lock(_registryLock);
+        for (auto it = _rings.begin(); it != _rings.end();) {
+            if (it->use_count() == 1 && (*it)->empty())
+                it = _rings.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    void run()
+    {
+        while (true) {
+            flush();
+            pruneRings();
+
+            std::unique_lock<std::mutex> lock(_sleepLock);
+            if (!_running)
+                break;
+            _sleeping.store(true, std::memory_order_release);
+            _wakeup.wait_for(lock, std::chrono::milliseconds(20));
+            _sleeping.store(false, std::memory_order_release);
+        }
+    }
+
+    static std::atomic<bool> sAlive;
+
+    std::mutex _registryLock;
+    std::vector<std::shared_ptr<Ring>> _rings;
+    std::mutex _drainLock;
+    std::mutex _sleepLock;
+    std::condition_variable _wakeup;
+    bool _running;
+    std::atomic<bool> _sleeping;
+    std::thread _thread;
+};
+
+template <typename Sink>
+std::atomic<bool> AsyncLogWriter<Sink>::sAlive(false);
+
+} // namespace Utils
@@ -0,0 +1,180 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <gst/gst.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace Utils {
+
+// Histogram of the time spent handling bus messages. Bucket i counts
+// messages handled in less than 2^(i+4) microseconds; the last bucket
+// collects everything slower.
+class GstBusLatencyHistogram {
+public:
+    static const int kBuckets = 14;
+
+    GstBusLatencyHistogram()
+    {
+        for (int i = 0; i < kBuckets; i++)
+            _buckets[i] = 0;
+        _count = 0;
+        _maxUs = 0;
+    }
+
+    void add(uint64_t us)
+    {
+        int bucket = 0;
+        while (bucket < kBuckets - 1 && us >= (16ULL << bucket))
+            bucket++;
+        _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t max = _maxUs.load(std::memory_order_relaxed);
+        while (us > max && !_maxUs.compare_exchange_weak(max, us, std::memory_order_relaxed))
+            ;
+    }
+
+    uint64_t count() const { return _count.load(std::memory_order_relaxed); }
+
+    // "<16us:3 <32us:10 ... >=131072us:0 max=240us"
+    std::string summary() const
+    {
+        std::string out;
+        for (int i = 0; i < kBuckets; i++) {
+            out += (i < kBuckets - 1 ? "<" : ">=") + std::to_string(16ULL << (i < kBuckets - 1 ? i : i - 1)) + "us:"
+                + std::to_string(_buckets[i].load(std::memory_order_relaxed)) + " ";
+        }
+        out += "max=" + std::to_string(_maxUs.load(std::memory_order_relaxed)) + "us";
+        return out;
+    }
+
+private:
+    std::atomic<uint64_t> _buckets[kBuckets];
+    std::atomic<uint64_t> _count;
+    std::atomic<uint64_t> _maxUs;
+};
+
+namespace Gst {
+
+    struct WatchData {
+        GstBusFunc func;
+        gpointer userData;
+        GstBusLatencyHistogram* histogram;
+    };
+
+    inline gboolean timedDispatch(GstBus* bus, GstMessage* message, gpointer data)
+    {
+        WatchData* watch = static_cast<WatchData*>(data);
+        auto start = std::chrono::steady_clock::now();
+        gboolean result = watch->func(bus, message, watch->userData);
+        if (watch->histogram) {
+            watch->histogram->add(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+        return result;
+    }
+
+    inline void freeWatchData(gpointer data)
+    {
+        delete static_cast<WatchData*>(data);
+    }
+
+    // Adds a watch for |bus| on |context| rather than the thread default
+    // context. Every dispatch is timed into |histogram| when given. The
+    // returned source is released with removeWatch().
+    inline GSource* addWatch(GstBus* bus, GMainContext* context, GstBusFunc func, gpointer userData,
+        GstBusLatencyHistogram* histogram = nullptr)
+    {
+        GSource* source = gst_bus_create_watch(bus);
+        if (source == nullptr)
+            return nullptr;
+
+        WatchData* watch = new WatchData { func, userData, histogram };
+        g_source_set_callback(source, (GSourceFunc)(void*)timedDispatch, watch, freeWatchData);
+        g_source_attach(source, context);
+        return source;
+    }
+
+    inline void removeWatch(GSource*& source)
+    {
+        if (source != nullptr) {
+            g_source_destroy(source);
+            g_source_unref(source);
+            source = nullptr;
+        }
+    }
+
+    // Counts the items a pipeline has played. The owner bumps it when the
+    // pipeline moves on to the next item, which drops the state changes
+    // still queued for the previous one.
+    typedef std::shared_ptr<std::atomic<uint32_t>> PipelineGeneration;
+
+    inline PipelineGeneration newPipelineGeneration()
+    {
+        return std::make_shared<std::atomic<uint32_t>>(0);
+    }
+
+    struct StateChange {
+        GstElement* element;
+        GstState state;
+        PipelineGeneration generation;
+        uint32_t queuedIn;
+    };
+
+    inline gboolean applyStateChange(gpointer data)
+    {
+        StateChange* change = static_cast<StateChange*>(data);
+        // Skip if the pipeline has moved on to another item, or has been
+        // torn down, since the request was queued
+        if (change->generation && change->generation->load() != change->queuedIn)
+            return G_SOURCE_REMOVE;
+        if (GST_STATE_TARGET(change->element) > GST_STATE_READY)
+            gst_element_set_state(change->element, change->state);
+        return G_SOURCE_REMOVE;
+    }
+
+    inline void freeStateChange(gpointer data)
+    {
+        StateChange* change = static_cast<StateChange*>(data);
+        gst_object_unref(change->element);
+        delete change;
+    }
+
+    // Requests a PAUSED <-> PLAYING transition of |element| from the thread
+    // running |context|, so it is serialised with the bus messages handled
+    // there. Runs immediately when called on that thread. The caller keeps
+    // its own view of the state, as the transition happens later; with
+    // |generation| given the request only applies to the current item.
+    inline void invokeStateChange(GMainContext* context, GstElement* element, GstState state,
+        const PipelineGeneration& generation = PipelineGeneration())
+    {
+        StateChange* change = new StateChange { GST_ELEMENT(gst_object_ref(element)), state, generation,
+            generation ? generation->load() : 0 };
+        g_main_context_invoke_full(context, G_PRIORITY_DEFAULT, applyStateChange, change, freeStateChange);
+    }
+
+} // namespace Gst
+} // namespace Utils
@@ -39,7 +39,8 @@ public:
         return derived.send(message);
     }
 
-    void setOnMessageHandler(const std::function<void(const std::string&)>& handler)
+    // The handler receives the payload as an rvalue and may take it over
+    void setOnMessageHandler(const std::function<void(std::string&&)>& handler)
     {
         LOGINFO("Setting onMessage handler.");
         onMessage = handler;
@@ -48,7 +49,7 @@ public:
 protected:
     ~BinaryInterface() = default;
 
-    std::function<void(const std::string&)> onMessage{[](const std::string& message) { LOGWARN("Default onMessage."); }};
+    std::function<void(std::string&&)> onMessage{[](const std::string& message) { LOGWARN("Default onMessage."); }};
     websocketpp::frame::opcode::value opcode_{websocketpp::frame::opcode::binary};
 
 private:
@@ -58,6 +58,10 @@ protected:
     {
         result.setAuthenticationSuccess(true);
     }
+
+    void connectionOpened(websocketpp::connection_hdl handler)
+    {
+    }
 };
 
 }   // namespace WebSockets
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <string>
 #include <vector>
@@ -27,6 +28,7 @@
 #include "websocketpp/config/asio_client.hpp"
 #include "websocketpp/client.hpp"
 
+#include "TlsSessionCache.h"
 #include "Module.h"
 #include "UtilsLogging.h"
 
@@ -49,15 +51,22 @@ protected:
     void setup();
     std::string addProtocolToAddress(const std::string& address);
     void setAuthenticationState(ConnectionInitializationResult& result, websocketpp::connection_hdl hdl);
+    void connectionOpened(websocketpp::connection_hdl hdl);
 
 private:
+    using SocketType = boost::asio::ssl::stream<boost::asio::ip::tcp::socket>;
+
     WebsocketppContextPtr onTlsInit(websocketpp::connection_hdl);
+    void onSocketInit(websocketpp::connection_hdl hdl, SocketType& socket);
     bool logIfCertFailure(bool preverified, boost::asio::ssl::verify_context& verify_ctx) const;
     void loadCertificateAuthorities(const WebsocketppContextPtr& ctx) const;
 
     std::vector<std::string> CAFileNames_;
     std::string certFileName_;
     std::string keyFileName_;
+    // Of the client connection, see TlsSessionCache
+    std::string sessionKey_;
+    std::chrono::steady_clock::time_point handshakeStart_;
 };
 
 template <typename Derived, typename Role>
@@ -99,6 +108,7 @@ void TlsEnabled<Derived, Role>::setup()
     LOGINFO("Setting up TLS handler.");
     Derived& derived = static_cast<Derived&>(*this);
     derived.endpointImpl_.set_tls_init_handler(std::bind(&TlsEnabled<Derived, Role>::onTlsInit, this, std::placeholders::_1));
+    derived.endpointImpl_.set_socket_init_handler(std::bind(&TlsEnabled<Derived, Role>::onSocketInit, this, std::placeholders::_1, std::placeholders::_2));
 }
 
 template <typename Derived, typename Role>
@@ -126,6 +136,9 @@ void TlsEnabled<Derived, Role>::setAuthenticationState(ConnectionInitializationR
             case error::value::tls_handshake_failed:
             case error::value::tls_failed_sni_hostname:
                 LOGINFO("TLS connection not established.");
+                // A full handshake is tried next time
+                if (!sessionKey_.empty())
+                    TlsSessionCache::instance().remove(sessionKey_);
                 result.setAuthenticationSuccess(false);
                 return;
             break;
@@ -136,6 +149,40 @@ void TlsEnabled<Derived, Role>::setAuthenticationState(ConnectionInitializationR
     result.setAuthenticationSuccess(true);
 }
 
+template <typename Derived, typename Role>
+void TlsEnabled<Derived, Role>::connectionOpened(websocketpp::connection_hdl hdl)
+{
+    if (sessionKey_.empty())
+        return;
+    Derived& derived = static_cast<Derived&>(*this);
+    const auto& connection = derived.getConnection(hdl);
+    if (!connection)
+        return;
+
+    // Includes the websocket upgrade following the TLS handshake
+    SSL* ssl = connection->get_socket().native_handle();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - handshakeStart_).count();
+    TlsSessionCache::instance().handshakeDone(ssl, ms);
+    LOGINFO("TLS session %s, connected in %.1f ms.", SSL_session_reused(ssl) ? "resumed" : "negotiated", ms);
+}
+
+template <typename Derived, typename Role>
+void TlsEnabled<Derived, Role>::onSocketInit(websocketpp::connection_hdl hdl, SocketType& socket)
+{
+    Derived& derived = static_cast<Derived&>(*this);
+    if (derived.endpointImpl_.is_server())
+        return;
+    const auto& connection = derived.getConnection(hdl);
+    if (!connection)
+        return;
+
+    // Called after the TCP connect, right before the TLS handshake
+    const auto& uri = connection->get_uri();
+    sessionKey_ = TlsSessionCache::key(uri->get_host(), uri->get_port(), certFileName_, keyFileName_, CAFileNames_);
+    TlsSessionCache::instance().attach(socket.native_handle(), sessionKey_);
+    handshakeStart_ = std::chrono::steady_clock::now();
+}
+
 template <typename Derived, typename Role>
 typename TlsEnabled<Derived, Role>::WebsocketppContextPtr TlsEnabled<Derived, Role>::onTlsInit(websocketpp::connection_hdl)
 {
@@ -161,6 +208,9 @@ typename TlsEnabled<Derived, Role>::WebsocketppContextPtr TlsEnabled<Derived, Ro
         LOGINFO("Enabling advanced cipher negotiation.");
         SSL_CTX_set_ecdh_auto(ctx->native_handle(), 1);
 
+        LOGINFO("Enabling TLS session resumption.");
+        TlsSessionCache::enable(ctx->native_handle());
+
         LOGINFO("Loading certificates to context.");
         if (!boost::filesystem::exists(certFileName_))
         {
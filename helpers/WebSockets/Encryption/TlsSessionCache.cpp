@@ -0,0 +1,232 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "TlsSessionCache.h"
+
+#include <ctime>
+
+namespace WebSockets   {
+
+namespace {
+
+// What an SSL of a cached connection stores its sessions under, freed
+// with the SSL
+struct Binding
+{
+    TlsSessionCache* cache;
+    std::string key;
+};
+
+void freeBinding(void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*)
+{
+    delete static_cast<Binding*>(ptr);
+}
+
+int bindingIndex()
+{
+    static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, freeBinding);
+    return index;
+}
+
+// Also true for sessions of connections that were not shut down cleanly,
+// which OpenSSL marks as not resumable
+bool expired(const SSL_SESSION* session)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+    if (!SSL_SESSION_is_resumable(session))
+        return true;
+#endif
+    return SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session) <= (long)time(nullptr);
+}
+
+}
+
+TlsSessionCache::TlsSessionCache(size_t capacity)
+    : capacity_(capacity)
+    , handshakes_(0)
+    , offered_(0)
+    , resumed_(0)
+    , fullMs_(0.0)
+    , resumedMs_(0.0)
+{
+}
+
+TlsSessionCache::~TlsSessionCache()
+{
+    clear();
+}
+
+TlsSessionCache& TlsSessionCache::instance()
+{
+    static TlsSessionCache cache;
+    return cache;
+}
+
+std::string TlsSessionCache::key(const std::string& host, uint16_t port,
+    const std::string& certFileName, const std::string& keyFileName,
+    const std::vector<std::string>& CAFileNames)
+{
+    std::string key = host + ":" + std::to_string(port) + "|" + certFileName + "|" + keyFileName;
+    for (const std::string& CAFileName : CAFileNames)
+        key += "|" + CAFileName;
+    return key;
+}
+
+void TlsSessionCache::setCapacity(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = capacity;
+    trim();
+}
+
+void TlsSessionCache::enable(SSL_CTX* ctx)
+{
+    // Sessions are only kept here, the context lives for one connection
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(ctx, &TlsSessionCache::onNewSession);
+}
+
+void TlsSessionCache::attach(SSL* ssl, const std::string& key)
+{
+    SSL_SESSION* session = get(key);
+    if (session)
+    {
+        if (SSL_set_session(ssl, session) == 1)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            offered_++;
+        }
+        SSL_SESSION_free(session);
+    }
+    Binding* binding = new Binding{this, key};
+    if (!SSL_set_ex_data(ssl, bindingIndex(), binding))
+        delete binding;
+}
+
+void TlsSessionCache::handshakeDone(SSL* ssl, double ms)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    handshakes_++;
+    if (SSL_session_reused(ssl))
+    {
+        resumed_++;
+        resumedMs_ += ms;
+    }
+    else
+    {
+        fullMs_ += ms;
+    }
+}
+
+int TlsSessionCache::onNewSession(SSL* ssl, SSL_SESSION* session)
+{
+    Binding* binding = static_cast<Binding*>(SSL_get_ex_data(ssl, bindingIndex()));
+    if (!binding)
+        return 0;
+    binding->cache->put(binding->key, session);
+    // The reference was taken over
+    return 1;
+}
+
+void TlsSessionCache::put(const std::string& key, SSL_SESSION* session)
+{
+    if (expired(session))
+    {
+        SSL_SESSION_free(session);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end(); ++it)
+    {
+        if (it->key == key)
+        {
+            SSL_SESSION_free(it->session);
+            entries_.erase(it);
+            break;
+        }
+    }
+    entries_.push_front(Entry{key, session});
+    trim();
+}
+
+SSL_SESSION* TlsSessionCache::get(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end(); ++it)
+    {
+        if (it->key != key)
+            continue;
+        if (expired(it->session))
+        {
+            SSL_SESSION_free(it->session);
+            entries_.erase(it);
+            return nullptr;
+        }
+        entries_.splice(entries_.begin(), entries_, it);
+        SSL_SESSION_up_ref(it->session);
+        return it->session;
+    }
+    return nullptr;
+}
+
+void TlsSessionCache::remove(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end(); ++it)
+    {
+        if (it->key == key)
+        {
+            SSL_SESSION_free(it->session);
+            entries_.erase(it);
+            return;
+        }
+    }
+}
+
+void TlsSessionCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Entry& entry : entries_)
+        SSL_SESSION_free(entry.session);
+    entries_.clear();
+}
+
+TlsSessionCache::Stats TlsSessionCache::stats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.handshakes = handshakes_;
+    stats.offered = offered_;
+    stats.resumed = resumed_;
+    stats.fullMs = fullMs_;
+    stats.resumedMs = resumedMs_;
+    stats.sessions = entries_.size();
+    return stats;
+}
+
+void TlsSessionCache::trim()
+{
+    while (entries_.size() > capacity_)
+    {
+        SSL_SESSION_free(entries_.back().session);
+        entries_.pop_back();
+    }
+}
+
+}   // namespace WebSockets
@@ -0,0 +1,111 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <openssl/ssl.h>
+
+namespace WebSockets   {
+
+// TLS sessions of the servers secured websockets connected to, keyed by
+// host, port, client certificate and the CA files the server was verified
+// against, so that connecting again resumes the session with an abbreviated
+// handshake instead of a full RSA/ECDHE one.
+//
+// Sessions are handed to the cache by OpenSSL as the server sends them,
+// which for TLS 1.3 is after the handshake, and offered to the next
+// connection with the same key. The least recently used are dropped
+// beyond the capacity, expired ones when looked up.
+class TlsSessionCache
+{
+public:
+    struct Stats
+    {
+        uint64_t handshakes;
+        uint64_t offered;       // handshakes a cached session was offered for
+        uint64_t resumed;
+        double fullMs;          // total time of full handshakes
+        double resumedMs;       // total time of resumed handshakes
+        size_t sessions;
+    };
+
+    explicit TlsSessionCache(size_t capacity = 16);
+    ~TlsSessionCache();
+
+    // Cache shared by all secured websockets
+    static TlsSessionCache& instance();
+
+    // 0 disables caching and drops what is cached
+    void setCapacity(size_t capacity);
+
+    // Key of a connection. A resumed session skips verifying the server's
+    // chain, so connections verifying it against other CA files do not
+    // share sessions.
+    static std::string key(const std::string& host, uint16_t port,
+        const std::string& certFileName, const std::string& keyFileName,
+        const std::vector<std::string>& CAFileNames);
+
+    // Lets ctx hand the sessions of its connections to the cache
+    static void enable(SSL_CTX* ctx);
+    // Offers the session cached for key to ssl before its handshake and
+    // stores the sessions ssl receives under key
+    void attach(SSL* ssl, const std::string& key);
+    // Records a finished handshake of ssl
+    void handshakeDone(SSL* ssl, double ms);
+
+    // Takes over a reference of session
+    void put(const std::string& key, SSL_SESSION* session);
+    // Returns a new reference, nullptr if there is no session or it expired
+    SSL_SESSION* get(const std::string& key);
+    void remove(const std::string& key);
+    void clear();
+
+    Stats stats();
+
+private:
+    TlsSessionCache(const TlsSessionCache&) = delete;
+    TlsSessionCache& operator=(const TlsSessionCache&) = delete;
+
+    struct Entry
+    {
+        std::string key;
+        SSL_SESSION* session;
+    };
+
+    static int onNewSession(SSL* ssl, SSL_SESSION* session);
+    void trim();
+
+    std::mutex mutex_;
+    // Most recently used first
+    std::list<Entry> entries_;
+    size_t capacity_;
+    uint64_t handshakes_;
+    uint64_t offered_;
+    uint64_t resumed_;
+    double fullMs_;
+    double resumedMs_;
+};
+
+}   // namespace WebSockets
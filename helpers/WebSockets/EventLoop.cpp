@@ -0,0 +1,134 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "EventLoop.h"
+
+#include <algorithm>
+
+#include "UtilsLogging.h"
+
+namespace WebSockets   {
+
+namespace {
+thread_local bool onLoopThread = false;
+}
+
+EventLoop::EventLoop()
+    : threadCount_(2)
+    , endpoints_(0)
+    , peakEndpoints_(0)
+{
+}
+
+EventLoop::~EventLoop()
+{
+    stop();
+}
+
+EventLoop& EventLoop::instance()
+{
+    static EventLoop loop;
+    return loop;
+}
+
+void EventLoop::setThreads(size_t threads)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    threadCount_ = std::max<size_t>(1, threads);
+}
+
+boost::asio::io_service& EventLoop::ioService()
+{
+    return ioService_;
+}
+
+void EventLoop::start()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!threads_.empty())
+        return;
+
+    LOGINFO("Starting %zu websocket event loop threads", threadCount_);
+    ioService_.reset();
+    work_.reset(new boost::asio::io_service::work(ioService_));
+    for (size_t i = 0; i < threadCount_; i++)
+    {
+        threads_.emplace_back([this]() {
+            onLoopThread = true;
+            ioService_.run();
+        });
+    }
+}
+
+void EventLoop::stop()
+{
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (threads_.empty())
+            return;
+        if (onLoopThread)
+        {
+            LOGERR("Event loop cannot be stopped from its own thread");
+            return;
+        }
+        work_.reset();
+        if (endpoints_ > 0)
+        {
+            // Their connections would keep the threads running
+            LOGWARN("Stopping event loop with %zu endpoints left", endpoints_);
+            ioService_.stop();
+        }
+        threads.swap(threads_);
+    }
+    for (auto& thread : threads)
+        thread.join();
+    LOGINFO("Websocket event loop stopped");
+}
+
+bool EventLoop::isLoopThread() const
+{
+    return onLoopThread;
+}
+
+void EventLoop::addEndpoint()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    endpoints_++;
+    peakEndpoints_ = std::max(peakEndpoints_, endpoints_);
+}
+
+void EventLoop::removeEndpoint()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (endpoints_ > 0)
+        endpoints_--;
+}
+
+EventLoop::Stats EventLoop::stats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.threads = threads_.size();
+    stats.endpoints = endpoints_;
+    stats.peakEndpoints = peakEndpoints_;
+    return stats;
+}
+
+}   // namespace WebSockets
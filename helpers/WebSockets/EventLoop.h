@@ -0,0 +1,74 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <boost/asio/io_service.hpp>
+
+namespace WebSockets   {
+
+// io_service shared by all WSEndpoint instances, run by a small pool of
+// threads started with the first connection. Handlers of one connection
+// are serialized by its websocketpp strand, so a connection is served by
+// one thread at a time while the others serve other connections.
+class EventLoop
+{
+public:
+    struct Stats
+    {
+        size_t threads;
+        size_t endpoints;
+        size_t peakEndpoints;
+    };
+
+    static EventLoop& instance();
+
+    // Only takes effect before the threads are started
+    void setThreads(size_t threads);
+
+    boost::asio::io_service& ioService();
+    void start();
+    // Endpoints are expected to be destroyed before
+    void stop();
+    bool isLoopThread() const;
+
+    void addEndpoint();
+    void removeEndpoint();
+    Stats stats();
+
+private:
+    EventLoop();
+    ~EventLoop();
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    std::mutex mutex_;
+    boost::asio::io_service ioService_;
+    std::unique_ptr<boost::asio::io_service::work> work_;
+    std::vector<std::thread> threads_;
+    size_t threadCount_;
+    size_t endpoints_;
+    size_t peakEndpoints_;
+};
+
+}   // namespace WebSockets
@@ -37,6 +37,10 @@ protected:
     {
     }
 
+    void stopPing()
+    {
+    }
+
 private:
     PingPongDisabled(const PingPongDisabled&) = delete;
     PingPongDisabled& operator=(const PingPongDisabled&) = delete;
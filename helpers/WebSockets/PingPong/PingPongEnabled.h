@@ -20,7 +20,9 @@
 #pragma once
 #include <string>
 #include <functional>
+#include <mutex>
 
+#include "websocketpp/common/asio.hpp"
 #include "websocketpp/common/connection_hdl.hpp"
 #include "websocketpp/common/functional.hpp"
 #include "websocketpp/error.hpp"
@@ -40,6 +42,8 @@ public:
 protected:
     ~PingPongEnabled() = default;
     void startPing(ConnectionHandler handler);
+    // Cancels the next ping and keeps further ones from being scheduled
+    void stopPing();
 
 private:
     void schedule(uint interval, const std::function<void(websocketpp::lib::error_code const &)>& cb);
@@ -49,6 +53,9 @@ private:
     void printConnectionState(const websocketpp::session::state::value& state) const;
 
     const uint pingInterval_{5000};
+    std::mutex pingMutex_;
+    bool pingStopped_{false};
+    websocketpp::lib::shared_ptr<websocketpp::lib::asio::steady_timer> pingTimer_;
     PingPongEnabled(const PingPongEnabled&) = delete;
     PingPongEnabled& operator=(const PingPongEnabled&) = delete;
 };
@@ -73,11 +80,31 @@ void PingPongEnabled<Derived>::startPing(ConnectionHandler handler)
     schedule(pingInterval_, std::bind(&PingPongEnabled::ping, this, websocketpp::lib::placeholders::_1));
 }
 
+template<typename Derived>
+void PingPongEnabled<Derived>::stopPing()
+{
+    std::lock_guard<std::mutex> lock(pingMutex_);
+    pingStopped_ = true;
+    if (pingTimer_)
+    {
+        pingTimer_->cancel();
+        pingTimer_.reset();
+    }
+}
+
 template<typename Derived>
 void PingPongEnabled<Derived>::schedule(uint interval, const std::function<void(websocketpp::lib::error_code const &)>& cb)
 {
     Derived& derived = static_cast<Derived&>(*this);
-    derived.endpointImpl_.set_timer(
+    auto connection = derived.getConnection(derived.connectionHandler_);
+    if (!connection)
+        return;
+    // On the connection's strand, like all its other handlers on the
+    // shared event loop
+    std::lock_guard<std::mutex> lock(pingMutex_);
+    if (pingStopped_)
+        return;
+    pingTimer_ = connection->set_timer(
         interval,
         websocketpp::lib::bind(
             cb,
@@ -90,6 +117,11 @@ template<typename Derived>
 void PingPongEnabled<Derived>::ping(websocketpp::lib::error_code ecc)
 {
     LOGINFO();
+    if (ecc)
+    {
+        // Cancelled by stopPing() or the connection closing
+        return;
+    }
     Derived& derived = static_cast<Derived&>(*this);
     auto connection = derived.getConnection(derived.connectionHandler_);
     if (!connection)
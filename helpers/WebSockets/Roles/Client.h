@@ -40,8 +40,11 @@ public:
     Client() = default;
 
     bool connect(std::string address, std::function<void(ConnectionInitializationResult)> connectionInitializationCallback,
-        std::function<void(void)> connectionClosedCallback);
+        std::function<void(websocketpp::close::status::value)> connectionClosedCallback);
     void disconnect();
+    // Stops/restarts reading the socket, so the peer is throttled by TCP flow control
+    void pauseReading();
+    void resumeReading();
 
 protected:
     ~Client() = default;
@@ -53,7 +56,7 @@ private:
 
 template<typename Derived>
 bool Client<Derived>::connect(std::string address, std::function<void(ConnectionInitializationResult)> connectionInitializationCallback,
-    std::function<void(void)> connectionClosedCallback)
+    std::function<void(websocketpp::close::status::value)> connectionClosedCallback)
 {
     Derived& derived = static_cast<Derived&>(*this);
     const std::string uri = derived.addProtocolToAddress(address);
@@ -70,6 +73,10 @@ bool Client<Derived>::connect(std::string address, std::function<void(Connection
         return false;
     }
 
+    // Known before the connection opens, so the endpoint can wait for a
+    // pending attempt when it is destroyed
+    derived.connectionHandler_ = connection->get_handle();
+    derived.setConnectionActive(true);
     derived.startEventLoop();
     LOGINFO("Calling connect on: %s\n", uri.c_str());
     derived.endpointImpl_.connect(connection);
@@ -85,4 +92,25 @@ void Client<Derived>::disconnect()
     LOGINFO("Disconnection successfull");
 }
 
+template<typename Derived>
+void Client<Derived>::pauseReading()
+{
+    Derived& derived = static_cast<Derived&>(*this);
+    auto connection = derived.getConnection(derived.connectionHandler_);
+    if (!connection)
+        return;
+    // Dispatched to the event loop thread by websocketpp
+    connection->pause_reading();
+}
+
+template<typename Derived>
+void Client<Derived>::resumeReading()
+{
+    Derived& derived = static_cast<Derived&>(*this);
+    auto connection = derived.getConnection(derived.connectionHandler_);
+    if (!connection)
+        return;
+    connection->resume_reading();
+}
+
 }   // namespace WebSockets
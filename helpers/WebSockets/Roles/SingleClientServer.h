@@ -41,7 +41,7 @@ public:
     SingleClientServer() = default;
 
     bool start(int port, std::function<void(ConnectionInitializationResult)> connectionInitializationCallback,
-        std::function<void(void)> connectionClosedCallback);
+        std::function<void(websocketpp::close::status::value)> connectionClosedCallback);
     void stop();
 
 protected:
@@ -54,7 +54,7 @@ private:
 
 template<typename Derived>
 bool SingleClientServer<Derived>::start(int port, std::function<void(ConnectionInitializationResult)> connectionInitializationCallback,
-    std::function<void(void)> connectionClosedCallback)
+    std::function<void(websocketpp::close::status::value)> connectionClosedCallback)
 {
     LOGINFO("Starting websocket server on port: %d", port);
 
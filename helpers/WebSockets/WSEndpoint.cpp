@@ -18,6 +18,10 @@
 **/
 
 #include "WSEndpoint.h"
+
+#include <chrono>
+#include <future>
+
 #include "CommunicationInterface/BinaryInterface.h"
 #include "CommunicationInterface/CommandInterface.h"
 #include "CommunicationInterface/JsonRpcInterface.h"
@@ -50,9 +54,11 @@ WSEndpoint<Role, MessagingInterface, PingPong, Encryption>::WSEndpoint()
 
     registerHandlers();
 
-    endpointImpl_.init_asio();
+    // The shared event loop keeps running without connections, so no
+    // perpetual mode is needed
+    endpointImpl_.init_asio(&EventLoop::instance().ioService());
+    EventLoop::instance().addEndpoint();
     Encryption<WSEndpoint, Role<WSEndpoint> >::setup();
-    endpointImpl_.start_perpetual();
 }
 
 template<
@@ -64,9 +70,9 @@ template<
 WSEndpoint<Role, MessagingInterface, PingPong, Encryption>::~WSEndpoint()
 {
     LOGINFO();
-    endpointImpl_.stop_perpetual();
     closeConnection();
     stopEventLoop();
+    EventLoop::instance().removeEndpoint();
 }
 
 template<
@@ -106,15 +112,7 @@ template<
 void WSEndpoint<Role, MessagingInterface, PingPong, Encryption>::startEventLoop()
 {
     LOGINFO();
-    if (!eventLoopThread_)
-    {
-        LOGINFO("Starting new event loop thread");
-        eventLoopThread_ = std::thread([this]() {
-            LOGINFO("Starting websocket communication on new thread");
-            endpointImpl_.run();
-            LOGINFO("Event loop thread finished");
-        });
-    }
+    EventLoop::instance().start();
 }
 
 template<
@@ -126,12 +124,45 @@ template<
 void WSEndpoint<Role, MessagingInterface, PingPong, Encryption>::stopEventLoop()
 {
     LOGINFO();
-    if (eventLoopThread_ && eventLoopThread_->joinable())
+    if (EventLoop::instance().isLoopThread())
+    {
+        LOGERR("Endpoint destroyed on the event loop thread, not waiting for its connection.");
+        return;
+    }
+
+    // Resolving, connecting and both handshakes time out within this
+    const std::chrono::milliseconds timeout(20000);
     {
-        LOGINFO("Event loop thread is joinable. Waiting for join.");
-        eventLoopThread_->join();
-        eventLoopThread_ = boost::none;
+        std::unique_lock<std::mutex> lock(connectionMutex_);
+        if (!connectionDone_.wait_for(lock, timeout, [this]() { return !connectionActive_; }))
+            LOGERR("Connection did not close in time.");
     }
+    PingPong<WSEndpoint>::stopPing();
+
+    websocketpp::lib::error_code ec;
+    auto connection = endpointImpl_.get_con_from_hdl(connectionHandler_, ec);
+    if (ec || !connection)
+        return;
+    // Handlers already queued on the connection's strand run before this one
+    auto drained = std::make_shared<std::promise<void> >();
+    std::future<void> done = drained->get_future();
+    connection->set_timer(0, [drained](const websocketpp::lib::error_code&) { drained->set_value(); });
+    if (done.wait_for(timeout) != std::future_status::ready)
+        LOGERR("Connection handlers did not finish in time.");
+}
+
+template<
+    template <typename> typename Role,
+    template <typename> typename MessagingInterface,
+    template <typename> typename PingPong,
+    template <typename, typename> typename Encryption
+>
+void WSEndpoint<Role, MessagingInterface, PingPong, Encryption>::setConnectionActive(bool active)
+{
+    std::lock_guard<std::mutex> lock(connectionMutex_);
+    connectionActive_ = active;
+    if (!active)
+        connectionDone_.notify_all();
 }
 
 template<
@@ -189,7 +220,8 @@ void WSEndpoint<Role, MessagingInterface, PingPong, Encryption>::onMessage(Conne
         LOGERR("Received message is not tagged with text opcode, droping.");
         return;
     }
-    MessagingInterface<WSEndpoint>::onMessage(msg->get_payload());
+    // The message is not used after this, so its payload is moved out
+    MessagingInterface<WSEndpoint>::onMessage(std::move(msg->get_raw_payload()));
 }
 
 template<
@@ -202,6 +234,8 @@ void WSEndpoint<Role, MessagingInterface, PingPong, Encryption>::onOpen(Connecti
 {
     LOGINFO("New connection opened.");
     connectionHandler_ = handler;
+    setConnectionActive(true);
+    Encryption<WSEndpoint, Role<WSEndpoint> >::connectionOpened(handler);
     connectionInitializationCallback_(ConnectionInitializationResult(true));
     PingPong<WSEndpoint>::startPing(handler);
 }
@@ -228,6 +262,7 @@ void WSEndpoint<Role, MessagingInterface, PingPong, Encryption>::onFail(Connecti
     Encryption<WSEndpoint, Role<WSEndpoint> >::setAuthenticationState(result, handler);
 
     connectionInitializationCallback_(result);
+    setConnectionActive(false);
 }
 
 template<
@@ -236,10 +271,15 @@ template<
     template <typename> typename PingPong,
     template <typename, typename> typename Encryption
 >
-void WSEndpoint<Role, MessagingInterface, PingPong, Encryption>::onClose(ConnectionHandler)
+void WSEndpoint<Role, MessagingInterface, PingPong, Encryption>::onClose(ConnectionHandler handler)
 {
-    LOGINFO("Connection closed.");
-    connectionClosedCallback_();
+    websocketpp::close::status::value code = websocketpp::close::status::abnormal_close;
+    auto connection = getConnection(handler);
+    if (connection)
+        code = connection->get_remote_close_code();
+    LOGINFO("Connection closed, code: %u", (unsigned)code);
+    connectionClosedCallback_(code);
+    setConnectionActive(false);
 }
 
 template<
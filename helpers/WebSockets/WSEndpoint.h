@@ -18,13 +18,14 @@
 **/
 
 #pragma once
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
-#include <thread>
 #include <functional>
-#include <boost/optional.hpp>
 
 #include "ConnectionInitializationResult.h"
+#include "EventLoop.h"
 #include "websocketpp/server.hpp"
 
 namespace WebSockets   {
@@ -60,7 +61,9 @@ private:
     bool send(const std::string& message);
     void closeConnection();
     void startEventLoop();
+    // Waits until the shared event loop is done with this endpoint's connection
     void stopEventLoop();
+    void setConnectionActive(bool active);
     WSEndpoint::ConnectionPtr getConnection(ConnectionHandler handler);
 
     void registerHandlers();
@@ -71,9 +74,13 @@ private:
 
     WebsocketppEndpoint endpointImpl_;
     ConnectionHandler connectionHandler_;
-    boost::optional<std::thread> eventLoopThread_;
+    // From connecting until the connection has failed or closed
+    std::mutex connectionMutex_;
+    std::condition_variable connectionDone_;
+    bool connectionActive_{false};
     std::function<void(ConnectionInitializationResult)> connectionInitializationCallback_;
-    std::function<void(void)> connectionClosedCallback_;
+    // Called with the close code the peer sent, abnormal_close when none
+    std::function<void(websocketpp::close::status::value)> connectionClosedCallback_;
 };
 
 }   // namespace WebSockets